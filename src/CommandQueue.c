@@ -0,0 +1,265 @@
+/* Nic Pucci
+ * SIMULATION THREAD & COMMAND QUEUE IMPLEMENTATION
+ *
+ * Bounded ring of sequence-numbered slots: a producer claims a position with one compare-and-swap and
+ * publishes the slot by bumping its sequence, the simulation thread reads slots in order without any
+ * atomic read-modify-write. Commands are applied one at a time on the simulation thread, so the core
+ * keeps its single-threaded semantics and never needs a lock.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "CommandQueue.h"
+
+int OSSimApplyCommand ( OS_SIM *sim , const OSSIM_COMMAND *command , int *result )
+{
+	int unusedResult = 0;
+	if ( !result )
+	{
+		result = &unusedResult;
+	}
+
+	switch ( command -> type )
+	{
+		case OSSIM_CREATE_COMMAND :
+			return OSSimCreateProcess ( sim , command -> args [ 0 ] , result );
+
+		case OSSIM_CREATE_REAL_TIME_COMMAND :
+			return OSSimCreateRealTimeProcess ( sim , command -> args [ 0 ] , command -> args [ 1 ] , command -> args [ 2 ] , result );
+
+		case OSSIM_FORK_COMMAND :
+			return OSSimFork ( sim , result );
+
+		case OSSIM_KILL_COMMAND :
+			return OSSimKill ( sim , command -> args [ 0 ] , NULL );
+
+		case OSSIM_EXIT_COMMAND :
+			return OSSimExitWithStatus ( sim , command -> args [ 0 ] , NULL );
+
+		case OSSIM_QUANTUM_COMMAND :
+			return OSSimQuantum ( sim );
+
+		case OSSIM_SEND_COMMAND :
+			return OSSimSend ( sim , command -> args [ 0 ] , command -> messageStr , NULL );
+
+		case OSSIM_RECEIVE_COMMAND :
+			return OSSimReceive ( sim , NULL );
+
+		case OSSIM_REPLY_COMMAND :
+			return OSSimReply ( sim , command -> args [ 0 ] , command -> messageStr , NULL );
+
+		case OSSIM_NEW_SEMAPHORE_COMMAND :
+			return OSSimNewSemaphore ( sim , command -> args [ 0 ] , command -> args [ 1 ] );
+
+		case OSSIM_SEMAPHORE_P_COMMAND :
+			return OSSimSemaphoreP ( sim , command -> args [ 0 ] , result );
+
+		case OSSIM_SEMAPHORE_V_COMMAND :
+			return OSSimSemaphoreV ( sim , command -> args [ 0 ] , result );
+
+		case OSSIM_SET_AFFINITY_COMMAND :
+			return OSSimSetAffinity ( sim , command -> args [ 0 ] , command -> args [ 1 ] );
+
+		case OSSIM_USE_CPU_COMMAND :
+			return OSSimUseCPU ( sim , command -> args [ 0 ] );
+
+		case OSSIM_CREATE_IN_GROUP_COMMAND :
+			return OSSimCreateProcessInGroup ( sim , command -> args [ 0 ] , command -> args [ 1 ] , result );
+
+		case OSSIM_KILL_GROUP_COMMAND :
+			return OSSimKillGroup ( sim , command -> args [ 0 ] , result );
+
+		case OSSIM_SET_GROUP_PRIORITY_COMMAND :
+			return OSSimSetGroupPriority ( sim , command -> args [ 0 ] , command -> args [ 1 ] , result );
+
+		case OSSIM_GROUP_QUANTUM_COMMAND :
+			return OSSimGroupQuantum ( sim , command -> args [ 0 ] , result );
+
+		case OSSIM_WAIT_COMMAND :
+			return OSSimWait ( sim , result , NULL );
+
+		case OSSIM_KILL_TREE_COMMAND :
+			return OSSimKillTree ( sim , command -> args [ 0 ] , result );
+
+		case OSSIM_WRITE_MEMORY_COMMAND :
+			return OSSimWriteMemory ( sim , command -> args [ 0 ] , command -> messageStr , result );
+
+		default:
+			return OSSIM_FAILURE;
+	}
+}
+
+/* false while the slot at the dequeue position has not been published yet */
+int CommandWaiting ( SIM_THREAD *simThread )
+{
+	COMMAND_SLOT *slot = &simThread -> slots [ simThread -> dequeuePosition & ( COMMAND_QUEUE_CAPACITY - 1 ) ];
+	return atomic_load_explicit ( &slot -> sequence , memory_order_acquire ) == simThread -> dequeuePosition + 1;
+}
+
+/* applies up to COMMAND_BATCH_SIZE commands in queue order, returns how many */
+int ApplyBatch ( SIM_THREAD *simThread )
+{
+	int numApplied = 0;
+	while ( numApplied < COMMAND_BATCH_SIZE && CommandWaiting ( simThread ) )
+	{
+		COMMAND_SLOT *slot = &simThread -> slots [ simThread -> dequeuePosition & ( COMMAND_QUEUE_CAPACITY - 1 ) ];
+
+		int result = 0;
+		int status = OSSimApplyCommand ( simThread -> sim , &slot -> command , &result );
+		if ( slot -> command.onDone )
+		{
+			( *slot -> command.onDone ) ( &slot -> command , status , result , slot -> command.context );
+		}
+
+		// hands the slot back to the producer that will reach this position on the next lap
+		atomic_store_explicit ( &slot -> sequence , simThread -> dequeuePosition + COMMAND_QUEUE_CAPACITY , memory_order_release );
+		simThread -> dequeuePosition += 1;
+		numApplied += 1;
+	}
+
+	simThread -> numCommandsApplied += numApplied;
+	simThread -> numBatches += numApplied > 0;
+	return numApplied;
+}
+
+void *SimThreadMain ( void *simThreadPtr )
+{
+	SIM_THREAD *simThread = ( SIM_THREAD *) simThreadPtr;
+	while ( 1 )
+	{
+		if ( ApplyBatch ( simThread ) > 0 )
+		{
+			continue;
+		}
+
+		// announce the sleep before the last look at the queue, a producer either sees the flag or its command is seen here
+		pthread_mutex_lock ( &simThread -> wakeLock );
+		atomic_store ( &simThread -> sleeping , 1 );
+		atomic_thread_fence ( memory_order_seq_cst );
+
+		int stopping = atomic_load ( &simThread -> stopping );
+		if ( !CommandWaiting ( simThread ) && !stopping )
+		{
+			simThread -> numSleeps += 1;
+			pthread_cond_wait ( &simThread -> wakeCondition , &simThread -> wakeLock );
+		}
+
+		atomic_store ( &simThread -> sleeping , 0 );
+		pthread_mutex_unlock ( &simThread -> wakeLock );
+
+		if ( stopping && !CommandWaiting ( simThread ) )
+		{
+			return NULL;
+		}
+	}
+}
+
+SIM_THREAD *SimThreadStart ( OS_SIM *sim )
+{
+	SIM_THREAD *simThread = ( SIM_THREAD *) aligned_alloc ( CACHE_LINE_SIZE , sizeof ( SIM_THREAD ) );
+	if ( !simThread )
+	{
+		return NULL;
+	}
+
+	memset ( simThread , 0 , sizeof ( SIM_THREAD ) );
+	for ( unsigned long i = 0 ; i < COMMAND_QUEUE_CAPACITY ; i++ )
+	{
+		atomic_init ( &simThread -> slots [ i ].sequence , i );
+	}
+
+	simThread -> sim = sim;
+	pthread_mutex_init ( &simThread -> wakeLock , NULL );
+	pthread_cond_init ( &simThread -> wakeCondition , NULL );
+
+	if ( pthread_create ( &simThread -> thread , NULL , &SimThreadMain , simThread ) != 0 )
+	{
+		pthread_mutex_destroy ( &simThread -> wakeLock );
+		pthread_cond_destroy ( &simThread -> wakeCondition );
+		free ( simThread );
+		return NULL;
+	}
+
+	return simThread;
+}
+
+void WakeSimThread ( SIM_THREAD *simThread )
+{
+	pthread_mutex_lock ( &simThread -> wakeLock );
+	pthread_cond_signal ( &simThread -> wakeCondition );
+	pthread_mutex_unlock ( &simThread -> wakeLock );
+}
+
+int SimThreadSubmit ( SIM_THREAD *simThread , const OSSIM_COMMAND *command )
+{
+	if ( atomic_load_explicit ( &simThread -> stopping , memory_order_relaxed ) )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	unsigned long position = atomic_load_explicit ( &simThread -> enqueuePosition , memory_order_relaxed );
+	COMMAND_SLOT *slot = NULL;
+	int waitedForRoom = 0;
+	while ( 1 )
+	{
+		slot = &simThread -> slots [ position & ( COMMAND_QUEUE_CAPACITY - 1 ) ];
+		long lag = ( long ) ( atomic_load_explicit ( &slot -> sequence , memory_order_acquire ) - position );
+		if ( lag == 0 )
+		{
+			if ( atomic_compare_exchange_weak_explicit ( &simThread -> enqueuePosition , &position , position + 1 , memory_order_relaxed , memory_order_relaxed ) )
+			{
+				break; // the slot is ours
+			}
+		}
+		else if ( lag < 0 )
+		{
+			// full - the slot still holds the command from one lap ago
+			if ( !waitedForRoom )
+			{
+				atomic_fetch_add_explicit ( &simThread -> numFullWaits , 1 , memory_order_relaxed );
+				waitedForRoom = 1;
+			}
+
+			if ( atomic_load ( &simThread -> sleeping ) )
+			{
+				WakeSimThread ( simThread );
+			}
+
+			sched_yield ();
+			position = atomic_load_explicit ( &simThread -> enqueuePosition , memory_order_relaxed );
+		}
+		else
+		{
+			position = atomic_load_explicit ( &simThread -> enqueuePosition , memory_order_relaxed ); // another producer got here first
+		}
+	}
+
+	slot -> command = *command;
+	atomic_store_explicit ( &slot -> sequence , position + 1 , memory_order_release );
+
+	atomic_thread_fence ( memory_order_seq_cst ); // pairs with the fence before the simulation thread's last look
+	if ( atomic_load_explicit ( &simThread -> sleeping , memory_order_relaxed ) )
+	{
+		WakeSimThread ( simThread );
+	}
+
+	return SUCCESS_OP_CODE;
+}
+
+void SimThreadStop ( SIM_THREAD *simThread )
+{
+	if ( !simThread )
+	{
+		return;
+	}
+
+	atomic_store ( &simThread -> stopping , 1 );
+	WakeSimThread ( simThread );
+	pthread_join ( simThread -> thread , NULL );
+
+	pthread_mutex_destroy ( &simThread -> wakeLock );
+	pthread_cond_destroy ( &simThread -> wakeCondition );
+	free ( simThread );
+}
@@ -0,0 +1,98 @@
+/* Nic Pucci
+ * SIMULATION THREAD & COMMAND QUEUE HEADER
+*/
+
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <stdatomic.h>
+#include <pthread.h>
+#include "ossim.h"
+
+#define COMMAND_QUEUE_CAPACITY 4096 // commands, must be a power of 2
+#define COMMAND_BATCH_SIZE 64 // most commands the simulation thread applies between two looks at its stop flag
+#define CACHE_LINE_SIZE 64
+
+enum OSSIM_COMMAND_TYPE
+{
+	OSSIM_CREATE_COMMAND = 0 , // args [ 0 ] = priority level, result = new process ID
+	OSSIM_CREATE_REAL_TIME_COMMAND = 1 , // args = period, relative deadline, budget, result = new process ID
+	OSSIM_FORK_COMMAND = 2 , // result = new process ID
+	OSSIM_KILL_COMMAND = 3 , // args [ 0 ] = process ID
+	OSSIM_EXIT_COMMAND = 4 , // args [ 0 ] = exit status
+	OSSIM_QUANTUM_COMMAND = 5 ,
+	OSSIM_SEND_COMMAND = 6 , // args [ 0 ] = recipient process ID, messageStr
+	OSSIM_RECEIVE_COMMAND = 7 ,
+	OSSIM_REPLY_COMMAND = 8 , // args [ 0 ] = recipient process ID, messageStr
+	OSSIM_NEW_SEMAPHORE_COMMAND = 9 , // args = semaphore ID, initial value
+	OSSIM_SEMAPHORE_P_COMMAND = 10 , // args [ 0 ] = semaphore ID, result = semaphore value
+	OSSIM_SEMAPHORE_V_COMMAND = 11 , // args [ 0 ] = semaphore ID, result = semaphore value
+	OSSIM_SET_AFFINITY_COMMAND = 12 , // args = process ID, affinity mask
+	OSSIM_USE_CPU_COMMAND = 13 , // args [ 0 ] = CPU ID
+	OSSIM_CREATE_IN_GROUP_COMMAND = 14 , // args = priority level, group ID, result = new process ID
+	OSSIM_KILL_GROUP_COMMAND = 15 , // args [ 0 ] = group ID, result = processes killed
+	OSSIM_SET_GROUP_PRIORITY_COMMAND = 16 , // args = group ID, priority level, result = processes changed
+	OSSIM_GROUP_QUANTUM_COMMAND = 17 , // args [ 0 ] = group ID, result = processes pre-empted
+	OSSIM_WAIT_COMMAND = 18 , // result = child process ID reaped
+	OSSIM_KILL_TREE_COMMAND = 19 , // args [ 0 ] = process ID, result = processes killed
+	OSSIM_WRITE_MEMORY_COMMAND = 20 , // args [ 0 ] = page, messageStr = data, result = 1 after a copy-on-write fault
+	NUM_OSSIM_COMMAND_TYPES = 21
+};
+
+struct ossimCommand;
+
+/* runs on the simulation thread right after the command is applied, status is its OSSIM_STATUS */
+typedef void ( *OSSIM_COMMAND_DONE ) ( const struct ossimCommand *command , int status , int result , void *context );
+
+/* A PARSED COMMAND - copied into the queue, so the producer's copy can be reused as soon as it is submitted */
+typedef struct ossimCommand
+{
+	enum OSSIM_COMMAND_TYPE type;
+	int args [ 3 ];
+	char messageStr [ MAX_MESSAGE_LENGTH ];
+	OSSIM_COMMAND_DONE onDone; // NULL = fire and forget
+	void *context;
+} OSSIM_COMMAND;
+
+typedef struct commandSlot
+{
+	_Atomic unsigned long sequence; // == position: free for the producer that claims it, == position + 1: filled
+	OSSIM_COMMAND command;
+} COMMAND_SLOT;
+
+/* MULTI-PRODUCER / SINGLE-CONSUMER - any thread may submit, only the simulation thread applies */
+typedef struct simThread
+{
+	_Alignas ( CACHE_LINE_SIZE ) _Atomic unsigned long enqueuePosition; // producers only
+	_Alignas ( CACHE_LINE_SIZE ) unsigned long dequeuePosition; // simulation thread only
+	_Atomic int sleeping; // the simulation thread found the queue empty and is about to wait
+	_Atomic int stopping;
+
+	_Alignas ( CACHE_LINE_SIZE ) COMMAND_SLOT slots [ COMMAND_QUEUE_CAPACITY ];
+
+	OS_SIM *sim;
+	pthread_t thread;
+	pthread_mutex_t wakeLock; // only taken to sleep and to wake the simulation thread
+	pthread_cond_t wakeCondition;
+
+	/* COUNTERS */
+	unsigned long numCommandsApplied; // simulation thread only
+	unsigned long numBatches; // simulation thread only
+	unsigned long numSleeps; // simulation thread only
+	_Atomic unsigned long numFullWaits; // submits that found the queue full and had to wait for room
+} SIM_THREAD;
+
+
+/* applies one command on the calling thread, returns its OSSIM_STATUS */
+int OSSimApplyCommand ( OS_SIM *sim , const OSSIM_COMMAND *command , int *result );
+
+/* call after OSSimStart - from then on only the simulation thread may touch sim, until SimThreadStop returns */
+SIM_THREAD *SimThreadStart ( OS_SIM *sim );
+
+/* lock-free unless the queue is full or the simulation thread is asleep - FAILURE_OP_CODE once stopping */
+int SimThreadSubmit ( SIM_THREAD *simThread , const OSSIM_COMMAND *command );
+
+/* applies every command submitted before it is called, then joins the thread and frees it - producers must be done */
+void SimThreadStop ( SIM_THREAD *simThread );
+
+#endif
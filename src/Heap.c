@@ -0,0 +1,217 @@
+/* Nic Pucci
+ * HEAP IMPLEMENTATION (BINARY MIN-HEAP)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "List.h"
+#include "Heap.h"
+
+HEAP *HeapCreate ( int capacity , int ( *comparator ) ( void* , void* ) )
+{
+	if ( capacity <= 0 || !comparator )
+	{
+		return NULL;
+	}
+
+	HEAP *heap = ( HEAP *) malloc ( sizeof ( HEAP ) );
+	if ( !heap )
+	{
+		return NULL;
+	}
+
+	heap -> items = ( void **) malloc ( sizeof ( void *) * capacity );
+	if ( !heap -> items )
+	{
+		free ( heap );
+		return NULL;
+	}
+
+	heap -> count = 0;
+	heap -> capacity = capacity;
+	heap -> comparator = comparator;
+
+	return heap;
+}
+
+int HeapCount ( HEAP *heap )
+{
+	if ( !heap )
+	{
+		return 0;
+	}
+
+	return heap -> count;
+}
+
+void *HeapPeek ( HEAP *heap )
+{
+	if ( !heap || heap -> count <= 0 )
+	{
+		return NULL;
+	}
+
+	return heap -> items [ 0 ];
+}
+
+void SwapHeapItems ( HEAP *heap , int index1 , int index2 )
+{
+	void *temp = heap -> items [ index1 ];
+	heap -> items [ index1 ] = heap -> items [ index2 ];
+	heap -> items [ index2 ] = temp;
+}
+
+int HeapItemBefore ( HEAP *heap , int index1 , int index2 )
+{
+	return ( *heap -> comparator ) ( heap -> items [ index1 ] , heap -> items [ index2 ] ) < 0;
+}
+
+void SiftUp ( HEAP *heap , int index )
+{
+	while ( index > 0 )
+	{
+		int parentIndex = ( index - 1 ) / 2;
+		if ( !HeapItemBefore ( heap , index , parentIndex ) )
+		{
+			return;
+		}
+
+		SwapHeapItems ( heap , index , parentIndex );
+		index = parentIndex;
+	}
+}
+
+void SiftDown ( HEAP *heap , int index )
+{
+	while ( 1 )
+	{
+		int leftIndex = 2 * index + 1;
+		int rightIndex = leftIndex + 1;
+		int firstIndex = index;
+
+		if ( leftIndex < heap -> count && HeapItemBefore ( heap , leftIndex , firstIndex ) )
+		{
+			firstIndex = leftIndex;
+		}
+
+		if ( rightIndex < heap -> count && HeapItemBefore ( heap , rightIndex , firstIndex ) )
+		{
+			firstIndex = rightIndex;
+		}
+
+		if ( firstIndex == index )
+		{
+			return;
+		}
+
+		SwapHeapItems ( heap , index , firstIndex );
+		index = firstIndex;
+	}
+}
+
+int HeapPush ( HEAP *heap , void *item )
+{
+	if ( !heap )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	int heapFull = heap -> count >= heap -> capacity;
+	if ( heapFull )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	heap -> items [ heap -> count ] = item;
+	heap -> count += 1;
+	SiftUp ( heap , heap -> count - 1 );
+
+	return SUCCESS_OP_CODE;
+}
+
+void *RemoveHeapItemAt ( HEAP *heap , int index )
+{
+	void *item = heap -> items [ index ];
+
+	heap -> count -= 1;
+	if ( index == heap -> count )
+	{
+		return item;
+	}
+
+	heap -> items [ index ] = heap -> items [ heap -> count ];
+	SiftUp ( heap , index );
+	SiftDown ( heap , index );
+
+	return item;
+}
+
+void *HeapPop ( HEAP *heap )
+{
+	if ( !heap || heap -> count <= 0 )
+	{
+		return NULL;
+	}
+
+	return RemoveHeapItemAt ( heap , 0 );
+}
+
+int FindHeapIndex ( HEAP *heap , int ( *matcher ) ( void* , void* ) , void *comparisonArg )
+{
+	if ( !heap || !matcher )
+	{
+		return -1;
+	}
+
+	for ( int i = 0 ; i < heap -> count ; i++ )
+	{
+		int matchFound = ( *matcher ) ( heap -> items [ i ] , comparisonArg );
+		if ( matchFound )
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void *HeapSearch ( HEAP *heap , int ( *matcher ) ( void* , void* ) , void *comparisonArg )
+{
+	int index = FindHeapIndex ( heap , matcher , comparisonArg );
+	if ( index < 0 )
+	{
+		return NULL;
+	}
+
+	return heap -> items [ index ];
+}
+
+void *HeapRemove ( HEAP *heap , int ( *matcher ) ( void* , void* ) , void *comparisonArg )
+{
+	int index = FindHeapIndex ( heap , matcher , comparisonArg );
+	if ( index < 0 )
+	{
+		return NULL;
+	}
+
+	return RemoveHeapItemAt ( heap , index );
+}
+
+void HeapFree ( HEAP *heap , void ( *itemFree ) ( void* ) )
+{
+	if ( !heap )
+	{
+		return;
+	}
+
+	if ( itemFree )
+	{
+		for ( int i = 0 ; i < heap -> count ; i++ )
+		{
+			( *itemFree ) ( heap -> items [ i ] );
+		}
+	}
+
+	free ( heap -> items );
+	free ( heap );
+}
@@ -0,0 +1,33 @@
+/* Nic Pucci
+ * HEAP HEADER
+*/
+
+#ifndef HEAP_H
+#define HEAP_H
+
+typedef struct heap
+{
+	void **items;
+	int count;
+	int capacity;
+	int ( *comparator ) ( void* , void* ); // < 0 when first item must be popped before second
+} HEAP;
+
+
+HEAP *HeapCreate ( int capacity , int ( *comparator ) ( void* , void* ) );
+
+int HeapCount ( HEAP *heap );
+
+void *HeapPeek ( HEAP *heap );
+
+int HeapPush ( HEAP *heap , void *item );
+
+void *HeapPop ( HEAP *heap );
+
+void *HeapSearch ( HEAP *heap , int ( *matcher ) ( void* , void* ) , void *comparisonArg );
+
+void *HeapRemove ( HEAP *heap , int ( *matcher ) ( void* , void* ) , void *comparisonArg );
+
+void HeapFree ( HEAP *heap , void ( *itemFree ) ( void* ) );
+
+#endif
@@ -0,0 +1,92 @@
+/* Nic Pucci
+ * LOG-LINEAR (HDR-STYLE) HISTOGRAM IMPLEMENTATION
+*/
+
+#include <string.h>
+#include <limits.h>
+#include "Histogram.h"
+
+int BucketIndex ( unsigned long value )
+{
+	if ( value < HISTOGRAM_SUB_BUCKETS )
+	{
+		return value;
+	}
+
+	int exponent = ( sizeof ( unsigned long ) * CHAR_BIT - 1 ) - __builtin_clzl ( value ); // >= HISTOGRAM_SUB_BUCKET_BITS
+	int shift = exponent - HISTOGRAM_SUB_BUCKET_BITS;
+	int subBucket = ( value >> shift ) - HISTOGRAM_SUB_BUCKETS;
+	return ( shift + 1 ) * HISTOGRAM_SUB_BUCKETS + subBucket;
+}
+
+unsigned long BucketUpperBound ( int bucketIndex )
+{
+	if ( bucketIndex < HISTOGRAM_SUB_BUCKETS )
+	{
+		return bucketIndex;
+	}
+
+	int shift = bucketIndex / HISTOGRAM_SUB_BUCKETS - 1;
+	unsigned long subBucket = bucketIndex % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS;
+	return ( ( subBucket + 1 ) << shift ) - 1; // wraps to ULONG_MAX for the very last bucket
+}
+
+void HistogramInit ( HISTOGRAM *histogram )
+{
+	memset ( histogram , 0 , sizeof ( HISTOGRAM ) );
+	histogram -> min = ULONG_MAX;
+}
+
+void HistogramRecord ( HISTOGRAM *histogram , unsigned long value )
+{
+	histogram -> buckets [ BucketIndex ( value ) ] += 1;
+	histogram -> count += 1;
+	histogram -> total += value;
+
+	if ( value < histogram -> min )
+	{
+		histogram -> min = value;
+	}
+
+	if ( value > histogram -> max )
+	{
+		histogram -> max = value;
+	}
+}
+
+unsigned long HistogramPercentile ( const HISTOGRAM *histogram , double percentile )
+{
+	if ( histogram -> count == 0 )
+	{
+		return 0;
+	}
+
+	unsigned long rank = ( unsigned long ) ( percentile / 100.0 * histogram -> count + 0.5 );
+	if ( rank < 1 )
+	{
+		rank = 1;
+	}
+
+	unsigned long numSeen = 0;
+	for ( int i = 0 ; i < NUM_HISTOGRAM_BUCKETS ; i++ )
+	{
+		numSeen += histogram -> buckets [ i ];
+		if ( numSeen >= rank )
+		{
+			unsigned long upperBound = BucketUpperBound ( i );
+			return upperBound < histogram -> max ? upperBound : histogram -> max;
+		}
+	}
+
+	return histogram -> max;
+}
+
+double HistogramMean ( const HISTOGRAM *histogram )
+{
+	if ( histogram -> count == 0 )
+	{
+		return 0.0;
+	}
+
+	return ( double ) histogram -> total / histogram -> count;
+}
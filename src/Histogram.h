@@ -0,0 +1,31 @@
+/* Nic Pucci
+ * LOG-LINEAR (HDR-STYLE) HISTOGRAM HEADER
+*/
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#define HISTOGRAM_SUB_BUCKET_BITS 3 // 8 linear buckets per power of 2, so a bucket is at most 12.5% wide
+#define HISTOGRAM_SUB_BUCKETS ( 1 << HISTOGRAM_SUB_BUCKET_BITS )
+#define NUM_HISTOGRAM_BUCKETS ( ( 64 - HISTOGRAM_SUB_BUCKET_BITS + 1 ) * HISTOGRAM_SUB_BUCKETS )
+
+typedef struct histogram
+{
+	unsigned long buckets [ NUM_HISTOGRAM_BUCKETS ];
+	unsigned long count;
+	unsigned long total;
+	unsigned long min;
+	unsigned long max;
+} HISTOGRAM;
+
+
+void HistogramInit ( HISTOGRAM *histogram );
+
+void HistogramRecord ( HISTOGRAM *histogram , unsigned long value );
+
+/* upper bound of the bucket holding the percentile, never more than the largest value recorded */
+unsigned long HistogramPercentile ( const HISTOGRAM *histogram , double percentile );
+
+double HistogramMean ( const HISTOGRAM *histogram );
+
+#endif
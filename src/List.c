@@ -3,15 +3,12 @@
 */
 
 #include <stdio.h>
+#include <string.h>
 #include "List.h"
 
 const int SUCCESS_OP_CODE = 0;
 const int FAILURE_OP_CODE = -1;
 
-/* NUM OF ALLOCATIONS (Only for defining size of static arrays at compile-time) */
-#define MAX_NUM_NODES_ALLOC 500
-#define MAX_NUM_LISTS_ALLOC 500
-
 /* NUM OF ALLOCATIONS AS INTS (For functions and usage) */
 const int MAX_NUM_NODES = MAX_NUM_NODES_ALLOC;
 const int MAX_NUM_LISTS = MAX_NUM_LISTS_ALLOC;
@@ -20,28 +17,8 @@ const int MAX_NUM_LISTS = MAX_NUM_LISTS_ALLOC;
 const int INITIALIZED_FREE_MEM_ALLOC = 1;
 int initializedFreeMemAllocFlag = 0;
 
-/* ALLOCATED MEMORY */
-NODE allocNodesArr [ MAX_NUM_NODES_ALLOC ];
-int *freeNodeIndexesPtrArr [ MAX_NUM_NODES_ALLOC ];
-
-int topFreeNodeIndex = -1; 
-
-LIST allocListsArr [ MAX_NUM_LISTS_ALLOC ];
-int *freeListIndexesPtrArr [ MAX_NUM_LISTS_ALLOC ];
-int topFreeListIndex = -1;
-
-void DEBUG_PRINT_FREE_ALLOC_INFO () {
-	printf ( "\n-------------- DEBUG_PRINT_FREE_ALLOC_INFO\n" );
-
-	int totalFreeNodes = topFreeNodeIndex + 1;
-	int totalFreeListHeads = topFreeListIndex + 1;
-
-	printf ( "Total Free Nodes: %d\n", totalFreeNodes );
-	printf ( "Total Free List Heads: %d\n\n", totalFreeListHeads );
-
-	printf ( "topFreeNodeIndex: %d\n", topFreeNodeIndex );
-	printf ( "topFreeListIndex: %d\n\n", topFreeListIndex );
-}
+/* POOL USED BY ListCreate () */
+LIST_POOL defaultListPool;
 
 void ClearNode ( NODE *node ) 
 {
@@ -78,41 +55,41 @@ int SetList ( LIST *list , NODE *initHeadNodePtr )
 	return SUCCESS_OP_CODE;
 }
 
-NODE *PopNextFreeNode () 
+NODE *PopNextFreeNode ( LIST_POOL *pool ) 
 {
-	int stackEmpty = topFreeNodeIndex < 0;
+	int stackEmpty = pool -> topFreeNodeIndex < 0;
 	if ( stackEmpty ) 
 	{
 		return NULL;
 	}
 
-	int freeIndex = *freeNodeIndexesPtrArr [ topFreeNodeIndex ];
-	NODE* freeNode = &allocNodesArr [ freeIndex ];
+	int freeIndex = *pool -> freeNodeIndexesPtrArr [ pool -> topFreeNodeIndex ];
+	NODE* freeNode = &pool -> allocNodesArr [ freeIndex ];
 
-	topFreeNodeIndex -= 1;
+	pool -> topFreeNodeIndex -= 1;
 
 	return freeNode;
 }
 
-LIST *PopNextFreeList () 
+LIST *PopNextFreeList ( LIST_POOL *pool ) 
 {
-	int stackEmpty = topFreeListIndex < 0;
+	int stackEmpty = pool -> topFreeListIndex < 0;
 	if ( stackEmpty ) 
 	{
 		return NULL;
 	}
 
-	int freeIndex = *freeListIndexesPtrArr [ topFreeListIndex ];
-	LIST *freeList = &allocListsArr [ freeIndex ];
+	int freeIndex = *pool -> freeListIndexesPtrArr [ pool -> topFreeListIndex ];
+	LIST *freeList = &pool -> allocListsArr [ freeIndex ];
 
-	topFreeListIndex -= 1;
+	pool -> topFreeListIndex -= 1;
 
 	return freeList;
 }
 
-void PushFreedNode ( NODE *node ) 
+void PushFreedNode ( LIST_POOL *pool , NODE *node ) 
 {
-	if ( !node ) 
+	if ( !pool || !node ) 
 	{
 		return;
 	}
@@ -123,7 +100,7 @@ void PushFreedNode ( NODE *node )
 		return;
 	}
 
-	int stackFull = topFreeNodeIndex >= MAX_NUM_NODES - 1;
+	int stackFull = pool -> topFreeNodeIndex >= MAX_NUM_NODES - 1;
 	if ( stackFull ) 
 	{
 		return;
@@ -131,14 +108,14 @@ void PushFreedNode ( NODE *node )
 
 	ClearNode ( node );
 
-	topFreeNodeIndex += 1;
-	freeNodeIndexesPtrArr [ topFreeNodeIndex ] = nodeIndex;
+	pool -> topFreeNodeIndex += 1;
+	pool -> freeNodeIndexesPtrArr [ pool -> topFreeNodeIndex ] = nodeIndex;
 
 }
 
 void PushFreedList ( LIST *list ) 
 {
-	if ( !list ) 
+	if ( !list || !list -> pool ) 
 	{
 		return;
 	}
@@ -149,7 +126,8 @@ void PushFreedList ( LIST *list )
 		return;
 	}
 
-	int stackFull = topFreeListIndex >= MAX_NUM_LISTS - 1;
+	LIST_POOL *pool = list -> pool;
+	int stackFull = pool -> topFreeListIndex >= MAX_NUM_LISTS - 1;
 	if ( stackFull ) 
 	{
 		return;
@@ -157,23 +135,47 @@ void PushFreedList ( LIST *list )
 
 	SetList ( list , NULL );
 
-	topFreeListIndex += 1;
-	freeListIndexesPtrArr [ topFreeListIndex ] = listIndex;
+	pool -> topFreeListIndex += 1;
+	pool -> freeListIndexesPtrArr [ pool -> topFreeListIndex ] = listIndex;
 
 }
 
-void FreeAllocNode ( NODE *node ) 
+int PoolNodesInUse ( LIST_POOL *pool ) 
+{
+	return MAX_NUM_NODES - ( pool -> topFreeNodeIndex + 1 );
+}
+
+int PoolListsInUse ( LIST_POOL *pool ) 
+{
+	return MAX_NUM_LISTS - ( pool -> topFreeListIndex + 1 );
+}
+
+void AddOwnedNodes ( LIST_POOL *pool , int ownerID , int numNodes ) 
+{
+	LIST_OWNER_STATS *owner = &pool -> stats.owners [ ownerID ];
+	owner -> nodesInUse += numNodes;
+	if ( owner -> nodesInUse > owner -> peakNodesInUse ) 
+	{
+		owner -> peakNodesInUse = owner -> nodesInUse;
+	}
+}
+
+void FreeAllocNode ( LIST *list , NODE *node ) 
 {
 	if ( !node ) 
 	{
 		return;
 	}
 
+	LIST_POOL *pool = list -> pool;
+	pool -> stats.numNodeFrees += 1;
+	AddOwnedNodes ( pool , list -> ownerID , -1 );
+
 	node -> prevNodePtr = NULL;
 	node -> nextNodePtr = NULL;
 	node -> valuePtr = NULL;
 
-	PushFreedNode ( node );
+	PushFreedNode ( pool , node );
 }
 
 void FreeAllocList ( LIST *list ) 
@@ -185,60 +187,135 @@ void FreeAllocList ( LIST *list )
 
 	SetList ( list , NULL );
 
+	if ( list -> pool ) 
+	{
+		list -> pool -> stats.numListFrees += 1;
+	}
+
 	PushFreedList ( list );
 }
 
-NODE *GetNewNode ( void *item ) {
-	NODE *node = PopNextFreeNode ();
-	if ( node ) 
+NODE *GetNewNode ( LIST *list , void *item ) {
+	LIST_POOL *pool = list -> pool;
+	NODE *node = PopNextFreeNode ( pool );
+	if ( !node ) 
 	{
-		node -> valuePtr = item;
+		pool -> stats.numNodeExhaustions += 1;
+		pool -> stats.owners [ list -> ownerID ].numExhaustions += 1;
+		return NULL;
 	}
 
+	node -> valuePtr = item;
+
+	pool -> stats.numNodeAllocs += 1;
+	if ( PoolNodesInUse ( pool ) > pool -> stats.peakNodesInUse ) 
+	{
+		pool -> stats.peakNodesInUse = PoolNodesInUse ( pool );
+	}
+
+	AddOwnedNodes ( pool , list -> ownerID , 1 );
 	return node;
 }
 
-LIST *GetNewList () {
-	LIST *list = PopNextFreeList ();
+LIST *GetNewList ( LIST_POOL *pool ) {
+	LIST *list = PopNextFreeList ( pool );
+	if ( !list ) 
+	{
+		pool -> stats.numListExhaustions += 1;
+		return NULL;
+	}
+
+	list -> ownerID = 0;
+
+	pool -> stats.numListAllocs += 1;
+	if ( PoolListsInUse ( pool ) > pool -> stats.peakListsInUse ) 
+	{
+		pool -> stats.peakListsInUse = PoolListsInUse ( pool );
+	}
+
 	return list;
 }
 
-void InitAllFreeNodes () 
+void InitAllFreeNodes ( LIST_POOL *pool ) 
 {
+	pool -> topFreeNodeIndex = -1;
 	for ( int i = 0 ; i < MAX_NUM_NODES ; i++ ) 
 	{
-		NODE *node = &allocNodesArr [ i ];
+		NODE *node = &pool -> allocNodesArr [ i ];
 		node -> allocID = i;
-		PushFreedNode ( node );
+		PushFreedNode ( pool , node );
 	}
 }
 
-void InitAllFreeLists () 
+void InitAllFreeLists ( LIST_POOL *pool ) 
 {
+	pool -> topFreeListIndex = -1;
 	for ( int i = 0 ; i < MAX_NUM_LISTS ; i++ ) 
 	{
-		LIST *list = &allocListsArr [ i ];
+		LIST *list = &pool -> allocListsArr [ i ];
 		list -> currentNodeState = BEFORE_HEAD;
 		list -> currentCapacity = 0;
 		list -> allocID = i;
+		list -> pool = pool;
+		list -> ownerID = 0;
 		PushFreedList ( list );
 	}
 }
 
-void InitFreeAllocMemory () 
+void ListPoolInit ( LIST_POOL *pool ) 
+{
+	if ( !pool ) 
+	{
+		return;
+	}
+
+	InitAllFreeNodes ( pool ); 
+	InitAllFreeLists ( pool );
+	memset ( &pool -> stats , 0 , sizeof ( LIST_POOL_STATS ) );
+}
+
+void ListPoolGetStats ( LIST_POOL *pool , LIST_POOL_STATS *stats ) 
+{
+	if ( !pool || !stats ) 
+	{
+		return;
+	}
+
+	*stats = pool -> stats;
+	stats -> nodesInUse = PoolNodesInUse ( pool );
+	stats -> listsInUse = PoolListsInUse ( pool );
+}
+
+int ListSetOwner ( LIST *list , int ownerID ) 
 {
-	InitAllFreeNodes (); 
-	InitAllFreeLists ();
+	if ( !list || !list -> pool || ownerID < 0 || ownerID >= MAX_LIST_OWNERS ) 
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	AddOwnedNodes ( list -> pool , list -> ownerID , -list -> currentCapacity );
+	list -> ownerID = ownerID;
+	AddOwnedNodes ( list -> pool , list -> ownerID , list -> currentCapacity );
+	return SUCCESS_OP_CODE;
 }
 
 LIST *ListCreate () {
 	if ( initializedFreeMemAllocFlag != INITIALIZED_FREE_MEM_ALLOC ) 
 	{
-		InitFreeAllocMemory ();
+		ListPoolInit ( &defaultListPool );
 		initializedFreeMemAllocFlag = INITIALIZED_FREE_MEM_ALLOC;
 	}
 
-	LIST* list = GetNewList ();
+	return ListCreateFromPool ( &defaultListPool );
+}
+
+LIST *ListCreateFromPool ( LIST_POOL *pool ) {
+	if ( !pool ) 
+	{
+		return NULL;
+	}
+
+	LIST* list = GetNewList ( pool );
 	return list;
 }
 
@@ -400,7 +477,7 @@ int ListAppend ( LIST *list , void *item )
 		return FAILURE_OP_CODE;
 	}
 
-	NODE* newItemNode = GetNewNode ( item );
+	NODE* newItemNode = GetNewNode ( list , item );
 	int noFreeNodesLeft = !newItemNode;
 	if ( noFreeNodesLeft ) 
 	{
@@ -435,7 +512,7 @@ int ListPrepend ( LIST *list , void *item )
 		return FAILURE_OP_CODE;
 	}
 
-	NODE* newItemNode = GetNewNode ( item );
+	NODE* newItemNode = GetNewNode ( list , item );
 	int noFreeNodesLeft = !newItemNode;
 	if ( noFreeNodesLeft ) 
 	{
@@ -480,7 +557,7 @@ int ListInsert ( LIST *list , void *item )
 		return ListAppend ( list , item );
 	}
 
-	NODE* newItemNode = GetNewNode ( item );
+	NODE* newItemNode = GetNewNode ( list , item );
 	int noFreeNodesLeft = !newItemNode;
 	if ( noFreeNodesLeft ) 
 	{
@@ -521,7 +598,7 @@ int ListAdd ( LIST *list , void *item )
 		return ListAppend ( list , item );
 	}
 
-	NODE* newItemNode = GetNewNode ( item );
+	NODE* newItemNode = GetNewNode ( list , item );
 	int noFreeNodesLeft = !newItemNode;
 	if ( noFreeNodesLeft ) 
 	{
@@ -587,7 +664,7 @@ void *ListRemove ( LIST *list )
 	list -> currentCapacity -= 1;
 
 	void *value = oldCurrentNode -> valuePtr;
-	FreeAllocNode ( oldCurrentNode );
+	FreeAllocNode ( list , oldCurrentNode );
 	
 	return value;
 }
@@ -630,7 +707,7 @@ void *ListTrim ( LIST *list )
 	}
 
 	void *value = trimmedNode -> valuePtr;
-	FreeAllocNode ( trimmedNode );
+	FreeAllocNode ( list , trimmedNode );
 
 	return value;
 }
@@ -660,6 +737,11 @@ void ListFree ( LIST *list , void ( *itemFree ) ( void* ) )
 
 void ListConcat ( LIST *list1 , LIST **list2 ) 
 {
+	if ( list1 && list2 && *list2 && list1 -> pool != ( *list2 ) -> pool ) 
+	{
+		return; // nodes can only be moved between lists of the same pool
+	}
+
 	if ( !list1 || !( *list2 ) || ( *list2 ) -> currentCapacity <= 0 ) 
 	{
 		SetList ( *list2 , NULL );
@@ -668,6 +750,9 @@ void ListConcat ( LIST *list1 , LIST **list2 )
 		return;
 	}
 
+	AddOwnedNodes ( list1 -> pool , ( *list2 ) -> ownerID , -( *list2 ) -> currentCapacity );
+	AddOwnedNodes ( list1 -> pool , list1 -> ownerID , ( *list2 ) -> currentCapacity );
+
 	if ( list1 -> currentCapacity <= 0 ) 
 	{
 		list1 -> headNodePtr = (* list2 ) -> headNodePtr;
@@ -6,8 +6,8 @@
 #define LIST_H 
 
 /* PUBLIC ACCESS CONSTANT VARIABLES FOR TEST DRIVER */
-const int SUCCESS_OP_CODE;
-const int FAILURE_OP_CODE;
+extern const int SUCCESS_OP_CODE;
+extern const int FAILURE_OP_CODE;
 
 enum CURRENT_NODE_STATE {
 	BEFORE_HEAD,
@@ -15,6 +15,11 @@ enum CURRENT_NODE_STATE {
 	AFTER_TAIL
 };
 
+/* NUM OF ALLOCATIONS PER POOL (Only for defining size of static arrays at compile-time) */
+#define MAX_NUM_NODES_ALLOC 500
+#define MAX_NUM_LISTS_ALLOC 500
+#define MAX_LIST_OWNERS 8 // owner IDs a pool tracks node usage for, 0 = untagged
+
 typedef struct node
 {
 	void *valuePtr;
@@ -31,11 +36,58 @@ typedef struct list
 	int currentCapacity;
 	enum CURRENT_NODE_STATE currentNodeState;
 	int allocID; // index in its array
+	struct listPool *pool; // pool the list and its nodes are allocated from
+	int ownerID; // its nodes are counted under this owner in the pool statistics
 } LIST;
 
+/* ALLOCATOR STATISTICS - counted as nodes and lists are handed out and returned, since ListPoolInit */
+typedef struct listOwnerStats
+{
+	int nodesInUse;
+	int peakNodesInUse;
+	unsigned long numExhaustions; // adds that failed because the pool had no free node
+} LIST_OWNER_STATS;
+
+typedef struct listPoolStats
+{
+	int nodesInUse; // filled in by ListPoolGetStats
+	int peakNodesInUse;
+	int listsInUse; // filled in by ListPoolGetStats
+	int peakListsInUse;
+	unsigned long numNodeAllocs;
+	unsigned long numNodeFrees;
+	unsigned long numListAllocs;
+	unsigned long numListFrees;
+	unsigned long numNodeExhaustions;
+	unsigned long numListExhaustions;
+	LIST_OWNER_STATS owners [ MAX_LIST_OWNERS ];
+} LIST_POOL_STATS;
+
+/* ALLOCATED MEMORY - each pool is independent, so lists in different pools never share state */
+typedef struct listPool 
+{
+	NODE allocNodesArr [ MAX_NUM_NODES_ALLOC ];
+	int *freeNodeIndexesPtrArr [ MAX_NUM_NODES_ALLOC ];
+	int topFreeNodeIndex;
+
+	LIST allocListsArr [ MAX_NUM_LISTS_ALLOC ];
+	int *freeListIndexesPtrArr [ MAX_NUM_LISTS_ALLOC ];
+	int topFreeListIndex;
+
+	LIST_POOL_STATS stats;
+} LIST_POOL;
+
+
+void ListPoolInit ( LIST_POOL *pool );
+
+void ListPoolGetStats ( LIST_POOL *pool , LIST_POOL_STATS *stats );
+
+int ListSetOwner ( LIST *list , int ownerID );
 
 LIST *ListCreate ();
 
+LIST *ListCreateFromPool ( LIST_POOL *pool );
+
 int ListCount ( LIST *list );
 
 void *ListFirst ( LIST *list );
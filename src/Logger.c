@@ -0,0 +1,435 @@
+/* Nic Pucci
+ * ASYNC LOGGER IMPLEMENTATION (SPSC LOCK-FREE RING + WRITER THREAD + DEFERRED FORMATTING)
+*/
+
+#define _GNU_SOURCE // fopencookie
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <stddef.h>
+#include "List.h"
+#include "Logger.h"
+
+const char BINARY_LOG_MAGIC [ 8 ] = "OSSIMLOG";
+const int BINARY_LOG_VERSION = 1;
+
+typedef struct binaryLogHeader
+{
+	char magic [ 8 ];
+	int version;
+	int numFormats; // the log can only be rendered with the format table it was written with
+	int numStrings;
+} BINARY_LOG_HEADER;
+
+typedef struct binaryRecordHeader
+{
+	unsigned short kind;
+	unsigned short length; // payload bytes that follow
+} BINARY_RECORD_HEADER;
+
+unsigned long RingUse ( LOGGER *logger )
+{
+	unsigned long head = atomic_load_explicit ( &logger -> head , memory_order_relaxed );
+	unsigned long tail = atomic_load_explicit ( &logger -> tail , memory_order_acquire );
+	return head - tail;
+}
+
+const char *DeferredStr ( const LOG_FORMAT_TABLE *formatTable , int stringID )
+{
+	if ( stringID < 0 || stringID >= formatTable -> numStrings ) 
+	{
+		return "?";
+	}
+
+	return formatTable -> strings [ stringID ];
+}
+
+void RenderDeferred ( FILE *outputFile , const LOG_FORMAT_TABLE *formatTable , const DEFERRED_LOG_ENTRY *entry )
+{
+	if ( !formatTable || entry -> formatID >= formatTable -> numFormats ) 
+	{
+		fprintf ( outputFile , "<UNKNOWN LOG FORMAT %d>\n" , entry -> formatID );
+		return;
+	}
+
+	const char *format = formatTable -> formats [ entry -> formatID ];
+	int argIndex = 0;
+	while ( *format ) 
+	{
+		const char *conversionStart = strchr ( format , '%' );
+		if ( !conversionStart ) 
+		{
+			fputs ( format , outputFile );
+			return;
+		}
+
+		fwrite ( format , 1 , conversionStart - format , outputFile );
+		if ( conversionStart [ 1 ] == '%' ) 
+		{
+			fputc ( '%' , outputFile );
+			format = conversionStart + 2;
+			continue;
+		}
+
+		size_t specLength = 1 + strspn ( conversionStart + 1 , "-+ #0123456789." );
+		char conversion = conversionStart [ specLength ];
+		char spec [ 16 ];
+		if ( conversion == '\0' || specLength + 1 >= sizeof ( spec ) || !strchr ( "diuxXcs" , conversion ) ) 
+		{
+			fputs ( conversionStart , outputFile ); // not something a deferred record can hold, print it as is
+			return;
+		}
+
+		memcpy ( spec , conversionStart , specLength + 1 );
+		spec [ specLength + 1 ] = '\0';
+
+		int arg = argIndex < entry -> numArgs ? entry -> args [ argIndex ] : 0;
+		argIndex += 1;
+		if ( conversion == 's' ) 
+		{
+			fprintf ( outputFile , spec , DeferredStr ( formatTable , arg ) );
+		}
+		else 
+		{
+			fprintf ( outputFile , spec , arg );
+		}
+
+		format = conversionStart + specLength + 1;
+	}
+}
+
+void RenderRecord ( FILE *outputFile , const LOG_FORMAT_TABLE *formatTable , int kind , const void *payload , int length )
+{
+	if ( kind == LOG_TEXT )
+	{
+		fwrite ( payload , 1 , length , outputFile );
+	}
+	else if ( kind == LOG_DEFERRED_KIND )
+	{
+		DEFERRED_LOG_ENTRY entry = { 0 };
+		memcpy ( &entry , payload , length < ( int ) sizeof ( entry ) ? length : ( int ) sizeof ( entry ) );
+		RenderDeferred ( outputFile , formatTable , &entry );
+	}
+}
+
+void WriteRecord ( LOGGER *logger , const LOG_RECORD *record )
+{
+	if ( logger -> binaryFile ) 
+	{
+		BINARY_RECORD_HEADER recordHeader = { record -> kind , record -> length };
+		fwrite ( &recordHeader , sizeof ( recordHeader ) , 1 , logger -> binaryFile );
+		fwrite ( record -> payload , 1 , record -> length , logger -> binaryFile );
+	}
+
+	RenderRecord ( logger -> outputFile , logger -> formatTable , record -> kind , record -> payload , record -> length );
+}
+
+/* sleeps until the producer publishes a record or stops the logger */
+void WaitForRecords ( LOGGER *logger )
+{
+	// announce the sleep before the last look at the ring, the producer either sees the flag or its record is seen here
+	pthread_mutex_lock ( &logger -> wakeLock );
+	atomic_store ( &logger -> writerSleeping , 1 );
+	atomic_thread_fence ( memory_order_seq_cst );
+
+	if ( RingUse ( logger ) == 0 && !atomic_load ( &logger -> stopping ) )
+	{
+		atomic_fetch_add_explicit ( &logger -> numWriterSleeps , 1 , memory_order_relaxed );
+		pthread_cond_wait ( &logger -> wakeCondition , &logger -> wakeLock );
+	}
+
+	atomic_store ( &logger -> writerSleeping , 0 );
+	pthread_mutex_unlock ( &logger -> wakeLock );
+}
+
+void WakeLogWriter ( LOGGER *logger )
+{
+	pthread_mutex_lock ( &logger -> wakeLock );
+	pthread_cond_signal ( &logger -> wakeCondition );
+	pthread_mutex_unlock ( &logger -> wakeLock );
+}
+
+void *LogWriter ( void *loggerPtr )
+{
+	LOGGER *logger = ( LOGGER *) loggerPtr;
+	while ( 1 )
+	{
+		int stopping = atomic_load_explicit ( &logger -> stopping , memory_order_acquire );
+		unsigned long head = atomic_load_explicit ( &logger -> head , memory_order_acquire );
+		unsigned long tail = atomic_load_explicit ( &logger -> tail , memory_order_relaxed );
+
+		if ( tail == head )
+		{
+			if ( stopping )
+			{
+				return NULL; // the producer stops pushing before it sets stopping, so the ring is drained
+			}
+
+			WaitForRecords ( logger );
+			continue;
+		}
+
+		while ( tail != head )
+		{
+			WriteRecord ( logger , &logger -> ring [ tail & ( LOG_RING_CAPACITY - 1 ) ] );
+			tail += 1;
+			atomic_store_explicit ( &logger -> tail , tail , memory_order_release );
+			atomic_fetch_add_explicit ( &logger -> numRecordsWritten , 1 , memory_order_relaxed );
+		}
+
+		fflush ( logger -> outputFile );
+		if ( logger -> binaryFile ) 
+		{
+			fflush ( logger -> binaryFile );
+		}
+	}
+}
+
+LOGGER *LoggerCreate ( FILE *outputFile , enum LOG_OVERFLOW_POLICY policy , const LOG_FORMAT_TABLE *formatTable )
+{
+	if ( !outputFile )
+	{
+		return NULL;
+	}
+
+	LOGGER *logger = ( LOGGER *) calloc ( 1 , sizeof ( LOGGER ) );
+	if ( !logger )
+	{
+		return NULL;
+	}
+
+	atomic_init ( &logger -> head , 0 );
+	atomic_init ( &logger -> tail , 0 );
+	atomic_init ( &logger -> stopping , 0 );
+	atomic_init ( &logger -> numRecordsWritten , 0 );
+	logger -> policy = policy;
+	logger -> outputFile = outputFile;
+	logger -> formatTable = formatTable;
+	atomic_init ( &logger -> writerSleeping , 0 );
+	atomic_init ( &logger -> numWriterSleeps , 0 );
+	pthread_mutex_init ( &logger -> wakeLock , NULL );
+	pthread_cond_init ( &logger -> wakeCondition , NULL );
+
+	if ( policy != LOG_SYNC && pthread_create ( &logger -> writerThread , NULL , &LogWriter , logger ) != 0 )
+	{
+		pthread_mutex_destroy ( &logger -> wakeLock );
+		pthread_cond_destroy ( &logger -> wakeCondition );
+		free ( logger );
+		return NULL;
+	}
+
+	return logger;
+}
+
+int LoggerPush ( LOGGER *logger , int kind , const void *payload , int length )
+{
+	if ( !logger || length < 0 || length > LOG_PAYLOAD_SIZE )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	if ( logger -> policy == LOG_SYNC ) 
+	{
+		LOG_RECORD *record = &logger -> ring [ 0 ];
+		record -> kind = kind;
+		record -> length = length;
+		memcpy ( record -> payload , payload , length );
+		WriteRecord ( logger , record );
+
+		logger -> numRecordsPushed += 1;
+		atomic_store_explicit ( &logger -> numRecordsWritten , logger -> numRecordsPushed , memory_order_relaxed );
+		return SUCCESS_OP_CODE;
+	}
+
+	unsigned long ringUse = RingUse ( logger );
+	if ( ringUse >= LOG_RING_CAPACITY && logger -> policy == LOG_DROP && kind != LOG_TEXT )
+	{
+		logger -> numRecordsDropped += 1;
+		return FAILURE_OP_CODE;
+	}
+
+	if ( ringUse >= LOG_RING_CAPACITY )
+	{
+		logger -> numProducerWaits += 1;
+		while ( RingUse ( logger ) >= LOG_RING_CAPACITY )
+		{
+			sched_yield ();
+		}
+
+		ringUse = RingUse ( logger );
+	}
+
+	unsigned long head = atomic_load_explicit ( &logger -> head , memory_order_relaxed );
+	LOG_RECORD *record = &logger -> ring [ head & ( LOG_RING_CAPACITY - 1 ) ];
+	record -> kind = kind;
+	record -> length = length;
+	memcpy ( record -> payload , payload , length );
+	atomic_store_explicit ( &logger -> head , head + 1 , memory_order_release );
+
+	atomic_thread_fence ( memory_order_seq_cst ); // pairs with the fence before the writer thread's last look
+	if ( atomic_load_explicit ( &logger -> writerSleeping , memory_order_relaxed ) )
+	{
+		WakeLogWriter ( logger );
+	}
+
+	logger -> numRecordsPushed += 1;
+	if ( ringUse + 1 > logger -> peakRingUse )
+	{
+		logger -> peakRingUse = ringUse + 1;
+	}
+
+	return SUCCESS_OP_CODE;
+}
+
+int LoggerPushText ( LOGGER *logger , const char *text , int length )
+{
+	while ( length > 0 )
+	{
+		int chunkLength = length < LOG_PAYLOAD_SIZE ? length : LOG_PAYLOAD_SIZE;
+		if ( LoggerPush ( logger , LOG_TEXT , text , chunkLength ) != SUCCESS_OP_CODE )
+		{
+			return FAILURE_OP_CODE;
+		}
+
+		text += chunkLength;
+		length -= chunkLength;
+	}
+
+	return SUCCESS_OP_CODE;
+}
+
+int LoggerPushDeferred ( LOGGER *logger , int formatID , int numArgs , const int *args )
+{
+	if ( numArgs < 0 || numArgs > LOG_MAX_DEFERRED_ARGS )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	DEFERRED_LOG_ENTRY entry;
+	entry.formatID = formatID;
+	entry.numArgs = numArgs;
+	memcpy ( entry.args , args , numArgs * sizeof ( int ) );
+
+	return LoggerPush ( logger , LOG_DEFERRED_KIND , &entry , offsetof ( DEFERRED_LOG_ENTRY , args ) + numArgs * sizeof ( int ) );
+}
+
+ssize_t WriteTextStream ( void *logger , const char *buffer , size_t size )
+{
+	if ( LoggerPushText ( ( LOGGER *) logger , buffer , size ) != SUCCESS_OP_CODE )
+	{
+		return -1;
+	}
+
+	return size;
+}
+
+FILE *LoggerOpenTextStream ( LOGGER *logger )
+{
+	cookie_io_functions_t textStreamFunctions = { .write = &WriteTextStream };
+	FILE *textStream = fopencookie ( logger , "w" , textStreamFunctions );
+	if ( !textStream )
+	{
+		return NULL;
+	}
+
+	setvbuf ( textStream , NULL , _IONBF , 0 ); // every fprintf becomes its own record, in order with the client records
+	return textStream;
+}
+
+int LoggerOpenBinaryLog ( LOGGER *logger , const char *path )
+{
+	if ( !logger || logger -> binaryFile || logger -> numRecordsPushed > 0 )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	FILE *binaryFile = fopen ( path , "wb" );
+	if ( !binaryFile )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	BINARY_LOG_HEADER header = { { 0 } , BINARY_LOG_VERSION , 0 , 0 };
+	memcpy ( header.magic , BINARY_LOG_MAGIC , sizeof ( header.magic ) );
+	if ( logger -> formatTable )
+	{
+		header.numFormats = logger -> formatTable -> numFormats;
+		header.numStrings = logger -> formatTable -> numStrings;
+	}
+
+	if ( fwrite ( &header , sizeof ( header ) , 1 , binaryFile ) != 1 )
+	{
+		fclose ( binaryFile );
+		return FAILURE_OP_CODE;
+	}
+
+	logger -> binaryFile = binaryFile; // published to the writer thread by the release store of the first push
+	return SUCCESS_OP_CODE;
+}
+
+int LoggerRenderBinaryLog ( const char *path , FILE *outputFile , const LOG_FORMAT_TABLE *formatTable )
+{
+	FILE *binaryFile = fopen ( path , "rb" );
+	if ( !binaryFile )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	BINARY_LOG_HEADER header;
+	int validHeader = fread ( &header , sizeof ( header ) , 1 , binaryFile ) == 1 &&
+		memcmp ( header.magic , BINARY_LOG_MAGIC , sizeof ( header.magic ) ) == 0 &&
+		header.version == BINARY_LOG_VERSION &&
+		header.numFormats == formatTable -> numFormats &&
+		header.numStrings == formatTable -> numStrings;
+	if ( !validHeader )
+	{
+		fclose ( binaryFile );
+		return FAILURE_OP_CODE;
+	}
+
+	int result = SUCCESS_OP_CODE;
+	BINARY_RECORD_HEADER recordHeader;
+	unsigned char payload [ LOG_PAYLOAD_SIZE ];
+	while ( fread ( &recordHeader , sizeof ( recordHeader ) , 1 , binaryFile ) == 1 )
+	{
+		if ( recordHeader.length > LOG_PAYLOAD_SIZE || fread ( payload , 1 , recordHeader.length , binaryFile ) != recordHeader.length )
+		{
+			result = FAILURE_OP_CODE; // truncated or corrupt, everything before it has been rendered
+			break;
+		}
+
+		RenderRecord ( outputFile , formatTable , recordHeader.kind , payload , recordHeader.length );
+	}
+
+	fflush ( outputFile );
+	fclose ( binaryFile );
+	return result;
+}
+
+void LoggerFree ( LOGGER *logger )
+{
+	if ( !logger )
+	{
+		return;
+	}
+
+	if ( logger -> policy != LOG_SYNC )
+	{
+		atomic_store_explicit ( &logger -> stopping , 1 , memory_order_release );
+		WakeLogWriter ( logger );
+		pthread_join ( logger -> writerThread , NULL );
+	}
+
+	pthread_mutex_destroy ( &logger -> wakeLock );
+	pthread_cond_destroy ( &logger -> wakeCondition );
+
+	fflush ( logger -> outputFile );
+	if ( logger -> binaryFile )
+	{
+		fclose ( logger -> binaryFile );
+	}
+
+	free ( logger );
+}
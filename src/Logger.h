@@ -0,0 +1,107 @@
+/* Nic Pucci
+ * ASYNC LOGGER HEADER
+*/
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define LOG_RING_CAPACITY 4096 // records, must be a power of 2
+#define LOG_PAYLOAD_SIZE 240
+#define LOG_MAX_DEFERRED_ARGS 12
+
+enum LOG_OVERFLOW_POLICY
+{
+	LOG_BLOCK = 0 , // producer waits for the writer thread to make room
+	LOG_DROP = 1 , // record is thrown away and counted
+	LOG_SYNC = 2 // no ring or writer thread, records are rendered by the producer as they are pushed
+};
+
+enum LOG_RECORD_KIND
+{
+	LOG_TEXT = 0 , // payload is already formatted text, never dropped
+	LOG_DEFERRED_KIND = 1 // payload is a DEFERRED_LOG_ENTRY, formatted only when it is rendered
+};
+
+typedef struct logRecord
+{
+	int kind;
+	int length; // bytes of payload in use
+	unsigned char payload [ LOG_PAYLOAD_SIZE ];
+} LOG_RECORD;
+
+/* a printf call captured as its format ID and raw arguments - only the first numArgs args are stored */
+typedef struct deferredLogEntry
+{
+	unsigned short formatID;
+	unsigned short numArgs;
+	int args [ LOG_MAX_DEFERRED_ARGS ];
+} DEFERRED_LOG_ENTRY;
+
+/* FORMATS - supports %d %i %u %x %X %c with flags and width, a %s argument is an index into strings */
+typedef struct logFormatTable
+{
+	const char *const *formats; // indexed by format ID
+	int numFormats;
+	const char *const *strings;
+	int numStrings;
+} LOG_FORMAT_TABLE;
+
+/* SINGLE-PRODUCER / SINGLE-CONSUMER - only one thread may push, the writer thread is the only reader */
+typedef struct logger
+{
+	LOG_RECORD ring [ LOG_RING_CAPACITY ];
+	_Atomic unsigned long head; // next slot the producer fills
+	_Atomic unsigned long tail; // next slot the writer thread reads
+	_Atomic int stopping;
+	_Atomic int writerSleeping; // the writer thread found the ring empty and is about to wait
+
+	enum LOG_OVERFLOW_POLICY policy;
+	FILE *outputFile;
+	FILE *binaryFile; // every record is also appended here unrendered, NULL = none
+	const LOG_FORMAT_TABLE *formatTable;
+	pthread_t writerThread;
+	pthread_mutex_t wakeLock; // only taken to sleep and to wake the writer thread
+	pthread_cond_t wakeCondition;
+
+	/* COUNTERS */
+	unsigned long numRecordsPushed; // producer only
+	unsigned long numRecordsDropped; // producer only
+	unsigned long numProducerWaits; // producer only - times LOG_BLOCK had to wait for room
+	unsigned long peakRingUse; // producer only
+	_Atomic unsigned long numRecordsWritten; // writer thread only
+	_Atomic unsigned long numWriterSleeps; // writer thread only - times it found the ring empty and waited
+} LOGGER;
+
+/* logs a format ID and its int arguments - costs a few stores, the text is only produced when the record is rendered */
+#define LOG_DEFERRED( logger , formatID , ... ) \
+	do \
+	{ \
+		const int deferredArgs [] = { __VA_ARGS__ }; \
+		_Static_assert ( sizeof ( deferredArgs ) <= LOG_MAX_DEFERRED_ARGS * sizeof ( int ) , "too many deferred log arguments" ); \
+		LoggerPushDeferred ( logger , formatID , sizeof ( deferredArgs ) / sizeof ( int ) , deferredArgs ); \
+	} \
+	while ( 0 )
+
+
+LOGGER *LoggerCreate ( FILE *outputFile , enum LOG_OVERFLOW_POLICY policy , const LOG_FORMAT_TABLE *formatTable );
+
+int LoggerPush ( LOGGER *logger , int kind , const void *payload , int length );
+
+int LoggerPushText ( LOGGER *logger , const char *text , int length );
+
+int LoggerPushDeferred ( LOGGER *logger , int formatID , int numArgs , const int *args );
+
+FILE *LoggerOpenTextStream ( LOGGER *logger );
+
+/* BINARY LOG - must be opened before the first push, records are stored in native byte order */
+int LoggerOpenBinaryLog ( LOGGER *logger , const char *path );
+
+int LoggerRenderBinaryLog ( const char *path , FILE *outputFile , const LOG_FORMAT_TABLE *formatTable );
+
+void LoggerFree ( LOGGER *logger );
+
+#endif
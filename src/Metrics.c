@@ -0,0 +1,364 @@
+/* Nic Pucci
+ * PROMETHEUS METRICS EXPORT IMPLEMENTATION
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "Metrics.h"
+
+const int SCRAPE_REQUEST_TIMEOUT_MS = 100;
+const char HTTP_RESPONSE_HEADER [] = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n\r\n";
+const char *MIGRATION_DISTANCE_LABELS [ NUM_CPU_DISTANCES ] = { "same_cpu" , "shared_cache" , "same_node" , "cross_node" };
+const char *LIST_OWNER_LABELS [ NUM_OSSIM_LIST_OWNERS ] = { "untagged" , "ready" , "semaphore" , "send_blocked" , "receive_blocked" , "messages" , "wait_blocked" };
+
+void WriteMetricHeader ( FILE *outputFile , const char *name , const char *type , const char *help )
+{
+	fprintf ( outputFile , "# HELP %s %s\n# TYPE %s %s\n" , name , help , name , type );
+}
+
+void MetricsWrite ( FILE *outputFile , OS_SIM *sim )
+{
+	int numRunning = 0;
+	int numReady = 0;
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ )
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		numReady += CPUReadyCount ( sim , cpu );
+		numRunning += cpu -> runningProcess && cpu -> runningProcess -> processID != INIT_PROCESS_ID;
+	}
+
+	int numSemBlocked = 0;
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ )
+	{
+		numSemBlocked += ListCount ( sim -> semaphores [ i ].blockedPCBs );
+	}
+
+	WriteMetricHeader ( outputFile , "ossim_ticks_total" , "counter" , "Quantums the simulator has run." );
+	fprintf ( outputFile , "ossim_ticks_total %d\n" , sim -> currentTick );
+
+	WriteMetricHeader ( outputFile , "ossim_processes" , "gauge" , "Processes in each state, INIT excluded." );
+	fprintf ( outputFile , "ossim_processes{state=\"running\"} %d\n" , numRunning );
+	fprintf ( outputFile , "ossim_processes{state=\"ready\"} %d\n" , numReady );
+	fprintf ( outputFile , "ossim_processes{state=\"send_blocked\"} %d\n" , ListCount ( sim -> sendBlockedQueue ) );
+	fprintf ( outputFile , "ossim_processes{state=\"receive_blocked\"} %d\n" , ListCount ( sim -> receiveBlockedQueue ) );
+	fprintf ( outputFile , "ossim_processes{state=\"sem_blocked\"} %d\n" , numSemBlocked );
+	fprintf ( outputFile , "ossim_processes{state=\"period_waiting\"} %d\n" , HeapCount ( sim -> realTimeReleaseHeap ) );
+	fprintf ( outputFile , "ossim_processes{state=\"wait_blocked\"} %d\n" , ListCount ( sim -> waitBlockedQueue ) );
+
+	WriteMetricHeader ( outputFile , "ossim_zombie_processes" , "gauge" , "Processes that have ended but whose parent has not waited for them yet." );
+	fprintf ( outputFile , "ossim_zombie_processes %d\n" , sim -> numZombieProcesses );
+
+	WriteMetricHeader ( outputFile , "ossim_ready_queue_depth" , "gauge" , "Processes in each ready queue, level=\"rt\" is the EDF heap." );
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ )
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		fprintf ( outputFile , "ossim_ready_queue_depth{cpu=\"%d\",level=\"rt\"} %d\n" , i , HeapCount ( cpu -> realTimeReadyHeap ) );
+		for ( int level = 0 ; level < sim -> numPriorityLevels ; level++ )
+		{
+			fprintf ( outputFile , "ossim_ready_queue_depth{cpu=\"%d\",level=\"%d\"} %d\n" , i , level , ListCount ( cpu -> readyPriorityQueues [ level ] ) );
+		}
+	}
+
+	WriteMetricHeader ( outputFile , "ossim_message_backlog" , "gauge" , "Messages sent that no process has received yet." );
+	fprintf ( outputFile , "ossim_message_backlog %d\n" , ListCount ( sim -> messagesQueue ) );
+
+	WriteMetricHeader ( outputFile , "ossim_semaphore_waiters" , "gauge" , "Processes blocked on each created semaphore." );
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ )
+	{
+		if ( sim -> semaphores [ i ].semStatus == CREATED )
+		{
+			fprintf ( outputFile , "ossim_semaphore_waiters{semaphore=\"%d\"} %d\n" , i , ListCount ( sim -> semaphores [ i ].blockedPCBs ) );
+		}
+	}
+
+	WriteMetricHeader ( outputFile , "ossim_context_switches_total" , "counter" , "Context switches per CPU." );
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ )
+	{
+		fprintf ( outputFile , "ossim_context_switches_total{cpu=\"%d\"} %d\n" , i , sim -> cpus [ i ].numContextSwitches );
+	}
+
+	WriteMetricHeader ( outputFile , "ossim_cpu_ticks_total" , "counter" , "Busy and idle ticks per CPU." );
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ )
+	{
+		fprintf ( outputFile , "ossim_cpu_ticks_total{cpu=\"%d\",mode=\"busy\"} %d\n" , i , sim -> cpus [ i ].numBusyTicks );
+		fprintf ( outputFile , "ossim_cpu_ticks_total{cpu=\"%d\",mode=\"idle\"} %d\n" , i , sim -> cpus [ i ].numIdleTicks );
+	}
+
+	WriteMetricHeader ( outputFile , "ossim_dispatches_total" , "counter" , "Processes dispatched onto a CPU." );
+	fprintf ( outputFile , "ossim_dispatches_total %d\n" , sim -> numDispatches );
+
+	WriteMetricHeader ( outputFile , "ossim_priority_changes_total" , "counter" , "Priority level promotions and demotions." );
+	fprintf ( outputFile , "ossim_priority_changes_total{direction=\"promotion\"} %d\n" , sim -> numPromotions );
+	fprintf ( outputFile , "ossim_priority_changes_total{direction=\"demotion\"} %d\n" , sim -> numDemotions );
+
+	WriteMetricHeader ( outputFile , "ossim_deadline_misses_total" , "counter" , "REAL-TIME jobs that missed their deadline." );
+	fprintf ( outputFile , "ossim_deadline_misses_total %d\n" , sim -> totalDeadlineMisses );
+
+	WriteMetricHeader ( outputFile , "ossim_migrations_total" , "counter" , "Process migrations by CPU distance." );
+	for ( int i = SHARED_CACHE ; i < NUM_CPU_DISTANCES ; i++ )
+	{
+		fprintf ( outputFile , "ossim_migrations_total{distance=\"%s\"} %d\n" , MIGRATION_DISTANCE_LABELS [ i ] , sim -> numMigrationsByDistance [ i ] );
+	}
+
+	WriteMetricHeader ( outputFile , "ossim_forks_total" , "counter" , "Processes forked, each sharing its parent's memory copy-on-write." );
+	fprintf ( outputFile , "ossim_forks_total %d\n" , sim -> numForks );
+
+	WriteMetricHeader ( outputFile , "ossim_fork_pages_shared_total" , "counter" , "Memory pages forks shared instead of copying." );
+	fprintf ( outputFile , "ossim_fork_pages_shared_total %ld\n" , sim -> numForkPagesShared );
+
+	WriteMetricHeader ( outputFile , "ossim_page_table_copies_total" , "counter" , "Shared page tables copied on the first write by one of their processes." );
+	fprintf ( outputFile , "ossim_page_table_copies_total %d\n" , sim -> numPageTableCopies );
+
+	WriteMetricHeader ( outputFile , "ossim_cow_faults_total" , "counter" , "Writes to a shared page that gave the writer a page of its own." );
+	fprintf ( outputFile , "ossim_cow_faults_total %d\n" , sim -> numCOWFaults );
+
+	WriteMetricHeader ( outputFile , "ossim_deadlocks_total" , "counter" , "Wait-for cycles closed by a semaphore or send block." );
+	fprintf ( outputFile , "ossim_deadlocks_total %d\n" , sim -> numDeadlocksDetected );
+
+	WriteMetricHeader ( outputFile , "ossim_deadlocked_processes_total" , "counter" , "Processes on the wait-for cycles detected." );
+	fprintf ( outputFile , "ossim_deadlocked_processes_total %d\n" , sim -> numDeadlockedProcesses );
+
+	WriteMetricHeader ( outputFile , "ossim_deadlock_searches_total" , "counter" , "Deadlock searches, one per block that added a wait-for edge." );
+	fprintf ( outputFile , "ossim_deadlock_searches_total %d\n" , sim -> numDeadlockSearches );
+
+	WriteMetricHeader ( outputFile , "ossim_deadlock_search_steps_total" , "counter" , "Processes expanded by deadlock searches." );
+	fprintf ( outputFile , "ossim_deadlock_search_steps_total %ld\n" , sim -> numDeadlockSearchSteps );
+
+	WriteMetricHeader ( outputFile , "ossim_priority_boosts_total" , "counter" , "Processes raised above their own level by a process waiting on a lock they hold or a reply they owe." );
+	fprintf ( outputFile , "ossim_priority_boosts_total %d\n" , sim -> numPriorityBoosts );
+
+	WriteMetricHeader ( outputFile , "ossim_boosted_run_ticks_total" , "counter" , "Ticks processes ran above their own level, time otherwise lost to priority inversion." );
+	fprintf ( outputFile , "ossim_boosted_run_ticks_total %ld\n" , sim -> numBoostedRunTicks );
+
+	int numFreeNodes = sim -> listPool.topFreeNodeIndex + 1;
+	int numFreeLists = sim -> listPool.topFreeListIndex + 1;
+	WriteMetricHeader ( outputFile , "ossim_list_pool_in_use" , "gauge" , "List pool allocations in use." );
+	fprintf ( outputFile , "ossim_list_pool_in_use{kind=\"node\"} %d\n" , MAX_NUM_NODES_ALLOC - numFreeNodes );
+	fprintf ( outputFile , "ossim_list_pool_in_use{kind=\"list\"} %d\n" , MAX_NUM_LISTS_ALLOC - numFreeLists );
+	WriteMetricHeader ( outputFile , "ossim_list_pool_capacity" , "gauge" , "List pool allocations available in total." );
+	fprintf ( outputFile , "ossim_list_pool_capacity{kind=\"node\"} %d\n" , MAX_NUM_NODES_ALLOC );
+	fprintf ( outputFile , "ossim_list_pool_capacity{kind=\"list\"} %d\n" , MAX_NUM_LISTS_ALLOC );
+
+	LIST_POOL_STATS poolStats;
+	ListPoolGetStats ( &sim -> listPool , &poolStats );
+	WriteMetricHeader ( outputFile , "ossim_list_pool_peak_in_use" , "gauge" , "Most list pool allocations ever in use at once." );
+	fprintf ( outputFile , "ossim_list_pool_peak_in_use{kind=\"node\"} %d\n" , poolStats.peakNodesInUse );
+	fprintf ( outputFile , "ossim_list_pool_peak_in_use{kind=\"list\"} %d\n" , poolStats.peakListsInUse );
+	WriteMetricHeader ( outputFile , "ossim_list_pool_allocs_total" , "counter" , "List pool allocations handed out." );
+	fprintf ( outputFile , "ossim_list_pool_allocs_total{kind=\"node\"} %lu\n" , poolStats.numNodeAllocs );
+	fprintf ( outputFile , "ossim_list_pool_allocs_total{kind=\"list\"} %lu\n" , poolStats.numListAllocs );
+	WriteMetricHeader ( outputFile , "ossim_list_pool_frees_total" , "counter" , "List pool allocations returned." );
+	fprintf ( outputFile , "ossim_list_pool_frees_total{kind=\"node\"} %lu\n" , poolStats.numNodeFrees );
+	fprintf ( outputFile , "ossim_list_pool_frees_total{kind=\"list\"} %lu\n" , poolStats.numListFrees );
+	WriteMetricHeader ( outputFile , "ossim_list_pool_exhaustions_total" , "counter" , "List pool allocations that failed because the pool was empty." );
+	fprintf ( outputFile , "ossim_list_pool_exhaustions_total{kind=\"node\"} %lu\n" , poolStats.numNodeExhaustions );
+	fprintf ( outputFile , "ossim_list_pool_exhaustions_total{kind=\"list\"} %lu\n" , poolStats.numListExhaustions );
+
+	WriteMetricHeader ( outputFile , "ossim_list_owner_nodes_in_use" , "gauge" , "List pool nodes in use by each owner." );
+	for ( int i = OSSIM_READY_QUEUES ; i < NUM_OSSIM_LIST_OWNERS ; i++ )
+	{
+		fprintf ( outputFile , "ossim_list_owner_nodes_in_use{owner=\"%s\"} %d\n" , LIST_OWNER_LABELS [ i ] , poolStats.owners [ i ].nodesInUse );
+	}
+
+	WriteMetricHeader ( outputFile , "ossim_list_owner_peak_nodes_in_use" , "gauge" , "Most list pool nodes ever in use by each owner." );
+	for ( int i = OSSIM_READY_QUEUES ; i < NUM_OSSIM_LIST_OWNERS ; i++ )
+	{
+		fprintf ( outputFile , "ossim_list_owner_peak_nodes_in_use{owner=\"%s\"} %d\n" , LIST_OWNER_LABELS [ i ] , poolStats.owners [ i ].peakNodesInUse );
+	}
+
+	WriteMetricHeader ( outputFile , "ossim_list_owner_exhaustions_total" , "counter" , "Adds by each owner that failed because the pool had no free node." );
+	for ( int i = OSSIM_READY_QUEUES ; i < NUM_OSSIM_LIST_OWNERS ; i++ )
+	{
+		fprintf ( outputFile , "ossim_list_owner_exhaustions_total{owner=\"%s\"} %lu\n" , LIST_OWNER_LABELS [ i ] , poolStats.owners [ i ].numExhaustions );
+	}
+}
+
+long MsSince ( const struct timespec *startTime )
+{
+	struct timespec now;
+	clock_gettime ( CLOCK_MONOTONIC , &now );
+
+	return ( now.tv_sec - startTime -> tv_sec ) * 1000 + ( now.tv_nsec - startTime -> tv_nsec ) / 1000000;
+}
+
+int WriteMetricsFile ( METRICS_EXPORTER *exporter , OS_SIM *sim )
+{
+	char tempPath [ PATH_MAX_METRICS_FILE ];
+	snprintf ( tempPath , sizeof ( tempPath ) , "%s.tmp" , exporter -> filePath );
+
+	FILE *tempFile = fopen ( tempPath , "w" );
+	if ( !tempFile )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	MetricsWrite ( tempFile , sim );
+	if ( fclose ( tempFile ) != 0 || rename ( tempPath , exporter -> filePath ) != 0 ) // readers only ever see a whole file
+	{
+		unlink ( tempPath );
+		return FAILURE_OP_CODE;
+	}
+
+	clock_gettime ( CLOCK_MONOTONIC , &exporter -> lastFileWrite );
+	exporter -> fileStale = 0;
+	exporter -> numFileWrites += 1;
+	return SUCCESS_OP_CODE;
+}
+
+void ServeScrape ( METRICS_EXPORTER *exporter , OS_SIM *sim )
+{
+	int clientSocket = accept ( exporter -> listenSocket , NULL , NULL );
+	if ( clientSocket < 0 )
+	{
+		return;
+	}
+
+	char request [ 512 ] = { 0 };
+	struct pollfd clientPoll = { clientSocket , POLLIN , 0 };
+	if ( poll ( &clientPoll , 1 , SCRAPE_REQUEST_TIMEOUT_MS ) > 0 ) // plain clients send nothing, HTTP clients send a request first
+	{
+		if ( read ( clientSocket , request , sizeof ( request ) - 1 ) < 0 )
+		{
+			request [ 0 ] = '\0';
+		}
+	}
+
+	FILE *clientFile = fdopen ( clientSocket , "w" );
+	if ( !clientFile )
+	{
+		close ( clientSocket );
+		return;
+	}
+
+	if ( strncmp ( request , "GET " , 4 ) == 0 )
+	{
+		fputs ( HTTP_RESPONSE_HEADER , clientFile );
+	}
+
+	MetricsWrite ( clientFile , sim );
+	fclose ( clientFile );
+	exporter -> numScrapes += 1;
+}
+
+METRICS_EXPORTER *MetricsExporterCreate ( const char *socketPath , const char *filePath , int fileIntervalMs )
+{
+	if ( ( socketPath && strlen ( socketPath ) >= MAX_SOCKET_PATH_LENGTH ) || ( filePath && strlen ( filePath ) + 5 > PATH_MAX_METRICS_FILE ) || fileIntervalMs < 0 )
+	{
+		return NULL;
+	}
+
+	METRICS_EXPORTER *exporter = ( METRICS_EXPORTER *) calloc ( 1 , sizeof ( METRICS_EXPORTER ) );
+	if ( !exporter )
+	{
+		return NULL;
+	}
+
+	exporter -> listenSocket = -1;
+	exporter -> filePath = filePath;
+	exporter -> fileIntervalMs = fileIntervalMs;
+	exporter -> fileStale = filePath != NULL;
+
+	if ( socketPath )
+	{
+		struct sockaddr_un address = { .sun_family = AF_UNIX };
+		strncpy ( address.sun_path , socketPath , sizeof ( address.sun_path ) - 1 );
+
+		exporter -> listenSocket = socket ( AF_UNIX , SOCK_STREAM , 0 );
+		unlink ( socketPath ); // left behind by an earlier run
+		if ( exporter -> listenSocket < 0 || 
+			bind ( exporter -> listenSocket , ( struct sockaddr *) &address , sizeof ( address ) ) != 0 || 
+			listen ( exporter -> listenSocket , 8 ) != 0 )
+		{
+			if ( exporter -> listenSocket >= 0 )
+			{
+				close ( exporter -> listenSocket );
+			}
+
+			free ( exporter );
+			return NULL;
+		}
+
+		strncpy ( exporter -> socketPath , socketPath , MAX_SOCKET_PATH_LENGTH - 1 );
+		signal ( SIGPIPE , SIG_IGN ); // a scraper hanging up early must not end the simulator
+	}
+
+	return exporter;
+}
+
+void MetricsExporterStateChanged ( METRICS_EXPORTER *exporter )
+{
+	if ( exporter && exporter -> filePath )
+	{
+		exporter -> fileStale = 1;
+	}
+}
+
+int MetricsExporterWaitForInput ( METRICS_EXPORTER *exporter , OS_SIM *sim , int inputFD )
+{
+	while ( 1 )
+	{
+		int timeoutMs = -1;
+		if ( exporter -> fileStale )
+		{
+			long msUntilWrite = exporter -> numFileWrites == 0 ? 0 : exporter -> fileIntervalMs - MsSince ( &exporter -> lastFileWrite );
+			if ( msUntilWrite <= 0 )
+			{
+				WriteMetricsFile ( exporter , sim );
+			}
+			else
+			{
+				timeoutMs = msUntilWrite;
+			}
+		}
+
+		struct pollfd pollFDs [ 2 ] = { { inputFD , POLLIN , 0 } , { exporter -> listenSocket , POLLIN , 0 } };
+		int numPollFDs = exporter -> listenSocket >= 0 ? 2 : 1;
+		if ( poll ( pollFDs , numPollFDs , timeoutMs ) < 0 )
+		{
+			if ( errno == EINTR )
+			{
+				continue;
+			}
+
+			return FAILURE_OP_CODE;
+		}
+
+		if ( numPollFDs == 2 && ( pollFDs [ 1 ].revents & POLLIN ) )
+		{
+			ServeScrape ( exporter , sim );
+		}
+
+		if ( pollFDs [ 0 ].revents )
+		{
+			return SUCCESS_OP_CODE; // input, end of input or an error - the caller's read finds out which
+		}
+	}
+}
+
+void MetricsExporterFree ( METRICS_EXPORTER *exporter , OS_SIM *sim )
+{
+	if ( !exporter )
+	{
+		return;
+	}
+
+	if ( exporter -> fileStale )
+	{
+		WriteMetricsFile ( exporter , sim );
+	}
+
+	if ( exporter -> listenSocket >= 0 )
+	{
+		close ( exporter -> listenSocket );
+		unlink ( exporter -> socketPath );
+	}
+
+	free ( exporter );
+}
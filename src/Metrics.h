@@ -0,0 +1,42 @@
+/* Nic Pucci
+ * PROMETHEUS METRICS EXPORT HEADER
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <time.h>
+#include "ossim.h"
+
+#define MAX_SOCKET_PATH_LENGTH 108 // sun_path
+#define DEFAULT_METRICS_FILE_INTERVAL_MS 1000
+#define PATH_MAX_METRICS_FILE 4096
+
+/* SINGLE-THREADED - scrapes are answered from the thread that runs the simulator, so they never race a command */
+typedef struct metricsExporter
+{
+	int listenSocket; // -1 = no socket
+	char socketPath [ MAX_SOCKET_PATH_LENGTH ];
+	const char *filePath; // NULL = no file
+	int fileIntervalMs; // the file is rewritten at most this often
+	struct timespec lastFileWrite;
+	int fileStale; // the simulator changed since the file was last written
+	unsigned long numScrapes;
+	unsigned long numFileWrites;
+} METRICS_EXPORTER;
+
+
+/* Prometheus text exposition format, read from counters the core keeps up to date - no queue is walked */
+void MetricsWrite ( FILE *outputFile , OS_SIM *sim );
+
+METRICS_EXPORTER *MetricsExporterCreate ( const char *socketPath , const char *filePath , int fileIntervalMs );
+
+void MetricsExporterStateChanged ( METRICS_EXPORTER *exporter );
+
+/* answers scrapes and rewrites the file until inputFD is readable */
+int MetricsExporterWaitForInput ( METRICS_EXPORTER *exporter , OS_SIM *sim , int inputFD );
+
+void MetricsExporterFree ( METRICS_EXPORTER *exporter , OS_SIM *sim );
+
+#endif
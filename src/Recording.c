@@ -0,0 +1,195 @@
+/* Nic Pucci
+ * COMMAND RECORDING IMPLEMENTATION
+ *
+ * A header with the configuration, then entries of a kind byte and their fields in native byte order.
+ * A command costs 7 bytes plus its text, so hours of interactive input stay a few hundred KB.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Recording.h"
+
+int WriteField ( FILE *file , const void *field , size_t size ) 
+{
+	return fwrite ( field , size , 1 , file ) == 1 ? SUCCESS_OP_CODE : FAILURE_OP_CODE;
+}
+
+int ReadField ( FILE *file , void *field , size_t size ) 
+{
+	return fread ( field , size , 1 , file ) == 1 ? SUCCESS_OP_CODE : FAILURE_OP_CODE;
+}
+
+int WriteCheckpoint ( COMMAND_RECORDER *recorder , OS_SIM *sim ) 
+{
+	unsigned char kind = RECORDED_CHECKPOINT;
+	int tick = sim -> currentTick;
+	unsigned long stateHash = OSSimStateHash ( sim );
+
+	int result = WriteField ( recorder -> file , &kind , sizeof ( kind ) );
+	result |= WriteField ( recorder -> file , &recorder -> numCommands , sizeof ( recorder -> numCommands ) );
+	result |= WriteField ( recorder -> file , &tick , sizeof ( tick ) );
+	result |= WriteField ( recorder -> file , &stateHash , sizeof ( stateHash ) );
+	recorder -> numCheckpoints += 1;
+
+	return result == SUCCESS_OP_CODE ? SUCCESS_OP_CODE : FAILURE_OP_CODE;
+}
+
+COMMAND_RECORDER *RecorderCreate ( const char *path , OS_SIM *sim , int checkpointInterval ) 
+{
+	if ( checkpointInterval < 1 ) 
+	{
+		return NULL;
+	}
+
+	COMMAND_RECORDER *recorder = ( COMMAND_RECORDER *) calloc ( 1 , sizeof ( COMMAND_RECORDER ) );
+	if ( !recorder ) 
+	{
+		return NULL;
+	}
+
+	recorder -> file = fopen ( path , "wb" );
+	if ( !recorder -> file ) 
+	{
+		free ( recorder );
+		return NULL;
+	}
+
+	recorder -> checkpointInterval = checkpointInterval;
+
+	RECORDING_HEADER header;
+	memset ( &header , 0 , sizeof ( RECORDING_HEADER ) );
+	memcpy ( header.magic , RECORDING_MAGIC , sizeof ( header.magic ) );
+	header.version = RECORDING_VERSION;
+	header.numCPUs = sim -> numCPUs;
+	header.numNodes = sim -> numNodes;
+	header.numCPUsPerCache = sim -> numCPUsPerCache;
+	header.numPriorityLevels = sim -> numPriorityLevels;
+	header.maxCPUBursts = sim -> maxCPUBursts;
+	header.agingPolicy = sim -> agingPolicy;
+	header.checkpointInterval = checkpointInterval;
+
+	// the start state is checkpointed too, so a replay against a different build fails before its first command
+	if ( WriteField ( recorder -> file , &header , sizeof ( RECORDING_HEADER ) ) != SUCCESS_OP_CODE || 
+		WriteCheckpoint ( recorder , sim ) != SUCCESS_OP_CODE ) 
+	{
+		fclose ( recorder -> file );
+		free ( recorder );
+		return NULL;
+	}
+
+	return recorder;
+}
+
+int RecorderAppendCommand ( COMMAND_RECORDER *recorder , OS_SIM *sim , const char *command , int length ) 
+{
+	if ( !recorder ) 
+	{
+		return SUCCESS_OP_CODE;
+	}
+
+	if ( length < 0 || length > MAX_RECORDED_COMMAND_LENGTH ) 
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	unsigned char kind = RECORDED_COMMAND;
+	unsigned short commandLength = length;
+	int tick = sim -> currentTick;
+
+	int result = WriteField ( recorder -> file , &kind , sizeof ( kind ) );
+	result |= WriteField ( recorder -> file , &tick , sizeof ( tick ) );
+	result |= WriteField ( recorder -> file , &commandLength , sizeof ( commandLength ) );
+	if ( length > 0 ) 
+	{
+		result |= WriteField ( recorder -> file , command , length );
+	}
+
+	recorder -> numCommands += 1;
+	return result == SUCCESS_OP_CODE ? SUCCESS_OP_CODE : FAILURE_OP_CODE;
+}
+
+int RecorderCommandDone ( COMMAND_RECORDER *recorder , OS_SIM *sim ) 
+{
+	if ( !recorder || recorder -> numCommands % recorder -> checkpointInterval != 0 ) 
+	{
+		return SUCCESS_OP_CODE;
+	}
+
+	return WriteCheckpoint ( recorder , sim );
+}
+
+void RecorderFree ( COMMAND_RECORDER *recorder , OS_SIM *sim ) 
+{
+	if ( !recorder ) 
+	{
+		return;
+	}
+
+	if ( recorder -> numCommands % recorder -> checkpointInterval != 0 ) 
+	{
+		WriteCheckpoint ( recorder , sim );
+	}
+
+	fclose ( recorder -> file );
+	free ( recorder );
+}
+
+FILE *RecordingOpen ( const char *path , RECORDING_HEADER *header ) 
+{
+	FILE *file = fopen ( path , "rb" );
+	if ( !file ) 
+	{
+		return NULL;
+	}
+
+	int validHeader = ReadField ( file , header , sizeof ( RECORDING_HEADER ) ) == SUCCESS_OP_CODE && 
+		memcmp ( header -> magic , RECORDING_MAGIC , sizeof ( header -> magic ) ) == 0 && 
+		header -> version == RECORDING_VERSION && 
+		header -> checkpointInterval >= 1;
+	if ( !validHeader ) 
+	{
+		fclose ( file );
+		return NULL;
+	}
+
+	return file;
+}
+
+int RecordingReadEntry ( FILE *file , RECORDING_ENTRY *entry , int *atEnd ) 
+{
+	*atEnd = 0;
+
+	unsigned char kind = 0;
+	if ( ReadField ( file , &kind , sizeof ( kind ) ) != SUCCESS_OP_CODE ) 
+	{
+		*atEnd = feof ( file ) && !ferror ( file );
+		return *atEnd ? SUCCESS_OP_CODE : FAILURE_OP_CODE;
+	}
+
+	entry -> kind = kind;
+	if ( kind == RECORDED_COMMAND ) 
+	{
+		unsigned short commandLength = 0;
+		if ( ReadField ( file , &entry -> tick , sizeof ( entry -> tick ) ) != SUCCESS_OP_CODE || 
+			ReadField ( file , &commandLength , sizeof ( commandLength ) ) != SUCCESS_OP_CODE || 
+			commandLength > MAX_RECORDED_COMMAND_LENGTH || 
+			( commandLength > 0 && ReadField ( file , entry -> command , commandLength ) != SUCCESS_OP_CODE ) ) 
+		{
+			return FAILURE_OP_CODE;
+		}
+
+		entry -> length = commandLength;
+		entry -> command [ commandLength ] = '\0';
+		return SUCCESS_OP_CODE;
+	}
+	else if ( kind == RECORDED_CHECKPOINT ) 
+	{
+		int result = ReadField ( file , &entry -> numCommands , sizeof ( entry -> numCommands ) );
+		result |= ReadField ( file , &entry -> tick , sizeof ( entry -> tick ) );
+		result |= ReadField ( file , &entry -> stateHash , sizeof ( entry -> stateHash ) );
+		return result == SUCCESS_OP_CODE ? SUCCESS_OP_CODE : FAILURE_OP_CODE;
+	}
+
+	return FAILURE_OP_CODE; // truncated or not a recording
+}
@@ -0,0 +1,72 @@
+/* Nic Pucci
+ * COMMAND RECORDING HEADER
+*/
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <stdio.h>
+#include "ossim.h"
+
+#define RECORDING_MAGIC "OSSIMREC"
+#define RECORDING_VERSION 2
+#define DEFAULT_CHECKPOINT_INTERVAL 100 // commands between state hash checkpoints
+#define MAX_RECORDED_COMMAND_LENGTH 1023
+
+enum RECORDING_ENTRY_KIND
+{
+	RECORDED_COMMAND = 'C' , // tick, 2-byte length, command line without its new line
+	RECORDED_CHECKPOINT = 'H' // number of commands so far, tick, OSSimStateHash
+};
+
+/* the configuration the session was started with, replay starts an identical instance from it */
+typedef struct recordingHeader
+{
+	char magic [ 8 ];
+	unsigned int version;
+	int numCPUs;
+	int numNodes;
+	int numCPUsPerCache;
+	int numPriorityLevels;
+	int maxCPUBursts;
+	int agingPolicy;
+	int checkpointInterval;
+} RECORDING_HEADER;
+
+typedef struct recordingEntry
+{
+	int kind;
+	int tick; // sim -> currentTick when the command was read, or at the checkpoint
+	long numCommands; // CHECKPOINT only
+	unsigned long stateHash; // CHECKPOINT only
+	int length; // COMMAND only
+	char command [ MAX_RECORDED_COMMAND_LENGTH + 1 ]; // COMMAND only, null-terminated
+} RECORDING_ENTRY;
+
+typedef struct commandRecorder
+{
+	FILE *file;
+	int checkpointInterval;
+	long numCommands;
+	long numCheckpoints;
+} COMMAND_RECORDER;
+
+
+/* call after OSSimStart, the instance's configuration goes into the header */
+COMMAND_RECORDER *RecorderCreate ( const char *path , OS_SIM *sim , int checkpointInterval );
+
+/* call before the command runs, so its tick is the one it was issued at */
+int RecorderAppendCommand ( COMMAND_RECORDER *recorder , OS_SIM *sim , const char *command , int length );
+
+/* call after the command runs, writes a checkpoint every checkpointInterval commands */
+int RecorderCommandDone ( COMMAND_RECORDER *recorder , OS_SIM *sim );
+
+/* writes a final checkpoint, so replay always verifies the end state */
+void RecorderFree ( COMMAND_RECORDER *recorder , OS_SIM *sim );
+
+/* READING - RecordingReadEntry returns SUCCESS_OP_CODE per entry, 0 entries left is reported through *atEnd */
+FILE *RecordingOpen ( const char *path , RECORDING_HEADER *header );
+
+int RecordingReadEntry ( FILE *file , RECORDING_ENTRY *entry , int *atEnd );
+
+#endif
@@ -0,0 +1,399 @@
+/* Nic Pucci
+ * MULTI-CLIENT COMMAND SERVER IMPLEMENTATION
+ *
+ * Line-based protocol over a Unix domain stream socket: every line a client sends is one command, and its
+ * response is exactly what the shell would have printed for it. Each client has its own input line buffer
+ * and output buffer, so a client that sends half a line or reads slowly never holds up the others.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "Server.h"
+
+#define SERVER_LISTEN_BACKLOG 16
+#define SERVER_FINAL_SEND_TIMEOUT_S 1
+
+int SetNonBlocking ( int fd )
+{
+	int flags = fcntl ( fd , F_GETFL , 0 );
+	return flags >= 0 && fcntl ( fd , F_SETFL , flags | O_NONBLOCK ) == 0 ? SUCCESS_OP_CODE : FAILURE_OP_CODE;
+}
+
+size_t PendingOutput ( SERVER_CLIENT *client )
+{
+	return client -> outputLength - client -> outputSent;
+}
+
+void CloseClient ( COMMAND_SERVER *server , SERVER_CLIENT *client )
+{
+	for ( int i = 0 ; i < server -> numClients ; i++ )
+	{
+		if ( server -> clients [ i ] == client )
+		{
+			server -> numClients -= 1;
+			server -> clients [ i ] = server -> clients [ server -> numClients ];
+			break;
+		}
+	}
+
+	epoll_ctl ( server -> epollFD , EPOLL_CTL_DEL , client -> socketFD , NULL );
+	close ( client -> socketFD );
+	free ( client -> outputBuffer );
+	free ( client );
+}
+
+/* reads are paused while too much output is queued, writes are only watched while something is queued */
+void UpdateWatchedEvents ( COMMAND_SERVER *server , SERVER_CLIENT *client )
+{
+	unsigned int events = 0;
+	if ( !client -> hungUp && PendingOutput ( client ) < MAX_SERVER_PENDING_OUTPUT )
+	{
+		events |= EPOLLIN;
+	}
+	else if ( !client -> hungUp && ( client -> watchedEvents & EPOLLIN ) )
+	{
+		server -> numBackpressureStalls += 1;
+	}
+
+	if ( PendingOutput ( client ) > 0 )
+	{
+		events |= EPOLLOUT;
+	}
+
+	if ( events != client -> watchedEvents )
+	{
+		struct epoll_event event = { .events = events , .data.ptr = client };
+		epoll_ctl ( server -> epollFD , EPOLL_CTL_MOD , client -> socketFD , &event );
+		client -> watchedEvents = events;
+	}
+}
+
+int QueueOutput ( SERVER_CLIENT *client , const char *data , size_t length )
+{
+	if ( client -> outputSent == client -> outputLength )
+	{
+		client -> outputSent = 0;
+		client -> outputLength = 0;
+	}
+
+	if ( client -> outputLength + length > client -> outputCapacity )
+	{
+		size_t newCapacity = client -> outputCapacity ? client -> outputCapacity : SERVER_READ_CHUNK;
+		while ( newCapacity < client -> outputLength + length )
+		{
+			newCapacity *= 2;
+		}
+
+		char *newBuffer = ( char *) realloc ( client -> outputBuffer , newCapacity );
+		if ( !newBuffer )
+		{
+			return FAILURE_OP_CODE;
+		}
+
+		client -> outputBuffer = newBuffer;
+		client -> outputCapacity = newCapacity;
+	}
+
+	memcpy ( client -> outputBuffer + client -> outputLength , data , length );
+	client -> outputLength += length;
+	return SUCCESS_OP_CODE;
+}
+
+/* sends as much as the socket takes without blocking - FAILURE_OP_CODE once the client is gone */
+int FlushClient ( COMMAND_SERVER *server , SERVER_CLIENT *client )
+{
+	while ( PendingOutput ( client ) > 0 )
+	{
+		ssize_t numSent = send ( client -> socketFD , client -> outputBuffer + client -> outputSent , PendingOutput ( client ) , MSG_NOSIGNAL );
+		if ( numSent < 0 && errno == EINTR )
+		{
+			continue;
+		}
+
+		if ( numSent < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK ) )
+		{
+			break;
+		}
+
+		if ( numSent <= 0 )
+		{
+			return FAILURE_OP_CODE;
+		}
+
+		client -> outputSent += numSent;
+		server -> numBytesSent += numSent;
+	}
+
+	if ( client -> hungUp && PendingOutput ( client ) == 0 )
+	{
+		return FAILURE_OP_CODE; // nothing left to do for it
+	}
+
+	UpdateWatchedEvents ( server , client );
+	return SUCCESS_OP_CODE;
+}
+
+void RunHandler ( COMMAND_SERVER *server , SERVER_CLIENT *client , char *commandLine )
+{
+	char *response = NULL;
+	size_t responseLength = 0;
+	FILE *responseFile = open_memstream ( &response , &responseLength );
+	if ( !responseFile )
+	{
+		return;
+	}
+
+	if ( !server -> handler ( commandLine , responseFile , server -> context ) )
+	{
+		server -> running = 0;
+	}
+
+	fclose ( responseFile );
+	QueueOutput ( client , response , responseLength );
+	free ( response );
+
+	if ( commandLine )
+	{
+		server -> numCommands += 1;
+	}
+}
+
+void AcceptClients ( COMMAND_SERVER *server )
+{
+	while ( 1 )
+	{
+		int socketFD = accept ( server -> listenSocket , NULL , NULL );
+		if ( socketFD < 0 )
+		{
+			if ( errno == EINTR )
+			{
+				continue;
+			}
+
+			return; // EAGAIN once the backlog is empty
+		}
+
+		SERVER_CLIENT *client = NULL;
+		if ( server -> numClients < MAX_SERVER_CLIENTS && SetNonBlocking ( socketFD ) == SUCCESS_OP_CODE )
+		{
+			client = ( SERVER_CLIENT *) calloc ( 1 , sizeof ( SERVER_CLIENT ) );
+		}
+
+		struct epoll_event event = { .events = EPOLLIN , .data.ptr = client };
+		if ( !client || epoll_ctl ( server -> epollFD , EPOLL_CTL_ADD , socketFD , &event ) != 0 )
+		{
+			server -> numRejectedConnections += 1;
+			free ( client );
+			close ( socketFD );
+			continue;
+		}
+
+		server -> numConnections += 1;
+		client -> socketFD = socketFD;
+		client -> clientID = server -> numConnections;
+		client -> watchedEvents = EPOLLIN;
+		server -> clients [ server -> numClients ] = client;
+		server -> numClients += 1;
+
+		RunHandler ( server , client , NULL );
+		if ( FlushClient ( server , client ) != SUCCESS_OP_CODE )
+		{
+			CloseClient ( server , client );
+		}
+	}
+}
+
+void RunCompleteLine ( COMMAND_SERVER *server , SERVER_CLIENT *client )
+{
+	int lineLength = client -> inputLength;
+	if ( lineLength > 0 && client -> inputBuffer [ lineLength - 1 ] == '\r' )
+	{
+		lineLength -= 1; // sent by telnet-style clients
+	}
+
+	client -> inputBuffer [ lineLength ] = '\0';
+	client -> inputLength = 0;
+	if ( client -> discardingLine )
+	{
+		client -> discardingLine = 0;
+
+		char response [ 64 ];
+		int responseLength = snprintf ( response , sizeof ( response ) , "ERROR: line too long (max %d characters)\n\n" , MAX_SERVER_LINE_LENGTH - 1 );
+		QueueOutput ( client , response , responseLength ); // a cut line could be a different command, so it is not run
+		return;
+	}
+
+	RunHandler ( server , client , client -> inputBuffer );
+}
+
+/* one chunk per wake-up, every complete line in it runs before the next client is looked at */
+void ReadClient ( COMMAND_SERVER *server , SERVER_CLIENT *client )
+{
+	char chunk [ SERVER_READ_CHUNK ];
+	ssize_t numRead = read ( client -> socketFD , chunk , SERVER_READ_CHUNK );
+	if ( numRead < 0 && ( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ) )
+	{
+		return;
+	}
+
+	for ( ssize_t i = 0 ; i < numRead && server -> running ; i++ )
+	{
+		if ( chunk [ i ] == '\n' )
+		{
+			RunCompleteLine ( server , client );
+		}
+		else if ( client -> inputLength < MAX_SERVER_LINE_LENGTH - 1 )
+		{
+			client -> inputBuffer [ client -> inputLength ] = chunk [ i ];
+			client -> inputLength += 1;
+		}
+		else
+		{
+			client -> discardingLine = 1;
+		}
+	}
+
+	if ( numRead <= 0 )
+	{
+		if ( client -> inputLength > 0 && server -> running )
+		{
+			RunCompleteLine ( server , client ); // last line without a new line
+		}
+
+		client -> hungUp = 1; // end of input, or the socket failed - its output is still sent if it can be
+	}
+}
+
+COMMAND_SERVER *ServerCreate ( const char *socketPath , SERVER_COMMAND_HANDLER handler , void *context )
+{
+	if ( !socketPath || strlen ( socketPath ) >= MAX_SOCKET_PATH_LENGTH || !handler )
+	{
+		return NULL;
+	}
+
+	COMMAND_SERVER *server = ( COMMAND_SERVER *) calloc ( 1 , sizeof ( COMMAND_SERVER ) );
+	if ( !server )
+	{
+		return NULL;
+	}
+
+	server -> handler = handler;
+	server -> context = context;
+	server -> running = 1;
+
+	struct sockaddr_un address = { .sun_family = AF_UNIX };
+	strncpy ( address.sun_path , socketPath , sizeof ( address.sun_path ) - 1 );
+
+	server -> listenSocket = socket ( AF_UNIX , SOCK_STREAM , 0 );
+	server -> epollFD = epoll_create1 ( 0 );
+	unlink ( socketPath ); // left behind by an earlier run
+
+	struct epoll_event listenEvent = { .events = EPOLLIN , .data.ptr = NULL };
+	if ( server -> listenSocket < 0 || 
+		server -> epollFD < 0 || 
+		SetNonBlocking ( server -> listenSocket ) != SUCCESS_OP_CODE || 
+		bind ( server -> listenSocket , ( struct sockaddr *) &address , sizeof ( address ) ) != 0 || 
+		listen ( server -> listenSocket , SERVER_LISTEN_BACKLOG ) != 0 || 
+		epoll_ctl ( server -> epollFD , EPOLL_CTL_ADD , server -> listenSocket , &listenEvent ) != 0 )
+	{
+		if ( server -> listenSocket >= 0 )
+		{
+			close ( server -> listenSocket );
+		}
+
+		if ( server -> epollFD >= 0 )
+		{
+			close ( server -> epollFD );
+		}
+
+		free ( server );
+		return NULL;
+	}
+
+	strncpy ( server -> socketPath , socketPath , MAX_SOCKET_PATH_LENGTH - 1 );
+	return server;
+}
+
+int ServerPollFD ( COMMAND_SERVER *server )
+{
+	return server -> epollFD;
+}
+
+int ServerHandleEvents ( COMMAND_SERVER *server , int timeoutMs )
+{
+	if ( !server -> running )
+	{
+		return FAILURE_OP_CODE;
+	}
+
+	struct epoll_event events [ MAX_SERVER_CLIENTS + 1 ];
+	int numEvents = epoll_wait ( server -> epollFD , events , MAX_SERVER_CLIENTS + 1 , timeoutMs );
+	if ( numEvents < 0 )
+	{
+		return errno == EINTR ? SUCCESS_OP_CODE : FAILURE_OP_CODE;
+	}
+
+	for ( int i = 0 ; i < numEvents && server -> running ; i++ )
+	{
+		SERVER_CLIENT *client = events [ i ].data.ptr;
+		if ( !client )
+		{
+			AcceptClients ( server );
+			continue;
+		}
+
+		// a hang-up or error is reported even while reads are paused, reading then would run commands past the
+		// output cap, and with the peer gone what is queued can not be delivered anyway
+		int readsPaused = !( client -> watchedEvents & EPOLLIN );
+		if ( readsPaused && ( events [ i ].events & ( EPOLLHUP | EPOLLERR ) ) )
+		{
+			CloseClient ( server , client );
+			continue;
+		}
+
+		if ( !readsPaused && ( events [ i ].events & ( EPOLLIN | EPOLLHUP | EPOLLERR ) ) )
+		{
+			ReadClient ( server , client );
+		}
+
+		if ( FlushClient ( server , client ) != SUCCESS_OP_CODE )
+		{
+			CloseClient ( server , client );
+		}
+	}
+
+	return server -> running ? SUCCESS_OP_CODE : FAILURE_OP_CODE;
+}
+
+void ServerFree ( COMMAND_SERVER *server )
+{
+	if ( !server )
+	{
+		return;
+	}
+
+	while ( server -> numClients > 0 )
+	{
+		SERVER_CLIENT *client = server -> clients [ 0 ];
+		struct timeval sendTimeout = { .tv_sec = SERVER_FINAL_SEND_TIMEOUT_S };
+		int flags = fcntl ( client -> socketFD , F_GETFL , 0 );
+		fcntl ( client -> socketFD , F_SETFL , flags & ~O_NONBLOCK ); // the last responses are sent in full ...
+		setsockopt ( client -> socketFD , SOL_SOCKET , SO_SNDTIMEO , &sendTimeout , sizeof ( sendTimeout ) ); // ... unless the client stopped reading
+		client -> hungUp = 1;
+		FlushClient ( server , client );
+		CloseClient ( server , client );
+	}
+
+	close ( server -> listenSocket );
+	close ( server -> epollFD );
+	unlink ( server -> socketPath );
+	free ( server );
+}
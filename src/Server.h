@@ -0,0 +1,67 @@
+/* Nic Pucci
+ * MULTI-CLIENT COMMAND SERVER HEADER
+*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+#include "Metrics.h"
+
+#define MAX_SERVER_CLIENTS 64
+#define MAX_SERVER_LINE_LENGTH 1024 // a longer line is discarded up to its new line and answered with an error
+#define SERVER_READ_CHUNK 4096 // bytes read from one client per wake-up, so one client cannot starve the others
+#define MAX_SERVER_PENDING_OUTPUT ( 1 << 20 ) // a client is not read from while this much of its output is unsent
+
+/* called once per complete line with the client's response stream, and once with commandLine NULL when the
+ * client connects - returns 0 to shut the server down after the response is queued */
+typedef int ( *SERVER_COMMAND_HANDLER ) ( char *commandLine , FILE *responseFile , void *context );
+
+typedef struct serverClient
+{
+	int socketFD;
+	unsigned long clientID;
+	char inputBuffer [ MAX_SERVER_LINE_LENGTH ];
+	int inputLength;
+	int discardingLine; // the current line was longer than the buffer, it is rejected at its new line
+	char *outputBuffer;
+	size_t outputLength;
+	size_t outputCapacity;
+	size_t outputSent;
+	unsigned int watchedEvents; // EPOLLIN / EPOLLOUT currently registered
+	int hungUp; // closed once its output is sent
+} SERVER_CLIENT;
+
+/* SINGLE-THREADED - one epoll loop owns every socket and calls the handler, so commands never overlap */
+typedef struct commandServer
+{
+	int listenSocket;
+	int epollFD;
+	char socketPath [ MAX_SOCKET_PATH_LENGTH ];
+	SERVER_CLIENT *clients [ MAX_SERVER_CLIENTS ];
+	int numClients;
+	SERVER_COMMAND_HANDLER handler;
+	void *context;
+	int running;
+
+	/* COUNTERS */
+	unsigned long numConnections;
+	unsigned long numRejectedConnections; // MAX_SERVER_CLIENTS already connected
+	unsigned long numCommands;
+	unsigned long numBytesSent;
+	unsigned long numBackpressureStalls; // times a client stopped being read until its output drained
+} COMMAND_SERVER;
+
+
+COMMAND_SERVER *ServerCreate ( const char *socketPath , SERVER_COMMAND_HANDLER handler , void *context );
+
+/* readable whenever the server has work, so it can be waited on together with other descriptors */
+int ServerPollFD ( COMMAND_SERVER *server );
+
+/* handles every ready socket, waiting up to timeoutMs (-1 = forever) for one - FAILURE_OP_CODE once stopped */
+int ServerHandleEvents ( COMMAND_SERVER *server , int timeoutMs );
+
+/* sends what every client still has queued, then closes them all */
+void ServerFree ( COMMAND_SERVER *server );
+
+#endif
@@ -0,0 +1,233 @@
+/* Nic Pucci
+ * CHROME TRACE-EVENT EXPORT IMPLEMENTATION
+ * 
+ * JSON array format - trace pid 1 has one track per CPU, trace pid 2 one track per simulated process.
+ * Loads in chrome://tracing and ui.perfetto.dev.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include "Trace.h"
+
+const int CPU_TRACK_GROUP = 1;
+const int PROCESS_TRACK_GROUP = 2;
+
+void WriteTraceRecord ( TRACE_WRITER *writer , const char *format , ... )
+{
+	va_list args;
+	va_start ( args , format );
+
+	fputs ( writer -> numEvents == 0 ? "[\n" : ",\n" , writer -> outputFile );
+	vfprintf ( writer -> outputFile , format , args );
+	writer -> numEvents += 1;
+
+	va_end ( args );
+}
+
+long TraceTimestamp ( TRACE_WRITER *writer , int tick )
+{
+	long tickTs = ( long ) tick * TRACE_TICK_US;
+	if ( tick != writer -> lastTick || writer -> lastTs < tickTs )
+	{
+		writer -> lastTick = tick;
+		writer -> lastTs = tickTs;
+	}
+	else if ( writer -> lastTs < tickTs + TRACE_TICK_US - 1 )
+	{
+		writer -> lastTs += 1;
+	}
+
+	return writer -> lastTs;
+}
+
+void WriteThreadName ( TRACE_WRITER *writer , int trackGroup , int trackID , const char *nameFormat , int nameValue )
+{
+	char name [ 64 ];
+	snprintf ( name , sizeof ( name ) , nameFormat , nameValue );
+	WriteTraceRecord ( writer , 
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}" , 
+		trackGroup , 
+		trackID , 
+		name 
+	);
+}
+
+void WriteInstant ( TRACE_WRITER *writer , long ts , int processID , const char *name , const char *argsJSON )
+{
+	WriteTraceRecord ( writer , 
+		"{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%ld,\"pid\":%d,\"tid\":%d,\"args\":{%s}}" , 
+		name , 
+		ts , 
+		PROCESS_TRACK_GROUP , 
+		processID , 
+		argsJSON 
+	);
+}
+
+void CloseRunningSlice ( TRACE_WRITER *writer , int cpuID , long endTs )
+{
+	TRACE_SLICE *slice = &writer -> runningSlices [ cpuID ];
+	if ( slice -> processID < 0 )
+	{
+		return;
+	}
+
+	long duration = endTs > slice -> startTs ? endTs - slice -> startTs : 1;
+	if ( slice -> processID == INIT_PROCESS_ID )
+	{
+		WriteTraceRecord ( writer , 
+			"{\"name\":\"INIT (idle)\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%ld,\"dur\":%ld,\"pid\":%d,\"tid\":%d}" , 
+			slice -> startTs , duration , CPU_TRACK_GROUP , cpuID 
+		);
+	}
+	else
+	{
+		WriteTraceRecord ( writer , 
+			"{\"name\":\"PID %d\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%ld,\"dur\":%ld,\"pid\":%d,\"tid\":%d}" , 
+			slice -> processID , slice -> startTs , duration , CPU_TRACK_GROUP , cpuID 
+		);
+		WriteTraceRecord ( writer , 
+			"{\"name\":\"CPU %d\",\"cat\":\"process\",\"ph\":\"X\",\"ts\":%ld,\"dur\":%ld,\"pid\":%d,\"tid\":%d}" , 
+			cpuID , slice -> startTs , duration , PROCESS_TRACK_GROUP , slice -> processID 
+		);
+	}
+
+	slice -> processID = -1;
+}
+
+TRACE_WRITER *TraceWriterCreate ( const char *path , OS_SIM *sim )
+{
+	TRACE_WRITER *writer = ( TRACE_WRITER *) calloc ( 1 , sizeof ( TRACE_WRITER ) );
+	if ( !writer )
+	{
+		return NULL;
+	}
+
+	writer -> outputFile = fopen ( path , "w" );
+	writer -> buffer = ( char *) malloc ( TRACE_BUFFER_SIZE );
+	if ( !writer -> outputFile || !writer -> buffer )
+	{
+		if ( writer -> outputFile )
+		{
+			fclose ( writer -> outputFile );
+		}
+
+		free ( writer -> buffer );
+		free ( writer );
+		return NULL;
+	}
+
+	setvbuf ( writer -> outputFile , writer -> buffer , _IOFBF , TRACE_BUFFER_SIZE );
+	writer -> numCPUs = sim -> numCPUs;
+	for ( int i = 0 ; i < MAX_NUM_CPUS ; i++ )
+	{
+		writer -> runningSlices [ i ].processID = -1;
+	}
+
+	WriteTraceRecord ( writer , "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"CPUs\"}}" , CPU_TRACK_GROUP );
+	WriteTraceRecord ( writer , "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Processes\"}}" , PROCESS_TRACK_GROUP );
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ )
+	{
+		WriteThreadName ( writer , CPU_TRACK_GROUP , i , "CPU %d" , i );
+	}
+
+	return writer;
+}
+
+void TraceEvent ( const OSSIM_EVENT *event , void *traceWriter )
+{
+	TRACE_WRITER *writer = ( TRACE_WRITER *) traceWriter;
+	long ts = TraceTimestamp ( writer , event -> tick );
+	const PCB *process = event -> process;
+	char argsJSON [ 128 ];
+
+	switch ( event -> type )
+	{
+		case OSSIM_EVENT_PROCESS_CREATED :
+			WriteThreadName ( writer , PROCESS_TRACK_GROUP , process -> processID , "PID %d" , process -> processID );
+			snprintf ( argsJSON , sizeof ( argsJSON ) , "\"cpu\":%d,\"priority\":%d,\"parent\":%d" , event -> cpuID , process -> priorityLevel , event -> fromValue );
+			WriteInstant ( writer , ts , process -> processID , "created" , argsJSON );
+			break;
+
+		case OSSIM_EVENT_PROCESS_ENDED :
+			for ( int i = 0 ; i < writer -> numCPUs ; i++ )
+			{
+				if ( writer -> runningSlices [ i ].processID == process -> processID && process -> processID != INIT_PROCESS_ID )
+				{
+					CloseRunningSlice ( writer , i , ts );
+				}
+			}
+
+			WriteInstant ( writer , ts , process -> processID , "ended" , "" );
+			break;
+
+		case OSSIM_EVENT_DISPATCHED :
+			CloseRunningSlice ( writer , event -> cpuID , ts );
+			writer -> runningSlices [ event -> cpuID ].processID = process -> processID;
+			writer -> runningSlices [ event -> cpuID ].startTs = ts;
+			break;
+
+		case OSSIM_EVENT_BLOCKED :
+		case OSSIM_EVENT_UNBLOCKED :
+			snprintf ( argsJSON , sizeof ( argsJSON ) , "\"state\":%d,\"semaphore\":%d" , event -> fromValue , event -> toValue );
+			WriteInstant ( writer , ts , process -> processID , event -> type == OSSIM_EVENT_BLOCKED ? "blocked" : "unblocked" , argsJSON );
+			break;
+
+		case OSSIM_EVENT_PROMOTED :
+		case OSSIM_EVENT_DEMOTED :
+			snprintf ( argsJSON , sizeof ( argsJSON ) , "\"from\":%d,\"to\":%d" , event -> fromValue , event -> toValue );
+			WriteInstant ( writer , ts , process -> processID , event -> type == OSSIM_EVENT_PROMOTED ? "promoted" : "demoted" , argsJSON );
+			break;
+
+		case OSSIM_EVENT_MESSAGE_QUEUED :
+		case OSSIM_EVENT_MESSAGE_DELIVERED :
+			snprintf ( argsJSON , sizeof ( argsJSON ) , "\"sender\":%d,\"recipient\":%d" , event -> message -> senderProcessID , event -> message -> recipientProcessID );
+			WriteInstant ( writer , ts , event -> message -> recipientProcessID , 
+				event -> type == OSSIM_EVENT_MESSAGE_QUEUED ? "message queued" : "message delivered" , argsJSON );
+			break;
+
+		case OSSIM_EVENT_STOLEN :
+		case OSSIM_EVENT_LOAD_BALANCED :
+			snprintf ( argsJSON , sizeof ( argsJSON ) , "\"from_cpu\":%d,\"to_cpu\":%d" , event -> fromValue , event -> toValue );
+			WriteInstant ( writer , ts , process -> processID , event -> type == OSSIM_EVENT_STOLEN ? "stolen" : "load balanced" , argsJSON );
+			break;
+
+		case OSSIM_EVENT_DEADLINE_MISSED :
+			snprintf ( argsJSON , sizeof ( argsJSON ) , "\"deadline\":%d,\"budget_left\":%d" , event -> fromValue , process -> remainingBudget );
+			WriteInstant ( writer , ts , process -> processID , "deadline missed" , argsJSON );
+			break;
+
+		case OSSIM_EVENT_DEADLOCK :
+			snprintf ( argsJSON , sizeof ( argsJSON ) , "\"waits_for\":%d,\"semaphore\":%d" , event -> fromValue , event -> toValue );
+			WriteInstant ( writer , ts , process -> processID , "deadlock" , argsJSON );
+			break;
+
+		case OSSIM_EVENT_PRIORITY_INHERITED :
+			snprintf ( argsJSON , sizeof ( argsJSON ) , "\"from_level\":%d,\"to_level\":%d,\"own_level\":%d" , event -> fromValue , event -> toValue , process -> priorityLevel );
+			WriteInstant ( writer , ts , process -> processID , "priority inherited" , argsJSON );
+			break;
+
+		default :
+			break;
+	}
+}
+
+void TraceWriterFree ( TRACE_WRITER *writer )
+{
+	if ( !writer )
+	{
+		return;
+	}
+
+	long endTs = writer -> lastTs + 1;
+	for ( int i = 0 ; i < writer -> numCPUs ; i++ )
+	{
+		CloseRunningSlice ( writer , i , endTs );
+	}
+
+	fputs ( "\n]\n" , writer -> outputFile );
+	fclose ( writer -> outputFile );
+	free ( writer -> buffer );
+	free ( writer );
+}
@@ -0,0 +1,42 @@
+/* Nic Pucci
+ * CHROME TRACE-EVENT EXPORT HEADER
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include "ossim.h"
+
+#define TRACE_TICK_US 1000 // one quantum is drawn as 1 ms
+#define TRACE_BUFFER_SIZE ( 1 << 20 )
+
+typedef struct traceSlice
+{
+	int processID; // -1 = nothing open on the CPU
+	long startTs;
+} TRACE_SLICE;
+
+/* STREAMED - every event is written as it happens, only the slice open on each CPU is held in memory */
+typedef struct traceWriter
+{
+	FILE *outputFile;
+	char *buffer;
+	int numCPUs;
+	TRACE_SLICE runningSlices [ MAX_NUM_CPUS ];
+	int lastTick;
+	long lastTs; // events in the same tick are spread 1 us apart so they keep their order
+	unsigned long numEvents;
+} TRACE_WRITER;
+
+
+/* call before OSSimStart so every process creation is seen */
+TRACE_WRITER *TraceWriterCreate ( const char *path , OS_SIM *sim );
+
+/* OSSIM_EVENT_CALLBACK */
+void TraceEvent ( const OSSIM_EVENT *event , void *traceWriter );
+
+/* closes the slices still open and the JSON array */
+void TraceWriterFree ( TRACE_WRITER *writer );
+
+#endif
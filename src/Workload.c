@@ -0,0 +1,147 @@
+/* Nic Pucci
+ * RANDOM WORKLOAD GENERATOR - a reproducible mix of every command, shared by the sweep and the soak harness
+*/
+
+#include "ossim.h"
+#include "Workload.h"
+
+unsigned int NextRandom ( unsigned int *randomState ) 
+{
+	// xorshift32, so every run is reproducible from its seed alone
+	unsigned int x = *randomState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*randomState = x;
+	return x;
+}
+
+int RandomProcessID ( OS_SIM *sim , unsigned int *randomState ) 
+{
+	int lowestRecentID = sim -> nextAvailProcessID - 64;
+	if ( lowestRecentID <= INIT_PROCESS_ID ) 
+	{
+		lowestRecentID = INIT_PROCESS_ID + 1;
+	}
+
+	int numRecentIDs = sim -> nextAvailProcessID - lowestRecentID;
+	if ( numRecentIDs <= 0 ) 
+	{
+		return INIT_PROCESS_ID + 1;
+	}
+
+	return lowestRecentID + NextRandom ( randomState ) % numRecentIDs;
+}
+
+int RandomGroupID ( unsigned int *randomState ) 
+{
+	return NextRandom ( randomState ) % MAX_WORKLOAD_GROUPS;
+}
+
+void WorkloadCreateSemaphores ( OS_SIM *sim , unsigned int *randomState ) 
+{
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		OSSimNewSemaphore ( sim , i , NextRandom ( randomState ) % 3 );
+	}
+}
+
+void WorkloadRunOps ( OS_SIM *sim , unsigned int *randomState , long numOps ) 
+{
+	char messageStr [] = "workload";
+
+	for ( long op = 0 ; op < numOps ; op++ ) 
+	{
+		int cpuID = NextRandom ( randomState ) % sim -> numCPUs;
+		OSSimUseCPU ( sim , cpuID );
+		const PCB *runningProcess = OSSimRunningProcess ( sim , cpuID );
+		int runningIsInit = runningProcess -> processID == INIT_PROCESS_ID;
+		int roomForProcesses = NumSystemProcessesTotal ( sim ) < MAX_WORKLOAD_PROCESSES;
+
+		int roll = NextRandom ( randomState ) % 100;
+		if ( roll < 14 && roomForProcesses ) 
+		{
+			int groupID = NextRandom ( randomState ) % 2 ? RandomGroupID ( randomState ) : NO_PROCESS_GROUP;
+			OSSimCreateProcessInGroup ( sim , NextRandom ( randomState ) % sim -> numPriorityLevels , groupID , NULL );
+		}
+		else if ( roll < 16 && roomForProcesses ) 
+		{
+			int period = 4 + NextRandom ( randomState ) % 9;
+			int budget = 1 + NextRandom ( randomState ) % ( period / 3 );
+			OSSimCreateRealTimeProcess ( sim , period , period , budget , NULL );
+		}
+		else if ( roll < 22 && roomForProcesses && !runningIsInit ) 
+		{
+			OSSimFork ( sim , NULL );
+		}
+		else if ( roll < 27 ) 
+		{
+			OSSimKill ( sim , RandomProcessID ( sim , randomState ) , NULL );
+		}
+		else if ( roll < 31 && !runningIsInit ) 
+		{
+			OSSimExitWithStatus ( sim , NextRandom ( randomState ) % 4 , NULL );
+		}
+		else if ( roll < 34 && !runningIsInit ) 
+		{
+			OSSimWait ( sim , NULL , NULL );
+		}
+		else if ( roll < 35 ) 
+		{
+			OSSimKillTree ( sim , RandomProcessID ( sim , randomState ) , NULL );
+		}
+		else if ( roll < 60 ) 
+		{
+			OSSimQuantum ( sim );
+		}
+		else if ( roll < 67 && ListCount ( sim -> messagesQueue ) < MAX_WORKLOAD_MESSAGES ) 
+		{
+			OSSimSend ( sim , RandomProcessID ( sim , randomState ) , messageStr , NULL );
+		}
+		else if ( roll < 74 ) 
+		{
+			OSSimReceive ( sim , NULL );
+		}
+		else if ( roll < 79 ) 
+		{
+			OSSimReply ( sim , RandomProcessID ( sim , randomState ) , messageStr , NULL );
+		}
+		else if ( roll < 86 ) 
+		{
+			OSSimSemaphoreP ( sim , NextRandom ( randomState ) % NUM_SEMAPHORES , NULL );
+		}
+		else if ( roll < 93 ) 
+		{
+			OSSimSemaphoreV ( sim , NextRandom ( randomState ) % NUM_SEMAPHORES , NULL );
+		}
+		else if ( roll < 96 && !runningIsInit ) 
+		{
+			OSSimWriteMemory ( sim , NextRandom ( randomState ) % NUM_MEMORY_PAGES , messageStr , NULL );
+		}
+		else if ( roll < 97 ) 
+		{
+			// any non-empty subset of the CPUs, so a mask can pin a process to a NUMA node or a single CPU
+			unsigned int affinityMask = 1 + NextRandom ( randomState ) % ( ( 1u << sim -> numCPUs ) - 1 );
+			OSSimSetAffinity ( sim , RandomProcessID ( sim , randomState ) , affinityMask );
+		}
+		else if ( roll < 98 ) 
+		{
+			OSSimSetGroupPriority ( sim , RandomGroupID ( randomState ) , NextRandom ( randomState ) % sim -> numPriorityLevels , NULL );
+		}
+		else if ( roll < 99 ) 
+		{
+			OSSimGroupQuantum ( sim , RandomGroupID ( randomState ) , NULL );
+		}
+		else 
+		{
+			OSSimKillGroup ( sim , RandomGroupID ( randomState ) , NULL );
+		}
+	}
+}
+
+void RunRandomWorkload ( OS_SIM *sim , unsigned int seed , int numOps ) 
+{
+	unsigned int randomState = seed ? seed : 1;
+	WorkloadCreateSemaphores ( sim , &randomState );
+	WorkloadRunOps ( sim , &randomState , numOps );
+}
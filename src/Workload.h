@@ -0,0 +1,27 @@
+/* Nic Pucci
+ * RANDOM WORKLOAD GENERATOR HEADER
+*/
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "ossim.h"
+
+#define MAX_WORKLOAD_PROCESSES 100
+#define MAX_WORKLOAD_MESSAGES 100
+#define MAX_WORKLOAD_GROUPS 4 // few enough that group commands usually find members
+
+unsigned int NextRandom ( unsigned int *randomState );
+
+int RandomProcessID ( OS_SIM *sim , unsigned int *randomState );
+
+int RandomGroupID ( unsigned int *randomState );
+
+/* SEEDED RUNS - the same seed and op count always issue the same commands on the same configuration */
+void WorkloadCreateSemaphores ( OS_SIM *sim , unsigned int *randomState );
+
+void WorkloadRunOps ( OS_SIM *sim , unsigned int *randomState , long numOps );
+
+void RunRandomWorkload ( OS_SIM *sim , unsigned int seed , int numOps );
+
+#endif
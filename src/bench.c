@@ -0,0 +1,591 @@
+/* Nic Pucci
+ * BENCHMARK SUITE - List micro benchmarks and simulator macro benchmarks
+ *
+ * Every benchmark does a fixed amount of work from a fixed starting state, so runs are comparable
+ * between builds. Results are tab-separated, one line per benchmark and size.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "ossim.h"
+#include "CommandQueue.h"
+
+#define DEFAULT_REPETITIONS 5
+#define MAX_REPETITIONS 100
+#define LIST_BENCH_OPS 1000000 // per repetition
+#define SIM_BENCH_OPS 200000
+#define MAX_LIST_BENCH_SIZE ( MAX_NUM_NODES_ALLOC - 4 )
+#define NUM_INGEST_PRODUCERS 4
+
+const int LIST_BENCH_SIZES [] = { 16 , 128 , MAX_LIST_BENCH_SIZE };
+const int NUM_LIST_BENCH_SIZES = sizeof ( LIST_BENCH_SIZES ) / sizeof ( int );
+const int SIM_BENCH_SIZES [] = { 8 , 64 };
+const int NUM_SIM_BENCH_SIZES = sizeof ( SIM_BENCH_SIZES ) / sizeof ( int );
+
+/* runs one repetition at the given size, returns the number of operations timed and their total time */
+typedef long ( *BENCH_FUNCTION ) ( int size , double *elapsedNs );
+
+typedef struct benchmark
+{
+	const char *name;
+	BENCH_FUNCTION function;
+	int isListBench; // sized by LIST_BENCH_SIZES, otherwise SIM_BENCH_SIZES
+} BENCHMARK;
+
+int benchItems [ MAX_NUM_NODES_ALLOC ];
+LIST_POOL benchListPool;
+
+double NsSince ( const struct timespec *startTime )
+{
+	struct timespec endTime;
+	clock_gettime ( CLOCK_MONOTONIC , &endTime );
+
+	return ( endTime.tv_sec - startTime -> tv_sec ) * 1e9 + ( endTime.tv_nsec - startTime -> tv_nsec );
+}
+
+void FreeNothing ( void *item )
+{
+	( void ) item; // the benchmark lists hold no owned items
+}
+
+int IsItem ( void *item , void *comparisonArg )
+{
+	return item == comparisonArg;
+}
+
+LIST *FilledList ( int size )
+{
+	LIST *list = ListCreateFromPool ( &benchListPool );
+	for ( int i = 0 ; i < size ; i++ )
+	{
+		ListAppend ( list , &benchItems [ i ] );
+	}
+
+	return list;
+}
+
+/* LIST MICRO BENCHMARKS */
+long BenchListAppend ( int size , double *elapsedNs )
+{
+	long numOps = 0;
+	while ( numOps < LIST_BENCH_OPS )
+	{
+		LIST *list = ListCreateFromPool ( &benchListPool );
+
+		struct timespec startTime;
+		clock_gettime ( CLOCK_MONOTONIC , &startTime );
+		for ( int i = 0 ; i < size ; i++ )
+		{
+			ListAppend ( list , &benchItems [ i ] );
+		}
+		*elapsedNs += NsSince ( &startTime );
+
+		numOps += size;
+		ListFree ( list , &FreeNothing );
+	}
+
+	return numOps;
+}
+
+long BenchListPrepend ( int size , double *elapsedNs )
+{
+	long numOps = 0;
+	while ( numOps < LIST_BENCH_OPS )
+	{
+		LIST *list = ListCreateFromPool ( &benchListPool );
+
+		struct timespec startTime;
+		clock_gettime ( CLOCK_MONOTONIC , &startTime );
+		for ( int i = 0 ; i < size ; i++ )
+		{
+			ListPrepend ( list , &benchItems [ i ] );
+		}
+		*elapsedNs += NsSince ( &startTime );
+
+		numOps += size;
+		ListFree ( list , &FreeNothing );
+	}
+
+	return numOps;
+}
+
+long BenchListTrim ( int size , double *elapsedNs )
+{
+	long numOps = 0;
+	while ( numOps < LIST_BENCH_OPS )
+	{
+		LIST *list = FilledList ( size );
+
+		struct timespec startTime;
+		clock_gettime ( CLOCK_MONOTONIC , &startTime );
+		for ( int i = 0 ; i < size ; i++ )
+		{
+			ListTrim ( list );
+		}
+		*elapsedNs += NsSince ( &startTime );
+
+		numOps += size;
+		ListFree ( list , &FreeNothing );
+	}
+
+	return numOps;
+}
+
+long BenchListRemove ( int size , double *elapsedNs )
+{
+	long numOps = 0;
+	while ( numOps < LIST_BENCH_OPS )
+	{
+		LIST *list = FilledList ( size );
+
+		struct timespec startTime;
+		clock_gettime ( CLOCK_MONOTONIC , &startTime );
+		ListFirst ( list );
+		for ( int i = 0 ; i < size ; i++ )
+		{
+			ListRemove ( list ); // from the front, the next item becomes current
+		}
+		*elapsedNs += NsSince ( &startTime );
+
+		numOps += size;
+		ListFree ( list , &FreeNothing );
+	}
+
+	return numOps;
+}
+
+long BenchListSearch ( int size , double *elapsedNs )
+{
+	LIST *list = FilledList ( size );
+	long numSearches = LIST_BENCH_OPS / size; // every search scans on average half the list
+	void *matchFound = NULL;
+
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+	for ( long i = 0 ; i < numSearches ; i++ )
+	{
+		matchFound = ListSearch ( list , &IsItem , &benchItems [ i % size ] );
+	}
+	*elapsedNs += NsSince ( &startTime );
+
+	if ( !matchFound )
+	{
+		fprintf ( stderr , "BENCH: ListSearch missed an item in the list\n" );
+	}
+
+	ListFree ( list , &FreeNothing );
+	return numSearches;
+}
+
+/* SIMULATOR MACRO BENCHMARKS - the core with no subscribers, so nothing is formatted or printed */
+OS_SIM *StartBenchSimWithAging ( enum AGING_POLICY agingPolicy )
+{
+	OS_SIM *sim = OSSimCreate ();
+	if ( sim )
+	{
+		sim -> agingPolicy = agingPolicy;
+	}
+
+	if ( !sim || OSSimStart ( sim ) != OSSIM_SUCCESS )
+	{
+		fprintf ( stderr , "BENCH: Could not start the simulator\n" );
+		exit ( 1 );
+	}
+
+	return sim;
+}
+
+OS_SIM *StartBenchSim ()
+{
+	return StartBenchSimWithAging ( BOUNCE_AGING );
+}
+
+int RunningProcessID ( OS_SIM *sim )
+{
+	return OSSimRunningProcess ( sim , sim -> currentCPU -> cpuID ) -> processID;
+}
+
+long BenchCreateQuantumStorm ( int size , double *elapsedNs )
+{
+	OS_SIM *sim = StartBenchSim ();
+	int *processIDs = ( int *) malloc ( size * sizeof ( int ) );
+	long numOps = 0;
+
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+	while ( numOps < SIM_BENCH_OPS )
+	{
+		for ( int i = 0 ; i < size ; i++ )
+		{
+			OSSimCreateProcess ( sim , i % sim -> numPriorityLevels , &processIDs [ i ] );
+		}
+
+		for ( int i = 0 ; i < 4 * size ; i++ )
+		{
+			OSSimQuantum ( sim );
+		}
+
+		for ( int i = 0 ; i < size ; i++ )
+		{
+			OSSimKill ( sim , processIDs [ i ] , NULL );
+		}
+
+		numOps += 6 * size;
+	}
+	*elapsedNs += NsSince ( &startTime );
+
+	free ( processIDs );
+	OSSimFree ( sim );
+	return numOps;
+}
+
+long BenchSendReplyPingPong ( int size , double *elapsedNs )
+{
+	OS_SIM *sim = StartBenchSim ();
+	int processIDs [ 2 ];
+	OSSimCreateProcess ( sim , 0 , &processIDs [ 0 ] );
+	OSSimCreateProcess ( sim , 0 , &processIDs [ 1 ] );
+	for ( int i = 2 ; i < size ; i++ )
+	{
+		OSSimCreateProcess ( sim , sim -> numPriorityLevels - 1 , NULL ); // bystanders on the lowest level, never dispatched
+	}
+
+	long numOps = 0;
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+	while ( numOps < SIM_BENCH_OPS )
+	{
+		int senderID = RunningProcessID ( sim );
+		int recipientID = senderID == processIDs [ 0 ] ? processIDs [ 1 ] : processIDs [ 0 ];
+
+		OSSimSend ( sim , recipientID , "ping" , NULL ); // sender SEND-BLOCKS, the recipient runs
+		OSSimReceive ( sim , NULL );
+		OSSimReply ( sim , senderID , "pong" , NULL );
+		numOps += 3;
+	}
+	*elapsedNs += NsSince ( &startTime );
+
+	OSSimFree ( sim );
+	return numOps;
+}
+
+long BenchSemaphoreContention ( int size , double *elapsedNs )
+{
+	OS_SIM *sim = StartBenchSim ();
+	for ( int i = 0 ; i < size ; i++ )
+	{
+		OSSimCreateProcess ( sim , 0 , NULL );
+	}
+
+	OSSimNewSemaphore ( sim , 0 , 1 );
+
+	long numOps = 0;
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+	while ( numOps < SIM_BENCH_OPS )
+	{
+		if ( RunningProcessID ( sim ) == INIT_PROCESS_ID )
+		{
+			OSSimSemaphoreV ( sim , 0 , NULL ); // everyone is blocked
+		}
+		else if ( numOps % 3 == 0 )
+		{
+			OSSimSemaphoreP ( sim , 0 , NULL );
+		}
+		else if ( numOps % 3 == 1 )
+		{
+			OSSimQuantum ( sim );
+		}
+		else
+		{
+			OSSimSemaphoreV ( sim , 0 , NULL );
+		}
+
+		numOps += 1;
+	}
+	*elapsedNs += NsSince ( &startTime );
+
+	OSSimFree ( sim );
+	return numOps;
+}
+
+long BenchKillChurn ( int size , double *elapsedNs )
+{
+	OS_SIM *sim = StartBenchSim ();
+	int *processIDs = ( int *) malloc ( size * sizeof ( int ) ); // ring, oldest process first
+	for ( int i = 0 ; i < size ; i++ )
+	{
+		OSSimCreateProcess ( sim , i % sim -> numPriorityLevels , &processIDs [ i ] );
+	}
+
+	long numOps = 0;
+	int oldest = 0;
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+	while ( numOps < SIM_BENCH_OPS )
+	{
+		OSSimKill ( sim , processIDs [ oldest ] , NULL );
+		OSSimCreateProcess ( sim , numOps % sim -> numPriorityLevels , &processIDs [ oldest ] );
+		oldest = ( oldest + 1 ) % size;
+		numOps += 2;
+	}
+	*elapsedNs += NsSince ( &startTime );
+
+	free ( processIDs );
+	OSSimFree ( sim );
+	return numOps;
+}
+
+long BenchGroupKill ( int size , double *elapsedNs )
+{
+	OS_SIM *sim = StartBenchSim ();
+	for ( int i = 0 ; i < size ; i++ )
+	{
+		OSSimCreateProcess ( sim , i % sim -> numPriorityLevels , NULL ); // bystanders outside the group
+	}
+
+	long numOps = 0;
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+	while ( numOps < SIM_BENCH_OPS )
+	{
+		for ( int i = 0 ; i < size ; i++ )
+		{
+			OSSimCreateProcessInGroup ( sim , i % sim -> numPriorityLevels , 0 , NULL );
+		}
+
+		OSSimKillGroup ( sim , 0 , NULL );
+		numOps += 2 * size; // every create and every process killed
+	}
+	*elapsedNs += NsSince ( &startTime );
+
+	OSSimFree ( sim );
+	return numOps;
+}
+
+/* a parent holding size pages forks a child that writes one page and exits - with copy-on-write the fork costs the
+ * same whatever size is, and the write copies one page */
+long BenchCOWFork ( int size , double *elapsedNs )
+{
+	OS_SIM *sim = StartBenchSimWithAging ( NO_AGING ); // parent and child stay on one level and take turns
+	OSSimCreateProcess ( sim , 0 , NULL );
+	for ( int i = 0 ; i < size && i < NUM_MEMORY_PAGES ; i++ )
+	{
+		OSSimWriteMemory ( sim , i , "parent" , NULL );
+	}
+
+	long numOps = 0;
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+	while ( numOps < SIM_BENCH_OPS )
+	{
+		OSSimFork ( sim , NULL );
+		OSSimQuantum ( sim ); // the child runs next
+		OSSimWriteMemory ( sim , 0 , "child" , NULL );
+		OSSimExit ( sim , NULL );
+		OSSimWait ( sim , NULL , NULL );
+		numOps += 5;
+	}
+	*elapsedNs += NsSince ( &startTime );
+
+	OSSimFree ( sim );
+	return numOps;
+}
+
+/* QUEUED INGEST - producer threads submit parsed commands to the simulation thread, timed until all are applied */
+typedef struct ingestProducer
+{
+	pthread_t thread;
+	SIM_THREAD *simThread;
+	int numLevels;
+	long numOps;
+} INGEST_PRODUCER;
+
+void *RunIngestProducer ( void *producerPtr )
+{
+	INGEST_PRODUCER *producer = ( INGEST_PRODUCER *) producerPtr;
+	OSSIM_COMMAND command;
+	memset ( &command , 0 , sizeof ( OSSIM_COMMAND ) );
+
+	// same mix as the create/quantum storm, but exit + create keeps the population steady without knowing PIDs
+	for ( long i = 0 ; i < producer -> numOps ; i++ )
+	{
+		int step = i % 6;
+		command.type = step < 4 ? OSSIM_QUANTUM_COMMAND : step == 4 ? OSSIM_EXIT_COMMAND : OSSIM_CREATE_COMMAND;
+		command.args [ 0 ] = i % producer -> numLevels;
+		SimThreadSubmit ( producer -> simThread , &command );
+	}
+
+	return NULL;
+}
+
+long BenchQueuedIngest ( int size , double *elapsedNs )
+{
+	OS_SIM *sim = StartBenchSim ();
+	for ( int i = 0 ; i < size ; i++ )
+	{
+		OSSimCreateProcess ( sim , i % sim -> numPriorityLevels , NULL );
+	}
+
+	INGEST_PRODUCER producers [ NUM_INGEST_PRODUCERS ];
+	long numOps = 0;
+
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+	SIM_THREAD *simThread = SimThreadStart ( sim );
+	if ( !simThread )
+	{
+		fprintf ( stderr , "BENCH: Could not start the simulation thread\n" );
+		exit ( 1 );
+	}
+
+	for ( int i = 0 ; i < NUM_INGEST_PRODUCERS ; i++ )
+	{
+		producers [ i ].simThread = simThread;
+		producers [ i ].numLevels = sim -> numPriorityLevels;
+		producers [ i ].numOps = SIM_BENCH_OPS / NUM_INGEST_PRODUCERS;
+		pthread_create ( &producers [ i ].thread , NULL , &RunIngestProducer , &producers [ i ] );
+	}
+
+	for ( int i = 0 ; i < NUM_INGEST_PRODUCERS ; i++ )
+	{
+		pthread_join ( producers [ i ].thread , NULL );
+		numOps += producers [ i ].numOps;
+	}
+
+	SimThreadStop ( simThread );
+	*elapsedNs += NsSince ( &startTime );
+
+	OSSimFree ( sim );
+	return numOps;
+}
+
+const BENCHMARK BENCHMARKS [] =
+{
+	{ "list_append" , &BenchListAppend , 1 } ,
+	{ "list_prepend" , &BenchListPrepend , 1 } ,
+	{ "list_trim" , &BenchListTrim , 1 } ,
+	{ "list_remove" , &BenchListRemove , 1 } ,
+	{ "list_search" , &BenchListSearch , 1 } ,
+	{ "sim_create_quantum_storm" , &BenchCreateQuantumStorm , 0 } ,
+	{ "sim_send_reply_ping_pong" , &BenchSendReplyPingPong , 0 } ,
+	{ "sim_semaphore_contention" , &BenchSemaphoreContention , 0 } ,
+	{ "sim_kill_churn" , &BenchKillChurn , 0 } ,
+	{ "sim_group_kill" , &BenchGroupKill , 0 } ,
+	{ "sim_cow_fork" , &BenchCOWFork , 0 } ,
+	{ "sim_queued_ingest" , &BenchQueuedIngest , 0 }
+};
+const int NUM_BENCHMARKS = sizeof ( BENCHMARKS ) / sizeof ( BENCHMARK );
+
+int CompareDoubles ( const void *a , const void *b )
+{
+	double difference = *( const double *) a - *( const double *) b;
+	return ( difference > 0 ) - ( difference < 0 );
+}
+
+void RunBenchmark ( FILE *resultsFile , const BENCHMARK *benchmark , int size , int numRepetitions )
+{
+	double nsPerOp [ MAX_REPETITIONS ];
+	long numOps = 0;
+	for ( int i = 0 ; i < numRepetitions ; i++ )
+	{
+		double elapsedNs = 0.0;
+		numOps = ( *benchmark -> function ) ( size , &elapsedNs );
+		nsPerOp [ i ] = elapsedNs / numOps;
+	}
+
+	qsort ( nsPerOp , numRepetitions , sizeof ( double ) , &CompareDoubles );
+	double medianNsPerOp = nsPerOp [ numRepetitions / 2 ];
+
+	fprintf ( resultsFile ,
+		"%s\t%d\t%ld\t%d\t%.2f\t%.2f\t%.0f\n" ,
+		benchmark -> name ,
+		size ,
+		numOps ,
+		numRepetitions ,
+		nsPerOp [ 0 ] ,
+		medianNsPerOp ,
+		1e9 / medianNsPerOp
+	);
+	fflush ( resultsFile );
+}
+
+void PrintUsage ( const char *programName )
+{
+	printf ( "Usage: %s [-r repetitions (1-%d)] [-f benchmarkNameFilter] [-o resultsFile]\n" , programName , MAX_REPETITIONS );
+}
+
+int main ( int argc , char *argv [] )
+{
+	int numRepetitions = DEFAULT_REPETITIONS;
+	const char *nameFilter = NULL;
+	const char *resultsPath = NULL;
+
+	int option = 0;
+	while ( ( option = getopt ( argc , argv , "r:f:o:" ) ) != -1 )
+	{
+		if ( option == 'r' )
+		{
+			numRepetitions = atoi ( optarg );
+		}
+		else if ( option == 'f' )
+		{
+			nameFilter = optarg;
+		}
+		else if ( option == 'o' )
+		{
+			resultsPath = optarg;
+		}
+		else
+		{
+			PrintUsage ( argv [ 0 ] );
+			exit ( 1 );
+		}
+	}
+
+	if ( numRepetitions < 1 || numRepetitions > MAX_REPETITIONS )
+	{
+		PrintUsage ( argv [ 0 ] );
+		exit ( 1 );
+	}
+
+	FILE *resultsFile = resultsPath ? fopen ( resultsPath , "w" ) : stdout;
+	if ( !resultsFile )
+	{
+		fprintf ( stderr , "ERROR: Could not open results file \"%s\"\n" , resultsPath );
+		exit ( 1 );
+	}
+
+	ListPoolInit ( &benchListPool );
+	for ( int i = 0 ; i < MAX_NUM_NODES_ALLOC ; i++ )
+	{
+		benchItems [ i ] = i;
+	}
+
+	fprintf ( resultsFile , "benchmark\tsize\tops\trepetitions\tmin_ns_per_op\tmedian_ns_per_op\tmedian_ops_per_sec\n" );
+	for ( int i = 0 ; i < NUM_BENCHMARKS ; i++ )
+	{
+		const BENCHMARK *benchmark = &BENCHMARKS [ i ];
+		if ( nameFilter && !strstr ( benchmark -> name , nameFilter ) )
+		{
+			continue;
+		}
+
+		const int *sizes = benchmark -> isListBench ? LIST_BENCH_SIZES : SIM_BENCH_SIZES;
+		int numSizes = benchmark -> isListBench ? NUM_LIST_BENCH_SIZES : NUM_SIM_BENCH_SIZES;
+		for ( int j = 0 ; j < numSizes ; j++ )
+		{
+			RunBenchmark ( resultsFile , benchmark , sizes [ j ] , numRepetitions );
+		}
+	}
+
+	if ( resultsFile != stdout )
+	{
+		fclose ( resultsFile );
+	}
+
+	return 0;
+}
@@ -1,5 +1,5 @@
 /* Nic Pucci
- * OS-SIM IMPLEMENTATION
+ * OS-SIM INTERACTIVE SHELL - a front end over the libossim core library
 */
 
 #include <stdio.h>
@@ -10,63 +10,29 @@
 #include <limits.h>
 #include <ctype.h>
 #include <stdarg.h>
-#include "List.h"
-
-#define NUM_PRIORITY_LEVELS 3
-#define MAX_MESSAGE_LENGTH 40
-#define MAX_INPUT_LENGTH ( 2 + MAX_MESSAGE_LENGTH )
-#define INIT_PROCESS_ID 0
-#define NUM_SEMAPHORES 5
-#define MAX_CPU_BURSTS 5
-
-typedef struct message
-{
-	int senderProcessID;
-	int recipientProcessID;
-	char messageStr [ MAX_MESSAGE_LENGTH ];
-} MESSAGE;
-
-enum STATE 
-{
-	SEND_BLOCKED = 0 ,
-	RECEIVE_BLOCKED = 1 ,
-	SEM_BLOCKED = 2 ,
-	READY = 3,
-	RUNNING = 4
-};
-
-enum PRIORITY_DIRECTION 
-{
-	PROMOTING = 0 ,
-	DEMOTING = 1
-};
-
-typedef struct pcb 
-{
-	int processID;
-	int priorityLevel;
-	enum PRIORITY_DIRECTION priorityDirection;
-	int numCPUBurstsInPriorityLevel;
-	enum STATE processState;
-	MESSAGE *readMessage;
-} PCB;
-
-
-PCB INIT_PROCESS = 
-{ 
-	.processID = INIT_PROCESS_ID , 
-	.priorityLevel = NUM_PRIORITY_LEVELS ,
-	.priorityDirection = DEMOTING ,
-	.numCPUBurstsInPriorityLevel = 0 ,
-	.processState = RUNNING ,
-	.readMessage = NULL
-};
+#include <time.h>
+#include <pthread.h>
+#include "ossim.h"
+#include "Logger.h"
+#include "Histogram.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "Workload.h"
+#include "Recording.h"
+#include "Server.h"
+
+#define MAX_INPUT_LENGTH ( MAX_RECORDED_COMMAND_LENGTH + 1 ) // a whole line, batches included
+#define MAX_SWEEP_VALUES 16
+#define DEFAULT_SWEEP_OPS 10000
+#define NUM_COMMAND_LETTERS 26 // every command is a single letter
+#define NUM_LOAD_BANDS 6
 
 const int SUCCESS_OP = 1;
 const int FAILURE_OP = 0;
 
 /* USER COMMANDS */
 const char COMMAND_DELIMITER [] = ", ";
+const char BATCH_DELIMITER [] = ";";
 const char *CREATE_COMMAND = "C";
 const char *FORK_COMMAND = "F";
 const char *KILL_COMMAND = "K";
@@ -80,67 +46,136 @@ const char *SEMAPHORE_P_COMMAND = "P";
 const char *SEMAPHORE_V_COMMAND = "V";
 const char *PROCESS_INFO_COMMAND = "I";
 const char *TOTAL_INFO_COMMAND = "T";
+const char *DEADLINE_CREATE_COMMAND = "D";
+const char *USE_CPU_COMMAND = "U";
+const char *AFFINITY_COMMAND = "A";
+const char *COMMAND_STATS_COMMAND = "H";
+const char *SAVE_SNAPSHOT_COMMAND = "O";
+const char *LOAD_SNAPSHOT_COMMAND = "L";
+const char *GROUP_COMMAND = "G";
+const char *WAIT_COMMAND = "W";
+const char *KILL_TREE_COMMAND = "X";
+const char *MEMORY_COMMAND = "M";
+
+const char *LOG_POLICY_NAMES [] = { "BLOCK" , "DROP" , "SYNC" };
+
+typedef struct listPrinter 
+{
+	OS_SIM *sim;
+	int numbering;
+} LIST_PRINTER;
 
-int nextAvailProcessID = INIT_PROCESS_ID + 1;
-
-const char DEFAULT_TEXT_COLOR [] = "\033[0m"; // default color by system
-const char OS_TEXT_COLOR [] = "\033[0;36m"; // cyan
-const char ERROR_TEXT_COLOR [] = "\033[0;31m"; // red
-const char SUCCESS_TEXT_COLOR [] = "\033[0;32m"; // green
-
-LIST *readyPriorityQueues [ NUM_PRIORITY_LEVELS ];
-LIST *sendBlockedQueue;
-LIST *receiveBlockedQueue;
-LIST *messagesQueue;
+#define DEFAULT_TEXT_COLOR "\033[0m" // default color by system
+#define OS_TEXT_COLOR "\033[0;36m" // cyan
+#define ERROR_TEXT_COLOR "\033[0;31m" // red
+#define SUCCESS_TEXT_COLOR "\033[0;32m" // green
 
-enum SEMAPHORE_STATUS 
+/* DEFERRED LOG FORMATS - event narration is logged as one of these IDs plus its int arguments */
+enum LOG_FORMAT_ID
 {
-	CREATED = 0 ,
-	NOT_CREATED = 1
+	DISPATCHED_INIT_FORMAT = 0 ,
+	DISPATCHED_REAL_TIME_FORMAT ,
+	DISPATCHED_FORMAT ,
+	PRIORITY_CHANGED_FORMAT ,
+	SEND_BLOCKING_FORMAT ,
+	RECEIVE_BLOCKED_FORMAT ,
+	RECEIVE_UNBLOCKED_FORMAT ,
+	SEM_BLOCKED_FORMAT ,
+	SEM_UNBLOCKED_FORMAT ,
+	WAIT_BLOCKED_FORMAT ,
+	WAIT_UNBLOCKED_FORMAT ,
+	STOLEN_FORMAT ,
+	LOAD_BALANCED_FORMAT ,
+	DEADLINE_MISSED_FORMAT ,
+	DEADLOCK_SEMAPHORE_FORMAT ,
+	DEADLOCK_REPLY_FORMAT ,
+	PRIORITY_INHERITED_FORMAT ,
+	PRIORITY_RESTORED_FORMAT ,
+	NUM_LOG_FORMATS
 };
 
-typedef struct semaphore 
+const char *const LOG_FORMATS [ NUM_LOG_FORMATS ] = 
 {
-	int semID;
-	enum SEMAPHORE_STATUS semStatus;
-	int semValue;
-	LIST *blockedPCBs;
-} SEMAPHORE;
+	[ DISPATCHED_INIT_FORMAT ] = OS_TEXT_COLOR "OS: CPU %d now running - INIT PROCESS (ID = %d) (%s) (TOTAL CPU-Bursts = %d)\n\n" DEFAULT_TEXT_COLOR ,
+	[ DISPATCHED_REAL_TIME_FORMAT ] = OS_TEXT_COLOR "OS: CPU %d now running - REAL-TIME PROCESS (ID = %d) (%s) (PERIOD = %d, DEADLINE = %d, BUDGET LEFT = %d/%d) (ABSOLUTE DEADLINE = %d) (DEADLINE MISSES = %d, JOBS COMPLETED = %d)\n\n" DEFAULT_TEXT_COLOR ,
+	[ DISPATCHED_FORMAT ] = OS_TEXT_COLOR "OS: CPU %d now running - PROCESS (ID = %d) (%s) (PRIORITY = %d) (%d CPU-Bursts until %s)\n\n" DEFAULT_TEXT_COLOR ,
+	[ PRIORITY_CHANGED_FORMAT ] = "OS: PROCESS ( ID = %d) %s PRIORITY LEVEL (%d -> %d)\n\n" ,
+	[ SEND_BLOCKING_FORMAT ] = OS_TEXT_COLOR "OS: Process (ID = %d) is %s\n\n" DEFAULT_TEXT_COLOR ,
+	[ RECEIVE_BLOCKED_FORMAT ] = OS_TEXT_COLOR "OS: Running Process (ID = %d) is RECEIVE-BLOCKED\n\n" DEFAULT_TEXT_COLOR ,
+	[ RECEIVE_UNBLOCKED_FORMAT ] = OS_TEXT_COLOR "OS: Process (ID = %d) is RECEIVE-UNBLOCKED\n\n" DEFAULT_TEXT_COLOR ,
+	[ SEM_BLOCKED_FORMAT ] = OS_TEXT_COLOR "OS: PROCESS (ID = %d) has been SEM-BLOCKED\n\n" DEFAULT_TEXT_COLOR ,
+	[ SEM_UNBLOCKED_FORMAT ] = OS_TEXT_COLOR "OS: PROCESS (ID = %d) SEM-UNBLOCKED\n\n" DEFAULT_TEXT_COLOR ,
+	[ WAIT_BLOCKED_FORMAT ] = OS_TEXT_COLOR "OS: Running Process (ID = %d) is WAIT-BLOCKED\n\n" DEFAULT_TEXT_COLOR ,
+	[ WAIT_UNBLOCKED_FORMAT ] = OS_TEXT_COLOR "OS: Process (ID = %d) is WAIT-UNBLOCKED by the exit of its Child Process (ID = %d)\n\n" DEFAULT_TEXT_COLOR ,
+	[ STOLEN_FORMAT ] = OS_TEXT_COLOR "OS: CPU %d STOLE PROCESS (ID = %d) from CPU %d\n\n" DEFAULT_TEXT_COLOR ,
+	[ LOAD_BALANCED_FORMAT ] = OS_TEXT_COLOR "OS: LOAD BALANCE moved PROCESS (ID = %d) from CPU %d to CPU %d\n\n" DEFAULT_TEXT_COLOR ,
+	[ DEADLINE_MISSED_FORMAT ] = ERROR_TEXT_COLOR "OS: REAL-TIME PROCESS (ID = %d) MISSED DEADLINE %d (%d/%d BUDGET LEFT) (TOTAL MISSES = %d)\n\n" DEFAULT_TEXT_COLOR ,
+	[ DEADLOCK_SEMAPHORE_FORMAT ] = ERROR_TEXT_COLOR "OS: DEADLOCK - PROCESS (ID = %d) waits on SEMAPHORE %d held by PROCESS (ID = %d)\n\n" DEFAULT_TEXT_COLOR ,
+	[ DEADLOCK_REPLY_FORMAT ] = ERROR_TEXT_COLOR "OS: DEADLOCK - PROCESS (ID = %d) waits for a REPLY from PROCESS (ID = %d)\n\n" DEFAULT_TEXT_COLOR ,
+	[ PRIORITY_INHERITED_FORMAT ] = OS_TEXT_COLOR "OS: PROCESS (ID = %d) INHERITS PRIORITY LEVEL %d from a process waiting on it (OWN LEVEL = %d)\n\n" DEFAULT_TEXT_COLOR ,
+	[ PRIORITY_RESTORED_FORMAT ] = OS_TEXT_COLOR "OS: PROCESS (ID = %d) back to its own PRIORITY LEVEL %d (WAS %d)\n\n" DEFAULT_TEXT_COLOR
+};
 
-SEMAPHORE semaphores [ NUM_SEMAPHORES ];
+/* %s arguments of the deferred formats - the process states come first so a STATE is its own string ID */
+enum LOG_STRING_ID
+{
+	STATE_ERROR_STRING = ZOMBIE + 1 ,
+	PROMOTION_STRING ,
+	DEMOTION_STRING ,
+	PROMOTED_STRING ,
+	DEMOTED_STRING ,
+	SEND_UNBLOCKED_STRING ,
+	NUM_LOG_STRINGS
+};
 
-PCB *runningProcess = &INIT_PROCESS;
+const char *const LOG_STRINGS [ NUM_LOG_STRINGS ] = 
+{
+	[ SEND_BLOCKED ] = "SEND-BLOCKED" ,
+	[ RECEIVE_BLOCKED ] = "RECEIVE-BLOCKED" ,
+	[ SEM_BLOCKED ] = "SEMAPHORE-BLOCKED" ,
+	[ READY ] = "READY" ,
+	[ RUNNING ] = "RUNNING" ,
+	[ PERIOD_WAITING ] = "PERIOD-WAITING" ,
+	[ WAIT_BLOCKED ] = "WAIT-BLOCKED" ,
+	[ ZOMBIE ] = "ZOMBIE" ,
+	[ STATE_ERROR_STRING ] = "ERROR" ,
+	[ PROMOTION_STRING ] = "PROMOTION" ,
+	[ DEMOTION_STRING ] = "DEMOTION" ,
+	[ PROMOTED_STRING ] = "PROMOTED" ,
+	[ DEMOTED_STRING ] = "DEMOTED" ,
+	[ SEND_UNBLOCKED_STRING ] = "SEND-UNBLOCKED"
+};
 
+const LOG_FORMAT_TABLE NARRATION_FORMAT_TABLE = { LOG_FORMATS , NUM_LOG_FORMATS , LOG_STRINGS , NUM_LOG_STRINGS };
 
-void ChangeTextColorToDefault () 
+void ChangeTextColorToDefault ( OS_SIM *sim ) 
 {
-	printf ( DEFAULT_TEXT_COLOR );
+	fprintf ( sim -> outputFile , DEFAULT_TEXT_COLOR );
 }
 
-void ChangeTextColorToOS () 
+void ChangeTextColorToOS ( OS_SIM *sim ) 
 {
-	printf ( OS_TEXT_COLOR );
+	fprintf ( sim -> outputFile , OS_TEXT_COLOR );
 }
 
-void ChangeTextColorToError () 
+void ChangeTextColorToError ( OS_SIM *sim ) 
 {
-	printf ( ERROR_TEXT_COLOR );
+	fprintf ( sim -> outputFile , ERROR_TEXT_COLOR );
 }
 
-void ChangeTextColorToSuccess () 
+void ChangeTextColorToSuccess ( OS_SIM *sim ) 
 {
-	printf ( SUCCESS_TEXT_COLOR );
+	fprintf ( sim -> outputFile , SUCCESS_TEXT_COLOR );
 }
- 
 
-void PrintMessage ( const MESSAGE *message ) 
+void PrintMessage ( OS_SIM *sim , const MESSAGE *message ) 
 {
 	if ( !message ) 
 	{
 		return;
 	}
 
-	printf ( 
+	fprintf ( sim -> outputFile , 
 		"Message: %s (SenderID = %d, RecipientID = %d\n)" , 
 		message -> messageStr ,
 		message -> senderProcessID ,
@@ -148,307 +183,242 @@ void PrintMessage ( const MESSAGE *message )
 	);
 }
 
-int NumSystemProcessesTotal () 
+int ProcessStateStrID ( const PCB *pcb ) 
 {
-	int numReady = 0;
-	for ( int i = 0 ; i < NUM_PRIORITY_LEVELS ; i++ ) 
+	if ( pcb -> processState < SEND_BLOCKED || pcb -> processState > ZOMBIE ) 
 	{
-		LIST *readyQueue = readyPriorityQueues [ i ];
-		numReady += ListCount ( readyQueue );
+		return STATE_ERROR_STRING;
 	}
 
-	int numSemBlocked = 0;
-	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
-	{
-		SEMAPHORE *semaphore = &semaphores [ i ];
-		numSemBlocked += ListCount ( semaphore -> blockedPCBs );
-	}
+	return pcb -> processState;
+}
 
-	int numSendBlocked = ListCount ( sendBlockedQueue );
-	int numReceiveBlocked = ListCount ( receiveBlockedQueue );
-	
-	int initProcessCount = 1;
-	int runningProcessCount = 0;
-	if ( runningProcess -> processID != INIT_PROCESS_ID ) 
+int PriorityDirectionStrID ( const PCB *pcb ) 
+{
+	switch ( pcb -> priorityDirection ) 
 	{
-		runningProcessCount = 1;
-	}
+		case PROMOTING :
+			return PROMOTION_STRING;
 
-	int numProcesses = initProcessCount + 
-		runningProcessCount + 
-		numReady + 
-		numSemBlocked + 
-		numSendBlocked + 
-		numReceiveBlocked;
+		case DEMOTING :
+			return DEMOTION_STRING;
 
-	return numProcesses;
+		default: 
+			return STATE_ERROR_STRING;
+	}
 }
 
-void PrintPCB ( const PCB *pcb ) 
+void WritePCB ( FILE *outputFile , int maxCPUBursts , const PCB *pcb ) 
 {
 	if ( !pcb ) 
 	{
 		return;
 	}
 
-	char* processStateStr;
-	switch ( pcb -> processState ) 
-	{
-		case SEND_BLOCKED :
-			processStateStr = "SEND-BLOCKED";
-			break;
-
-		case RECEIVE_BLOCKED :
-			processStateStr = "RECEIVE-BLOCKED";
-			break;
-
-		case SEM_BLOCKED :
-			processStateStr = "SEMAPHORE-BLOCKED";
-			break;
-
-		case READY :
-			processStateStr = "READY";
-			break;
-
-		case RUNNING :
-			processStateStr = "RUNNING";
-			break;
-
-		default: 
-			processStateStr = "ERROR";
-	}
-
-	char* priorityDirStr;
-	switch ( pcb -> priorityDirection ) 
-	{
-		case PROMOTING :
-			priorityDirStr = "PROMOTION";
-			break;
-
-		case DEMOTING :
-			priorityDirStr = "DEMOTION";
-			break;
-
-		default: 
-			priorityDirStr = "ERROR";
-	}
+	const char *processStateStr = LOG_STRINGS [ ProcessStateStrID ( pcb ) ];
+	const char *priorityDirStr = LOG_STRINGS [ PriorityDirectionStrID ( pcb ) ];
 
 	if ( pcb -> processID == INIT_PROCESS_ID )
 	{
-		printf ( 
+		fprintf ( outputFile , 
 			"INIT PROCESS (ID = %d) (%s) (TOTAL CPU-Bursts = %d)\n\n" ,
 			pcb -> processID , 
 			processStateStr ,
 			pcb -> numCPUBurstsInPriorityLevel
 		);
 	}
+	else if ( pcb -> schedulingClass == REAL_TIME_CLASS )
+	{
+		fprintf ( outputFile , 
+			"REAL-TIME PROCESS (ID = %d) (%s) (PERIOD = %d, DEADLINE = %d, BUDGET LEFT = %d/%d) (ABSOLUTE DEADLINE = %d) (DEADLINE MISSES = %d, JOBS COMPLETED = %d)\n\n" ,
+			pcb -> processID , 
+			processStateStr ,
+			pcb -> period ,
+			pcb -> relativeDeadline ,
+			pcb -> remainingBudget ,
+			pcb -> budget ,
+			pcb -> absoluteDeadline ,
+			pcb -> numDeadlineMisses ,
+			pcb -> numJobsCompleted
+		);
+	}
 	else 
 	{
-		printf ( 
+		fprintf ( outputFile , 
 			"PROCESS (ID = %d) (%s) (PRIORITY = %d) (%d CPU-Bursts until %s)\n\n" ,
 			pcb -> processID , 
 			processStateStr ,
 			pcb -> priorityLevel ,
-			MAX_CPU_BURSTS - pcb -> numCPUBurstsInPriorityLevel ,
+			maxCPUBursts - pcb -> numCPUBurstsInPriorityLevel ,
 			priorityDirStr
 		);
 	}
 }
 
-void PrintCurrentRunningProcess () 
+void PrintPCB ( OS_SIM *sim , const PCB *pcb ) 
 {
-	if ( !runningProcess ) 
-	{
-		return;
-	}
-
-	ChangeTextColorToOS ();
-	printf ( "OS: now running - " );
-	PrintPCB ( runningProcess );
-	ChangeTextColorToDefault ();
+	WritePCB ( sim -> outputFile , sim -> maxCPUBursts , pcb );
 }
 
-void PrintInputPrompt () 
+void PrintCurrentRunningProcess ( OS_SIM *sim , CPU *cpu ) 
 {
-	printf ( "Prompt: Please input an OS Command (separate params with space or comma)\n" );
-	printf ( "> " );
-	fflush ( stdout );
-}
-
-void InitAllLists () 
-{
-	for ( int i = 0 ; i < NUM_PRIORITY_LEVELS ; i++ ) 
-	{
-		readyPriorityQueues [ i ] = ListCreate ();
-	}
-
-	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	if ( !cpu -> runningProcess ) 
 	{
-		semaphores [ i ].semID = i;
-		semaphores [ i ].semValue = 0;
-		semaphores [ i ].semStatus = NOT_CREATED;
-		semaphores [ i ].blockedPCBs = ListCreate ();
-	}
-
-	receiveBlockedQueue = ListCreate ();
-	sendBlockedQueue = ListCreate ();
-	messagesQueue = ListCreate ();
-}
-
-void FreeMessage ( MESSAGE *message ) 
-{
-	if ( !message ) {
 		return;
 	}
 
-	free ( message );
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: CPU %d now running - " , cpu -> cpuID );
+	PrintPCB ( sim , cpu -> runningProcess );
+	ChangeTextColorToDefault ( sim );
 }
 
-void FreePCB ( PCB *pcb ) 
+/* EVENT NARRATION - logged as deferred records, the text is produced by the logger when it renders them */
+typedef struct eventLogContext 
 {
-	if ( !pcb ) {
-		return;
-	}
+	LOGGER *logger;
+	OS_SIM *sim;
+} EVENT_LOG_CONTEXT;
 
-	FreeMessage ( pcb -> readMessage );
-	free ( pcb );
-}
+void LogDispatchedEvent ( LOGGER *logger , int maxCPUBursts , const OSSIM_EVENT *event ) 
+{
+	const PCB *process = event -> process;
 
-void FreeAllLists () {
-	for ( int i = 0 ; i < NUM_PRIORITY_LEVELS ; i++ ) 
+	if ( process -> processID == INIT_PROCESS_ID ) 
 	{
-		ListFree ( readyPriorityQueues [ i ] , ( void *) &FreePCB );
+		LOG_DEFERRED ( logger , DISPATCHED_INIT_FORMAT , 
+			event -> cpuID , 
+			process -> processID , 
+			ProcessStateStrID ( process ) , 
+			process -> numCPUBurstsInPriorityLevel 
+		);
 	}
-
-	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	else if ( process -> schedulingClass == REAL_TIME_CLASS ) 
+	{
+		LOG_DEFERRED ( logger , DISPATCHED_REAL_TIME_FORMAT , 
+			event -> cpuID , 
+			process -> processID , 
+			ProcessStateStrID ( process ) , 
+			process -> period , 
+			process -> relativeDeadline , 
+			process -> remainingBudget , 
+			process -> budget , 
+			process -> absoluteDeadline , 
+			process -> numDeadlineMisses , 
+			process -> numJobsCompleted 
+		);
+	}
+	else 
 	{
-		SEMAPHORE *semaphore = &semaphores [ i ];
-		ListFree ( semaphore -> blockedPCBs , ( void *) &FreePCB );
+		LOG_DEFERRED ( logger , DISPATCHED_FORMAT , 
+			event -> cpuID , 
+			process -> processID , 
+			ProcessStateStrID ( process ) , 
+			process -> priorityLevel , 
+			maxCPUBursts - process -> numCPUBurstsInPriorityLevel , 
+			PriorityDirectionStrID ( process ) 
+		);
 	}
-
-	ListFree ( receiveBlockedQueue , ( void *) &FreePCB );
-	ListFree ( sendBlockedQueue , ( void *) &FreePCB );
-	ListFree ( messagesQueue , ( void *) &FreeMessage );
 }
 
-int ValidPriorityLevel ( int priorityLevel ) 
+void LogEvent ( const OSSIM_EVENT *event , void *eventLogContext ) 
 {
-	return priorityLevel > -1 && priorityLevel < NUM_PRIORITY_LEVELS;
-}
-
-void AddToReadyQueue ( PCB *pcb ) 
-{
-	if ( !pcb || pcb -> processID == INIT_PROCESS_ID ) {
-		return;
-	}
+	EVENT_LOG_CONTEXT *context = ( EVENT_LOG_CONTEXT *) eventLogContext;
+	LOGGER *logger = context -> logger;
+	const PCB *process = event -> process;
 
-	int priorityLevel = pcb -> priorityLevel;
-	if ( !ValidPriorityLevel ( priorityLevel ) ) {
-		return;
+	if ( event -> type == OSSIM_EVENT_DISPATCHED ) 
+	{
+		LogDispatchedEvent ( logger , context -> sim -> maxCPUBursts , event );
 	}
-
-	pcb -> processState = READY;
-	LIST* readyQueue = readyPriorityQueues [ priorityLevel ];
-	ListPrepend ( readyQueue , pcb );
-}
-
-void UpdateProcessPriorityLevel ( PCB *process ) 
-{
-	if ( !process ) 
+	else if ( event -> type == OSSIM_EVENT_MESSAGE_DELIVERED ) 
 	{
-		return;
+		ChangeTextColorToSuccess ( context -> sim ); // the message text does not fit a deferred record
+		fprintf ( context -> sim -> outputFile , 
+			"SUCCESS: Received message \"%s\" (SenderID = %d, recipientProcessID = %d)\n\n",
+			event -> message -> messageStr,
+			event -> message -> senderProcessID,
+			event -> message -> recipientProcessID
+		);
+		ChangeTextColorToDefault ( context -> sim );
 	}
-
-	process -> numCPUBurstsInPriorityLevel += 1;
-	if ( process -> numCPUBurstsInPriorityLevel < MAX_CPU_BURSTS ) 
+	else if ( event -> type == OSSIM_EVENT_PROMOTED || event -> type == OSSIM_EVENT_DEMOTED ) 
 	{
-		return;
+		LOG_DEFERRED ( logger , PRIORITY_CHANGED_FORMAT , 
+			process -> processID , 
+			event -> type == OSSIM_EVENT_PROMOTED ? PROMOTED_STRING : DEMOTED_STRING , 
+			event -> fromValue , 
+			event -> toValue 
+		);
 	}
-
-	if ( process -> priorityLevel == NUM_PRIORITY_LEVELS - 1 ) 
+	else if ( event -> type == OSSIM_EVENT_BLOCKED || event -> type == OSSIM_EVENT_UNBLOCKED ) 
 	{
-		process -> priorityDirection = PROMOTING;
+		int blocked = event -> type == OSSIM_EVENT_BLOCKED;
+
+		if ( event -> fromValue == SEND_BLOCKED ) 
+		{
+			LOG_DEFERRED ( logger , SEND_BLOCKING_FORMAT , process -> processID , blocked ? SEND_BLOCKED : SEND_UNBLOCKED_STRING );
+		}
+		else if ( event -> fromValue == RECEIVE_BLOCKED ) 
+		{
+			LOG_DEFERRED ( logger , blocked ? RECEIVE_BLOCKED_FORMAT : RECEIVE_UNBLOCKED_FORMAT , process -> processID );
+		}
+		else if ( event -> fromValue == WAIT_BLOCKED && blocked ) 
+		{
+			LOG_DEFERRED ( logger , WAIT_BLOCKED_FORMAT , process -> processID );
+		}
+		else if ( event -> fromValue == WAIT_BLOCKED ) 
+		{
+			LOG_DEFERRED ( logger , WAIT_UNBLOCKED_FORMAT , process -> processID , event -> toValue );
+		}
+		else 
+		{
+			LOG_DEFERRED ( logger , blocked ? SEM_BLOCKED_FORMAT : SEM_UNBLOCKED_FORMAT , process -> processID );
+		}
 	}
-	else if ( process -> priorityLevel == 0 ) 
+	else if ( event -> type == OSSIM_EVENT_STOLEN ) 
 	{
-		process -> priorityDirection = DEMOTING;
+		LOG_DEFERRED ( logger , STOLEN_FORMAT , event -> toValue , process -> processID , event -> fromValue );
 	}
-
-	int prevPriorityLevel = process -> priorityLevel;
-	if ( process -> priorityDirection == PROMOTING ) 
+	else if ( event -> type == OSSIM_EVENT_LOAD_BALANCED ) 
 	{
-		process -> priorityLevel -= 1;
-		printf ( 
-			"OS: PROCESS ( ID = %d) PROMOTED PRIORITY LEVEL (%d -> %d)\n\n" ,
-			process -> processID ,
-			prevPriorityLevel ,
-			process -> priorityLevel
-		);
+		LOG_DEFERRED ( logger , LOAD_BALANCED_FORMAT , process -> processID , event -> fromValue , event -> toValue );
 	}
-	else if ( process -> priorityDirection == DEMOTING ) 
+	else if ( event -> type == OSSIM_EVENT_DEADLINE_MISSED ) 
 	{
-		process -> priorityLevel += 1;
-		printf ( 
-			"OS: PROCESS ( ID = %d) DEMOTED PRIORITY LEVEL (%d -> %d)\n\n" ,
-			process -> processID ,
-			prevPriorityLevel ,
-			process -> priorityLevel
+		LOG_DEFERRED ( logger , DEADLINE_MISSED_FORMAT , 
+			process -> processID , 
+			event -> fromValue , 
+			process -> remainingBudget , 
+			process -> budget , 
+			process -> numDeadlineMisses 
 		);
 	}
-
-	process -> numCPUBurstsInPriorityLevel = 0;
-}
-
-void RunNextProcess () 
-{
-	int runningProcIsAlive = runningProcess != NULL;
-
-	if ( runningProcIsAlive && runningProcess -> processID == INIT_PROCESS_ID ) 
+	else if ( event -> type == OSSIM_EVENT_DEADLOCK && event -> toValue == WAITING_FOR_REPLY ) 
 	{
-		INIT_PROCESS.processState = READY;
-		INIT_PROCESS.numCPUBurstsInPriorityLevel += 1;
+		LOG_DEFERRED ( logger , DEADLOCK_REPLY_FORMAT , process -> processID , event -> fromValue );
 	}
-	else if ( runningProcIsAlive )
+	else if ( event -> type == OSSIM_EVENT_DEADLOCK ) 
 	{
-		UpdateProcessPriorityLevel ( runningProcess );
-		AddToReadyQueue ( runningProcess );
-	}
-
-	runningProcess = NULL;
-	for ( int i = 0 ; i < NUM_PRIORITY_LEVELS ; i++ ) {
-		LIST *readyQueue = readyPriorityQueues [ i ];
-		if ( ListCount ( readyQueue ) > 0 ) {
-			runningProcess = ListTrim ( readyQueue );
-			break;
-		}
+		LOG_DEFERRED ( logger , DEADLOCK_SEMAPHORE_FORMAT , process -> processID , event -> toValue , event -> fromValue );
 	}
-
-	if ( !runningProcess ) {
-		runningProcess = &INIT_PROCESS;
-		INIT_PROCESS.processState = RUNNING;
+	else if ( event -> type == OSSIM_EVENT_PRIORITY_INHERITED && event -> toValue < process -> priorityLevel ) 
+	{
+		LOG_DEFERRED ( logger , PRIORITY_INHERITED_FORMAT , process -> processID , event -> toValue , process -> priorityLevel );
 	}
-
-	runningProcess -> processState = RUNNING;
-
-	PrintCurrentRunningProcess ();
-
-	MESSAGE *receivedMessage = runningProcess -> readMessage;
-	if ( receivedMessage ) 
+	else if ( event -> type == OSSIM_EVENT_PRIORITY_INHERITED ) 
 	{
-		ChangeTextColorToSuccess ();
-		printf ( 
-			"SUCCESS: Received message \"%s\" (SenderID = %d, recipientProcessID = %d)\n\n",
-			receivedMessage -> messageStr,
-			receivedMessage -> senderProcessID,
-			receivedMessage -> recipientProcessID
-		);
-		ChangeTextColorToDefault ();
-
-		FreeMessage ( receivedMessage );
-		runningProcess -> readMessage = NULL;
+		LOG_DEFERRED ( logger , PRIORITY_RESTORED_FORMAT , process -> processID , event -> toValue , event -> fromValue );
 	}
 }
 
+void PrintInputPrompt ( OS_SIM *sim ) 
+{
+	fprintf ( sim -> outputFile , "Prompt: Please input an OS Command (separate params with space or comma)\n" );
+	fprintf ( sim -> outputFile , "CPU %d > " , sim -> currentCPU -> cpuID );
+	fflush ( sim -> outputFile );
+}
+
 int EqualStr ( const char* str1 , const char* str2 ) 
 {
 	return strcmp ( str1 , str2 ) == 0;
@@ -481,1107 +451,2448 @@ int ParamToInt ( const char *param )
    return paramInt;
 }
 
-PCB *NewProcess ( int priorityLevel ) 
+void PrintRealTimeSummary ( OS_SIM *sim , const PCB *pcb ) 
 {
-	if ( !ValidPriorityLevel ( priorityLevel ) ) {
-		int lowestPriorityNum = NUM_PRIORITY_LEVELS - 1;
-
-		ChangeTextColorToError ();
-		printf ( "ERROR: Priority Level number can only be between 0 (Highest) and %d (Lowest)\n\n" , lowestPriorityNum );
-		ChangeTextColorToDefault ();
-
-		return NULL;
-	}
-
-	PCB *newProcess = ( PCB *) malloc ( sizeof ( PCB ) );
-	newProcess -> processID = nextAvailProcessID;
-	newProcess -> priorityLevel = priorityLevel;
-	newProcess -> numCPUBurstsInPriorityLevel = 0;
-	newProcess -> readMessage = NULL;
-
-	if ( newProcess -> priorityLevel == NUM_PRIORITY_LEVELS - 1 ) 
-	{
-		newProcess -> priorityDirection = PROMOTING;
-	}
-	else 
+	if ( !pcb || pcb -> schedulingClass != REAL_TIME_CLASS ) 
 	{
-		newProcess -> priorityDirection = DEMOTING;
+		return;
 	}
 
-	nextAvailProcessID++;
-	return newProcess;
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , 
+		"OS: REAL-TIME PROCESS (ID = %d) COMPLETED %d JOBS with %d DEADLINE MISSES\n\n" ,
+		pcb -> processID ,
+		pcb -> numJobsCompleted ,
+		pcb -> numDeadlineMisses
+	);
+	ChangeTextColorToDefault ( sim );
 }
 
-void CreateProcess ( int priorityLevel ) {
-	PCB *newProcess = NewProcess ( priorityLevel );
-	if ( !newProcess ) 
+void StrToUpper ( char *str ) 
+{
+	if ( !str ) 
 	{
 		return;
 	}
 
-	AddToReadyQueue ( newProcess );
-
-	ChangeTextColorToSuccess ();
-	printf ( "SUCCESS: CREATED " );
-	PrintPCB ( newProcess );
-	ChangeTextColorToDefault ();
-
-	if ( runningProcess -> processID == INIT_PROCESS_ID ) {
-		RunNextProcess ();
+	for ( int i = 0 ; i < strlen ( str ) ; i++ ) 
+	{
+		str [ i ] = toupper ( str [ i ] );
 	}
 }
 
-void QuantumExpired () 
-{
-	RunNextProcess ();
-}
-
-int EqualsProcessID ( void *pcb , void *processID ) 
+int ProcInfo ( OS_SIM *sim , int processID ) 
 {
-	if ( !pcb || !processID )
+	const PCB *foundProcess = OSSimFindProcess ( sim , processID );
+	if ( !foundProcess ) 
 	{
-		return 0;
+		ChangeTextColorToError ( sim );
+		fprintf ( sim -> outputFile , "ERROR: PROCESS (ID = %d) does not exist in system\n\n" , processID );
+		ChangeTextColorToDefault ( sim );
+
+		return OSSIM_NO_SUCH_PROCESS;
 	}
 
-	return ( ( PCB *) pcb ) -> processID == *( ( int *) processID );
-}
+	char* processStateStr;
+	switch ( foundProcess -> processState ) 
+	{
+		case SEND_BLOCKED :
+			processStateStr = "SEND-BLOCKED";
+			break;
 
-PCB *RemoveProcessFromQueue ( int processID , LIST *queue ) 
-{
-	if ( !queue ) {
-		return NULL;
-	} 
+		case RECEIVE_BLOCKED :
+			processStateStr = "RECEIVE-BLOCKED";
+			break;
 
-	ListFirst ( queue );
-	PCB *foundProcess = ( PCB *) ListSearch ( queue , &EqualsProcessID , &processID );
-	if ( !foundProcess ) {
-		return NULL;
-	}
+		case SEM_BLOCKED :
+			processStateStr = "SEMAPHORE-BLOCKED";
+			break;
 
-	ListRemove ( queue );
-	return foundProcess;
-}
+		case READY :
+			processStateStr = "READY";
+			break;
 
-PCB *FindProcessFromQueue ( int processID , LIST *queue ) 
-{
-	if ( !queue ) {
-		return NULL;
-	} 
+		case RUNNING :
+			processStateStr = "RUNNING";
+			break;
 
-	ListFirst ( queue );
-	PCB *foundProcess = ( PCB *) ListSearch ( queue , &EqualsProcessID , &processID );
-	if ( !foundProcess ) {
-		return NULL;
-	}
+		case PERIOD_WAITING :
+			processStateStr = "PERIOD-WAITING";
+			break;
 
-	return foundProcess;
-}
+		case WAIT_BLOCKED :
+			processStateStr = "WAIT-BLOCKED";
+			break;
 
-PCB *FindAndRemoveProcessFromAllQueues ( int processID ) 
-{
-	PCB *foundProcess = RemoveProcessFromQueue ( processID , sendBlockedQueue );
-	
-	if ( !foundProcess ) 
-	{
-		foundProcess = RemoveProcessFromQueue ( processID , receiveBlockedQueue );
+		default: 
+			processStateStr = "ERROR";
 	}
 
-	for ( int i = 0 ; i < NUM_PRIORITY_LEVELS && !foundProcess ; i++ ) 
+	char groupStr [ 32 ] = "";
+	if ( foundProcess -> groupID != NO_PROCESS_GROUP ) 
 	{
-		LIST *readyQueue = readyPriorityQueues [ i ];
-		foundProcess = RemoveProcessFromQueue ( processID , readyQueue );
+		snprintf ( groupStr , sizeof ( groupStr ) , " (GROUP = %d)" , foundProcess -> groupID );
 	}
 
-	for ( int i = 0 ; i < NUM_SEMAPHORES && !foundProcess ; i++ ) 
+	char inheritedStr [ 32 ] = "";
+	if ( foundProcess -> inheritedPriorityLevel < foundProcess -> priorityLevel ) 
 	{
-		SEMAPHORE *semaphore = &semaphores [ i ];
-		LIST *blockedQueue = semaphore -> blockedPCBs;
-		foundProcess = RemoveProcessFromQueue ( processID , blockedQueue );
+		snprintf ( inheritedStr , sizeof ( inheritedStr ) , ", INHERITED = %d" , foundProcess -> inheritedPriorityLevel );
 	}
 
-	return foundProcess;
-}
+	char treeStr [ 64 ] = "";
+	int treeLength = 0;
+	if ( foundProcess -> parentProcessID != INIT_PROCESS_ID ) 
+	{
+		treeLength += snprintf ( treeStr , sizeof ( treeStr ) , " (PARENT = %d)" , foundProcess -> parentProcessID );
+	}
 
-PCB *FindProcessFromAllQueues ( int processID ) 
-{
-	PCB *foundProcess = FindProcessFromQueue ( processID , sendBlockedQueue );
-	
-	if ( !foundProcess ) 
+	if ( foundProcess -> numChildren > 0 ) 
 	{
-		foundProcess = FindProcessFromQueue ( processID , receiveBlockedQueue );
+		snprintf ( treeStr + treeLength , sizeof ( treeStr ) - treeLength , 
+			" (CHILDREN = %d, ZOMBIE = %d)" , 
+			foundProcess -> numChildren , 
+			foundProcess -> numZombieChildren 
+		);
 	}
 
-	for ( int i = 0 ; i < NUM_PRIORITY_LEVELS && !foundProcess ; i++ ) 
+	char memoryStr [ 48 ] = "";
+	if ( foundProcess -> addressSpace ) 
 	{
-		LIST *readyQueue = readyPriorityQueues [ i ];
-		foundProcess = FindProcessFromQueue ( processID , readyQueue );
+		snprintf ( memoryStr , sizeof ( memoryStr ) , 
+			" (MEMORY = %d PAGES%s)" , 
+			foundProcess -> addressSpace -> numPages , 
+			foundProcess -> addressSpace -> refCount > 1 ? ", SHARED COPY-ON-WRITE" : "" 
+		);
 	}
 
-	for ( int i = 0 ; i < NUM_SEMAPHORES && !foundProcess ; i++ ) 
+	if ( foundProcess -> processID == INIT_PROCESS_ID )
+	{
+		ChangeTextColorToSuccess ( sim );
+		fprintf ( sim -> outputFile , 
+			"SUCCESS: INIT PROCESS (ID = %d) (STATE = %s) (PRIORITY LEVEL = %d)\n\n" ,
+			foundProcess -> processID , 
+			processStateStr ,
+			foundProcess -> priorityLevel 
+		);
+		ChangeTextColorToDefault ( sim );
+	}
+	else if ( foundProcess -> schedulingClass == REAL_TIME_CLASS ) 
+	{
+		ChangeTextColorToSuccess ( sim );
+		fprintf ( sim -> outputFile , 
+			"SUCCESS: REAL-TIME PROCESS (ID = %d) (STATE = %s) (CPU = %d) (AFFINITY = 0x%X) (MIGRATIONS = %d, CROSS-NODE = %d) (PERIOD = %d) (DEADLINE = %d) (BUDGET = %d) (DEADLINE MISSES = %d) (JOBS COMPLETED = %d)%s%s%s\n\n" ,
+			foundProcess -> processID , 
+			processStateStr ,
+			foundProcess -> cpuID ,
+			foundProcess -> affinityMask ,
+			foundProcess -> numMigrations ,
+			foundProcess -> numCrossNodeMigrations ,
+			foundProcess -> period ,
+			foundProcess -> relativeDeadline ,
+			foundProcess -> budget ,
+			foundProcess -> numDeadlineMisses ,
+			foundProcess -> numJobsCompleted ,
+			groupStr ,
+			treeStr ,
+			memoryStr
+		);
+		ChangeTextColorToDefault ( sim );
+	}
+	else 
 	{
-		SEMAPHORE *semaphore = &semaphores [ i ];
-		LIST *blockedQueue = semaphore -> blockedPCBs;
-		foundProcess = FindProcessFromQueue ( processID , blockedQueue );
+		ChangeTextColorToSuccess ( sim );
+		fprintf ( sim -> outputFile , 
+			"SUCCESS: PROCESS (ID = %d) (STATE = %s) (PRIORITY LEVEL = %d%s) (CPU = %d) (AFFINITY = 0x%X) (MIGRATIONS = %d, CROSS-NODE = %d)%s%s%s\n\n" ,
+			foundProcess -> processID , 
+			processStateStr ,
+			foundProcess -> priorityLevel ,
+			inheritedStr ,
+			foundProcess -> cpuID ,
+			foundProcess -> affinityMask ,
+			foundProcess -> numMigrations ,
+			foundProcess -> numCrossNodeMigrations ,
+			groupStr ,
+			treeStr ,
+			memoryStr
+		);
+		ChangeTextColorToDefault ( sim );
 	}
 
-	return foundProcess;
+	return OSSIM_SUCCESS;
 }
 
-int ProcessExistsInQueue ( int processID , LIST *queue ) 
+int SearchPrintMessage ( void *item , void *messageListPrinter ) 
 {
-	if ( !queue ) {
-		return 0;
-	} 
+	MESSAGE *message = ( MESSAGE *) item;
 
-	ListFirst ( queue );
-	PCB *foundProcess = ( PCB *) ListSearch ( queue , &EqualsProcessID , &processID );
-	if ( !foundProcess ) {
-		return 0;
+	LIST_PRINTER *printer = ( LIST_PRINTER *) messageListPrinter;
+	OS_SIM *sim = printer -> sim;
+	fprintf ( sim -> outputFile , "\t%d. " , printer -> numbering );
+
+	if ( message ) 
+	{
+		PrintMessage ( sim , message );
+	}
+	else 
+	{
+		ChangeTextColorToError ( sim );
+		fprintf ( sim -> outputFile , "DEV-ERROR: Found NULL MESSAGE\n\n" );	
+		ChangeTextColorToDefault ( sim );	
 	}
 
-	return 1;
+	printer -> numbering += 1;
+	return 0;
 }
 
-int ProcessExists ( int processID ) 
+int SearchPrintPCB ( void *item , void *pcbListPrinter ) 
 {
-	int foundProcess = processID == INIT_PROCESS_ID;
+	PCB *pcb = ( PCB *) item;
 
-	if ( !foundProcess ) 
-	{
-		foundProcess = processID == runningProcess -> processID;
-	}
+	LIST_PRINTER *printer = ( LIST_PRINTER *) pcbListPrinter;
+	OS_SIM *sim = printer -> sim;
+	fprintf ( sim -> outputFile , "\t%d. " , printer -> numbering );
 
-	if ( !foundProcess ) 
+	if ( pcb ) 
 	{
-		foundProcess = ProcessExistsInQueue ( processID , sendBlockedQueue );
+		PrintPCB ( sim , pcb );
 	}
-
-	if ( !foundProcess ) 
+	else 
 	{
-		foundProcess = ProcessExistsInQueue ( processID , receiveBlockedQueue );
+		ChangeTextColorToError ( sim );
+		fprintf ( sim -> outputFile , "DEV-ERROR: Found NULL PCB\n\n" );	
+		ChangeTextColorToDefault ( sim );	
 	}
 
-	for ( int i = 0 ; i < NUM_PRIORITY_LEVELS && !foundProcess ; i++ ) 
+	printer -> numbering += 1;
+	return 0;
+}
+
+void PrintSemaphore ( OS_SIM *sim , const SEMAPHORE *semaphore ) 
+{
+	if ( !semaphore ) 
 	{
-		LIST *readyQueue = readyPriorityQueues [ i ];
-		foundProcess = ProcessExistsInQueue ( processID , readyQueue );
+		return;
 	}
 
-	for ( int i = 0 ; i < NUM_SEMAPHORES && !foundProcess ; i++ ) 
+	fprintf ( sim -> outputFile , "\tSemaphore (ID = %d), Status: " , semaphore -> semID );
+	if ( semaphore -> semStatus == NOT_CREATED ) 
 	{
-		SEMAPHORE *semaphore = &semaphores [ i ];
-		LIST *blockedPCBs = semaphore -> blockedPCBs;
-		foundProcess = ProcessExistsInQueue ( processID , blockedPCBs );
+		fprintf ( sim -> outputFile , "NOT CREATED\n" );
+		return;
 	}
 
-	return foundProcess;
-}
+	fprintf ( sim -> outputFile , 
+		"CREATED - Value = %d\n" , 
+		semaphore -> semValue
+	);
 
-void EndProcess ( int processID , char *commandAction ) 
-{
-	int numSystemProcessesTotal = NumSystemProcessesTotal ();
-	int onlyInitProcessesInSystem = numSystemProcessesTotal == 1;
-	if ( processID == INIT_PROCESS_ID && !onlyInitProcessesInSystem ) {
-		ChangeTextColorToError ();
-		printf ( 
-			"ERROR: Not %s INIT PROCESS (ID = %d), there are still %d other processes in the system\n\n" ,
-			commandAction ,
-			INIT_PROCESS.processID ,
-			numSystemProcessesTotal - 1
+	if ( ListCount ( semaphore -> blockedPCBs ) == 0 ) 
+	{
+		fprintf ( sim -> outputFile , "\tNo processes SEM-BLOCKED\n\n" );
+	}
+	else
+	{
+		fprintf ( sim -> outputFile , 
+			"\tProcesses SEM-BLOCKED: %d\n" , 
+			ListCount ( semaphore -> blockedPCBs ) 
 		);
-		ChangeTextColorToDefault ();
 
-		return;
+		LIST_PRINTER pcbListPrinter = { .sim = sim , .numbering = 1 };
+		ListFirst ( semaphore -> blockedPCBs );
+		ListSearch ( semaphore -> blockedPCBs , &SearchPrintPCB , &pcbListPrinter );
 	}
+}
 
-	if ( processID == INIT_PROCESS_ID && onlyInitProcessesInSystem ) {
-		ChangeTextColorToSuccess ();
-		printf ( 
-			"SUCCESS: %s INIT PROCESS (ID = %d)\n\n" , 
-			commandAction , 
-			runningProcess -> processID 
-		);
-		ChangeTextColorToDefault ();
-
-		runningProcess = NULL;
-		return;
+void PrintCPU ( OS_SIM *sim , CPU *cpu ) 
+{
+	int numTicks = cpu -> numBusyTicks + cpu -> numIdleTicks;
+	double utilization = 0.0;
+	if ( numTicks > 0 ) 
+	{
+		utilization = 100.0 * cpu -> numBusyTicks / numTicks;
 	}
 
-	if ( processID == runningProcess -> processID ) {
-		ChangeTextColorToSuccess ();
-		printf ( 
-			"SUCCESS: %s PROCESS (ID = %d) (State = RUNNING)\n\n" , 
-			commandAction , 
-			runningProcess -> processID 
-		);
-		ChangeTextColorToDefault ();
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: CPU %d (NODE = %d, CACHE = %d) - Currently Running Process\n\t" , cpu -> cpuID , cpu -> nodeID , cpu -> cacheID );
+	ChangeTextColorToDefault ( sim );
 
-		FreePCB ( runningProcess );
-		runningProcess = NULL;
-		RunNextProcess ();
-		return;
-	}
+	PrintPCB ( sim , cpu -> runningProcess );
 
-	PCB *foundProcess = FindAndRemoveProcessFromAllQueues ( processID );
-	if ( !foundProcess ) {
-		ChangeTextColorToError ();
-		printf ( "ERROR: No Process with ID = %d exists\n\n" , processID );
-		ChangeTextColorToDefault ();
+	fprintf ( sim -> outputFile , 
+		"\tUTILIZATION - %.1f%% (BUSY = %d, IDLE = %d TICKS) (CONTEXT SWITCHES = %d) (MIGRATIONS IN = %d, OUT = %d) (STEALS = %d) (WARM-UP BURSTS = %d)\n\n" ,
+		utilization ,
+		cpu -> numBusyTicks ,
+		cpu -> numIdleTicks ,
+		cpu -> numContextSwitches ,
+		cpu -> numMigrationsIn ,
+		cpu -> numMigrationsOut ,
+		cpu -> numSteals ,
+		cpu -> numWarmUpBursts
+	);
 
-		return;
-	}
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: CPU %d REAL-TIME Ready Heap (EDF) - Process List\n" , cpu -> cpuID );
+	ChangeTextColorToDefault ( sim );
 
-	char *processStateText = "";
-	if ( foundProcess -> processState == RUNNING ) 
+	if ( HeapCount ( cpu -> realTimeReadyHeap ) == 0 ) 
 	{
-		processStateText = "RUNNING";
+		fprintf ( sim -> outputFile , "\tEMPTY - No REAL-TIME Processes Ready\n\n" );
 	}
-	else if ( foundProcess -> processState == READY )
+	else 
 	{
-		processStateText = "READY";
+		fprintf ( sim -> outputFile , 
+			"\tCOUNT - %d (HEAP ORDER, 1 -> NEXT TO RUN)\n\n" , 
+			HeapCount ( cpu -> realTimeReadyHeap ) 
+		);
+
+		LIST_PRINTER pcbListPrinter = { .sim = sim , .numbering = 1 };
+		HeapSearch ( cpu -> realTimeReadyHeap , &SearchPrintPCB , &pcbListPrinter );
 	}
 
-	ChangeTextColorToSuccess ();
-	printf ( 
-		"SUCCESS: %s PROCESS (ID = %d) (State = %s)\n\n" ,
-		commandAction , 
-		foundProcess -> processID , 
-		processStateText
-	);
-	ChangeTextColorToDefault ();
+	for ( int i = 0 ; i < sim -> numPriorityLevels ; i++ ) 
+	{
+		ChangeTextColorToOS ( sim );
+		fprintf ( sim -> outputFile , "OS: CPU %d Ready Queue (Priority Level = %d) - Process List\n" , cpu -> cpuID , i );
+		ChangeTextColorToDefault ( sim );
+
+		LIST *readyQueue = cpu -> readyPriorityQueues [ i ];
+
+		if ( ListCount ( readyQueue ) == 0 ) 
+		{
+			fprintf ( sim -> outputFile , "\tEMPTY - No Processes In Queue\n\n" );
+		}
+		else 
+		{
+			fprintf ( sim -> outputFile , 
+				"\tCOUNT - %d (LAST TO RUN -> 1 ... %d -> NEXT TO RUN\n\n" ,
+				ListCount ( readyQueue ) ,
+				ListCount ( readyQueue )
+			);
 
-	FreePCB ( foundProcess );
+			LIST_PRINTER pcbListPrinter = { .sim = sim , .numbering = 1 };
+			ListFirst ( readyQueue );
+			ListSearch ( readyQueue , &SearchPrintPCB , &pcbListPrinter );			
+		}
+	}
 }
 
-void SendBlockRunningProcess () 
+void PrintListPoolStats ( OS_SIM *sim ) 
 {
-	if ( runningProcess -> processID == INIT_PROCESS_ID ) 
-	{
-		return;
-	} 
-
-	runningProcess -> processState = SEND_BLOCKED;
-	ListAppend ( sendBlockedQueue , ( void *) runningProcess );
+	LIST_POOL_STATS poolStats;
+	ListPoolGetStats ( &sim -> listPool , &poolStats );
+
+	int numTicks = sim -> currentTick > 0 ? sim -> currentTick : 1;
+	fprintf ( sim -> outputFile , 
+		"OS: List Pool - NODES IN USE = %d/%d (PEAK %d), LISTS IN USE = %d/%d (PEAK %d), NODE ALLOCS = %lu (%.2f PER TICK), NODE FREES = %lu (%.2f PER TICK), EXHAUSTED = %lu NODE / %lu LIST\n" ,
+		poolStats.nodesInUse ,
+		MAX_NUM_NODES_ALLOC ,
+		poolStats.peakNodesInUse ,
+		poolStats.listsInUse ,
+		MAX_NUM_LISTS_ALLOC ,
+		poolStats.peakListsInUse ,
+		poolStats.numNodeAllocs ,
+		( double ) poolStats.numNodeAllocs / numTicks ,
+		poolStats.numNodeFrees ,
+		( double ) poolStats.numNodeFrees / numTicks ,
+		poolStats.numNodeExhaustions ,
+		poolStats.numListExhaustions
+	);
 
-	ChangeTextColorToOS ();
-	printf ( "OS: Process (ID = %d) is SEND-BLOCKED\n\n" , runningProcess -> processID );
-	ChangeTextColorToDefault ();
+	for ( int i = OSSIM_READY_QUEUES ; i < NUM_OSSIM_LIST_OWNERS ; i++ ) 
+	{
+		const LIST_OWNER_STATS *owner = &poolStats.owners [ i ];
+		fprintf ( sim -> outputFile , 
+			"\t%s - NODES IN USE = %d, PEAK = %d, EXHAUSTED = %lu\n" , 
+			OSSimListOwnerStr ( i ) , 
+			owner -> nodesInUse , 
+			owner -> peakNodesInUse , 
+			owner -> numExhaustions 
+		);
+	}
 
-	runningProcess = NULL;
-	RunNextProcess ();
+	fprintf ( sim -> outputFile , "\n" );
 }
 
-int UnblockSendBlockedProcess ( MESSAGE *replyMessage ) 
+void DisplayTotalSystemInfo ( OS_SIM *sim , LOGGER *logger ) 
 {
-	if ( !replyMessage ) 
+	fprintf ( sim -> outputFile , "\n-------------- TOTAL SYSTEM INFO --------------\n" );
+
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: Number of Processes in System = %d\n\n" , NumSystemProcessesTotal ( sim ) );
+	if ( sim -> numZombieProcesses > 0 ) 
 	{
-		return 0;
+		fprintf ( sim -> outputFile , "OS: ZOMBIE Processes Not Yet Waited For = %d\n\n" , sim -> numZombieProcesses );
+	}
+
+	fprintf ( sim -> outputFile , "OS: Current Tick = %d\n\n" , sim -> currentTick );
+	fprintf ( sim -> outputFile , 
+		"OS: Topology = %d CPUs, %d NUMA NODES, %d CPUs per SHARED CACHE\n\n" , 
+		sim -> numCPUs , 
+		sim -> numNodes , 
+		sim -> numCPUsPerCache 
+	);
+	fprintf ( sim -> outputFile , 
+		"OS: Migrations - SHARED CACHE = %d, SAME NODE = %d, CROSS NODE = %d (SIMULATED WARM-UP COST = %d BURSTS)\n\n" ,
+		sim -> numMigrationsByDistance [ SHARED_CACHE ] ,
+		sim -> numMigrationsByDistance [ SAME_NODE ] ,
+		sim -> numMigrationsByDistance [ CROSS_NODE ] ,
+		sim -> totalMigrationWarmUpBursts
+	);
+	fprintf ( sim -> outputFile , 
+		"OS: Scheduler - PROMOTIONS = %d, DEMOTIONS = %d, DISPATCHES = %d, MEAN READY WAIT = %.2f TICKS, MAX READY WAIT = %d TICKS, DEADLINE MISSES = %d\n\n" ,
+		sim -> numPromotions ,
+		sim -> numDemotions ,
+		sim -> numDispatches ,
+		MeanReadyWaitTicks ( sim ) ,
+		sim -> maxReadyWaitTicks ,
+		sim -> totalDeadlineMisses
+	);
+	fprintf ( sim -> outputFile , 
+		"OS: Memory - FORKS = %d (PAGES SHARED = %ld), PAGE TABLE COPIES = %d, COPY-ON-WRITE FAULTS = %d\n\n" ,
+		sim -> numForks ,
+		sim -> numForkPagesShared ,
+		sim -> numPageTableCopies ,
+		sim -> numCOWFaults
+	);
+	fprintf ( sim -> outputFile , 
+		"OS: Deadlocks - DETECTED = %d (PROCESSES = %d), SEARCHES = %d (PROCESSES EXPANDED = %ld)\n\n" ,
+		sim -> numDeadlocksDetected ,
+		sim -> numDeadlockedProcesses ,
+		sim -> numDeadlockSearches ,
+		sim -> numDeadlockSearchSteps
+	);
+	fprintf ( sim -> outputFile , 
+		"OS: Priority Inheritance - BOOSTS = %d, BOOSTED RUN TICKS = %ld\n\n" ,
+		sim -> numPriorityBoosts ,
+		sim -> numBoostedRunTicks
+	);
+	PrintListPoolStats ( sim );
+
+	if ( logger -> policy != LOG_SYNC ) 
+	{
+		fprintf ( sim -> outputFile , 
+			"OS: Async Logger (POLICY = %s) - QUEUED = %lu, WRITTEN = %lu, DROPPED = %lu, PRODUCER WAITS = %lu, WRITER SLEEPS = %lu, PEAK RING USE = %lu/%d\n\n" ,
+			LOG_POLICY_NAMES [ logger -> policy ] ,
+			logger -> numRecordsPushed ,
+			atomic_load ( &logger -> numRecordsWritten ) ,
+			logger -> numRecordsDropped ,
+			logger -> numProducerWaits ,
+			atomic_load ( &logger -> numWriterSleeps ) ,
+			logger -> peakRingUse ,
+			LOG_RING_CAPACITY
+		);
 	}
+	ChangeTextColorToDefault ( sim );
 
-	if ( replyMessage -> recipientProcessID == INIT_PROCESS_ID ) 
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
 	{
-		return 0;
+		PrintCPU ( sim , &sim -> cpus [ i ] );
 	}
 
-	PCB *unblockedProcess = RemoveProcessFromQueue ( replyMessage -> recipientProcessID , sendBlockedQueue );
-	if ( !unblockedProcess ) 
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: REAL-TIME PERIOD-WAITING Heap - Process List\n" );
+	ChangeTextColorToDefault ( sim );
+
+	if ( HeapCount ( sim -> realTimeReleaseHeap ) == 0 ) 
 	{
-		return 0;
+		fprintf ( sim -> outputFile , "\tEMPTY - No REAL-TIME Processes Waiting For Next Period\n\n" );
 	}
+	else 
+	{
+		fprintf ( sim -> outputFile , 
+			"\tCOUNT - %d (HEAP ORDER, 1 -> NEXT RELEASED)\n\n" , 
+			HeapCount ( sim -> realTimeReleaseHeap ) 
+		);
 
-	unblockedProcess -> readMessage = replyMessage;
+		LIST_PRINTER pcbListPrinter = { .sim = sim , .numbering = 1 };
+		HeapSearch ( sim -> realTimeReleaseHeap , &SearchPrintPCB , &pcbListPrinter );
+	}
 
-	ChangeTextColorToOS ();
-	printf ( "OS: Process (ID = %d) is SEND-UNBLOCKED\n\n" , unblockedProcess -> processID );
-	ChangeTextColorToDefault ();
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: SEND-BLOCKED Queue - Process List\n" );
+	ChangeTextColorToDefault ( sim );
 
-	AddToReadyQueue ( unblockedProcess );
-	return 1;
-}
+	if ( ListCount ( sim -> sendBlockedQueue ) == 0 ) 
+	{
+		fprintf ( sim -> outputFile , "\tEMPTY - No Processes SEND-BLOCKED\n\n" );
+	}
+	else 
+	{
+		fprintf ( sim -> outputFile , 
+			"\tCOUNT - %d\n\n" , 
+			ListCount ( sim -> sendBlockedQueue ) 
+		);
 
-void AddToMessagesQueue ( MESSAGE *message ) 
-{
-	if ( !message ) 
+		LIST_PRINTER pcbListPrinter = { .sim = sim , .numbering = 1 };
+		ListFirst ( sim -> sendBlockedQueue );
+		ListSearch ( sim -> sendBlockedQueue , &SearchPrintPCB , &pcbListPrinter );
+	}
+
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: RECEIVE-BLOCKED Queue - Process List\n" );
+	ChangeTextColorToDefault ( sim );
+
+	if ( ListCount ( sim -> receiveBlockedQueue ) == 0 ) 
 	{
-		return;
+		fprintf ( sim -> outputFile , "\tEMPTY - No Processes RECEIVE-BLOCKED\n\n" );
+	}
+	else 
+	{
+		fprintf ( sim -> outputFile , 
+			"\tCOUNT - %d\n\n" , 
+			ListCount ( sim -> receiveBlockedQueue ) 
+		);
+
+		LIST_PRINTER pcbListPrinter = { .sim = sim , .numbering = 1 };
+		ListFirst ( sim -> receiveBlockedQueue );
+		ListSearch ( sim -> receiveBlockedQueue , &SearchPrintPCB , &pcbListPrinter );
 	}
 
-	ListAppend ( messagesQueue , ( void *) message );
-}
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: WAIT-BLOCKED Queue - Process List\n" );
+	ChangeTextColorToDefault ( sim );
 
-MESSAGE *CreateMessage ( int senderProcessID , int recipientProcessID , const char *messageStr ) 
-{
-	if ( !messageStr || strlen ( messageStr ) == 0 ) 
+	if ( ListCount ( sim -> waitBlockedQueue ) == 0 ) 
+	{
+		fprintf ( sim -> outputFile , "\tEMPTY - No Processes WAIT-BLOCKED\n\n" );
+	}
+	else 
 	{
-		messageStr = "<Blank Message>\0";
+		fprintf ( sim -> outputFile , 
+			"\tCOUNT - %d\n\n" , 
+			ListCount ( sim -> waitBlockedQueue ) 
+		);
+
+		LIST_PRINTER pcbListPrinter = { .sim = sim , .numbering = 1 };
+		ListFirst ( sim -> waitBlockedQueue );
+		ListSearch ( sim -> waitBlockedQueue , &SearchPrintPCB , &pcbListPrinter );
 	}
 
-	MESSAGE *message = ( MESSAGE *) malloc ( sizeof ( MESSAGE ) );
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: MESSAGES Queue - Messages List\n" );
+	ChangeTextColorToDefault ( sim );
+
+	if ( ListCount ( sim -> messagesQueue ) == 0 ) 
+	{
+		fprintf ( sim -> outputFile , "\tEMPTY - No Messages Waiting\n\n" );
+	}
+	else
+	{
+		fprintf ( sim -> outputFile , 
+			"\tCOUNT - %d\n\n" , 
+			ListCount ( sim -> messagesQueue ) 
+		);
 
-	message -> senderProcessID = senderProcessID;
-	message -> recipientProcessID = recipientProcessID;
-	strcpy ( message -> messageStr , messageStr );
+		LIST_PRINTER messagesListPrinter = { .sim = sim , .numbering = 1 };
+		ListFirst ( sim -> messagesQueue );
+		ListSearch ( sim -> messagesQueue , &SearchPrintMessage , &messagesListPrinter );
+	}
 
-	return message;
-}
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: SEMAPHORES List\n" );
+	ChangeTextColorToDefault ( sim );
 
-int EqualsMessageRecipientID (  void *message , void *processID ) 
-{
-	if ( !message || !processID ) 
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
 	{
-		return 0;
+		SEMAPHORE *semaphore = &sim -> semaphores [ i ];
+		PrintSemaphore ( sim , semaphore );
 	}
 
-	return ( ( MESSAGE *) message ) -> recipientProcessID == *( ( int *) processID );
+	fprintf ( sim -> outputFile , "------------- END Of SYSTEM INFO -------------\n\n" );
 }
 
-MESSAGE *FindMessage ( int processID ) 
+/* USER COMMAND HANDLERS - run a command on the core and report its status */
+void PrintError ( OS_SIM *sim , const char *format , ... ) 
 {
-	ListFirst ( messagesQueue );
-	MESSAGE *foundMessage = ( MESSAGE *) ListSearch ( messagesQueue , &EqualsMessageRecipientID , &processID );
-	if ( !foundMessage ) {
-		return 0;
-	}
+	va_list args;
+	va_start ( args , format );
 
-	ListRemove ( messagesQueue );
+	ChangeTextColorToError ( sim );
+	vfprintf ( sim -> outputFile , format , args );
+	ChangeTextColorToDefault ( sim );
 
-	return foundMessage;
+	va_end ( args );
 }
 
-void ReceiveBlockRunningProcess () 
+void PrintSuccess ( OS_SIM *sim , const char *format , ... ) 
 {
-	if ( runningProcess -> processID == INIT_PROCESS_ID ) 
-	{
-		return;
-	}
+	va_list args;
+	va_start ( args , format );
 
-	runningProcess -> processState = RECEIVE_BLOCKED;
-	ListAppend ( receiveBlockedQueue , ( void *) runningProcess );
+	ChangeTextColorToSuccess ( sim );
+	vfprintf ( sim -> outputFile , format , args );
+	ChangeTextColorToDefault ( sim );
 
-	ChangeTextColorToOS ();
-	printf ( "OS: Running Process (ID = %d) is RECEIVE-BLOCKED\n\n" , runningProcess -> processID );
-	ChangeTextColorToDefault ();
-
-	runningProcess = NULL;
-	RunNextProcess ();
+	va_end ( args );
 }
 
-int UnblockReceiveBlockedProcess ( MESSAGE *sentMessage ) 
+void PrintStatusError ( OS_SIM *sim , int status ) 
 {
-	if ( !sentMessage ) 
+	if ( status == OSSIM_INVALID_PRIORITY ) 
 	{
-		return 0;
+		PrintError ( sim , "ERROR: Priority Level number can only be between 0 (Highest) and %d (Lowest)\n\n" , sim -> numPriorityLevels - 1 );
 	}
-
-	if ( sentMessage -> recipientProcessID == INIT_PROCESS_ID ) 
+	else if ( status == OSSIM_INVALID_REAL_TIME_PARAMS ) 
 	{
-		return 0;
+		PrintError ( sim , "ERROR: REAL-TIME parameters must satisfy 0 < BUDGET <= DEADLINE <= PERIOD\n\n" );
 	}
-
-	PCB *unblockedProcess = RemoveProcessFromQueue ( sentMessage -> recipientProcessID , receiveBlockedQueue );
-	if ( !unblockedProcess ) 
+	else if ( status == OSSIM_TOO_MANY_REAL_TIME_PROCESSES ) 
 	{
-		return 0;
+		PrintError ( sim , "ERROR: Maximum number of REAL-TIME processes (%d) reached\n\n" , MAX_REAL_TIME_PROCESSES );
 	}
-
-	unblockedProcess -> readMessage = sentMessage;
-
-	ChangeTextColorToOS ();
-	printf ( "OS: Process (ID = %d) is RECEIVE-UNBLOCKED\n\n" , unblockedProcess -> processID );
-	ChangeTextColorToDefault ();
-
-	AddToReadyQueue ( unblockedProcess );
-	return 1;
-}
-
-void ReceiveMessage () 
-{
-	MESSAGE *receivedMessage = FindMessage ( runningProcess -> processID );
-	if ( receivedMessage ) 
+	else if ( status == OSSIM_INVALID_SEMAPHORE ) 
 	{
-		runningProcess -> readMessage = receivedMessage;
-		ChangeTextColorToSuccess ();
-		printf ( 
-			"SUCCESS: Received message (SenderID = %d, recipientProcessID = %d) - \"%s\"\n\n",
-			receivedMessage -> senderProcessID,
-			receivedMessage -> recipientProcessID,
-			receivedMessage -> messageStr
-		);
-		ChangeTextColorToDefault ();
-
-		return;
+		PrintError ( sim , "ERROR: Invalid Semaphore ID (VALID IDs = 0-%d)\n\n" , NUM_SEMAPHORES - 1 );
 	}
-
-	if ( runningProcess -> processID == INIT_PROCESS_ID ) 
+	else if ( status == OSSIM_INVALID_GROUP ) 
 	{
-		ChangeTextColorToSuccess ();
-		printf ( "SUCCESS: No messages sent to INIT PROCESS (ID = %d)\n\n" , INIT_PROCESS_ID );
-		ChangeTextColorToDefault ();
-
-		return;
+		PrintError ( sim , "ERROR: Invalid Process Group ID (VALID IDs = 0-%d)\n\n" , MAX_PROCESS_GROUPS - 1 );
 	}
-	else 
+	else if ( status == OSSIM_INVALID_PAGE ) 
 	{
-		ChangeTextColorToSuccess ();
-		printf ( "SUCCESS: No messages sent to PROCESS (ID = %d)\n\n" , runningProcess -> processID );	
-		ChangeTextColorToDefault ();
+		PrintError ( sim , "ERROR: Invalid Memory Page (VALID PAGES = 0-%d)\n\n" , NUM_MEMORY_PAGES - 1 );
 	}
-
-	if ( runningProcess -> processID != INIT_PROCESS_ID ) 
+	else 
 	{
-		ReceiveBlockRunningProcess ();
+		PrintError ( sim , "ERROR: %s\n\n" , OSSimStatusStr ( status ) );
 	}
 }
 
-void SendMessage ( int recipientProcessID , const char *messageStr ) 
+void PrintCreatedProcess ( OS_SIM *sim , int status , int newProcessID ) 
 {
-	if ( recipientProcessID == runningProcess -> processID ) 
+	if ( status != OSSIM_SUCCESS ) 
 	{
-		ChangeTextColorToError ();
-		printf ( "ERROR: Process (ID = %d) cannot send message to self\n\n" , recipientProcessID );
-		ChangeTextColorToDefault ();
-
+		PrintStatusError ( sim , status );
 		return;
 	}
 
-	int recipientProcessExists = ProcessExists ( recipientProcessID );
-	if ( !recipientProcessExists ) 
-	{
-		ChangeTextColorToError ();
-		printf ("ERROR: Recipient Process (ID = %d) does not exist in system\n\n" , recipientProcessID );
-		ChangeTextColorToDefault ();
+	ChangeTextColorToSuccess ( sim );
+	fprintf ( sim -> outputFile , "SUCCESS: CREATED " );
+	PrintPCB ( sim , OSSimFindProcess ( sim , newProcessID ) );
+	ChangeTextColorToDefault ( sim );
+}
 
-		return;
-	}
+int CreateCommand ( OS_SIM *sim , int priorityLevel , int groupID ) 
+{
+	int newProcessID = 0;
+	int status = OSSimCreateProcessInGroup ( sim , priorityLevel , groupID , &newProcessID );
+	PrintCreatedProcess ( sim , status , newProcessID );
 
-	MESSAGE *message = CreateMessage ( runningProcess -> processID , recipientProcessID , messageStr );
-	ChangeTextColorToSuccess ();
-	printf ( 
-		"SUCCESS: Process (ID = %d) Sent Message \"%s\" to Process (ID = %d)\n\n" ,
-		message -> senderProcessID ,
-		message -> messageStr ,
-		message -> recipientProcessID
-	);
-	ChangeTextColorToDefault ();
+	return status;
+}
 
-	int unblockedAProcess = UnblockReceiveBlockedProcess ( message );
-	if ( !unblockedAProcess ) 
-	{
-		AddToMessagesQueue ( message );
-	}
+int DeadlineCreateCommand ( OS_SIM *sim , int period , int relativeDeadline , int budget ) 
+{
+	int newProcessID = 0;
+	int status = OSSimCreateRealTimeProcess ( sim , period , relativeDeadline , budget , &newProcessID );
+	PrintCreatedProcess ( sim , status , newProcessID );
+
+	return status;
+}
 
-	if ( runningProcess -> processID != INIT_PROCESS_ID ) 
+int ForkCommand ( OS_SIM *sim ) 
+{
+	int parentProcessID = sim -> currentCPU -> runningProcess -> processID;
+	int newProcessID = 0;
+	int status = OSSimFork ( sim , &newProcessID );
+	if ( status == OSSIM_INIT_PROCESS_NOT_ALLOWED ) 
 	{
-		SendBlockRunningProcess ();
+		PrintError ( sim , "ERROR: Cannot FORK INIT PROCESS (ID = %d)\n\n" , parentProcessID );
+		return status;
 	}
-	else if ( runningProcess -> processID == INIT_PROCESS_ID ) 
+	else if ( status != OSSIM_SUCCESS ) 
 	{
-		RunNextProcess ();
+		PrintStatusError ( sim , status );
+		return status;
 	}
+
+	ChangeTextColorToSuccess ( sim );
+	fprintf ( sim -> outputFile , "SUCCESS: FORKED RUNNING " );
+	PrintPCB ( sim , OSSimFindProcess ( sim , parentProcessID ) );
+	fprintf ( sim -> outputFile , " |\n" );
+	fprintf ( sim -> outputFile , " --> " );
+	PrintPCB ( sim , OSSimFindProcess ( sim , newProcessID ) );
+	ChangeTextColorToDefault ( sim );
+
+	return status;
 }
 
-void ReplyMessage ( int recipientProcessID , char *messageStr ) 
+void PrintEndedProcess ( OS_SIM *sim , int status , int processID , const char *commandAction , const PCB *endedProcess ) 
 {
-	if ( recipientProcessID == runningProcess -> processID ) 
+	if ( status == OSSIM_INIT_PROCESS_BUSY ) 
 	{
-		ChangeTextColorToError ();
-		printf ( "ERROR: Process (ID = %d) cannot send message to self\n\n" , recipientProcessID );
-		ChangeTextColorToDefault ();
-
+		PrintError ( sim , 
+			"ERROR: Not %s INIT PROCESS (ID = %d), there are still %d other processes in the system\n\n" ,
+			commandAction ,
+			INIT_PROCESS_ID ,
+			NumSystemProcessesTotal ( sim ) - 1
+		);
 		return;
 	}
-
-	int sendBlockedRecipientProcessExists = ProcessExistsInQueue ( recipientProcessID , sendBlockedQueue );
-	if ( !sendBlockedRecipientProcessExists ) 
+	else if ( status == OSSIM_NO_SUCH_PROCESS ) 
 	{
-		ChangeTextColorToError ();
-		printf ("ERROR: No SEND-BLOCKED Recipient Process with ID = %d\n\n" , recipientProcessID );
-		ChangeTextColorToDefault ();
-
+		PrintError ( sim , "ERROR: No Process with ID = %d exists\n\n" , processID );
+		return;
+	}
+	else if ( status != OSSIM_SUCCESS ) 
+	{
+		PrintStatusError ( sim , status );
 		return;
 	}
 
-	MESSAGE *repliedMessage = CreateMessage ( runningProcess -> processID , recipientProcessID , messageStr );
-	
-	ChangeTextColorToSuccess ();
-	printf ( 
-		"SUCCESS: Process (ID = %d) Sent a Reply Message \"%s\" to Process (ID = %d)\n\n" ,
-		repliedMessage -> senderProcessID ,
-		repliedMessage -> messageStr ,
-		repliedMessage -> recipientProcessID
-	);
-	ChangeTextColorToDefault ();
+	if ( endedProcess -> processID == INIT_PROCESS_ID ) 
+	{
+		PrintSuccess ( sim , "SUCCESS: %s INIT PROCESS (ID = %d)\n\n" , commandAction , INIT_PROCESS_ID );
+		return;
+	}
 
-	int unblockedAProcess = UnblockSendBlockedProcess ( repliedMessage );
-	if ( !unblockedAProcess ) 
+	char *processStateText = "";
+	if ( endedProcess -> processState == RUNNING ) 
 	{
-		AddToMessagesQueue ( repliedMessage );
+		processStateText = "RUNNING";
+	}
+	else if ( endedProcess -> processState == READY )
+	{
+		processStateText = "READY";
 	}
 
-	if ( runningProcess -> processID == INIT_PROCESS_ID ) 
+	// a kill always ends with KILLED_EXIT_STATUS, so only a status EXIT was given is worth showing
+	char exitStatusStr [ 32 ] = "";
+	if ( endedProcess -> exitStatus != 0 && endedProcess -> exitStatus != KILLED_EXIT_STATUS ) 
 	{
-		RunNextProcess ();
+		snprintf ( exitStatusStr , sizeof ( exitStatusStr ) , " (EXIT STATUS = %d)" , endedProcess -> exitStatus );
 	}
+
+	PrintSuccess ( sim , 
+		"SUCCESS: %s PROCESS (ID = %d) (State = %s)%s\n\n" ,
+		commandAction , 
+		endedProcess -> processID , 
+		processStateText ,
+		exitStatusStr
+	);
+
+	PrintRealTimeSummary ( sim , endedProcess );
 }
 
-int ValidSemID ( int semaphoreID ) 
+int KillCommand ( OS_SIM *sim , int processID ) 
 {
-	if ( semaphoreID < 0 || semaphoreID >= NUM_SEMAPHORES ) 
-	{
-		ChangeTextColorToError ();
-		printf ( "ERROR: Invalid Semaphore ID (VALID IDs = 0-%d)\n\n" , NUM_SEMAPHORES - 1 );
-		ChangeTextColorToDefault ();
+	PCB endedProcess;
+	int status = OSSimKill ( sim , processID , &endedProcess );
+	PrintEndedProcess ( sim , status , processID , "KILLING" , &endedProcess );
 
-		return 0;
-	}
+	return status;
+}
+
+int ExitCommand ( OS_SIM *sim , int exitStatus ) 
+{
+	int processID = sim -> currentCPU -> runningProcess -> processID;
+	PCB endedProcess;
+	int status = OSSimExitWithStatus ( sim , exitStatus , &endedProcess );
+	PrintEndedProcess ( sim , status , processID , "EXITING" , &endedProcess );
 
-	return 1;
+	return status;
 }
 
-int CreatedSem ( int semaphoreID ) 
+int WaitCommand ( OS_SIM *sim ) 
 {
-	if ( !ValidSemID ( semaphoreID ) ) 
+	int processID = sim -> currentCPU -> runningProcess -> processID;
+	int childProcessID = 0;
+	int exitStatus = 0;
+	int status = OSSimWait ( sim , &childProcessID , &exitStatus );
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		PrintSuccess ( sim , 
+			"SUCCESS: PROCESS (ID = %d) REAPED CHILD PROCESS (ID = %d) (EXIT STATUS = %d)\n\n" , 
+			processID , 
+			childProcessID , 
+			exitStatus 
+		);
+	}
+	else if ( status == OSSIM_NO_EXITED_CHILD ) 
 	{
-		return 0;
+		PrintSuccess ( sim , "SUCCESS: No child of PROCESS (ID = %d) has exited yet\n\n" , processID );
 	}
-
-	SEMAPHORE *semaphore = &semaphores [ semaphoreID ];
-	if ( semaphore -> semStatus == NOT_CREATED ) 
+	else if ( status == OSSIM_INIT_PROCESS_NOT_ALLOWED ) 
+	{
+		PrintError ( sim , "ERROR: INIT PROCESS (ID = %d) cannot WAIT, it reaps its children as they end\n\n" , INIT_PROCESS_ID );
+	}
+	else if ( status == OSSIM_NO_CHILDREN ) 
+	{
+		PrintError ( sim , "ERROR: PROCESS (ID = %d) has no child processes to WAIT for\n\n" , processID );
+	}
+	else 
 	{
-		return 0;
+		PrintStatusError ( sim , status );
 	}
 
-	return 1;
+	return status;
 }
 
-void SemaphoreV ( int semaphoreID ) 
+int KillTreeCommand ( OS_SIM *sim , int processID ) 
 {
-	if ( !CreatedSem ( semaphoreID ) ) 
+	int numKilled = 0;
+	int status = OSSimKillTree ( sim , processID , &numKilled );
+	if ( status == OSSIM_SUCCESS ) 
 	{
-		ChangeTextColorToError ();
-		printf ( "ERROR: Semaphore (ID = %d) has not been created\n\n" , semaphoreID );
-		ChangeTextColorToDefault ();
-
-		return;
+		PrintSuccess ( sim , "SUCCESS: KILLED PROCESS TREE (ROOT ID = %d) (%d PROCESSES)\n\n" , processID , numKilled );
 	}
-
-	SEMAPHORE *semaphore = &semaphores [ semaphoreID ];
-	semaphore -> semValue += 1;
-
-	ChangeTextColorToSuccess ();
-	printf ( 
-		"SUCCESS: V operation on Semaphore (ID = %d) (%d -> %d)\n\n" , 
-		semaphoreID ,
-		semaphore -> semValue - 1,
-		semaphore -> semValue
-	);
-	ChangeTextColorToDefault ();
-
-	if ( semaphore -> semValue <= 0 && ListCount ( semaphore -> blockedPCBs ) > 0 ) 
+	else if ( status == OSSIM_INIT_PROCESS_NOT_ALLOWED ) 
 	{
-		PCB *blockedProcess = ListTrim ( semaphore -> blockedPCBs );
-		AddToReadyQueue ( blockedProcess );
-
-		ChangeTextColorToOS ();
-		printf ( "OS: PROCESS (ID = %d) SEM-UNBLOCKED\n\n" , blockedProcess -> processID );
-		ChangeTextColorToDefault ();
+		PrintError ( sim , "ERROR: Cannot KILL the tree of INIT PROCESS (ID = %d)\n\n" , INIT_PROCESS_ID );
 	}
-
-	if ( runningProcess -> processID == INIT_PROCESS_ID ) 
+	else if ( status == OSSIM_NO_SUCH_PROCESS ) 
+	{
+		PrintError ( sim , "ERROR: No Process with ID = %d exists\n\n" , processID );
+	}
+	else 
 	{
-		RunNextProcess ();
+		PrintStatusError ( sim , status );
 	}
+
+	return status;
 }
 
-void SemaphoreP ( int semaphoreID ) 
+/* writes the page of the running process when data is given, reads it otherwise */
+int MemoryCommand ( OS_SIM *sim , int page , const char *data ) 
 {
-	if ( !CreatedSem ( semaphoreID ) ) 
+	int processID = sim -> currentCPU -> runningProcess -> processID;
+	char pageData [ MEMORY_PAGE_SIZE ];
+	int copiedOnWrite = 0;
+	int status = data ? OSSimWriteMemory ( sim , page , data , &copiedOnWrite ) : OSSimReadMemory ( sim , page , pageData );
+	if ( status == OSSIM_INIT_PROCESS_NOT_ALLOWED ) 
 	{
-		ChangeTextColorToError ();
-		printf ( "ERROR: Semaphore (ID = %d) has not been created\n\n" , semaphoreID );
-		ChangeTextColorToDefault ();
-
-		return;
+		PrintError ( sim , "ERROR: INIT PROCESS (ID = %d) has no memory of its own\n\n" , INIT_PROCESS_ID );
+		return status;
 	}
-
-	SEMAPHORE *semaphore = &semaphores [ semaphoreID ];
-	semaphore -> semValue -= 1;
-
-	ChangeTextColorToSuccess ();
-	printf ( 
-		"SUCCESS: P operation on Semaphore (ID = %d) (%d -> %d)\n\n" , 
-		semaphoreID ,
-		semaphore -> semValue + 1,
-		semaphore -> semValue
-	);
-	ChangeTextColorToDefault ();
-
-	if ( runningProcess -> processID != INIT_PROCESS_ID && semaphore -> semValue < 0 ) 
+	else if ( status != OSSIM_SUCCESS ) 
 	{
-		ChangeTextColorToOS ();
-		printf ( "OS: PROCESS (ID = %d) has been SEM-BLOCKED\n\n" , runningProcess -> processID );
-		ChangeTextColorToDefault ();
+		PrintStatusError ( sim , status );
+		return status;
+	}
 
-		ListPrepend ( semaphore -> blockedPCBs , runningProcess );
-		runningProcess -> processState = SEM_BLOCKED;
-		
-		runningProcess = NULL;
-		RunNextProcess ();
+	if ( data ) 
+	{
+		OSSimReadMemory ( sim , page , pageData );
+		PrintSuccess ( sim , 
+			"SUCCESS: Process (ID = %d) Wrote \"%s\" to PAGE %d%s\n\n" , 
+			processID , 
+			pageData , 
+			page , 
+			copiedOnWrite ? " (COPY-ON-WRITE FAULT)" : "" 
+		);
+	}
+	else if ( pageData [ 0 ] == '\0' ) 
+	{
+		PrintSuccess ( sim , "SUCCESS: PAGE %d of Process (ID = %d) is EMPTY\n\n" , page , processID );
+	}
+	else 
+	{
+		PrintSuccess ( sim , "SUCCESS: PAGE %d of Process (ID = %d) holds \"%s\"\n\n" , page , processID , pageData );
 	}
+
+	return status;
 }
 
-void NewSemaphore ( int semaphoreID , int initSemValue ) 
+int SendCommand ( OS_SIM *sim , int recipientProcessID , const char *messageStr ) 
 {
-	if ( !ValidSemID ( semaphoreID ) ) 
+	MESSAGE sentMessage;
+	int status = OSSimSend ( sim , recipientProcessID , messageStr , &sentMessage );
+	if ( status == OSSIM_SEND_TO_SELF ) 
 	{
-		return;
+		PrintError ( sim , "ERROR: Process (ID = %d) cannot send message to self\n\n" , recipientProcessID );
+		return status;
 	}
-
-	if ( initSemValue < 0 ) 
+	else if ( status == OSSIM_NO_SUCH_PROCESS ) 
 	{
-		ChangeTextColorToError ();
-		printf ( "ERROR: Invalid Semaphore Value (%d < 0)\n\n" , initSemValue );
-		ChangeTextColorToDefault ();
-
-		return;
+		PrintError ( sim , "ERROR: Recipient Process (ID = %d) does not exist in system\n\n" , recipientProcessID );
+		return status;
 	}
-
-	if ( CreatedSem ( semaphoreID ) ) 
+	else if ( status != OSSIM_SUCCESS ) 
 	{
-		ChangeTextColorToError ();
-		printf ( "ERROR: Semaphore (ID = %d) has already been created\n\n" , semaphoreID );
-		ChangeTextColorToDefault ();
-
-		return;
+		PrintStatusError ( sim , status );
+		return status;
 	}
 
-	SEMAPHORE *semaphore = &semaphores [ semaphoreID ];
-	semaphore -> semStatus = CREATED;
-	semaphore -> semValue = initSemValue;
-	semaphore -> blockedPCBs = ListCreate ();
+	PrintSuccess ( sim , 
+		"SUCCESS: Process (ID = %d) Sent Message \"%s\" to Process (ID = %d)\n\n" ,
+		sentMessage.senderProcessID ,
+		sentMessage.messageStr ,
+		sentMessage.recipientProcessID
+	);
 
-	ChangeTextColorToSuccess ();
-	printf ( "SUCCESS: Semaphore (ID = %d) (value = %d) CREATED\n\n" , semaphoreID , initSemValue );
-	ChangeTextColorToDefault ();
+	return status;
 }
 
-void StrToUpper ( char *str ) 
+int ReceiveCommand ( OS_SIM *sim ) 
 {
-	if ( !str ) 
+	int processID = sim -> currentCPU -> runningProcess -> processID;
+	MESSAGE receivedMessage;
+	int status = OSSimReceive ( sim , &receivedMessage );
+	if ( status == OSSIM_SUCCESS ) 
 	{
-		return;
+		PrintSuccess ( sim , 
+			"SUCCESS: Received message (SenderID = %d, recipientProcessID = %d) - \"%s\"\n\n",
+			receivedMessage.senderProcessID,
+			receivedMessage.recipientProcessID,
+			receivedMessage.messageStr
+		);
 	}
-
-	for ( int i = 0 ; i < strlen ( str ) ; i++ ) 
+	else if ( status == OSSIM_NO_MESSAGE && processID == INIT_PROCESS_ID ) 
 	{
-		str [ i ] = toupper ( str [ i ] );
+		PrintSuccess ( sim , "SUCCESS: No messages sent to INIT PROCESS (ID = %d)\n\n" , INIT_PROCESS_ID );
+	}
+	else if ( status == OSSIM_NO_MESSAGE ) 
+	{
+		PrintSuccess ( sim , "SUCCESS: No messages sent to PROCESS (ID = %d)\n\n" , processID );
+	}
+	else 
+	{
+		PrintStatusError ( sim , status );
 	}
+
+	return status;
 }
 
-void ProcInfo ( int processID ) 
+int ReplyCommand ( OS_SIM *sim , int recipientProcessID , const char *messageStr ) 
 {
-	PCB *foundProcess = NULL;
-
-	if ( processID == INIT_PROCESS_ID ) 
+	MESSAGE repliedMessage;
+	int status = OSSimReply ( sim , recipientProcessID , messageStr , &repliedMessage );
+	if ( status == OSSIM_SEND_TO_SELF ) 
 	{
-		foundProcess = &INIT_PROCESS;
+		PrintError ( sim , "ERROR: Process (ID = %d) cannot send message to self\n\n" , recipientProcessID );
+		return status;
 	}
-
-	if ( processID == runningProcess -> processID ) 
+	else if ( status == OSSIM_NOT_SEND_BLOCKED ) 
 	{
-		foundProcess = runningProcess;
+		PrintError ( sim , "ERROR: No SEND-BLOCKED Recipient Process with ID = %d\n\n" , recipientProcessID );
+		return status;
 	}
-
-	if ( !foundProcess ) 
+	else if ( status != OSSIM_SUCCESS ) 
 	{
-		foundProcess = FindProcessFromAllQueues ( processID );
+		PrintStatusError ( sim , status );
+		return status;
 	}
-	
-	if ( !foundProcess ) 
-	{
-		ChangeTextColorToError ();
-		printf ( "ERROR: PROCESS (ID = %d) does not exist in system\n\n" , processID );
-		ChangeTextColorToDefault ();
 
-		return;
-	}
-
-	char* processStateStr;
-	switch ( foundProcess -> processState ) 
-	{
-		case SEND_BLOCKED :
-			processStateStr = "SEND-BLOCKED";
-			break;
-
-		case RECEIVE_BLOCKED :
-			processStateStr = "RECEIVE-BLOCKED";
-			break;
-
-		case SEM_BLOCKED :
-			processStateStr = "SEMAPHORE-BLOCKED";
-			break;
-
-		case READY :
-			processStateStr = "READY";
-			break;
+	PrintSuccess ( sim , 
+		"SUCCESS: Process (ID = %d) Sent a Reply Message \"%s\" to Process (ID = %d)\n\n" ,
+		repliedMessage.senderProcessID ,
+		repliedMessage.messageStr ,
+		repliedMessage.recipientProcessID
+	);
 
-		case RUNNING :
-			processStateStr = "RUNNING";
-			break;
+	return status;
+}
 
-		default: 
-			processStateStr = "ERROR";
+int NewSemaphoreCommand ( OS_SIM *sim , int semaphoreID , int initSemValue ) 
+{
+	int status = OSSimNewSemaphore ( sim , semaphoreID , initSemValue );
+	if ( status == OSSIM_INVALID_SEMAPHORE_VALUE ) 
+	{
+		PrintError ( sim , "ERROR: Invalid Semaphore Value (%d < 0)\n\n" , initSemValue );
 	}
-
-	if ( foundProcess -> processID == INIT_PROCESS_ID )
+	else if ( status == OSSIM_SEMAPHORE_EXISTS ) 
 	{
-		ChangeTextColorToSuccess ();
-		printf ( 
-			"SUCCESS: INIT PROCESS (ID = %d) (STATE = %s) (PRIORITY LEVEL = %d)\n\n" ,
-			foundProcess -> processID , 
-			processStateStr ,
-			foundProcess -> priorityLevel 
-		);
-		ChangeTextColorToDefault ();
+		PrintError ( sim , "ERROR: Semaphore (ID = %d) has already been created\n\n" , semaphoreID );
+	}
+	else if ( status != OSSIM_SUCCESS ) 
+	{
+		PrintStatusError ( sim , status );
 	}
 	else 
 	{
-		ChangeTextColorToSuccess ();
-		printf ( 
-			"SUCCESS: PROCESS (ID = %d) (STATE = %s) (PRIORITY LEVEL = %d)\n\n" ,
-			foundProcess -> processID , 
-			processStateStr ,
-			foundProcess -> priorityLevel 
-		);
-		ChangeTextColorToDefault ();
+		PrintSuccess ( sim , "SUCCESS: Semaphore (ID = %d) (value = %d) CREATED\n\n" , semaphoreID , initSemValue );
 	}
+
+	return status;
 }
 
-void ForkProcess () 
+int SemaphoreCommand ( OS_SIM *sim , int semaphoreID , char semOperation ) 
 {
-	if ( runningProcess -> processID == INIT_PROCESS_ID ) 
+	int semValue = 0;
+	int status = OSSIM_SUCCESS;
+	int prevSemValueOffset = 0;
+	if ( semOperation == 'P' ) 
 	{
-		ChangeTextColorToError ();
-		printf ( "ERROR: Cannot FORK INIT PROCESS (ID = %d)\n\n" , runningProcess -> processID );
-		ChangeTextColorToDefault ();
-
-		return;
+		status = OSSimSemaphoreP ( sim , semaphoreID , &semValue );
+		prevSemValueOffset = 1;
+	}
+	else 
+	{
+		status = OSSimSemaphoreV ( sim , semaphoreID , &semValue );
+		prevSemValueOffset = -1;
 	}
 
-	int priorityLevel = runningProcess -> priorityLevel;
-	PCB *newProcess = NewProcess ( priorityLevel );
-	if ( !newProcess ) 
+	if ( status == OSSIM_SEMAPHORE_NOT_CREATED ) 
 	{
-		return;
+		PrintError ( sim , "ERROR: Semaphore (ID = %d) has not been created\n\n" , semaphoreID );
+		return status;
+	}
+	else if ( status != OSSIM_SUCCESS ) 
+	{
+		PrintStatusError ( sim , status );
+		return status;
 	}
 
-	AddToReadyQueue ( newProcess );
+	PrintSuccess ( sim , 
+		"SUCCESS: %c operation on Semaphore (ID = %d) (%d -> %d)\n\n" , 
+		semOperation ,
+		semaphoreID ,
+		semValue + prevSemValueOffset ,
+		semValue
+	);
 
-	ChangeTextColorToSuccess ();
-	printf ( "SUCCESS: FORKED RUNNING " );
-	PrintPCB ( runningProcess );
-	printf ( " |\n" );
-	printf ( " --> " );
-	PrintPCB ( newProcess );
-	ChangeTextColorToDefault ();
+	return status;
 }
 
-int SearchPrintMessage ( void *item , void *messageListNumbering ) 
+int AffinityCommand ( OS_SIM *sim , int processID , unsigned int affinityMask ) 
 {
-	MESSAGE *message = ( MESSAGE *) item;
-
-	int *numbering = ( int *) messageListNumbering;
-	printf ( "\t%d. " , *numbering );
-
-	if ( message ) 
+	unsigned int validCPUsMask = ( 1u << sim -> numCPUs ) - 1;
+	int status = OSSimSetAffinity ( sim , processID , affinityMask );
+	if ( status == OSSIM_INVALID_AFFINITY ) 
+	{
+		PrintError ( sim , "ERROR: Affinity mask must allow at least one of CPUs 0-%d (VALID MASK BITS = 0x%X)\n\n" , sim -> numCPUs - 1 , validCPUsMask );
+	}
+	else if ( status == OSSIM_INIT_PROCESS_NOT_ALLOWED ) 
+	{
+		PrintError ( sim , "ERROR: Cannot set affinity of INIT PROCESS (ID = %d)\n\n" , INIT_PROCESS_ID );
+	}
+	else if ( status == OSSIM_NO_SUCH_PROCESS ) 
+	{
+		PrintError ( sim , "ERROR: PROCESS (ID = %d) does not exist in system\n\n" , processID );
+	}
+	else if ( status != OSSIM_SUCCESS ) 
 	{
-		PrintMessage ( message );
+		PrintStatusError ( sim , status );
 	}
 	else 
 	{
-		ChangeTextColorToError ();
-		printf ( "DEV-ERROR: Found NULL MESSAGE\n\n" );	
-		ChangeTextColorToDefault ();	
+		PrintSuccess ( sim , "SUCCESS: PROCESS (ID = %d) AFFINITY MASK = 0x%X\n\n" , processID , affinityMask & validCPUsMask );
 	}
 
-	*numbering += 1;
-	return 0;
+	return status;
 }
 
-int SearchPrintPCB ( void *item , void *pcbListNumbering ) 
+int GroupCommand ( OS_SIM *sim , char groupOperation , int groupID , int priorityLevel ) 
 {
-	PCB *pcb = ( PCB *) item;
-
-	int *numbering = ( int *) pcbListNumbering;
-	printf ( "\t%d. " , *numbering );
+	int numProcesses = 0;
+	int status = OSSIM_SUCCESS;
+	if ( groupOperation == 'K' ) 
+	{
+		status = OSSimKillGroup ( sim , groupID , &numProcesses );
+	}
+	else if ( groupOperation == 'P' ) 
+	{
+		status = OSSimSetGroupPriority ( sim , groupID , priorityLevel , &numProcesses );
+	}
+	else if ( groupOperation == 'Q' ) 
+	{
+		status = OSSimGroupQuantum ( sim , groupID , &numProcesses );
+	}
+	else 
+	{
+		PrintError ( sim , "ERROR: Group operation must be K (kill), P (set priority) or Q (quantum)\n\n" );
+		return OSSIM_INVALID_GROUP;
+	}
 
-	if ( pcb ) 
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		PrintStatusError ( sim , status );
+	}
+	else if ( groupOperation == 'K' ) 
 	{
-		PrintPCB ( pcb );
+		PrintSuccess ( sim , "SUCCESS: KILLED PROCESS GROUP %d (%d PROCESSES)\n\n" , groupID , numProcesses );
+	}
+	else if ( groupOperation == 'P' ) 
+	{
+		PrintSuccess ( sim , "SUCCESS: PROCESS GROUP %d PRIORITY LEVEL = %d (%d PROCESSES)\n\n" , groupID , priorityLevel , numProcesses );
 	}
 	else 
 	{
-		ChangeTextColorToError ();
-		printf ( "DEV-ERROR: Found NULL PCB\n\n" );	
-		ChangeTextColorToDefault ();	
+		PrintSuccess ( sim , "SUCCESS: PRE-EMPTED PROCESS GROUP %d (%d RUNNING PROCESSES)\n\n" , groupID , numProcesses );
 	}
 
-	*numbering += 1;
-	return 0;
+	return status;
 }
 
-void PrintSemaphore ( const SEMAPHORE *semaphore ) 
+int SaveSnapshotCommand ( OS_SIM *sim , const char *path ) 
 {
-	if ( !semaphore ) 
+	if ( !path || !*path ) 
 	{
-		return;
+		PrintError ( sim , "ERROR: A snapshot file name is required\n\n" );
+		return OSSIM_SNAPSHOT_IO_ERROR;
 	}
 
-	printf ( "\tSemaphore (ID = %d), Status: " , semaphore -> semID );
-	if ( semaphore -> semStatus == NOT_CREATED ) 
+	int status = OSSimSaveSnapshot ( sim , path );
+	if ( status != OSSIM_SUCCESS ) 
 	{
-		printf ( "NOT CREATED\n" );
-		return;
+		PrintStatusError ( sim , status );
+		return status;
 	}
 
-	printf ( 
-		"CREATED - Value = %d\n" , 
-		semaphore -> semValue
+	PrintSuccess ( sim , "SUCCESS: Saved snapshot \"%s\" (%d PROCESSES, TICK %d)\n\n" , path , NumSystemProcessesTotal ( sim ) , sim -> currentTick );
+
+	return status;
+}
+
+int LoadSnapshotCommand ( OS_SIM *sim , const char *path ) 
+{
+	if ( !path || !*path ) 
+	{
+		PrintError ( sim , "ERROR: A snapshot file name is required\n\n" );
+		return OSSIM_SNAPSHOT_IO_ERROR;
+	}
+
+	int status = OSSimRestoreSnapshot ( sim , path );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		PrintStatusError ( sim , status ); // the current state is kept
+		return status;
+	}
+
+	PrintSuccess ( sim , 
+		"SUCCESS: Restored snapshot \"%s\" (%d PROCESSES, TICK %d, %d CPUs)\n\n" , 
+		path , 
+		NumSystemProcessesTotal ( sim ) , 
+		sim -> currentTick , 
+		sim -> numCPUs 
 	);
+	PrintCurrentRunningProcess ( sim , sim -> currentCPU );
 
-	if ( ListCount ( semaphore -> blockedPCBs ) == 0 ) 
+	return status;
+}
+
+int UseCPUCommand ( OS_SIM *sim , int cpuID ) 
+{
+	int status = OSSimUseCPU ( sim , cpuID );
+	if ( status == OSSIM_INVALID_CPU ) 
 	{
-		printf ( "\tNo processes SEM-BLOCKED\n\n" );
+		PrintError ( sim , "ERROR: Invalid CPU ID (VALID IDs = 0-%d)\n\n" , sim -> numCPUs - 1 );
 	}
-	else
+	else if ( status != OSSIM_SUCCESS ) 
 	{
-		printf ( 
-			"\tProcesses SEM-BLOCKED: %d\n" , 
-			ListCount ( semaphore -> blockedPCBs ) 
-		);
+		PrintStatusError ( sim , status );
+	}
+	else 
+	{
+		PrintSuccess ( sim , "SUCCESS: Commands are now issued on CPU %d\n\n" , cpuID );
+		PrintCurrentRunningProcess ( sim , sim -> currentCPU );
+	}
 
-		int pcbListNumbering = 1;
-		ListFirst ( semaphore -> blockedPCBs );
-		ListSearch ( semaphore -> blockedPCBs , &SearchPrintPCB , &pcbListNumbering );
+	return status;
+}
+
+/* COMMAND LATENCY - every command is timed, bucketed by how many processes were in the system when it ran */
+const char *LOAD_BAND_NAMES [ NUM_LOAD_BANDS ] = { "1-3" , "4-15" , "16-63" , "64-255" , "256-1023" , "1024+" };
+
+typedef struct commandStats 
+{
+	HISTOGRAM latency; // ns
+	unsigned long bandTotalNs [ NUM_LOAD_BANDS ];
+	unsigned long bandCount [ NUM_LOAD_BANDS ];
+} COMMAND_STATS;
+
+int LoadBand ( int numProcesses ) 
+{
+	int band = 0;
+	while ( band < NUM_LOAD_BANDS - 1 && numProcesses >= ( 4 << ( 2 * band ) ) ) 
+	{
+		band += 1;
 	}
+
+	return band;
 }
 
-void DisplayTotalSystemInfo () 
+unsigned long ElapsedNs ( const struct timespec *startTime ) 
 {
-	printf ( "\n-------------- TOTAL SYSTEM INFO --------------\n" );
+	struct timespec endTime;
+	clock_gettime ( CLOCK_MONOTONIC , &endTime );
 
-	ChangeTextColorToOS ();
-	printf ( "OS: Number of Processes in System = %d\n\n" , NumSystemProcessesTotal () );
-	printf ( "OS: Currently Running Process\n\t" );
-	ChangeTextColorToDefault ();
+	return ( endTime.tv_sec - startTime -> tv_sec ) * 1000000000L + ( endTime.tv_nsec - startTime -> tv_nsec );
+}
 
-	PrintPCB ( runningProcess );
+void RecordCommandLatency ( COMMAND_STATS *stats , unsigned long latencyNs , int numProcesses ) 
+{
+	int band = LoadBand ( numProcesses );
 
-	for ( int i = 0 ; i < NUM_PRIORITY_LEVELS ; i++ ) 
-	{
-		ChangeTextColorToOS ();
-		printf ( "OS: Ready Queue (Priority Level = %d) - Process List\n" , i );
-		ChangeTextColorToDefault ();
+	HistogramRecord ( &stats -> latency , latencyNs );
+	stats -> bandTotalNs [ band ] += latencyNs;
+	stats -> bandCount [ band ] += 1;
+}
 
-		LIST *readyQueue = readyPriorityQueues [ i ];
+void DisplayCommandStats ( OS_SIM *sim , const COMMAND_STATS *commandStats ) 
+{
+	fprintf ( sim -> outputFile , "\n-------------- COMMAND LATENCY --------------\n" );
 
-		if ( ListCount ( readyQueue ) == 0 ) 
+	ChangeTextColorToOS ( sim );
+	int numTimedCommands = 0;
+	for ( int i = 0 ; i < NUM_COMMAND_LETTERS ; i++ ) 
+	{
+		const HISTOGRAM *latency = &commandStats [ i ].latency;
+		if ( latency -> count == 0 ) 
 		{
-			printf ( "\tEMPTY - No Processes In Queue\n\n" );
+			continue;
 		}
-		else 
-		{
-			printf ( 
-				"\tCOUNT - %d (LAST TO RUN -> 1 ... %d -> NEXT TO RUN\n\n" ,
-				ListCount ( readyQueue ) ,
-				ListCount ( readyQueue )
-			);
 
-			int pcbListNumbering = 1;
-			ListFirst ( readyQueue );
-			ListSearch ( readyQueue , &SearchPrintPCB , &pcbListNumbering );			
+		numTimedCommands += 1;
+		fprintf ( sim -> outputFile , 
+			"OS: %c - CALLS = %lu, MIN = %lu ns, MEAN = %.0f ns, P50 <= %lu ns, P90 <= %lu ns, P99 <= %lu ns, MAX = %lu ns\n" ,
+			'A' + i ,
+			latency -> count ,
+			latency -> min ,
+			HistogramMean ( latency ) ,
+			HistogramPercentile ( latency , 50.0 ) ,
+			HistogramPercentile ( latency , 90.0 ) ,
+			HistogramPercentile ( latency , 99.0 ) ,
+			latency -> max
+		);
+
+		fprintf ( sim -> outputFile , "    MEAN BY PROCESSES IN SYSTEM -" );
+		for ( int band = 0 ; band < NUM_LOAD_BANDS ; band++ ) 
+		{
+			if ( commandStats [ i ].bandCount [ band ] > 0 ) 
+			{
+				fprintf ( sim -> outputFile , 
+					" %s = %lu ns (%lu CALLS)" , 
+					LOAD_BAND_NAMES [ band ] , 
+					commandStats [ i ].bandTotalNs [ band ] / commandStats [ i ].bandCount [ band ] , 
+					commandStats [ i ].bandCount [ band ] 
+				);
+			}
 		}
+		fprintf ( sim -> outputFile , "\n\n" );
 	}
 
-	ChangeTextColorToOS ();
-	printf ( "OS: SEND-BLOCKED Queue - Process List\n" );
-	ChangeTextColorToDefault ();
-
-	if ( ListCount ( sendBlockedQueue ) == 0 ) 
+	if ( numTimedCommands == 0 ) 
 	{
-		printf ( "\tEMPTY - No Processes SEND-BLOCKED\n\n" );
+		fprintf ( sim -> outputFile , "OS: No commands have run yet\n\n" );
 	}
-	else 
-	{
-		printf ( 
-			"\tCOUNT - %d\n\n" , 
-			ListCount ( sendBlockedQueue ) 
-		);
+	ChangeTextColorToDefault ( sim );
+}
 
-		int pcbListNumbering = 1;
-		ListFirst ( sendBlockedQueue );
-		ListSearch ( sendBlockedQueue , &SearchPrintPCB , &pcbListNumbering );
-	}
+/* PARAMETER SWEEP */
+const char SWEEP_KEY_DELIMITER [] = ";";
+const char SWEEP_VALUE_DELIMITER [] = ",";
+const char *AGING_POLICY_NAMES [] = { "bounce" , "demote" , "none" };
+
+typedef struct sweepAxis 
+{
+	int values [ MAX_SWEEP_VALUES ];
+	int numValues;
+} SWEEP_AXIS;
 
-	ChangeTextColorToOS ();
-	printf ( "OS: RECEIVE-BLOCKED Queue - Process List\n" );
-	ChangeTextColorToDefault ();
+typedef struct sweepRun 
+{
+	/* PARAMETERS - filled in before the run */
+	unsigned int seed;
+	int numCPUs;
+	int numPriorityLevels;
+	int maxCPUBursts;
+	enum AGING_POLICY agingPolicy;
+	int numOps;
+
+	/* RESULTS - filled in by the worker */
+	int completed;
+	int numTicks;
+	int numProcessesCreated;
+	int numProcessesAlive;
+	int numContextSwitches;
+	int numMigrations;
+	int numCrossNodeMigrations;
+	int numPromotions;
+	int numDemotions;
+	int numDeadlineMisses;
+	double meanReadyWaitTicks;
+	int maxReadyWaitTicks;
+	double elapsedMs;
+} SWEEP_RUN;
+
+typedef struct sweepPool 
+{
+	SWEEP_RUN *runs;
+	int numRuns;
+	int nextRun; // next run a worker thread picks up
+	pthread_mutex_t lock;
+} SWEEP_POOL;
 
-	if ( ListCount ( receiveBlockedQueue ) == 0 ) 
+int ParseLogPolicy ( const char *policyName ) 
+{
+	for ( int i = LOG_BLOCK ; i <= LOG_SYNC ; i++ ) 
 	{
-		printf ( "\tEMPTY - No Processes RECEIVE-BLOCKED\n\n" );
+		if ( policyName && strcasecmp ( policyName , LOG_POLICY_NAMES [ i ] ) == 0 ) 
+		{
+			return i;
+		}
 	}
-	else 
-	{
-		printf ( 
-			"\tCOUNT - %d\n\n" , 
-			ListCount ( receiveBlockedQueue ) 
-		);
 
-		int pcbListNumbering = 1;
-		ListFirst ( receiveBlockedQueue );
-		ListSearch ( receiveBlockedQueue , &SearchPrintPCB , &pcbListNumbering );
+	return -1;
+}
+
+int ParseAgingPolicy ( const char *policyName ) 
+{
+	for ( int i = BOUNCE_AGING ; i <= NO_AGING ; i++ ) 
+	{
+		if ( policyName && strcasecmp ( policyName , AGING_POLICY_NAMES [ i ] ) == 0 ) 
+		{
+			return i;
+		}
 	}
 
-	ChangeTextColorToOS ();
-	printf ( "OS: MESSAGES Queue - Messages List\n" );
-	ChangeTextColorToDefault ();
+	return -1;
+}
+
+double ElapsedMs ( const struct timespec *startTime ) 
+{
+	struct timespec endTime;
+	clock_gettime ( CLOCK_MONOTONIC , &endTime );
+
+	return ( endTime.tv_sec - startTime -> tv_sec ) * 1000.0 + 
+		( endTime.tv_nsec - startTime -> tv_nsec ) / 1000000.0;
+}
+
+void RunSweepPoint ( SWEEP_RUN *run ) 
+{
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
 
-	if ( ListCount ( messagesQueue ) == 0 ) 
+	OS_SIM *sim = OSSimCreate ();
+	if ( !sim ) 
 	{
-		printf ( "\tEMPTY - No Messages Waiting\n\n" );
+		return;
 	}
-	else
-	{
-		printf ( 
-			"\tCOUNT - %d\n\n" , 
-			ListCount ( messagesQueue ) 
-		);
 
-		int messagesListNumbering = 1;
-		ListFirst ( messagesQueue );
-		ListSearch ( messagesQueue , &SearchPrintMessage , &messagesListNumbering );
+	sim -> numCPUs = run -> numCPUs;
+	sim -> numPriorityLevels = run -> numPriorityLevels;
+	sim -> maxCPUBursts = run -> maxCPUBursts;
+	sim -> agingPolicy = run -> agingPolicy;
+
+	if ( OSSimStart ( sim ) != OSSIM_SUCCESS ) 
+	{
+		OSSimFree ( sim );
+		return;
 	}
 
-	ChangeTextColorToOS ();
-	printf ( "OS: SEMAPHORES List\n" );
-	ChangeTextColorToDefault ();
+	RunRandomWorkload ( sim , run -> seed , run -> numOps );
 
-	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	run -> numTicks = sim -> currentTick;
+	run -> numProcessesCreated = sim -> nextAvailProcessID - INIT_PROCESS_ID - 1;
+	run -> numProcessesAlive = NumSystemProcessesTotal ( sim ) - 1;
+	run -> numContextSwitches = 0;
+	run -> numMigrations = 0;
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
 	{
-		SEMAPHORE *semaphore = &semaphores [ i ];
-		PrintSemaphore ( semaphore );
+		run -> numContextSwitches += sim -> cpus [ i ].numContextSwitches;
+		run -> numMigrations += sim -> cpus [ i ].numMigrationsIn;
 	}
 
-	printf ( "------------- END Of SYSTEM INFO -------------\n\n" );
+	run -> numCrossNodeMigrations = sim -> numMigrationsByDistance [ CROSS_NODE ];
+	run -> numPromotions = sim -> numPromotions;
+	run -> numDemotions = sim -> numDemotions;
+	run -> numDeadlineMisses = sim -> totalDeadlineMisses;
+	run -> meanReadyWaitTicks = MeanReadyWaitTicks ( sim );
+	run -> maxReadyWaitTicks = sim -> maxReadyWaitTicks;
+	OSSimFree ( sim );
+
+	run -> elapsedMs = ElapsedMs ( &startTime );
+	run -> completed = 1;
 }
 
-int main () 
+void *SweepWorker ( void *sweepPool ) 
 {
-	InitAllLists ();
+	SWEEP_POOL *pool = ( SWEEP_POOL *) sweepPool;
 
-	RunNextProcess ();
-
-	PrintInputPrompt ();
-
-	char inputBuffer [ MAX_INPUT_LENGTH ];
-	int inputLength = 0;
-	while ( runningProcess && ( inputLength = read ( STDIN_FILENO , inputBuffer , MAX_INPUT_LENGTH ) ) > 0 )
+	while ( 1 ) 
 	{
-		inputBuffer [ inputLength - 1 ] = '\0'; // replace new line char from end of user input with null-terminate char
-		if ( inputLength == 1 ) {
-			PrintInputPrompt ();
-			continue;
+		pthread_mutex_lock ( &pool -> lock );
+		int runIndex = pool -> nextRun;
+		pool -> nextRun += 1;
+		pthread_mutex_unlock ( &pool -> lock );
+
+		if ( runIndex >= pool -> numRuns ) 
+		{
+			return NULL;
 		}
 
-		char *remainderStr = inputBuffer;
+		RunSweepPoint ( &pool -> runs [ runIndex ] );
+	}
+}
 
-		char *command = strtok_r ( remainderStr , COMMAND_DELIMITER , &remainderStr );
-		StrToUpper ( command );
-		char *param1 = strtok_r ( remainderStr , COMMAND_DELIMITER , &remainderStr );
-		char *param2 = remainderStr;
+int ParseSweepAxis ( char *valuesStr , SWEEP_AXIS *axis , int isPolicyAxis ) 
+{
+	axis -> numValues = 0;
 
-		if ( EqualStr ( command , CREATE_COMMAND ) )
+	char *remainderStr = valuesStr;
+	char *valueStr = NULL;
+	while ( ( valueStr = strtok_r ( remainderStr , SWEEP_VALUE_DELIMITER , &remainderStr ) ) ) 
+	{
+		if ( axis -> numValues >= MAX_SWEEP_VALUES ) 
 		{
-			int priorityLevel = ParamToInt ( param1 );
-			CreateProcess ( priorityLevel );
+			return FAILURE_OP;
 		}
-		else if ( EqualStr ( command , FORK_COMMAND ) )
+
+		int value = isPolicyAxis ? ParseAgingPolicy ( valueStr ) : ParamToInt ( valueStr );
+		if ( value < 0 ) 
 		{
-			ForkProcess ();
+			return FAILURE_OP;
 		}
-		else if ( EqualStr ( command , KILL_COMMAND ) )
+
+		axis -> values [ axis -> numValues ] = value;
+		axis -> numValues += 1;
+	}
+
+	return axis -> numValues > 0 ? SUCCESS_OP : FAILURE_OP;
+}
+
+int ValidSweepAxes ( const SWEEP_AXIS *cpusAxis , const SWEEP_AXIS *levelsAxis , const SWEEP_AXIS *burstsAxis , int numSeeds ) 
+{
+	for ( int i = 0 ; i < cpusAxis -> numValues ; i++ ) 
+	{
+		if ( cpusAxis -> values [ i ] < 1 || cpusAxis -> values [ i ] > MAX_NUM_CPUS ) 
 		{
-			int processID = ParamToInt ( param1 );
-			EndProcess ( processID , "KILLING" );
+			return 0;
 		}
-		else if ( EqualStr ( command , EXIT_COMMAND ) )
-		{
-			int processID = runningProcess -> processID;
-			EndProcess ( processID , "EXITING" );
-		}	
-		else if ( EqualStr ( command , QUANTUM_COMMAND ) )
+	}
+
+	for ( int i = 0 ; i < levelsAxis -> numValues ; i++ ) 
+	{
+		if ( levelsAxis -> values [ i ] < 1 || levelsAxis -> values [ i ] > MAX_NUM_PRIORITY_LEVELS ) 
 		{
-			QuantumExpired ();
+			return 0;
 		}
-		else if ( EqualStr ( command , SEND_COMMAND ) )
+	}
+
+	for ( int i = 0 ; i < burstsAxis -> numValues ; i++ ) 
+	{
+		if ( burstsAxis -> values [ i ] < 1 ) 
 		{
-			int recipientProcessID = ParamToInt ( param1 );
-			char *messageStr = param2;
-			SendMessage ( recipientProcessID , messageStr );
-		}			
-		else if ( EqualStr ( command , RECEIVE_COMMAND ) )
+			return 0;
+		}
+	}
+
+	return numSeeds >= 1;
+}
+
+void WriteSweepResults ( FILE *resultsFile , const SWEEP_RUN *runs , int numRuns ) 
+{
+	fprintf ( 
+		resultsFile , 
+		"run\tseed\tcpus\tlevels\tbursts\tpolicy\tops\tticks\tcreated\talive\tcontext_switches\tmigrations\tcross_node_migrations\tpromotions\tdemotions\tdeadline_misses\tmean_ready_wait\tmax_ready_wait\telapsed_ms\n" 
+	);
+
+	for ( int i = 0 ; i < numRuns ; i++ ) 
+	{
+		const SWEEP_RUN *run = &runs [ i ];
+		if ( !run -> completed ) 
 		{
-			ReceiveMessage ();
+			fprintf ( resultsFile , "%d\t%u\t%d\t%d\t%d\t%s\tFAILED\n" , i , run -> seed , run -> numCPUs , run -> numPriorityLevels , run -> maxCPUBursts , AGING_POLICY_NAMES [ run -> agingPolicy ] );
+			continue;
 		}
-		else if ( EqualStr ( command , REPLY_COMMAND ) )
+
+		fprintf ( 
+			resultsFile , 
+			"%d\t%u\t%d\t%d\t%d\t%s\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%.3f\t%d\t%.3f\n" ,
+			i ,
+			run -> seed ,
+			run -> numCPUs ,
+			run -> numPriorityLevels ,
+			run -> maxCPUBursts ,
+			AGING_POLICY_NAMES [ run -> agingPolicy ] ,
+			run -> numOps ,
+			run -> numTicks ,
+			run -> numProcessesCreated ,
+			run -> numProcessesAlive ,
+			run -> numContextSwitches ,
+			run -> numMigrations ,
+			run -> numCrossNodeMigrations ,
+			run -> numPromotions ,
+			run -> numDemotions ,
+			run -> numDeadlineMisses ,
+			run -> meanReadyWaitTicks ,
+			run -> maxReadyWaitTicks ,
+			run -> elapsedMs
+		);
+	}
+}
+
+int RunSweep ( OS_SIM *sim , char *sweepSpec , int numWorkers , int numOps , const char *resultsPath ) 
+{
+	SWEEP_AXIS cpusAxis = { .values = { sim -> numCPUs } , .numValues = 1 };
+	SWEEP_AXIS levelsAxis = { .values = { sim -> numPriorityLevels } , .numValues = 1 };
+	SWEEP_AXIS burstsAxis = { .values = { sim -> maxCPUBursts } , .numValues = 1 };
+	SWEEP_AXIS policyAxis = { .values = { sim -> agingPolicy } , .numValues = 1 };
+	int numSeeds = 1;
+
+	char *remainderStr = sweepSpec;
+	char *keyValueStr = NULL;
+	while ( ( keyValueStr = strtok_r ( remainderStr , SWEEP_KEY_DELIMITER , &remainderStr ) ) ) 
+	{
+		char *valuesStr = strchr ( keyValueStr , '=' );
+		if ( !valuesStr ) 
 		{
-			int recipientProcessID = ParamToInt ( param1 );
-			char *messageStr = param2;
-			ReplyMessage ( recipientProcessID , messageStr );
+			fprintf ( stderr , "ERROR: Sweep entry \"%s\" is not of the form key=value,...\n" , keyValueStr );
+			return FAILURE_OP;
 		}
-		else if ( EqualStr ( command , NEW_SEMAPHORE_COMMAND ) )
+
+		*valuesStr = '\0';
+		valuesStr += 1;
+
+		int parsed = FAILURE_OP;
+		if ( strcasecmp ( keyValueStr , "cpus" ) == 0 ) 
 		{
-			int semaphoreID = ParamToInt ( param1 );
-			int initSemValue = ParamToInt ( param2 );
-			NewSemaphore ( semaphoreID , initSemValue );
-		}	
-		else if ( EqualStr ( command , SEMAPHORE_P_COMMAND ) )
+			parsed = ParseSweepAxis ( valuesStr , &cpusAxis , 0 );
+		}
+		else if ( strcasecmp ( keyValueStr , "levels" ) == 0 ) 
 		{
-			int semaphoreID = ParamToInt ( param1 );
-			SemaphoreP ( semaphoreID ); 
+			parsed = ParseSweepAxis ( valuesStr , &levelsAxis , 0 );
 		}
-		else if ( EqualStr ( command , SEMAPHORE_V_COMMAND ) )
+		else if ( strcasecmp ( keyValueStr , "bursts" ) == 0 ) 
 		{
-			int semaphoreID = ParamToInt ( param1 );
-			SemaphoreV ( semaphoreID ); 
+			parsed = ParseSweepAxis ( valuesStr , &burstsAxis , 0 );
 		}
-		else if ( EqualStr ( command , PROCESS_INFO_COMMAND ) )
+		else if ( strcasecmp ( keyValueStr , "policy" ) == 0 ) 
 		{
-			int processID = ParamToInt ( param1 );
-			ProcInfo ( processID );
-		}			
-		else if ( EqualStr ( command , TOTAL_INFO_COMMAND ) )
+			parsed = ParseSweepAxis ( valuesStr , &policyAxis , 1 );
+		}
+		else if ( strcasecmp ( keyValueStr , "seeds" ) == 0 ) 
 		{
-			DisplayTotalSystemInfo ();
+			numSeeds = ParamToInt ( valuesStr );
+			parsed = SUCCESS_OP;
 		}
-		else 
+
+		if ( parsed == FAILURE_OP ) 
 		{
-			ChangeTextColorToError ();
-			printf ( "ERROR: \"%s\" is not a recognized command\n\n" , command );
-			ChangeTextColorToDefault ();
+			fprintf ( stderr , "ERROR: Invalid sweep values for \"%s\"\n" , keyValueStr );
+			return FAILURE_OP;
 		}
+	}
+
+	if ( !ValidSweepAxes ( &cpusAxis , &levelsAxis , &burstsAxis , numSeeds ) ) 
+	{
+		fprintf ( 
+			stderr , 
+			"ERROR: Sweep needs cpus 1-%d, levels 1-%d, bursts >= 1 and seeds >= 1\n" , 
+			MAX_NUM_CPUS , 
+			MAX_NUM_PRIORITY_LEVELS 
+		);
+		return FAILURE_OP;
+	}
+
+	int numRuns = cpusAxis.numValues * levelsAxis.numValues * burstsAxis.numValues * policyAxis.numValues * numSeeds;
+
+	SWEEP_RUN *runs = ( SWEEP_RUN *) calloc ( numRuns , sizeof ( SWEEP_RUN ) );
+	if ( !runs ) 
+	{
+		fprintf ( stderr , "ERROR: Could not allocate results for %d sweep runs\n" , numRuns );
+		return FAILURE_OP;
+	}
+
+	int runIndex = 0;
+	for ( int c = 0 ; c < cpusAxis.numValues ; c++ ) 
+	for ( int l = 0 ; l < levelsAxis.numValues ; l++ ) 
+	for ( int b = 0 ; b < burstsAxis.numValues ; b++ ) 
+	for ( int a = 0 ; a < policyAxis.numValues ; a++ ) 
+	for ( int seed = 1 ; seed <= numSeeds ; seed++ ) 
+	{
+		SWEEP_RUN *run = &runs [ runIndex ];
+		run -> seed = seed;
+		run -> numCPUs = cpusAxis.values [ c ];
+		run -> numPriorityLevels = levelsAxis.values [ l ];
+		run -> maxCPUBursts = burstsAxis.values [ b ];
+		run -> agingPolicy = policyAxis.values [ a ];
+		run -> numOps = numOps;
+		run -> completed = 0;
+		runIndex += 1;
+	}
+
+	struct timespec startTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+
+	// every run owns its own OS_SIM, so workers only share the queue of runs
+	SWEEP_POOL pool = { .runs = runs , .numRuns = numRuns , .nextRun = 0 };
+	pthread_mutex_init ( &pool.lock , NULL );
 
-		if ( runningProcess ) 
+	if ( numWorkers > numRuns ) 
+	{
+		numWorkers = numRuns;
+	}
+
+	pthread_t *workers = ( pthread_t *) malloc ( sizeof ( pthread_t ) * numWorkers );
+	int numStarted = 0;
+	while ( workers && numStarted < numWorkers ) 
+	{
+		if ( pthread_create ( &workers [ numStarted ] , NULL , &SweepWorker , &pool ) != 0 ) 
 		{
-			PrintInputPrompt ();
+			break;
 		}
+
+		numStarted += 1;
+	}
+
+	if ( numStarted == 0 ) 
+	{
+		SweepWorker ( &pool );
+	}
+
+	for ( int i = 0 ; i < numStarted ; i++ ) 
+	{
+		pthread_join ( workers [ i ] , NULL );
+	}
+
+	free ( workers );
+	pthread_mutex_destroy ( &pool.lock );
+
+	double elapsedMs = ElapsedMs ( &startTime );
+
+	FILE *resultsFile = stdout;
+	if ( resultsPath ) 
+	{
+		resultsFile = fopen ( resultsPath , "w" );
+		if ( !resultsFile ) 
+		{
+			fprintf ( stderr , "ERROR: Could not open results file \"%s\"\n" , resultsPath );
+			free ( runs );
+			return FAILURE_OP;
+		}
+	}
+
+	WriteSweepResults ( resultsFile , runs , numRuns );
+	if ( resultsFile != stdout ) 
+	{
+		fclose ( resultsFile );
+	}
+
+	int numCompleted = 0;
+	for ( int i = 0 ; i < numRuns ; i++ ) 
+	{
+		numCompleted += runs [ i ].completed;
+	}
+
+	fprintf ( 
+		stderr , 
+		"SWEEP: %d/%d runs completed in %.1f s on %d worker threads\n" , 
+		numCompleted , 
+		numRuns , 
+		elapsedMs / 1000.0 , 
+		numStarted 
+	);
+
+	free ( runs );
+	return numCompleted == numRuns ? SUCCESS_OP : FAILURE_OP;
+}
+
+/* SHELL - everything a command needs besides the instance, shared by the REPL and replay */
+typedef struct shell 
+{
+	OS_SIM *sim;
+	LOGGER *logger;
+	COMMAND_STATS *commandStats;
+	COMMAND_RECORDER *recorder; // NULL = not recording
+	METRICS_EXPORTER *metricsExporter; // NULL = not exporting
+} SHELL;
+
+/* runs one command, passing back the OSSIM status it ended with - FAILURE_OP only when no command was recognized */
+int DispatchCommand ( SHELL *shell , char *inputLine , int *status ) 
+{
+	OS_SIM *sim = shell -> sim;
+	char *remainderStr = inputLine;
+	*status = OSSIM_SUCCESS;
+
+	char *command = strtok_r ( remainderStr , COMMAND_DELIMITER , &remainderStr );
+	if ( !command ) 
+	{
+		PrintError ( sim , "ERROR: Empty command\n\n" );
+		return FAILURE_OP; // only delimiters, nothing to dispatch
+	}
+
+	StrToUpper ( command );
+	char *param1 = strtok_r ( remainderStr , COMMAND_DELIMITER , &remainderStr );
+	char *param2 = remainderStr;
+
+	int numProcessesBefore = NumSystemProcessesTotal ( sim );
+	int recognizedCommand = 1;
+	int commandStatus = OSSIM_SUCCESS;
+	struct timespec commandStartTime;
+	clock_gettime ( CLOCK_MONOTONIC , &commandStartTime );
+
+	if ( EqualStr ( command , CREATE_COMMAND ) )
+	{
+		int priorityLevel = ParamToInt ( param1 );
+		int groupID = NO_PROCESS_GROUP;
+		if ( param2 && strlen ( param2 ) > 0 ) 
+		{
+			groupID = ParamToInt ( param2 );
+		}
+
+		commandStatus = CreateCommand ( sim , priorityLevel , groupID );
+	}
+	else if ( EqualStr ( command , DEADLINE_CREATE_COMMAND ) )
+	{
+		int period = ParamToInt ( param1 );
+		char *deadlineParam = NULL;
+		char *budgetParam = strtok_r ( param2 , COMMAND_DELIMITER , &deadlineParam );
+		int budget = ParamToInt ( budgetParam );
+
+		int relativeDeadline = period; // implicit deadline unless given
+		if ( deadlineParam && strlen ( deadlineParam ) > 0 ) 
+		{
+			relativeDeadline = ParamToInt ( deadlineParam );
+		}
+
+		commandStatus = DeadlineCreateCommand ( sim , period , relativeDeadline , budget );
+	}
+	else if ( EqualStr ( command , FORK_COMMAND ) )
+	{
+		commandStatus = ForkCommand ( sim );
+	}
+	else if ( EqualStr ( command , KILL_COMMAND ) )
+	{
+		int processID = ParamToInt ( param1 );
+		commandStatus = KillCommand ( sim , processID );
+	}
+	else if ( EqualStr ( command , EXIT_COMMAND ) )
+	{
+		int exitStatus = param1 ? ParamToInt ( param1 ) : 0;
+		commandStatus = ExitCommand ( sim , exitStatus );
+	}	
+	else if ( EqualStr ( command , QUANTUM_COMMAND ) )
+	{
+		commandStatus = OSSimQuantum ( sim );
+	}
+	else if ( EqualStr ( command , SEND_COMMAND ) )
+	{
+		int recipientProcessID = ParamToInt ( param1 );
+		char *messageStr = param2;
+		commandStatus = SendCommand ( sim , recipientProcessID , messageStr );
+	}			
+	else if ( EqualStr ( command , RECEIVE_COMMAND ) )
+	{
+		commandStatus = ReceiveCommand ( sim );
+	}
+	else if ( EqualStr ( command , REPLY_COMMAND ) )
+	{
+		int recipientProcessID = ParamToInt ( param1 );
+		char *messageStr = param2;
+		commandStatus = ReplyCommand ( sim , recipientProcessID , messageStr );
+	}
+	else if ( EqualStr ( command , NEW_SEMAPHORE_COMMAND ) )
+	{
+		int semaphoreID = ParamToInt ( param1 );
+		int initSemValue = ParamToInt ( param2 );
+		commandStatus = NewSemaphoreCommand ( sim , semaphoreID , initSemValue );
+	}	
+	else if ( EqualStr ( command , SEMAPHORE_P_COMMAND ) )
+	{
+		int semaphoreID = ParamToInt ( param1 );
+		commandStatus = SemaphoreCommand ( sim , semaphoreID , 'P' );
+	}
+	else if ( EqualStr ( command , SEMAPHORE_V_COMMAND ) )
+	{
+		int semaphoreID = ParamToInt ( param1 );
+		commandStatus = SemaphoreCommand ( sim , semaphoreID , 'V' );
+	}
+	else if ( EqualStr ( command , PROCESS_INFO_COMMAND ) )
+	{
+		int processID = ParamToInt ( param1 );
+		commandStatus = ProcInfo ( sim , processID );
+	}			
+	else if ( EqualStr ( command , TOTAL_INFO_COMMAND ) )
+	{
+		DisplayTotalSystemInfo ( sim , shell -> logger );
+	}
+	else if ( EqualStr ( command , AFFINITY_COMMAND ) )
+	{
+		int processID = ParamToInt ( param1 );
+		int affinityMask = ParamToInt ( param2 );
+		commandStatus = AffinityCommand ( sim , processID , affinityMask );
+	}
+	else if ( EqualStr ( command , USE_CPU_COMMAND ) )
+	{
+		int cpuID = ParamToInt ( param1 );
+		commandStatus = UseCPUCommand ( sim , cpuID );
+	}
+	else if ( EqualStr ( command , COMMAND_STATS_COMMAND ) )
+	{
+		DisplayCommandStats ( sim , shell -> commandStats );
+	}
+	else if ( EqualStr ( command , SAVE_SNAPSHOT_COMMAND ) )
+	{
+		commandStatus = SaveSnapshotCommand ( sim , param1 );
+	}
+	else if ( EqualStr ( command , LOAD_SNAPSHOT_COMMAND ) )
+	{
+		commandStatus = LoadSnapshotCommand ( sim , param1 );
+	}
+	else if ( EqualStr ( command , GROUP_COMMAND ) )
+	{
+		char groupOperation = param1 ? toupper ( ( unsigned char ) param1 [ 0 ] ) : '\0';
+		char *priorityParam = NULL;
+		char *groupParam = strtok_r ( param2 , COMMAND_DELIMITER , &priorityParam );
+		commandStatus = GroupCommand ( sim , groupOperation , ParamToInt ( groupParam ) , ParamToInt ( priorityParam ) );
+	}
+	else if ( EqualStr ( command , WAIT_COMMAND ) )
+	{
+		commandStatus = WaitCommand ( sim );
+	}
+	else if ( EqualStr ( command , KILL_TREE_COMMAND ) )
+	{
+		int processID = ParamToInt ( param1 );
+		commandStatus = KillTreeCommand ( sim , processID );
+	}
+	else if ( EqualStr ( command , MEMORY_COMMAND ) )
+	{
+		int page = ParamToInt ( param1 );
+		commandStatus = MemoryCommand ( sim , page , param2 && strlen ( param2 ) > 0 ? param2 : NULL );
+	}
+	else 
+	{
+		recognizedCommand = 0;
+		ChangeTextColorToError ( sim );
+		fprintf ( sim -> outputFile , "ERROR: \"%s\" is not a recognized command\n\n" , command );
+		ChangeTextColorToDefault ( sim );
+	}
+
+	unsigned long commandLatencyNs = ElapsedNs ( &commandStartTime );
+	if ( recognizedCommand ) 
+	{
+		RecordCommandLatency ( &shell -> commandStats [ command [ 0 ] - 'A' ] , commandLatencyNs , numProcessesBefore );
+	}
+
+	*status = commandStatus;
+	return recognizedCommand ? SUCCESS_OP : FAILURE_OP;
+}
+
+/* BATCHES - "C 1; C 2; Q" runs as one OSSimBeginBatch / OSSimEndBatch, so idle CPUs are rescheduled once at
+ * the end and the whole batch is answered with one consolidated response and one prompt: what every command
+ * printed, in order, then one line summing up how many of them failed by the OSSIM status they ended with */
+int HasBatchCommandsLeft ( const char *batchRemainder ) 
+{
+	for ( ; batchRemainder && *batchRemainder ; batchRemainder++ ) 
+	{
+		if ( !strchr ( BATCH_DELIMITER , *batchRemainder ) && !strchr ( COMMAND_DELIMITER , *batchRemainder ) ) 
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+void DispatchBatch ( SHELL *shell , char *inputLine ) 
+{
+	OS_SIM *sim = shell -> sim;
+	OSSimBeginBatch ( sim );
+
+	int numCommands = 0;
+	int numUnrecognized = 0;
+	int numFailed = 0;
+	char *remainderStr = inputLine;
+	char *command = NULL;
+	while ( sim -> currentCPU -> runningProcess && ( command = strtok_r ( remainderStr , BATCH_DELIMITER , &remainderStr ) ) ) 
+	{
+		command += strspn ( command , COMMAND_DELIMITER );
+		if ( strlen ( command ) == 0 ) 
+		{
+			continue;
+		}
+
+		int commandStatus = OSSIM_SUCCESS;
+		int recognizedCommand = DispatchCommand ( shell , command , &commandStatus ) == SUCCESS_OP;
+		numCommands += 1;
+		numUnrecognized += !recognizedCommand;
+		numFailed += !recognizedCommand || commandStatus < OSSIM_SUCCESS; // RECEIVE / WAIT finding nothing is not a failure
+	}
+
+	OSSimEndBatch ( sim );
+
+	int stoppedEarly = !sim -> currentCPU -> runningProcess && HasBatchCommandsLeft ( remainderStr );
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: BATCH of %d commands applied - %d failed (%d not recognized)%s\n\n" , 
+		numCommands , 
+		numFailed , 
+		numUnrecognized , 
+		stoppedEarly ? " - stopped early, INIT has exited" : "" 
+	);
+	ChangeTextColorToDefault ( sim );
+}
+
+/* a line of nothing but delimiters names no command */
+int IsBlankCommand ( const char *inputLine ) 
+{
+	return inputLine [ strspn ( inputLine , COMMAND_DELIMITER ) ] == '\0';
+}
+
+/* one input line - recorded as is, so a replay splits batches the same way. A blank line is neither run nor recorded */
+void ExecuteCommand ( SHELL *shell , char *inputLine ) 
+{
+	OS_SIM *sim = shell -> sim;
+	if ( IsBlankCommand ( inputLine ) ) 
+	{
+		return;
+	}
+
+	if ( RecorderAppendCommand ( shell -> recorder , sim , inputLine , strlen ( inputLine ) ) != SUCCESS_OP_CODE ) 
+	{
+		fprintf ( stderr , "WARNING: Could not record command \"%s\"\n" , inputLine );
+	}
+
+	if ( strchr ( inputLine , BATCH_DELIMITER [ 0 ] ) ) 
+	{
+		DispatchBatch ( shell , inputLine );
+	}
+	else 
+	{
+		int commandStatus = OSSIM_SUCCESS;
+		DispatchCommand ( shell , inputLine , &commandStatus );
+	}
+
+	RecorderCommandDone ( shell -> recorder , sim );
+	MetricsExporterStateChanged ( shell -> metricsExporter );
+}
+
+/* REPLAY - runs a recording through the same dispatch as the REPL with no prompts and all output discarded,
+ * stopping at the first command issued at a different tick or checkpoint whose state hash differs */
+void ReportReplayDivergence ( long firstSuspectCommand , long numCommands , const char *lastCommand , const char *what , unsigned long actual , unsigned long recorded ) 
+{
+	fprintf ( stderr , "REPLAY DIVERGED within commands %ld-%ld (last \"%s\"): %s is %lx, recording has %lx\n" , 
+		firstSuspectCommand , 
+		numCommands , 
+		lastCommand , 
+		what , 
+		actual , 
+		recorded 
+	);
+}
+
+int RunReplay ( OS_SIM *sim , const char *recordingPath ) 
+{
+	RECORDING_HEADER header;
+	FILE *recordingFile = RecordingOpen ( recordingPath , &header );
+	if ( !recordingFile ) 
+	{
+		fprintf ( stderr , "ERROR: Could not open recording \"%s\" (missing, truncated or not a recording)\n" , recordingPath );
+		return FAILURE_OP;
+	}
+
+	sim -> numCPUs = header.numCPUs;
+	sim -> numNodes = header.numNodes;
+	sim -> numCPUsPerCache = header.numCPUsPerCache;
+	sim -> numPriorityLevels = header.numPriorityLevels;
+	sim -> maxCPUBursts = header.maxCPUBursts;
+	sim -> agingPolicy = header.agingPolicy;
+	sim -> outputFile = fopen ( "/dev/null" , "w" );
+
+	SHELL shell = { sim , NULL , NULL , NULL , NULL };
+	if ( sim -> outputFile ) 
+	{
+		shell.logger = LoggerCreate ( sim -> outputFile , LOG_SYNC , &NARRATION_FORMAT_TABLE ); // narration is not subscribed, T still reports it
+		shell.commandStats = ( COMMAND_STATS *) calloc ( NUM_COMMAND_LETTERS , sizeof ( COMMAND_STATS ) );
+	}
+
+	if ( !shell.logger || !shell.commandStats || OSSimStart ( sim ) != OSSIM_SUCCESS ) 
+	{
+		fprintf ( stderr , "ERROR: Could not start the simulator the recording was made with\n" );
+		fclose ( recordingFile );
+		return FAILURE_OP;
+	}
+
+	for ( int i = 0 ; i < NUM_COMMAND_LETTERS ; i++ ) 
+	{
+		HistogramInit ( &shell.commandStats [ i ].latency );
+	}
+
+	struct timespec replayStartTime;
+	clock_gettime ( CLOCK_MONOTONIC , &replayStartTime );
+
+	RECORDING_ENTRY entry;
+	char lastCommand [ MAX_RECORDED_COMMAND_LENGTH + 1 ] = "";
+	long numCommands = 0;
+	long numCheckpoints = 0;
+	long lastVerifiedCommand = 0; // commands up to here matched at a checkpoint
+	int diverged = 0;
+	int atEnd = 0;
+	int readResult = SUCCESS_OP_CODE;
+	while ( !diverged && ( readResult = RecordingReadEntry ( recordingFile , &entry , &atEnd ) ) == SUCCESS_OP_CODE && !atEnd ) 
+	{
+		if ( entry.kind == RECORDED_CHECKPOINT ) 
+		{
+			unsigned long stateHash = OSSimStateHash ( sim );
+			if ( entry.numCommands != numCommands ) 
+			{
+				ReportReplayDivergence ( lastVerifiedCommand + 1 , numCommands , lastCommand , "command count" , numCommands , entry.numCommands );
+				diverged = 1;
+			}
+			else if ( entry.tick != sim -> currentTick ) 
+			{
+				ReportReplayDivergence ( lastVerifiedCommand + 1 , numCommands , lastCommand , "tick" , sim -> currentTick , entry.tick );
+				diverged = 1;
+			}
+			else if ( stateHash != entry.stateHash ) 
+			{
+				ReportReplayDivergence ( lastVerifiedCommand + 1 , numCommands , lastCommand , "state hash" , stateHash , entry.stateHash );
+				diverged = 1;
+			}
+
+			lastVerifiedCommand = numCommands;
+			numCheckpoints += 1;
+			continue;
+		}
+
+		if ( !sim -> currentCPU -> runningProcess ) 
+		{
+			ReportReplayDivergence ( lastVerifiedCommand + 1 , numCommands , lastCommand , "INIT running" , 0 , 1 );
+			diverged = 1;
+		}
+		else if ( entry.tick != sim -> currentTick ) 
+		{
+			ReportReplayDivergence ( lastVerifiedCommand + 1 , numCommands , lastCommand , "tick" , sim -> currentTick , entry.tick );
+			diverged = 1;
+		}
+		else if ( IsBlankCommand ( entry.command ) ) 
+		{
+			numCommands += 1; // never recorded any more, but the recorder counted one like any other entry
+		}
+		else 
+		{
+			memcpy ( lastCommand , entry.command , entry.length + 1 );
+			ExecuteCommand ( &shell , entry.command );
+			numCommands += 1;
+		}
+	}
+
+	double replaySeconds = ElapsedNs ( &replayStartTime ) / 1e9;
+	if ( readResult != SUCCESS_OP_CODE ) 
+	{
+		fprintf ( stderr , "ERROR: Recording \"%s\" is truncated after %ld commands\n" , recordingPath , numCommands );
+	}
+	else if ( !diverged ) 
+	{
+		printf ( "REPLAY: %ld commands, %ld checkpoints verified in %.3f s (%.0f commands/sec), final state hash %016lx\n" , 
+			numCommands , 
+			numCheckpoints , 
+			replaySeconds , 
+			replaySeconds > 0 ? numCommands / replaySeconds : 0 , 
+			OSSimStateHash ( sim ) 
+		);
+	}
+
+	fclose ( recordingFile );
+	fclose ( sim -> outputFile );
+	sim -> outputFile = stdout;
+	LoggerFree ( shell.logger );
+	free ( shell.commandStats );
+
+	return readResult == SUCCESS_OP_CODE && !diverged ? SUCCESS_OP : FAILURE_OP;
+}
+
+void PrintShutdownMessage ( OS_SIM *sim ) 
+{
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: System Shutting Down ... Goodbye\n\n");
+	ChangeTextColorToDefault ( sim );
+}
+
+void RunInteractiveShell ( SHELL *shell ) 
+{
+	OS_SIM *sim = shell -> sim;
+	PrintInputPrompt ( sim );
+
+	// input is split into lines here rather than one read per line, so a driver can pipeline its commands
+	char inputBuffer [ MAX_INPUT_LENGTH + 1 ];
+	int bufferedLength = 0;
+	int endOfInput = 0;
+	while ( sim -> currentCPU -> runningProcess ) 
+	{
+		char *lineEnd = memchr ( inputBuffer , '\n' , bufferedLength );
+		if ( !lineEnd && !endOfInput && bufferedLength < MAX_INPUT_LENGTH ) 
+		{
+			int inputLength = 0;
+			if ( ( shell -> metricsExporter && MetricsExporterWaitForInput ( shell -> metricsExporter , sim , STDIN_FILENO ) != SUCCESS_OP_CODE ) || 
+				( inputLength = read ( STDIN_FILENO , inputBuffer + bufferedLength , MAX_INPUT_LENGTH - bufferedLength ) ) <= 0 ) 
+			{
+				endOfInput = 1;
+			}
+
+			bufferedLength += inputLength > 0 ? inputLength : 0;
+			continue;
+		}
+
+		if ( !lineEnd && bufferedLength == 0 ) 
+		{
+			break; // end of input
+		}
+
+		int lineLength = lineEnd ? lineEnd - inputBuffer : bufferedLength; // a full buffer or a last line without a new line
+		inputBuffer [ lineLength ] = '\0';
+		ExecuteCommand ( shell , inputBuffer ); // skips a blank line
+
+		int consumedLength = lineEnd ? lineLength + 1 : lineLength;
+		bufferedLength -= consumedLength;
+		memmove ( inputBuffer , inputBuffer + consumedLength , bufferedLength );
+
+		if ( sim -> currentCPU -> runningProcess ) 
+		{
+			PrintInputPrompt ( sim );
+		}
+	}
+}
+
+/* SERVER MODE - each client's commands run through ExecuteCommand with the output and narration of that
+ * command going into the client's response, so every client sees exactly what the shell would have printed */
+int ServerCommandHandler ( char *commandLine , FILE *responseFile , void *shellContext ) 
+{
+	SHELL *shell = ( SHELL *) shellContext;
+	OS_SIM *sim = shell -> sim;
+	sim -> outputFile = responseFile;
+	shell -> logger -> outputFile = responseFile; // LOG_SYNC renders as records are pushed
+
+	if ( commandLine ) 
+	{
+		ExecuteCommand ( shell , commandLine );
+	}
+
+	int running = sim -> currentCPU -> runningProcess != NULL;
+	if ( running ) 
+	{
+		PrintInputPrompt ( sim );
+	}
+	else 
+	{
+		PrintShutdownMessage ( sim );
+	}
+
+	sim -> outputFile = stdout;
+	shell -> logger -> outputFile = stdout;
+	return running;
+}
+
+int RunServer ( SHELL *shell , const char *socketPath ) 
+{
+	COMMAND_SERVER *server = ServerCreate ( socketPath , &ServerCommandHandler , shell );
+	if ( !server ) 
+	{
+		return FAILURE_OP;
+	}
+
+	OS_SIM *sim = shell -> sim;
+	ChangeTextColorToOS ( sim );
+	fprintf ( sim -> outputFile , "OS: Serving commands on \"%s\" (up to %d clients)\n\n" , socketPath , MAX_SERVER_CLIENTS );
+	ChangeTextColorToDefault ( sim );
+	fflush ( sim -> outputFile );
+
+	int serving = 1;
+	while ( serving ) 
+	{
+		// the exporter's wait returns once the server has work, scrapes are answered in between
+		if ( shell -> metricsExporter && MetricsExporterWaitForInput ( shell -> metricsExporter , sim , ServerPollFD ( server ) ) != SUCCESS_OP_CODE ) 
+		{
+			break;
+		}
+
+		serving = ServerHandleEvents ( server , shell -> metricsExporter ? 0 : -1 ) == SUCCESS_OP_CODE;
+	}
+
+	fprintf ( sim -> outputFile , "OS: Served %lu commands from %lu clients (%lu refused, %lu KB sent, %lu slow-reader stalls)\n\n" , 
+		server -> numCommands , 
+		server -> numConnections , 
+		server -> numRejectedConnections , 
+		server -> numBytesSent / 1024 , 
+		server -> numBackpressureStalls 
+	);
+
+	ServerFree ( server );
+	return SUCCESS_OP;
+}
+
+void PrintUsage ( const char *programName ) 
+{
+	printf ( 
+		"Usage: %s [-c numCPUs (1-%d)] [-n numNUMANodes (divides numCPUs)] [-l numCPUsPerSharedCache (divides CPUs per node)]\n"
+		"\t[-p numPriorityLevels (1-%d)] [-b maxCPUBursts (>= 1)] [-a agingPolicy (bounce|demote|none)]\n"
+		"\t[-L logPolicy (sync|block|drop)] [-B binaryLogFile] [-D binaryLogFileToRender]\n"
+		"\t[-m metricsSocket] [-M metricsFile [-I metricsFileIntervalMs]] [-t chromeTraceFile]\n"
+		"\t[-R recordingFile [-K checkpointIntervalCommands]] [-P recordingFileToReplay] [-s serverSocket (with -L sync only)]\n"
+		"\t[-S \"cpus=1,2;levels=3;bursts=5;policy=bounce,demote;seeds=10\" [-j numWorkers] [-O opsPerRun] [-o resultsFile]]\n" , 
+		programName , 
+		MAX_NUM_CPUS ,
+		MAX_NUM_PRIORITY_LEVELS
+	);
+}
+
+int main ( int argc , char *argv [] ) 
+{
+	OS_SIM *sim = OSSimCreate ();
+	if ( !sim ) 
+	{
+		fprintf ( stderr , "ERROR: Could not allocate the simulator\n" );
+		exit ( 1 );
+	}
+
+	sim -> outputFile = stdout;
+
+	char *sweepSpec = NULL;
+	char *sweepResultsPath = NULL;
+	int numSweepWorkers = sysconf ( _SC_NPROCESSORS_ONLN );
+	int numSweepOps = DEFAULT_SWEEP_OPS;
+	int logPolicy = LOG_SYNC;
+	char *binaryLogPath = NULL;
+	char *metricsSocketPath = NULL;
+	char *metricsFilePath = NULL;
+	int metricsFileIntervalMs = DEFAULT_METRICS_FILE_INTERVAL_MS;
+	char *tracePath = NULL;
+	char *recordingPath = NULL;
+	int checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+	char *replayPath = NULL;
+
+	char *serverSocketPath = NULL;
+
+	int option = 0;
+	while ( ( option = getopt ( argc , argv , "c:n:l:p:b:a:L:B:D:m:M:I:t:S:j:O:o:R:K:P:s:" ) ) != -1 ) 
+	{
+		if ( option == 'c' ) 
+		{
+			sim -> numCPUs = ParamToInt ( optarg );
+		}
+		else if ( option == 'n' ) 
+		{
+			sim -> numNodes = ParamToInt ( optarg );
+		}
+		else if ( option == 'l' ) 
+		{
+			sim -> numCPUsPerCache = ParamToInt ( optarg );
+		}
+		else if ( option == 'p' ) 
+		{
+			sim -> numPriorityLevels = ParamToInt ( optarg );
+		}
+		else if ( option == 'b' ) 
+		{
+			sim -> maxCPUBursts = ParamToInt ( optarg );
+		}
+		else if ( option == 'a' ) 
+		{
+			sim -> agingPolicy = ParseAgingPolicy ( optarg );
+		}
+		else if ( option == 'L' ) 
+		{
+			logPolicy = ParseLogPolicy ( optarg );
+			if ( logPolicy < 0 ) 
+			{
+				PrintUsage ( argv [ 0 ] );
+				exit ( 1 );
+			}
+		}
+		else if ( option == 'B' ) 
+		{
+			binaryLogPath = optarg;
+		}
+		else if ( option == 'D' ) 
+		{
+			int renderResult = LoggerRenderBinaryLog ( optarg , stdout , &NARRATION_FORMAT_TABLE );
+			if ( renderResult != SUCCESS_OP_CODE ) 
+			{
+				fprintf ( stderr , "ERROR: Could not render binary log \"%s\" (missing, truncated or written by a different build)\n" , optarg );
+			}
+
+			OSSimFree ( sim );
+			exit ( renderResult == SUCCESS_OP_CODE ? 0 : 1 );
+		}
+		else if ( option == 'm' ) 
+		{
+			metricsSocketPath = optarg;
+		}
+		else if ( option == 'M' ) 
+		{
+			metricsFilePath = optarg;
+		}
+		else if ( option == 'I' ) 
+		{
+			metricsFileIntervalMs = ParamToInt ( optarg );
+		}
+		else if ( option == 't' ) 
+		{
+			tracePath = optarg;
+		}
+		else if ( option == 'S' ) 
+		{
+			sweepSpec = optarg;
+		}
+		else if ( option == 'j' ) 
+		{
+			numSweepWorkers = ParamToInt ( optarg );
+		}
+		else if ( option == 'O' ) 
+		{
+			numSweepOps = ParamToInt ( optarg );
+		}
+		else if ( option == 'o' ) 
+		{
+			sweepResultsPath = optarg;
+		}
+		else if ( option == 'R' ) 
+		{
+			recordingPath = optarg;
+		}
+		else if ( option == 'K' ) 
+		{
+			checkpointInterval = ParamToInt ( optarg );
+		}
+		else if ( option == 'P' ) 
+		{
+			replayPath = optarg;
+		}
+		else if ( option == 's' ) 
+		{
+			serverSocketPath = optarg;
+		}
+		else 
+		{
+			PrintUsage ( argv [ 0 ] );
+			exit ( 1 );
+		}
+	}
+
+	int validNumCPUs = sim -> numCPUs >= 1 && sim -> numCPUs <= MAX_NUM_CPUS;
+	int validNumNodes = sim -> numNodes >= 1 && validNumCPUs && sim -> numCPUs % sim -> numNodes == 0;
+	int validNumCPUsPerCache = sim -> numCPUsPerCache >= 1 && validNumNodes && ( sim -> numCPUs / sim -> numNodes ) % sim -> numCPUsPerCache == 0;
+	int validPolicy = sim -> numPriorityLevels >= 1 && sim -> numPriorityLevels <= MAX_NUM_PRIORITY_LEVELS && sim -> maxCPUBursts >= 1 && sim -> agingPolicy >= 0;
+	int validSweep = numSweepWorkers >= 1 && numSweepOps >= 0;
+	int validRecording = checkpointInterval >= 1;
+	int validServer = !serverSocketPath || ( logPolicy == LOG_SYNC && !binaryLogPath ); // narration is rendered into each command's response
+	if ( !validNumCPUsPerCache || !validPolicy || !validSweep || !validRecording || !validServer ) 
+	{
+		PrintUsage ( argv [ 0 ] );
+		exit ( 1 );
+	}
+
+	if ( sweepSpec ) 
+	{
+		int sweepResult = RunSweep ( sim , sweepSpec , numSweepWorkers , numSweepOps , sweepResultsPath );
+		OSSimFree ( sim );
+		exit ( sweepResult == SUCCESS_OP ? 0 : 1 );
+	}
+
+	if ( replayPath ) 
+	{
+		int replayResult = RunReplay ( sim , replayPath );
+		OSSimFree ( sim );
+		exit ( replayResult == SUCCESS_OP ? 0 : 1 );
+	}
+
+	unsigned int narratedEventsMask = OSSIM_ALL_EVENTS & 
+		~OSSIM_EVENT_BIT ( OSSIM_EVENT_PROCESS_CREATED ) & 
+		~OSSIM_EVENT_BIT ( OSSIM_EVENT_PROCESS_ENDED ) & 
+		~OSSIM_EVENT_BIT ( OSSIM_EVENT_MESSAGE_QUEUED ); // reported by the command handlers instead
+
+	if ( binaryLogPath && logPolicy == LOG_SYNC ) 
+	{
+		logPolicy = LOG_BLOCK; // the writer thread appends the binary log, keeping it off the command path
+	}
+
+	LOGGER *logger = LoggerCreate ( stdout , logPolicy , &NARRATION_FORMAT_TABLE );
+	if ( !logger || ( binaryLogPath && LoggerOpenBinaryLog ( logger , binaryLogPath ) != SUCCESS_OP_CODE ) ) 
+	{
+		fprintf ( stderr , "ERROR: Could not start the logger\n" );
+		exit ( 1 );
+	}
+
+	if ( logPolicy != LOG_SYNC ) 
+	{
+		FILE *logTextStream = LoggerOpenTextStream ( logger );
+		if ( !logTextStream ) 
+		{
+			fprintf ( stderr , "ERROR: Could not start the async logger\n" );
+			exit ( 1 );
+		}
+
+		sim -> outputFile = logTextStream; // command output stays in order with the deferred records
+	}
+
+	EVENT_LOG_CONTEXT eventLogContext = { logger , sim };
+	OSSimSubscribe ( sim , narratedEventsMask , &LogEvent , &eventLogContext , NULL );
+
+	TRACE_WRITER *traceWriter = NULL;
+	if ( tracePath ) 
+	{
+		traceWriter = TraceWriterCreate ( tracePath , sim );
+		if ( !traceWriter ) 
+		{
+			fprintf ( stderr , "ERROR: Could not open trace file \"%s\"\n" , tracePath );
+			exit ( 1 );
+		}
+
+		OSSimSubscribe ( sim , OSSIM_ALL_EVENTS , &TraceEvent , traceWriter , NULL );
+	}
+
+	if ( OSSimStart ( sim ) != OSSIM_SUCCESS ) 
+	{
+		PrintUsage ( argv [ 0 ] );
+		exit ( 1 );
+	}
+
+	COMMAND_STATS *commandStats = ( COMMAND_STATS *) calloc ( NUM_COMMAND_LETTERS , sizeof ( COMMAND_STATS ) );
+	if ( !commandStats ) 
+	{
+		fprintf ( stderr , "ERROR: Could not allocate the command statistics\n" );
+		exit ( 1 );
+	}
+
+	for ( int i = 0 ; i < NUM_COMMAND_LETTERS ; i++ ) 
+	{
+		HistogramInit ( &commandStats [ i ].latency );
+	}
+
+	METRICS_EXPORTER *metricsExporter = NULL;
+	if ( metricsSocketPath || metricsFilePath ) 
+	{
+		metricsExporter = MetricsExporterCreate ( metricsSocketPath , metricsFilePath , metricsFileIntervalMs );
+		if ( !metricsExporter ) 
+		{
+			fprintf ( stderr , "ERROR: Could not start the metrics export\n" );
+			exit ( 1 );
+		}
+	}
+
+	COMMAND_RECORDER *recorder = NULL;
+	if ( recordingPath ) 
+	{
+		recorder = RecorderCreate ( recordingPath , sim , checkpointInterval );
+		if ( !recorder ) 
+		{
+			fprintf ( stderr , "ERROR: Could not open recording file \"%s\"\n" , recordingPath );
+			exit ( 1 );
+		}
+	}
+
+	SHELL shell = { sim , logger , commandStats , recorder , metricsExporter };
+	if ( serverSocketPath ) 
+	{
+		if ( RunServer ( &shell , serverSocketPath ) != SUCCESS_OP ) 
+		{
+			fprintf ( stderr , "ERROR: Could not serve commands on \"%s\"\n" , serverSocketPath );
+			exit ( 1 );
+		}
+	}
+	else 
+	{
+		RunInteractiveShell ( &shell );
+	}
+
+	RecorderFree ( recorder , sim );
+
+	DisplayCommandStats ( sim , commandStats );
+	free ( commandStats );
+
+	PrintShutdownMessage ( sim );
+
+	if ( sim -> outputFile != stdout ) 
+	{
+		fclose ( sim -> outputFile );
 	}
 
-	ChangeTextColorToOS ();
-	printf ( "OS: System Shutting Down ... Goodbye\n\n");
-	ChangeTextColorToDefault ();
+	LoggerFree ( logger );
+	MetricsExporterFree ( metricsExporter , sim );
+	TraceWriterFree ( traceWriter );
 
-	FreeAllLists ();
+	OSSimFree ( sim );
 	exit ( 0 );
 }
@@ -0,0 +1,5610 @@
+/* Nic Pucci
+ * OS-SIM CORE LIBRARY IMPLEMENTATION
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "List.h"
+#include "Heap.h"
+#include "ossim.h"
+
+const PCB INIT_PROCESS = 
+{ 
+	.processID = INIT_PROCESS_ID , 
+	.priorityLevel = NUM_PRIORITY_LEVELS ,
+	.priorityDirection = DEMOTING ,
+	.numCPUBurstsInPriorityLevel = 0 ,
+	.processState = RUNNING ,
+	.readMessage = NULL ,
+	.cpuID = 0 ,
+	.affinityMask = ALL_CPUS_AFFINITY_MASK ,
+	.numMigrations = 0 ,
+	.numCrossNodeMigrations = 0 ,
+	.warmUpBurstsLeft = 0 ,
+	.schedulingClass = NORMAL_CLASS ,
+	.groupID = NO_PROCESS_GROUP ,
+	.inheritedPriorityLevel = NO_INHERITED_PRIORITY ,
+	.parentProcessID = INIT_PROCESS_ID ,
+	.waitedChildID = INIT_PROCESS_ID
+};
+
+/* WARM-UP BURSTS CHARGED TO A PROCESS MIGRATED ACROSS EACH DISTANCE */
+const int MIGRATION_WARM_UP_BURSTS [ NUM_CPU_DISTANCES ] = { 0 , 1 , 2 , 4 };
+
+void EmitEvent ( OS_SIM *sim , enum OSSIM_EVENT_TYPE type , int cpuID , const PCB *process , const MESSAGE *message , int fromValue , int toValue ) 
+{
+	unsigned int eventBit = OSSIM_EVENT_BIT ( type );
+	if ( !( sim -> subscribedEventsMask & eventBit ) ) 
+	{
+		return; // nobody listening, so the event is never even built
+	}
+
+	OSSIM_EVENT event = 
+	{
+		.type = type ,
+		.tick = sim -> currentTick ,
+		.cpuID = cpuID ,
+		.process = process ,
+		.message = message ,
+		.fromValue = fromValue ,
+		.toValue = toValue
+	};
+
+	for ( int i = 0 ; i < MAX_EVENT_SUBSCRIBERS ; i++ ) 
+	{
+		EVENT_SUBSCRIBER *subscriber = &sim -> subscribers [ i ];
+		if ( subscriber -> callback && ( subscriber -> eventMask & eventBit ) ) 
+		{
+			( *subscriber -> callback ) ( &event , subscriber -> context );
+		}
+	}
+}
+
+void UpdateSubscribedEventsMask ( OS_SIM *sim ) 
+{
+	sim -> subscribedEventsMask = 0;
+	for ( int i = 0 ; i < MAX_EVENT_SUBSCRIBERS ; i++ ) 
+	{
+		EVENT_SUBSCRIBER *subscriber = &sim -> subscribers [ i ];
+		if ( subscriber -> callback ) 
+		{
+			sim -> subscribedEventsMask |= subscriber -> eventMask;
+		}
+	}
+}
+
+int OSSimSubscribe ( OS_SIM *sim , unsigned int eventMask , OSSIM_EVENT_CALLBACK callback , void *context , int *subscriberID ) 
+{
+	if ( !sim || !callback ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	for ( int i = 0 ; i < MAX_EVENT_SUBSCRIBERS ; i++ ) 
+	{
+		EVENT_SUBSCRIBER *subscriber = &sim -> subscribers [ i ];
+		if ( subscriber -> callback ) 
+		{
+			continue;
+		}
+
+		subscriber -> eventMask = eventMask;
+		subscriber -> callback = callback;
+		subscriber -> context = context;
+		UpdateSubscribedEventsMask ( sim );
+
+		if ( subscriberID ) 
+		{
+			*subscriberID = i;
+		}
+
+		return OSSIM_SUCCESS;
+	}
+
+	return OSSIM_TOO_MANY_SUBSCRIBERS;
+}
+
+int OSSimUnsubscribe ( OS_SIM *sim , int subscriberID ) 
+{
+	if ( !sim || subscriberID < 0 || subscriberID >= MAX_EVENT_SUBSCRIBERS || !sim -> subscribers [ subscriberID ].callback ) 
+	{
+		return OSSIM_NO_SUCH_SUBSCRIBER;
+	}
+
+	sim -> subscribers [ subscriberID ].callback = NULL;
+	UpdateSubscribedEventsMask ( sim );
+	return OSSIM_SUCCESS;
+}
+
+double MeanReadyWaitTicks ( OS_SIM *sim ) 
+{
+	if ( sim -> numDispatches == 0 ) 
+	{
+		return 0.0;
+	}
+
+	return ( double ) sim -> totalReadyWaitTicks / sim -> numDispatches;
+}
+
+int CPUReadyCount ( OS_SIM *sim , CPU *cpu ) 
+{
+	int numReady = HeapCount ( cpu -> realTimeReadyHeap );
+	for ( int i = 0 ; i < sim -> numPriorityLevels ; i++ ) 
+	{
+		LIST *readyQueue = cpu -> readyPriorityQueues [ i ];
+		numReady += ListCount ( readyQueue );
+	}
+
+	return numReady;
+}
+
+int CPULoad ( OS_SIM *sim , CPU *cpu ) 
+{
+	int runningLoad = cpu -> runningProcess && cpu -> runningProcess -> processID != INIT_PROCESS_ID;
+	return runningLoad + CPUReadyCount ( sim , cpu );
+}
+
+int NumSystemProcessesTotal ( OS_SIM *sim ) 
+{
+	int numReady = 0;
+	int runningProcessCount = 0;
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		numReady += CPUReadyCount ( sim , cpu );
+
+		if ( cpu -> runningProcess && cpu -> runningProcess -> processID != INIT_PROCESS_ID ) 
+		{
+			runningProcessCount += 1;
+		}
+	}
+
+	int numSemBlocked = 0;
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		SEMAPHORE *semaphore = &sim -> semaphores [ i ];
+		numSemBlocked += ListCount ( semaphore -> blockedPCBs );
+	}
+
+	int numSendBlocked = ListCount ( sim -> sendBlockedQueue );
+	int numReceiveBlocked = ListCount ( sim -> receiveBlockedQueue );
+	int numWaitBlocked = ListCount ( sim -> waitBlockedQueue );
+	int numPeriodWaiting = HeapCount ( sim -> realTimeReleaseHeap );
+	
+	int initProcessCount = 1;
+
+	int numProcesses = initProcessCount + 
+		runningProcessCount + 
+		numReady + 
+		numSemBlocked + 
+		numSendBlocked + 
+		numReceiveBlocked +
+		numWaitBlocked +
+		numPeriodWaiting;
+
+	return numProcesses;
+}
+
+int EarlierDeadline ( void *pcb1 , void *pcb2 ) 
+{
+	PCB *process1 = ( PCB *) pcb1;
+	PCB *process2 = ( PCB *) pcb2;
+
+	if ( process1 -> absoluteDeadline != process2 -> absoluteDeadline ) 
+	{
+		return process1 -> absoluteDeadline - process2 -> absoluteDeadline;
+	}
+
+	return process1 -> processID - process2 -> processID;
+}
+
+int EarlierRelease ( void *pcb1 , void *pcb2 ) 
+{
+	PCB *process1 = ( PCB *) pcb1;
+	PCB *process2 = ( PCB *) pcb2;
+
+	if ( process1 -> releaseTick != process2 -> releaseTick ) 
+	{
+		return process1 -> releaseTick - process2 -> releaseTick;
+	}
+
+	return process1 -> processID - process2 -> processID;
+}
+
+void InitAllLists ( OS_SIM *sim ) 
+{
+	ListPoolInit ( &sim -> listPool );
+
+	sim -> initProcess = INIT_PROCESS;
+	sim -> initProcess.priorityLevel = sim -> numPriorityLevels;
+	sim -> currentCPU = &sim -> cpus [ 0 ];
+
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		cpu -> cpuID = i;
+		cpu -> nodeID = i / ( sim -> numCPUs / sim -> numNodes );
+		cpu -> cacheID = i / sim -> numCPUsPerCache;
+		cpu -> runningProcess = &sim -> initProcess;
+		cpu -> numBusyTicks = 0;
+		cpu -> numIdleTicks = 0;
+		cpu -> numContextSwitches = 0;
+		cpu -> numMigrationsIn = 0;
+		cpu -> numMigrationsOut = 0;
+		cpu -> numSteals = 0;
+		cpu -> numWarmUpBursts = 0;
+
+		for ( int j = 0 ; j < sim -> numPriorityLevels ; j++ ) 
+		{
+			cpu -> readyPriorityQueues [ j ] = ListCreateFromPool ( &sim -> listPool );
+			ListSetOwner ( cpu -> readyPriorityQueues [ j ] , OSSIM_READY_QUEUES );
+		}
+
+		cpu -> realTimeReadyHeap = HeapCreate ( MAX_REAL_TIME_PROCESSES , &EarlierDeadline );
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		sim -> semaphores [ i ].semID = i;
+		sim -> semaphores [ i ].semValue = 0;
+		sim -> semaphores [ i ].initSemValue = 0;
+		sim -> semaphores [ i ].semStatus = NOT_CREATED;
+		sim -> semaphores [ i ].firstHolder = NULL;
+		sim -> semaphores [ i ].numTakes = 0;
+		sim -> semaphores [ i ].blockedPCBs = ListCreateFromPool ( &sim -> listPool );
+		ListSetOwner ( sim -> semaphores [ i ].blockedPCBs , OSSIM_SEMAPHORE_QUEUES );
+	}
+
+	sim -> receiveBlockedQueue = ListCreateFromPool ( &sim -> listPool );
+	sim -> sendBlockedQueue = ListCreateFromPool ( &sim -> listPool );
+	sim -> waitBlockedQueue = ListCreateFromPool ( &sim -> listPool );
+	sim -> messagesQueue = ListCreateFromPool ( &sim -> listPool );
+	ListSetOwner ( sim -> receiveBlockedQueue , OSSIM_RECEIVE_BLOCKED_QUEUE );
+	ListSetOwner ( sim -> sendBlockedQueue , OSSIM_SEND_BLOCKED_QUEUE );
+	ListSetOwner ( sim -> waitBlockedQueue , OSSIM_WAIT_BLOCKED_QUEUE );
+	ListSetOwner ( sim -> messagesQueue , OSSIM_MESSAGES_QUEUE );
+
+	sim -> realTimeReleaseHeap = HeapCreate ( MAX_REAL_TIME_PROCESSES , &EarlierRelease );
+}
+
+void FreeMessage ( MESSAGE *message ) 
+{
+	if ( !message ) {
+		return;
+	}
+
+	free ( message );
+}
+
+/* PROCESS TREE - a parent links its children through their PCBs, so adding or removing one is O(1) */
+void AddChild ( PCB *parent , PCB *child ) 
+{
+	child -> parent = parent;
+	child -> parentProcessID = parent -> processID;
+	child -> nextSibling = NULL;
+	child -> prevSibling = parent -> lastChild;
+
+	if ( parent -> lastChild ) 
+	{
+		parent -> lastChild -> nextSibling = child;
+	}
+	else 
+	{
+		parent -> firstChild = child;
+	}
+
+	parent -> lastChild = child;
+	parent -> numChildren += 1;
+	if ( child -> processState == ZOMBIE ) 
+	{
+		parent -> numZombieChildren += 1;
+	}
+}
+
+void RemoveChild ( PCB *child ) 
+{
+	PCB *parent = child -> parent;
+	if ( !parent ) 
+	{
+		return;
+	}
+
+	if ( child -> prevSibling ) 
+	{
+		child -> prevSibling -> nextSibling = child -> nextSibling;
+	}
+	else 
+	{
+		parent -> firstChild = child -> nextSibling;
+	}
+
+	if ( child -> nextSibling ) 
+	{
+		child -> nextSibling -> prevSibling = child -> prevSibling;
+	}
+	else 
+	{
+		parent -> lastChild = child -> prevSibling;
+	}
+
+	parent -> numChildren -= 1;
+	if ( child -> processState == ZOMBIE ) 
+	{
+		parent -> numZombieChildren -= 1;
+	}
+
+	child -> parent = NULL;
+	child -> parentProcessID = INIT_PROCESS_ID;
+	child -> nextSibling = NULL;
+	child -> prevSibling = NULL;
+}
+
+/* live children are handed to INIT, ZOMBIE children can no longer be waited for so they are freed */
+void ReleaseChildren ( PCB *pcb ) 
+{
+	PCB *child = pcb -> firstChild;
+	while ( child ) 
+	{
+		PCB *nextChild = child -> nextSibling;
+		child -> parent = NULL;
+		child -> parentProcessID = INIT_PROCESS_ID;
+		child -> nextSibling = NULL;
+		child -> prevSibling = NULL;
+
+		if ( child -> processState == ZOMBIE ) 
+		{
+			free ( child ); // a ZOMBIE has no message or children of its own left
+		}
+
+		child = nextChild;
+	}
+
+	pcb -> firstChild = NULL;
+	pcb -> lastChild = NULL;
+	pcb -> numChildren = 0;
+	pcb -> numZombieChildren = 0;
+}
+
+/* SIMULATED MEMORY - page tables and pages are reference counted, the last holder to let go frees them */
+void ReleaseAddressSpace ( PCB *pcb ) 
+{
+	ADDRESS_SPACE *addressSpace = pcb -> addressSpace;
+	pcb -> addressSpace = NULL;
+	if ( !addressSpace ) 
+	{
+		return;
+	}
+
+	addressSpace -> refCount -= 1;
+	if ( addressSpace -> refCount > 0 ) 
+	{
+		return;
+	}
+
+	for ( int i = 0 ; i < NUM_MEMORY_PAGES ; i++ ) 
+	{
+		MEMORY_PAGE *page = addressSpace -> pages [ i ];
+		if ( page ) 
+		{
+			page -> refCount -= 1;
+			if ( page -> refCount == 0 ) 
+			{
+				free ( page );
+			}
+		}
+	}
+
+	free ( addressSpace );
+}
+
+/* a fork copies no memory, the child holds the parent's page table until one of them writes */
+void ShareAddressSpace ( OS_SIM *sim , PCB *parent , PCB *child ) 
+{
+	sim -> numForks += 1;
+	child -> addressSpace = parent -> addressSpace;
+	if ( child -> addressSpace ) 
+	{
+		child -> addressSpace -> refCount += 1;
+		sim -> numForkPagesShared += child -> addressSpace -> numPages;
+	}
+}
+
+/* WAIT-FOR EDGES OF SEND - a SEND_BLOCKED process is linked into its recipient's list of waiting senders, so
+ * neither one has to search for the other when the sender is replied to or either of them ends */
+void LinkWaitingSender ( PCB *sender , PCB *recipient ) 
+{
+	sender -> sendRecipientID = INIT_PROCESS_ID;
+	sender -> sendRecipient = NULL;
+	sender -> nextWaitingSender = NULL;
+	sender -> prevWaitingSender = NULL;
+	if ( !recipient || recipient -> processID == INIT_PROCESS_ID ) 
+	{
+		return; // INIT never blocks, so waiting for it can never be part of a deadlock
+	}
+
+	sender -> sendRecipientID = recipient -> processID;
+	sender -> sendRecipient = recipient;
+	sender -> nextWaitingSender = recipient -> firstWaitingSender;
+	if ( recipient -> firstWaitingSender ) 
+	{
+		recipient -> firstWaitingSender -> prevWaitingSender = sender;
+	}
+
+	recipient -> firstWaitingSender = sender;
+}
+
+void UnlinkWaitingSender ( PCB *sender ) 
+{
+	PCB *recipient = sender -> sendRecipient;
+	if ( recipient ) 
+	{
+		if ( sender -> prevWaitingSender ) 
+		{
+			sender -> prevWaitingSender -> nextWaitingSender = sender -> nextWaitingSender;
+		}
+		else 
+		{
+			recipient -> firstWaitingSender = sender -> nextWaitingSender;
+		}
+
+		if ( sender -> nextWaitingSender ) 
+		{
+			sender -> nextWaitingSender -> prevWaitingSender = sender -> prevWaitingSender;
+		}
+	}
+
+	sender -> sendRecipientID = INIT_PROCESS_ID;
+	sender -> sendRecipient = NULL;
+	sender -> nextWaitingSender = NULL;
+	sender -> prevWaitingSender = NULL;
+}
+
+/* an ended process waits for no one and is waited for by no one - its senders stay SEND_BLOCKED until any
+ * process replies */
+void ReleaseWaitForEdges ( PCB *pcb ) 
+{
+	UnlinkWaitingSender ( pcb );
+
+	PCB *sender = pcb -> firstWaitingSender;
+	while ( sender ) 
+	{
+		PCB *nextSender = sender -> nextWaitingSender;
+		sender -> sendRecipientID = INIT_PROCESS_ID;
+		sender -> sendRecipient = NULL;
+		sender -> nextWaitingSender = NULL;
+		sender -> prevWaitingSender = NULL;
+		sender = nextSender;
+	}
+
+	pcb -> firstWaitingSender = NULL;
+}
+
+/* HOLDERS OF LOCK SEMAPHORES - each lock links the processes holding it, latest to take it first, so the
+ * processes its waiters wait for are found without a search. Every holder is stamped with the take that made it
+ * one, so a restored instance links and walks them in the same order */
+void LinkHolder ( OS_SIM *sim , PCB *pcb , int semaphoreID , PCB *prevHolder ) 
+{
+	PCB *nextHolder = prevHolder ? prevHolder -> nextHolder [ semaphoreID ] : sim -> semaphores [ semaphoreID ].firstHolder;
+	pcb -> prevHolder [ semaphoreID ] = prevHolder;
+	pcb -> nextHolder [ semaphoreID ] = nextHolder;
+	if ( prevHolder ) 
+	{
+		prevHolder -> nextHolder [ semaphoreID ] = pcb;
+	}
+	else 
+	{
+		sim -> semaphores [ semaphoreID ].firstHolder = pcb;
+	}
+
+	if ( nextHolder ) 
+	{
+		nextHolder -> prevHolder [ semaphoreID ] = pcb;
+	}
+}
+
+void UnlinkHolder ( OS_SIM *sim , PCB *pcb , int semaphoreID ) 
+{
+	if ( pcb -> prevHolder [ semaphoreID ] ) 
+	{
+		pcb -> prevHolder [ semaphoreID ] -> nextHolder [ semaphoreID ] = pcb -> nextHolder [ semaphoreID ];
+	}
+	else 
+	{
+		sim -> semaphores [ semaphoreID ].firstHolder = pcb -> nextHolder [ semaphoreID ];
+	}
+
+	if ( pcb -> nextHolder [ semaphoreID ] ) 
+	{
+		pcb -> nextHolder [ semaphoreID ] -> prevHolder [ semaphoreID ] = pcb -> prevHolder [ semaphoreID ];
+	}
+
+	pcb -> nextHolder [ semaphoreID ] = NULL;
+	pcb -> prevHolder [ semaphoreID ] = NULL;
+	pcb -> holdSequence [ semaphoreID ] = 0;
+}
+
+void AcquireLockSemaphore ( OS_SIM *sim , PCB *pcb , int semaphoreID ) 
+{
+	if ( pcb -> semaphoresHeld [ semaphoreID ] == 0 ) 
+	{
+		sim -> semaphores [ semaphoreID ].numTakes += 1;
+		pcb -> holdSequence [ semaphoreID ] = sim -> semaphores [ semaphoreID ].numTakes;
+		LinkHolder ( sim , pcb , semaphoreID , NULL );
+	}
+
+	pcb -> semaphoresHeld [ semaphoreID ] += 1;
+}
+
+void ReleaseLockSemaphore ( OS_SIM *sim , PCB *pcb , int semaphoreID ) 
+{
+	pcb -> semaphoresHeld [ semaphoreID ] -= 1;
+	if ( pcb -> semaphoresHeld [ semaphoreID ] == 0 ) 
+	{
+		UnlinkHolder ( sim , pcb , semaphoreID );
+	}
+}
+
+/* the lock semaphores an ended process held are not given back, its waiters just stop waiting for it */
+void ReleaseLockSemaphores ( OS_SIM *sim , PCB *pcb ) 
+{
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		if ( pcb -> semaphoresHeld [ i ] > 0 ) 
+		{
+			UnlinkHolder ( sim , pcb , i );
+			pcb -> semaphoresHeld [ i ] = 0;
+		}
+	}
+}
+
+/* leaves the process tree and send edges consistent whatever order the PCBs of an instance are freed in, the
+ * holder lists are dropped whole with the semaphores */
+void FreePCB ( PCB *pcb ) 
+{
+	if ( !pcb ) {
+		return;
+	}
+
+	RemoveChild ( pcb );
+	ReleaseChildren ( pcb );
+	ReleaseWaitForEdges ( pcb );
+	ReleaseAddressSpace ( pcb );
+	FreeMessage ( pcb -> readMessage );
+	free ( pcb );
+}
+
+int ValidGroupID ( int groupID ) 
+{
+	return groupID >= 0 && groupID < MAX_PROCESS_GROUPS;
+}
+
+/* PROCESS GROUP MEMBERSHIP - O(1) both ways, the links live in the member's PCB */
+void JoinProcessGroup ( OS_SIM *sim , PCB *pcb , int groupID ) 
+{
+	PROCESS_GROUP *group = &sim -> processGroups [ groupID ];
+	pcb -> groupID = groupID;
+	pcb -> nextInGroup = NULL;
+	pcb -> prevInGroup = group -> lastMember;
+
+	if ( group -> lastMember ) 
+	{
+		group -> lastMember -> nextInGroup = pcb;
+	}
+	else 
+	{
+		group -> firstMember = pcb;
+	}
+
+	group -> lastMember = pcb;
+	group -> numMembers += 1;
+}
+
+void LeaveProcessGroup ( OS_SIM *sim , PCB *pcb ) 
+{
+	if ( pcb -> groupID == NO_PROCESS_GROUP ) 
+	{
+		return;
+	}
+
+	PROCESS_GROUP *group = &sim -> processGroups [ pcb -> groupID ];
+	if ( pcb -> prevInGroup ) 
+	{
+		pcb -> prevInGroup -> nextInGroup = pcb -> nextInGroup;
+	}
+	else 
+	{
+		group -> firstMember = pcb -> nextInGroup;
+	}
+
+	if ( pcb -> nextInGroup ) 
+	{
+		pcb -> nextInGroup -> prevInGroup = pcb -> prevInGroup;
+	}
+	else 
+	{
+		group -> lastMember = pcb -> prevInGroup;
+	}
+
+	group -> numMembers -= 1;
+	pcb -> groupID = NO_PROCESS_GROUP;
+	pcb -> nextInGroup = NULL;
+	pcb -> prevInGroup = NULL;
+}
+
+void FreeAllLists ( OS_SIM *sim ) {
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		for ( int j = 0 ; j < sim -> numPriorityLevels ; j++ ) 
+		{
+			ListFree ( cpu -> readyPriorityQueues [ j ] , ( void *) &FreePCB );
+		}
+
+		HeapFree ( cpu -> realTimeReadyHeap , ( void *) &FreePCB );
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		SEMAPHORE *semaphore = &sim -> semaphores [ i ];
+		ListFree ( semaphore -> blockedPCBs , ( void *) &FreePCB );
+		semaphore -> firstHolder = NULL; // every holder is freed with its queue
+	}
+
+	ListFree ( sim -> receiveBlockedQueue , ( void *) &FreePCB );
+	ListFree ( sim -> sendBlockedQueue , ( void *) &FreePCB );
+	ListFree ( sim -> waitBlockedQueue , ( void *) &FreePCB );
+	ListFree ( sim -> messagesQueue , ( void *) &FreeMessage );
+
+	HeapFree ( sim -> realTimeReleaseHeap , ( void *) &FreePCB );
+}
+
+int ValidPriorityLevel ( OS_SIM *sim , int priorityLevel ) 
+{
+	return priorityLevel > -1 && priorityLevel < sim -> numPriorityLevels;
+}
+
+enum CPU_DISTANCE CPUDistance ( CPU *cpu1 , CPU *cpu2 ) 
+{
+	if ( cpu1 == cpu2 ) 
+	{
+		return SAME_CPU;
+	}
+
+	if ( cpu1 -> cacheID == cpu2 -> cacheID ) 
+	{
+		return SHARED_CACHE;
+	}
+
+	if ( cpu1 -> nodeID == cpu2 -> nodeID ) 
+	{
+		return SAME_NODE;
+	}
+
+	return CROSS_NODE;
+}
+
+int AllowedOnCPU ( void *pcb , void *cpu ) 
+{
+	if ( !pcb || !cpu ) 
+	{
+		return 0;
+	}
+
+	int cpuID = ( ( CPU *) cpu ) -> cpuID;
+	return ( ( ( PCB *) pcb ) -> affinityMask >> cpuID ) & 1;
+}
+
+void MigrateProcess ( OS_SIM *sim , PCB *pcb , CPU *fromCPU , CPU *toCPU ) 
+{
+	enum CPU_DISTANCE distance = CPUDistance ( fromCPU , toCPU );
+	int warmUpBursts = MIGRATION_WARM_UP_BURSTS [ distance ];
+
+	pcb -> cpuID = toCPU -> cpuID;
+	pcb -> numMigrations += 1;
+	pcb -> warmUpBurstsLeft = warmUpBursts;
+	fromCPU -> numMigrationsOut += 1;
+	toCPU -> numMigrationsIn += 1;
+
+	sim -> numMigrationsByDistance [ distance ] += 1;
+	sim -> totalMigrationWarmUpBursts += warmUpBursts;
+	if ( distance == CROSS_NODE ) 
+	{
+		pcb -> numCrossNodeMigrations += 1;
+	}
+}
+
+CPU *LeastLoadedCPU ( OS_SIM *sim , PCB *pcb , CPU *nearCPU ) 
+{
+	CPU *leastLoadedCPU = NULL;
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		if ( !AllowedOnCPU ( pcb , cpu ) ) 
+		{
+			continue;
+		}
+
+		if ( !leastLoadedCPU || CPULoad ( sim , cpu ) < CPULoad ( sim , leastLoadedCPU ) ) 
+		{
+			leastLoadedCPU = cpu;
+		}
+		else if ( CPULoad ( sim , cpu ) == CPULoad ( sim , leastLoadedCPU ) && 
+			CPUDistance ( cpu , nearCPU ) < CPUDistance ( leastLoadedCPU , nearCPU ) ) 
+		{
+			leastLoadedCPU = cpu; // equally loaded, prefer the more cache-local CPU
+		}
+	}
+
+	if ( !leastLoadedCPU ) 
+	{
+		return nearCPU;
+	}
+
+	return leastLoadedCPU;
+}
+
+int EqualsProcessID ( void *pcb , void *processID ) 
+{
+	if ( !pcb || !processID )
+	{
+		return 0;
+	}
+
+	return ( ( PCB *) pcb ) -> processID == *( ( int *) processID );
+}
+
+PCB *RemoveProcessFromQueue ( int processID , LIST *queue ) 
+{
+	if ( !queue ) {
+		return NULL;
+	} 
+
+	ListFirst ( queue );
+	PCB *foundProcess = ( PCB *) ListSearch ( queue , &EqualsProcessID , &processID );
+	if ( !foundProcess ) {
+		return NULL;
+	}
+
+	ListRemove ( queue );
+	return foundProcess;
+}
+
+/* level the process is queued at - its own, or one inherited from a process waiting on it */
+int EffectivePriorityLevel ( const PCB *pcb ) 
+{
+	return pcb -> inheritedPriorityLevel < pcb -> priorityLevel ? pcb -> inheritedPriorityLevel : pcb -> priorityLevel;
+}
+
+void AddToReadyQueue ( OS_SIM *sim , PCB *pcb ) 
+{
+	if ( !pcb || pcb -> processID == INIT_PROCESS_ID ) {
+		return;
+	}
+
+	CPU *queuedCPU = &sim -> cpus [ pcb -> cpuID ];
+	if ( !AllowedOnCPU ( pcb , queuedCPU ) ) 
+	{
+		MigrateProcess ( sim , pcb , queuedCPU , LeastLoadedCPU ( sim , pcb , queuedCPU ) );
+	}
+
+	pcb -> readyTick = sim -> currentTick;
+	if ( pcb -> schedulingClass == REAL_TIME_CLASS ) 
+	{
+		pcb -> processState = READY;
+		HeapPush ( sim -> cpus [ pcb -> cpuID ].realTimeReadyHeap , pcb );
+		return;
+	}
+
+	int priorityLevel = EffectivePriorityLevel ( pcb );
+	if ( !ValidPriorityLevel ( sim , priorityLevel ) ) {
+		return;
+	}
+
+	pcb -> processState = READY;
+	LIST* readyQueue = sim -> cpus [ pcb -> cpuID ].readyPriorityQueues [ priorityLevel ];
+	ListPrepend ( readyQueue , pcb );
+}
+
+/* WAITERS - the wait-for graph is read off state kept anyway: a SEM_BLOCKED process waits for every holder of
+ * its lock semaphore, a SEND_BLOCKED one for its recipient */
+void VisitWaiter ( OS_SIM *sim , PCB *waiter , PCB **searchTail ) 
+{
+	if ( waiter -> waitSearchID == sim -> lastWaitSearchID ) 
+	{
+		return;
+	}
+
+	waiter -> waitSearchID = sim -> lastWaitSearchID;
+	waiter -> waitSearchQueueNext = NULL;
+	( *searchTail ) -> waitSearchQueueNext = waiter;
+	*searchTail = waiter;
+}
+
+/* breadth first over the processes waiting on pcb, directly or through others - each is reached once and left
+ * queued behind pcb through waitSearchQueueNext */
+void SearchWaiters ( OS_SIM *sim , PCB *pcb ) 
+{
+	sim -> lastWaitSearchID += 1;
+	pcb -> waitSearchID = sim -> lastWaitSearchID;
+	pcb -> waitSearchQueueNext = NULL;
+
+	PCB *searchTail = pcb;
+	for ( PCB *expanded = pcb ; expanded ; expanded = expanded -> waitSearchQueueNext ) 
+	{
+		for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+		{
+			if ( expanded -> semaphoresHeld [ i ] == 0 ) 
+			{
+				continue;
+			}
+
+			// walks the links directly so the list cursor is never moved
+			for ( NODE *node = sim -> semaphores [ i ].blockedPCBs -> headNodePtr ; node ; node = node -> nextNodePtr ) 
+			{
+				VisitWaiter ( sim , node -> valuePtr , &searchTail );
+			}
+		}
+
+		for ( PCB *sender = expanded -> firstWaitingSender ; sender ; sender = sender -> nextWaitingSender ) 
+		{
+			VisitWaiter ( sim , sender , &searchTail );
+		}
+	}
+}
+
+/* PRIORITY INHERITANCE - a process holding a lock or owing a reply is queued at the most urgent level among the
+ * processes waiting on it, directly or through others, whenever that beats its own, so a process of a level in
+ * between cannot keep it, and with it them, off the CPU. The level is read off the waiters' own levels, so a cycle
+ * cannot keep a boost alive. Only a waiter more urgent than the process it waits for can change anything, and
+ * only then are that process and the ones it waits for recomputed */
+int LentPriorityLevel ( const PCB *waiter ) 
+{
+	return waiter -> schedulingClass == REAL_TIME_CLASS ? 0 : waiter -> priorityLevel;
+}
+
+/* the most urgent level among a process and everything waiting on it */
+int OfferedPriorityLevel ( const PCB *waiter ) 
+{
+	int priorityLevel = LentPriorityLevel ( waiter );
+	return waiter -> inheritedPriorityLevel < priorityLevel ? waiter -> inheritedPriorityLevel : priorityLevel;
+}
+
+int InheritablePriorityLevel ( OS_SIM *sim , PCB *pcb ) 
+{
+	int priorityLevel = NO_INHERITED_PRIORITY;
+	if ( pcb -> schedulingClass == REAL_TIME_CLASS ) 
+	{
+		return priorityLevel; // already ahead of every level
+	}
+
+	SearchWaiters ( sim , pcb );
+	for ( PCB *waiter = pcb -> waitSearchQueueNext ; waiter ; waiter = waiter -> waitSearchQueueNext ) 
+	{
+		if ( LentPriorityLevel ( waiter ) < priorityLevel ) 
+		{
+			priorityLevel = LentPriorityLevel ( waiter );
+		}
+	}
+
+	return priorityLevel < pcb -> priorityLevel ? priorityLevel : NO_INHERITED_PRIORITY;
+}
+
+/* the same for a process that waits for nothing, so none of its waiters can wait on it through another - each
+ * already offers what waits on it in turn, and nothing beats level 0 */
+int DirectlyInheritablePriorityLevel ( OS_SIM *sim , PCB *pcb ) 
+{
+	int priorityLevel = NO_INHERITED_PRIORITY;
+	for ( int i = 0 ; i < NUM_SEMAPHORES && priorityLevel > 0 ; i++ ) 
+	{
+		if ( pcb -> semaphoresHeld [ i ] == 0 ) 
+		{
+			continue;
+		}
+
+		for ( NODE *node = sim -> semaphores [ i ].blockedPCBs -> headNodePtr ; node && priorityLevel > 0 ; node = node -> nextNodePtr ) 
+		{
+			if ( OfferedPriorityLevel ( node -> valuePtr ) < priorityLevel ) 
+			{
+				priorityLevel = OfferedPriorityLevel ( node -> valuePtr );
+			}
+		}
+	}
+
+	for ( PCB *sender = pcb -> firstWaitingSender ; sender && priorityLevel > 0 ; sender = sender -> nextWaitingSender ) 
+	{
+		if ( OfferedPriorityLevel ( sender ) < priorityLevel ) 
+		{
+			priorityLevel = OfferedPriorityLevel ( sender );
+		}
+	}
+
+	return priorityLevel < pcb -> priorityLevel ? priorityLevel : NO_INHERITED_PRIORITY;
+}
+
+/* a ready process whose level changed moves to the back of its new level on the same CPU, keeping its ready tick */
+void RequeueReadyProcess ( OS_SIM *sim , PCB *pcb , int prevPriorityLevel ) 
+{
+	int priorityLevel = EffectivePriorityLevel ( pcb );
+	if ( pcb -> processState != READY || pcb -> schedulingClass == REAL_TIME_CLASS || priorityLevel == prevPriorityLevel ) 
+	{
+		return;
+	}
+
+	LIST **readyQueues = sim -> cpus [ pcb -> cpuID ].readyPriorityQueues;
+	if ( RemoveProcessFromQueue ( pcb -> processID , readyQueues [ prevPriorityLevel ] ) ) 
+	{
+		ListPrepend ( readyQueues [ priorityLevel ] , pcb );
+	}
+}
+
+void SetInheritedPriorityLevel ( OS_SIM *sim , PCB *pcb , int inheritedPriorityLevel ) 
+{
+	int prevPriorityLevel = EffectivePriorityLevel ( pcb );
+	pcb -> inheritedPriorityLevel = inheritedPriorityLevel;
+
+	int priorityLevel = EffectivePriorityLevel ( pcb );
+	if ( priorityLevel == prevPriorityLevel ) 
+	{
+		return;
+	}
+
+	RequeueReadyProcess ( sim , pcb , prevPriorityLevel );
+	if ( priorityLevel < prevPriorityLevel ) 
+	{
+		sim -> numPriorityBoosts += 1;
+	}
+
+	EmitEvent ( sim , OSSIM_EVENT_PRIORITY_INHERITED , pcb -> cpuID , pcb , NULL , prevPriorityLevel , priorityLevel );
+}
+
+void VisitWaitedFor ( OS_SIM *sim , PCB *pcb , PCB **updateTail ) 
+{
+	if ( pcb -> inheritanceUpdateID == sim -> lastInheritanceUpdateID ) 
+	{
+		return;
+	}
+
+	pcb -> inheritanceUpdateID = sim -> lastInheritanceUpdateID;
+	pcb -> inheritanceUpdateQueueNext = NULL;
+	( *updateTail ) -> inheritanceUpdateQueueNext = pcb;
+	*updateTail = pcb;
+}
+
+/* recomputes pcb and every process it waits for, directly or through others - the only processes whose waiters
+ * change when pcb gains or loses one, or starts or stops waiting itself */
+void UpdateInheritedPriorities ( OS_SIM *sim , PCB *pcb ) 
+{
+	sim -> lastInheritanceUpdateID += 1;
+	pcb -> inheritanceUpdateID = sim -> lastInheritanceUpdateID;
+	pcb -> inheritanceUpdateQueueNext = NULL;
+
+	PCB *updateTail = pcb;
+	for ( PCB *updated = pcb ; updated ; updated = updated -> inheritanceUpdateQueueNext ) 
+	{
+		SetInheritedPriorityLevel ( sim , updated , InheritablePriorityLevel ( sim , updated ) );
+
+		if ( updated -> processState == SEM_BLOCKED ) 
+		{
+			int semaphoreID = updated -> blockedSemaphoreID;
+			for ( PCB *holder = sim -> semaphores [ semaphoreID ].firstHolder ; holder ; holder = holder -> nextHolder [ semaphoreID ] ) 
+			{
+				VisitWaitedFor ( sim , holder , &updateTail );
+			}
+		}
+		else if ( updated -> processState == SEND_BLOCKED && updated -> sendRecipient ) 
+		{
+			VisitWaitedFor ( sim , updated -> sendRecipient , &updateTail );
+		}
+	}
+}
+
+/* a waiter offering offeredPriorityLevel started or stopped waiting on pcb - every process pcb waits for has pcb
+ * itself as a waiter, so unless the waiter is more urgent than pcb no level changes anywhere */
+void WaiterChanged ( OS_SIM *sim , PCB *pcb , int offeredPriorityLevel ) 
+{
+	if ( offeredPriorityLevel < LentPriorityLevel ( pcb ) ) 
+	{
+		UpdateInheritedPriorities ( sim , pcb );
+	}
+}
+
+void WaiterChangedAtHolders ( OS_SIM *sim , int semaphoreID , int offeredPriorityLevel ) 
+{
+	for ( PCB *holder = sim -> semaphores [ semaphoreID ].firstHolder ; holder ; holder = holder -> nextHolder [ semaphoreID ] ) 
+	{
+		WaiterChanged ( sim , holder , offeredPriorityLevel );
+	}
+}
+
+/* a process handed a lock becomes what the processes still queued on it wait for - none of them offers more than
+ * waitersPriorityLevel, so unless that beats the process the queue is not walked */
+void InheritFromLockWaiters ( OS_SIM *sim , PCB *pcb , int semaphoreID , int waitersPriorityLevel ) 
+{
+	if ( waitersPriorityLevel >= LentPriorityLevel ( pcb ) ) 
+	{
+		return;
+	}
+
+	int offeredPriorityLevel = NO_INHERITED_PRIORITY;
+	for ( NODE *node = sim -> semaphores [ semaphoreID ].blockedPCBs -> headNodePtr ; node ; node = node -> nextNodePtr ) 
+	{
+		if ( OfferedPriorityLevel ( node -> valuePtr ) < offeredPriorityLevel ) 
+		{
+			offeredPriorityLevel = OfferedPriorityLevel ( node -> valuePtr );
+		}
+	}
+
+	WaiterChanged ( sim , pcb , offeredPriorityLevel );
+}
+
+void UpdateProcessPriorityLevel ( OS_SIM *sim , PCB *process ) 
+{
+	if ( !process || process -> schedulingClass == REAL_TIME_CLASS ) 
+	{
+		return;
+	}
+
+	if ( sim -> agingPolicy == NO_AGING || sim -> numPriorityLevels == 1 ) 
+	{
+		return;
+	}
+
+	process -> numCPUBurstsInPriorityLevel += 1;
+	if ( process -> numCPUBurstsInPriorityLevel < sim -> maxCPUBursts ) 
+	{
+		return;
+	}
+
+	if ( process -> priorityLevel == sim -> numPriorityLevels - 1 && sim -> agingPolicy == DEMOTE_ONLY_AGING ) 
+	{
+		process -> numCPUBurstsInPriorityLevel = 0;
+		return;
+	}
+
+	if ( process -> priorityLevel == sim -> numPriorityLevels - 1 ) 
+	{
+		process -> priorityDirection = PROMOTING;
+	}
+	else if ( process -> priorityLevel == 0 ) 
+	{
+		process -> priorityDirection = DEMOTING;
+	}
+
+	int prevPriorityLevel = process -> priorityLevel;
+	if ( process -> priorityDirection == PROMOTING ) 
+	{
+		process -> priorityLevel -= 1;
+		sim -> numPromotions += 1;
+		EmitEvent ( sim , OSSIM_EVENT_PROMOTED , process -> cpuID , process , NULL , prevPriorityLevel , process -> priorityLevel );
+	}
+	else if ( process -> priorityDirection == DEMOTING ) 
+	{
+		process -> priorityLevel += 1;
+		sim -> numDemotions += 1;
+		EmitEvent ( sim , OSSIM_EVENT_DEMOTED , process -> cpuID , process , NULL , prevPriorityLevel , process -> priorityLevel );
+	}
+
+	process -> numCPUBurstsInPriorityLevel = 0;
+	// a boost only counts while it beats the process's own level - promoted it keeps one still ahead, demoted it
+	// keeps the one it had or looks for one. It was running, so it waits for nothing and lends to no one
+	if ( process -> priorityLevel < prevPriorityLevel && process -> inheritedPriorityLevel >= process -> priorityLevel ) 
+	{
+		SetInheritedPriorityLevel ( sim , process , NO_INHERITED_PRIORITY );
+	}
+	else if ( process -> priorityLevel > prevPriorityLevel && process -> inheritedPriorityLevel == NO_INHERITED_PRIORITY ) 
+	{
+		SetInheritedPriorityLevel ( sim , process , DirectlyInheritablePriorityLevel ( sim , process ) );
+	}
+}
+
+void ScheduleNextRealTimeJob ( OS_SIM *sim , PCB *process ) 
+{
+	process -> releaseTick += process -> period;
+	process -> absoluteDeadline = process -> releaseTick + process -> relativeDeadline;
+	process -> remainingBudget = process -> budget;
+
+	if ( process -> releaseTick <= sim -> currentTick ) 
+	{
+		AddToReadyQueue ( sim , process );
+		return;
+	}
+
+	process -> processState = PERIOD_WAITING;
+	HeapPush ( sim -> realTimeReleaseHeap , process );
+}
+
+void ChargeRealTimeBudget ( OS_SIM *sim , PCB *process ) 
+{
+	process -> remainingBudget -= 1;
+	if ( process -> remainingBudget > 0 ) 
+	{
+		AddToReadyQueue ( sim , process );
+		return;
+	}
+
+	process -> numJobsCompleted += 1;
+	ScheduleNextRealTimeJob ( sim , process );
+}
+
+void ReleaseRealTimeJobs ( OS_SIM *sim ) 
+{
+	PCB *nextReleased = HeapPeek ( sim -> realTimeReleaseHeap );
+	while ( nextReleased && nextReleased -> releaseTick <= sim -> currentTick ) 
+	{
+		HeapPop ( sim -> realTimeReleaseHeap );
+		AddToReadyQueue ( sim , nextReleased );
+
+		nextReleased = HeapPeek ( sim -> realTimeReleaseHeap );
+	}
+}
+
+void CheckRealTimeDeadlineMisses ( OS_SIM *sim , CPU *cpu ) 
+{
+	PCB *earliestDeadline = HeapPeek ( cpu -> realTimeReadyHeap );
+	while ( earliestDeadline && earliestDeadline -> absoluteDeadline <= sim -> currentTick ) 
+	{
+		HeapPop ( cpu -> realTimeReadyHeap );
+		earliestDeadline -> numDeadlineMisses += 1;
+		sim -> totalDeadlineMisses += 1;
+
+		EmitEvent ( sim , OSSIM_EVENT_DEADLINE_MISSED , cpu -> cpuID , earliestDeadline , NULL , earliestDeadline -> absoluteDeadline , 0 );
+
+		ScheduleNextRealTimeJob ( sim , earliestDeadline ); // the late job is dropped
+		earliestDeadline = HeapPeek ( cpu -> realTimeReadyHeap );
+	}
+}
+
+PCB *FindMigratableProcess ( OS_SIM *sim , CPU *cpu , CPU *toCPU , int detach ) 
+{
+	for ( int i = 0 ; i < sim -> numPriorityLevels ; i++ ) 
+	{
+		LIST *readyQueue = cpu -> readyPriorityQueues [ i ];
+		PCB *migratableProcess = ListSearch ( readyQueue , &AllowedOnCPU , toCPU ); // from LAST TO RUN, least likely to still be cache-warm
+		if ( migratableProcess && detach ) 
+		{
+			ListRemove ( readyQueue );
+		}
+
+		if ( migratableProcess ) 
+		{
+			return migratableProcess;
+		}
+	}
+
+	if ( detach ) 
+	{
+		return HeapRemove ( cpu -> realTimeReadyHeap , &AllowedOnCPU , toCPU );
+	}
+
+	return HeapSearch ( cpu -> realTimeReadyHeap , &AllowedOnCPU , toCPU );
+}
+
+CPU *StealVictimCPU ( OS_SIM *sim , CPU *idleCPU ) 
+{
+	for ( enum CPU_DISTANCE distance = SHARED_CACHE ; distance < NUM_CPU_DISTANCES ; distance++ ) 
+	{
+		CPU *victimCPU = NULL;
+		for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+		{
+			CPU *cpu = &sim -> cpus [ i ];
+			if ( CPUDistance ( cpu , idleCPU ) != distance || !FindMigratableProcess ( sim , cpu , idleCPU , 0 ) ) 
+			{
+				continue;
+			}
+
+			if ( !victimCPU || CPUReadyCount ( sim , cpu ) > CPUReadyCount ( sim , victimCPU ) ) 
+			{
+				victimCPU = cpu;
+			}
+		}
+
+		if ( victimCPU ) 
+		{
+			return victimCPU; // closest CPUs are stolen from first to keep caches warm
+		}
+	}
+
+	return NULL;
+}
+
+PCB *StealProcess ( OS_SIM *sim , CPU *idleCPU ) 
+{
+	CPU *victimCPU = StealVictimCPU ( sim , idleCPU );
+	if ( !victimCPU ) 
+	{
+		return NULL;
+	}
+
+	PCB *stolenProcess = FindMigratableProcess ( sim , victimCPU , idleCPU , 1 );
+	MigrateProcess ( sim , stolenProcess , victimCPU , idleCPU );
+	idleCPU -> numSteals += 1;
+
+	EmitEvent ( sim , OSSIM_EVENT_STOLEN , idleCPU -> cpuID , stolenProcess , NULL , victimCPU -> cpuID , idleCPU -> cpuID );
+
+	return stolenProcess;
+}
+
+void BalanceLoad ( OS_SIM *sim ) 
+{
+	while ( sim -> numCPUs > 1 ) 
+	{
+		CPU *busiestCPU = &sim -> cpus [ 0 ];
+		for ( int i = 1 ; i < sim -> numCPUs ; i++ ) 
+		{
+			CPU *cpu = &sim -> cpus [ i ];
+			if ( CPULoad ( sim , cpu ) > CPULoad ( sim , busiestCPU ) ) 
+			{
+				busiestCPU = cpu;
+			}
+		}
+
+		CPU *idlestCPU = busiestCPU;
+		for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+		{
+			CPU *cpu = &sim -> cpus [ i ];
+			if ( CPULoad ( sim , cpu ) < CPULoad ( sim , idlestCPU ) ) 
+			{
+				idlestCPU = cpu;
+			}
+			else if ( CPULoad ( sim , cpu ) == CPULoad ( sim , idlestCPU ) && 
+				CPUDistance ( cpu , busiestCPU ) < CPUDistance ( idlestCPU , busiestCPU ) ) 
+			{
+				idlestCPU = cpu;
+			}
+		}
+
+		int imbalanced = CPULoad ( sim , busiestCPU ) - CPULoad ( sim , idlestCPU ) > 1;
+		if ( !imbalanced ) 
+		{
+			return;
+		}
+
+		PCB *movedProcess = FindMigratableProcess ( sim , busiestCPU , idlestCPU , 1 );
+		if ( !movedProcess ) 
+		{
+			return;
+		}
+
+		MigrateProcess ( sim , movedProcess , busiestCPU , idlestCPU );
+		AddToReadyQueue ( sim , movedProcess );
+
+		EmitEvent ( sim , OSSIM_EVENT_LOAD_BALANCED , idlestCPU -> cpuID , movedProcess , NULL , busiestCPU -> cpuID , idlestCPU -> cpuID );
+	}
+}
+
+int ConsumeWarmUpBurst ( CPU *cpu , PCB *process ) 
+{
+	if ( process -> warmUpBurstsLeft <= 0 ) 
+	{
+		return 0;
+	}
+
+	process -> warmUpBurstsLeft -= 1;
+	cpu -> numWarmUpBursts += 1;
+	return 1;
+}
+
+void RunNextProcess ( OS_SIM *sim , CPU *cpu ) 
+{
+	PCB *prevProcess = cpu -> runningProcess;
+	int runningProcIsAlive = prevProcess != NULL;
+
+	if ( runningProcIsAlive && prevProcess -> processID == INIT_PROCESS_ID ) 
+	{
+		sim -> initProcess.processState = READY;
+		sim -> initProcess.numCPUBurstsInPriorityLevel += 1;
+	}
+	else if ( runningProcIsAlive && ConsumeWarmUpBurst ( cpu , prevProcess ) ) 
+	{
+		UpdateProcessPriorityLevel ( sim , prevProcess ); // a REAL-TIME job makes no progress while warming up
+		AddToReadyQueue ( sim , prevProcess );
+	}
+	else if ( runningProcIsAlive && prevProcess -> schedulingClass == REAL_TIME_CLASS ) 
+	{
+		ChargeRealTimeBudget ( sim , prevProcess );
+	}
+	else if ( runningProcIsAlive )
+	{
+		UpdateProcessPriorityLevel ( sim , prevProcess );
+		AddToReadyQueue ( sim , prevProcess );
+	}
+
+	ReleaseRealTimeJobs ( sim );
+	CheckRealTimeDeadlineMisses ( sim , cpu );
+
+	cpu -> runningProcess = NULL;
+	if ( HeapCount ( cpu -> realTimeReadyHeap ) > 0 ) 
+	{
+		cpu -> runningProcess = HeapPop ( cpu -> realTimeReadyHeap ); // real-time class pre-empts every priority level
+	}
+
+	for ( int i = 0 ; i < sim -> numPriorityLevels && !cpu -> runningProcess ; i++ ) {
+		LIST *readyQueue = cpu -> readyPriorityQueues [ i ];
+		if ( ListCount ( readyQueue ) > 0 ) {
+			cpu -> runningProcess = ListTrim ( readyQueue );
+			break;
+		}
+	}
+
+	if ( !cpu -> runningProcess ) {
+		cpu -> runningProcess = StealProcess ( sim , cpu );
+	}
+
+	if ( !cpu -> runningProcess ) {
+		cpu -> runningProcess = &sim -> initProcess;
+		sim -> initProcess.processState = RUNNING;
+	}
+	else 
+	{
+		int readyWaitTicks = sim -> currentTick - cpu -> runningProcess -> readyTick;
+		sim -> numDispatches += 1;
+		sim -> totalReadyWaitTicks += readyWaitTicks;
+		if ( readyWaitTicks > sim -> maxReadyWaitTicks ) 
+		{
+			sim -> maxReadyWaitTicks = readyWaitTicks;
+		}
+	}
+
+	cpu -> runningProcess -> processState = RUNNING;
+	if ( cpu -> runningProcess != prevProcess ) 
+	{
+		cpu -> numContextSwitches += 1;
+	}
+
+	EmitEvent ( sim , OSSIM_EVENT_DISPATCHED , cpu -> cpuID , cpu -> runningProcess , NULL , 0 , 0 );
+
+	MESSAGE *receivedMessage = cpu -> runningProcess -> readMessage;
+	if ( receivedMessage ) 
+	{
+		EmitEvent ( sim , OSSIM_EVENT_MESSAGE_DELIVERED , cpu -> cpuID , cpu -> runningProcess , receivedMessage , 0 , 0 );
+
+		FreeMessage ( receivedMessage );
+		cpu -> runningProcess -> readMessage = NULL;
+	}
+}
+
+void KickIdleCPUs ( OS_SIM *sim ) 
+{
+	if ( sim -> inBatch ) 
+	{
+		sim -> idleCPUKickDeferred = 1;
+		return;
+	}
+
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		int cpuIsIdle = cpu -> runningProcess && cpu -> runningProcess -> processID == INIT_PROCESS_ID;
+		if ( cpuIsIdle && ( CPUReadyCount ( sim , cpu ) > 0 || StealVictimCPU ( sim , cpu ) ) ) 
+		{
+			RunNextProcess ( sim , cpu );
+		}
+	}
+}
+
+/* a command made work for cpu - INIT gives way to it now, or once the batch ends */
+void DispatchIfIdle ( OS_SIM *sim , CPU *cpu ) 
+{
+	if ( sim -> inBatch ) 
+	{
+		sim -> deferredDispatchMask |= 1u << cpu -> cpuID;
+	}
+	else if ( cpu -> runningProcess -> processID == INIT_PROCESS_ID ) 
+	{
+		RunNextProcess ( sim , cpu );
+	}
+}
+
+/* the reschedule every command of the batch would have done on its own, done once */
+void RunDeferredDispatches ( OS_SIM *sim ) 
+{
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		if ( ( sim -> deferredDispatchMask & ( 1u << i ) ) && cpu -> runningProcess -> processID == INIT_PROCESS_ID ) 
+		{
+			RunNextProcess ( sim , cpu );
+		}
+	}
+
+	sim -> deferredDispatchMask = 0;
+	if ( sim -> idleCPUKickDeferred ) 
+	{
+		sim -> idleCPUKickDeferred = 0;
+		KickIdleCPUs ( sim );
+	}
+}
+
+OS_SIM *OSSimCreate () 
+{
+	OS_SIM *sim = ( OS_SIM *) calloc ( 1 , sizeof ( OS_SIM ) );
+	if ( !sim ) 
+	{
+		return NULL;
+	}
+
+	sim -> numCPUs = 1;
+	sim -> numNodes = 1;
+	sim -> numCPUsPerCache = 1;
+	sim -> currentCPU = &sim -> cpus [ 0 ];
+	sim -> numPriorityLevels = NUM_PRIORITY_LEVELS;
+	sim -> maxCPUBursts = MAX_CPU_BURSTS;
+	sim -> agingPolicy = BOUNCE_AGING;
+	sim -> initProcess = INIT_PROCESS;
+	sim -> nextAvailProcessID = INIT_PROCESS_ID + 1;
+	sim -> outputFile = NULL;
+
+	return sim;
+}
+
+int ValidConfiguration ( OS_SIM *sim ) 
+{
+	int validNumCPUs = sim -> numCPUs >= 1 && sim -> numCPUs <= MAX_NUM_CPUS;
+	int validNumNodes = sim -> numNodes >= 1 && validNumCPUs && sim -> numCPUs % sim -> numNodes == 0;
+	int validNumCPUsPerCache = sim -> numCPUsPerCache >= 1 && validNumNodes && ( sim -> numCPUs / sim -> numNodes ) % sim -> numCPUsPerCache == 0;
+	int validNumPriorityLevels = sim -> numPriorityLevels >= 1 && sim -> numPriorityLevels <= MAX_NUM_PRIORITY_LEVELS;
+	int validAgingPolicy = sim -> agingPolicy >= BOUNCE_AGING && sim -> agingPolicy <= NO_AGING;
+	return validNumCPUsPerCache && validNumPriorityLevels && validAgingPolicy && sim -> maxCPUBursts >= 1;
+}
+
+int OSSimStart ( OS_SIM *sim ) 
+{
+	if ( !sim ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	if ( !ValidConfiguration ( sim ) ) 
+	{
+		return OSSIM_INVALID_CONFIG;
+	}
+
+	InitAllLists ( sim );
+
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		RunNextProcess ( sim , &sim -> cpus [ i ] );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* frees every process, message and heap, the instance itself is left for the caller */
+void FreeSimState ( OS_SIM *sim ) 
+{
+	if ( sim -> realTimeReleaseHeap ) 
+	{
+		for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+		{
+			PCB *runningProcess = sim -> cpus [ i ].runningProcess;
+			if ( runningProcess && runningProcess != &sim -> initProcess ) 
+			{
+				FreePCB ( runningProcess );
+			}
+		}
+
+		FreeAllLists ( sim );
+	}
+
+	FreeMessage ( sim -> initProcess.readMessage );
+	sim -> initProcess.readMessage = NULL;
+}
+
+void OSSimFree ( OS_SIM *sim ) 
+{
+	if ( !sim ) 
+	{
+		return;
+	}
+
+	FreeSimState ( sim );
+	free ( sim );
+}
+
+int SystemRunning ( OS_SIM *sim ) 
+{
+	return sim && sim -> currentCPU && sim -> currentCPU -> runningProcess;
+}
+
+PCB *AllocateProcess ( OS_SIM *sim , int priorityLevel ) 
+{
+	PCB *newProcess = ( PCB *) malloc ( sizeof ( PCB ) );
+	if ( !newProcess ) 
+	{
+		return NULL;
+	}
+
+	newProcess -> processID = sim -> nextAvailProcessID;
+	newProcess -> priorityLevel = priorityLevel;
+	newProcess -> processState = READY;
+	newProcess -> numCPUBurstsInPriorityLevel = 0;
+	newProcess -> readMessage = NULL;
+	newProcess -> affinityMask = ALL_CPUS_AFFINITY_MASK;
+	newProcess -> cpuID = LeastLoadedCPU ( sim , newProcess , sim -> currentCPU ) -> cpuID;
+	newProcess -> numMigrations = 0;
+	newProcess -> numCrossNodeMigrations = 0;
+	newProcess -> warmUpBurstsLeft = 0;
+	newProcess -> schedulingClass = NORMAL_CLASS;
+	newProcess -> period = 0;
+	newProcess -> relativeDeadline = 0;
+	newProcess -> budget = 0;
+	newProcess -> remainingBudget = 0;
+	newProcess -> releaseTick = 0;
+	newProcess -> absoluteDeadline = 0;
+	newProcess -> numJobsCompleted = 0;
+	newProcess -> numDeadlineMisses = 0;
+	newProcess -> readyTick = sim -> currentTick;
+	newProcess -> groupID = NO_PROCESS_GROUP;
+	newProcess -> nextInGroup = NULL;
+	newProcess -> prevInGroup = NULL;
+	newProcess -> parentProcessID = INIT_PROCESS_ID;
+	newProcess -> parent = NULL;
+	newProcess -> firstChild = NULL;
+	newProcess -> lastChild = NULL;
+	newProcess -> nextSibling = NULL;
+	newProcess -> prevSibling = NULL;
+	newProcess -> numChildren = 0;
+	newProcess -> numZombieChildren = 0;
+	newProcess -> exitStatus = 0;
+	newProcess -> waitedChildID = INIT_PROCESS_ID;
+	newProcess -> waitedExitStatus = 0;
+	newProcess -> addressSpace = NULL;
+	memset ( newProcess -> semaphoresHeld , 0 , sizeof ( newProcess -> semaphoresHeld ) );
+	memset ( newProcess -> holdSequence , 0 , sizeof ( newProcess -> holdSequence ) );
+	newProcess -> blockedSemaphoreID = 0;
+	newProcess -> sendRecipientID = INIT_PROCESS_ID;
+	newProcess -> sendRecipient = NULL;
+	newProcess -> firstWaitingSender = NULL;
+	newProcess -> nextWaitingSender = NULL;
+	newProcess -> prevWaitingSender = NULL;
+	memset ( newProcess -> nextHolder , 0 , sizeof ( newProcess -> nextHolder ) );
+	memset ( newProcess -> prevHolder , 0 , sizeof ( newProcess -> prevHolder ) );
+	newProcess -> inheritedPriorityLevel = NO_INHERITED_PRIORITY;
+	newProcess -> waitSearchID = 0;
+	newProcess -> waitSearchNext = NULL;
+	newProcess -> waitSearchQueueNext = NULL;
+	newProcess -> inheritanceUpdateID = 0;
+	newProcess -> inheritanceUpdateQueueNext = NULL;
+
+	if ( newProcess -> priorityLevel == sim -> numPriorityLevels - 1 ) 
+	{
+		newProcess -> priorityDirection = PROMOTING;
+	}
+	else 
+	{
+		newProcess -> priorityDirection = DEMOTING;
+	}
+
+	sim -> nextAvailProcessID++;
+	sim -> numLiveProcesses += 1;
+	return newProcess;
+}
+
+int NewProcess ( OS_SIM *sim , int priorityLevel , PCB **newProcess ) 
+{
+	if ( !ValidPriorityLevel ( sim , priorityLevel ) ) {
+		return OSSIM_INVALID_PRIORITY;
+	}
+
+	*newProcess = AllocateProcess ( sim , priorityLevel );
+	if ( !*newProcess ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int NewRealTimeProcess ( OS_SIM *sim , int period , int relativeDeadline , int budget , PCB **newProcess ) 
+{
+	if ( period <= 0 || budget <= 0 || relativeDeadline < budget || relativeDeadline > period ) 
+	{
+		return OSSIM_INVALID_REAL_TIME_PARAMS;
+	}
+
+	if ( sim -> numRealTimeProcesses >= MAX_REAL_TIME_PROCESSES ) 
+	{
+		return OSSIM_TOO_MANY_REAL_TIME_PROCESSES;
+	}
+
+	PCB *process = AllocateProcess ( sim , REAL_TIME_PRIORITY_LEVEL );
+	if ( !process ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	process -> schedulingClass = REAL_TIME_CLASS;
+	process -> period = period;
+	process -> relativeDeadline = relativeDeadline;
+	process -> budget = budget;
+	process -> remainingBudget = budget;
+	process -> releaseTick = sim -> currentTick;
+	process -> absoluteDeadline = sim -> currentTick + relativeDeadline;
+
+	sim -> numRealTimeProcesses += 1;
+	*newProcess = process;
+	return OSSIM_SUCCESS;
+}
+
+void AdmitNewProcess ( OS_SIM *sim , PCB *newProcess , int *newProcessID ) 
+{
+	AddToReadyQueue ( sim , newProcess );
+	EmitEvent ( sim , OSSIM_EVENT_PROCESS_CREATED , newProcess -> cpuID , newProcess , NULL , 0 , 0 );
+
+	if ( newProcessID ) 
+	{
+		*newProcessID = newProcess -> processID;
+	}
+
+	DispatchIfIdle ( sim , sim -> currentCPU );
+	KickIdleCPUs ( sim );
+}
+
+int OSSimCreateProcess ( OS_SIM *sim , int priorityLevel , int *newProcessID ) {
+	return OSSimCreateProcessInGroup ( sim , priorityLevel , NO_PROCESS_GROUP , newProcessID );
+}
+
+int OSSimCreateProcessInGroup ( OS_SIM *sim , int priorityLevel , int groupID , int *newProcessID ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( groupID != NO_PROCESS_GROUP && !ValidGroupID ( groupID ) ) 
+	{
+		return OSSIM_INVALID_GROUP;
+	}
+
+	PCB *newProcess = NULL;
+	int status = NewProcess ( sim , priorityLevel , &newProcess );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	if ( groupID != NO_PROCESS_GROUP ) 
+	{
+		JoinProcessGroup ( sim , newProcess , groupID );
+	}
+
+	AdmitNewProcess ( sim , newProcess , newProcessID );
+	return OSSIM_SUCCESS;
+}
+
+int OSSimCreateRealTimeProcess ( OS_SIM *sim , int period , int relativeDeadline , int budget , int *newProcessID ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	PCB *newProcess = NULL;
+	int status = NewRealTimeProcess ( sim , period , relativeDeadline , budget , &newProcess );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	AdmitNewProcess ( sim , newProcess , newProcessID );
+	return OSSIM_SUCCESS;
+}
+
+void QuantumExpired ( OS_SIM *sim ) 
+{
+	sim -> currentTick += 1;
+
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		if ( cpu -> runningProcess -> processID == INIT_PROCESS_ID ) 
+		{
+			cpu -> numIdleTicks += 1;
+		}
+		else 
+		{
+			cpu -> numBusyTicks += 1;
+		}
+
+		if ( EffectivePriorityLevel ( cpu -> runningProcess ) < cpu -> runningProcess -> priorityLevel ) 
+		{
+			sim -> numBoostedRunTicks += 1;
+		}
+	}
+
+	if ( sim -> currentTick % LOAD_BALANCE_INTERVAL == 0 ) 
+	{
+		BalanceLoad ( sim );
+	}
+
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		RunNextProcess ( sim , &sim -> cpus [ i ] );
+	}
+}
+
+PCB *FindProcessFromQueue ( int processID , LIST *queue ) 
+{
+	if ( !queue ) {
+		return NULL;
+	} 
+
+	ListFirst ( queue );
+	PCB *foundProcess = ( PCB *) ListSearch ( queue , &EqualsProcessID , &processID );
+	if ( !foundProcess ) {
+		return NULL;
+	}
+
+	return foundProcess;
+}
+
+PCB *FindAndRemoveProcessFromAllQueues ( OS_SIM *sim , int processID ) 
+{
+	PCB *foundProcess = RemoveProcessFromQueue ( processID , sim -> sendBlockedQueue );
+	
+	if ( !foundProcess ) 
+	{
+		foundProcess = RemoveProcessFromQueue ( processID , sim -> receiveBlockedQueue );
+	}
+
+	if ( !foundProcess ) 
+	{
+		foundProcess = RemoveProcessFromQueue ( processID , sim -> waitBlockedQueue );
+	}
+
+	for ( int i = 0 ; i < sim -> numCPUs && !foundProcess ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		for ( int j = 0 ; j < sim -> numPriorityLevels && !foundProcess ; j++ ) 
+		{
+			LIST *readyQueue = cpu -> readyPriorityQueues [ j ];
+			foundProcess = RemoveProcessFromQueue ( processID , readyQueue );
+		}
+
+		if ( !foundProcess ) 
+		{
+			foundProcess = HeapRemove ( cpu -> realTimeReadyHeap , &EqualsProcessID , &processID );
+		}
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES && !foundProcess ; i++ ) 
+	{
+		SEMAPHORE *semaphore = &sim -> semaphores [ i ];
+		LIST *blockedQueue = semaphore -> blockedPCBs;
+		foundProcess = RemoveProcessFromQueue ( processID , blockedQueue );
+	}
+
+	if ( !foundProcess ) 
+	{
+		foundProcess = HeapRemove ( sim -> realTimeReleaseHeap , &EqualsProcessID , &processID );
+	}
+
+	return foundProcess;
+}
+
+PCB *FindProcessFromAllQueues ( OS_SIM *sim , int processID ) 
+{
+	PCB *foundProcess = FindProcessFromQueue ( processID , sim -> sendBlockedQueue );
+	
+	if ( !foundProcess ) 
+	{
+		foundProcess = FindProcessFromQueue ( processID , sim -> receiveBlockedQueue );
+	}
+
+	if ( !foundProcess ) 
+	{
+		foundProcess = FindProcessFromQueue ( processID , sim -> waitBlockedQueue );
+	}
+
+	for ( int i = 0 ; i < sim -> numCPUs && !foundProcess ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		for ( int j = 0 ; j < sim -> numPriorityLevels && !foundProcess ; j++ ) 
+		{
+			LIST *readyQueue = cpu -> readyPriorityQueues [ j ];
+			foundProcess = FindProcessFromQueue ( processID , readyQueue );
+		}
+
+		if ( !foundProcess ) 
+		{
+			foundProcess = HeapSearch ( cpu -> realTimeReadyHeap , &EqualsProcessID , &processID );
+		}
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES && !foundProcess ; i++ ) 
+	{
+		SEMAPHORE *semaphore = &sim -> semaphores [ i ];
+		LIST *blockedQueue = semaphore -> blockedPCBs;
+		foundProcess = FindProcessFromQueue ( processID , blockedQueue );
+	}
+
+	if ( !foundProcess ) 
+	{
+		foundProcess = HeapSearch ( sim -> realTimeReleaseHeap , &EqualsProcessID , &processID );
+	}
+
+	return foundProcess;
+}
+
+CPU *CPURunningProcess ( OS_SIM *sim , int processID ) 
+{
+	if ( processID == INIT_PROCESS_ID ) 
+	{
+		return NULL;
+	}
+
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		if ( cpu -> runningProcess && cpu -> runningProcess -> processID == processID ) 
+		{
+			return cpu;
+		}
+	}
+
+	return NULL;
+}
+
+int ProcessExistsInQueue ( int processID , LIST *queue ) 
+{
+	if ( !queue ) {
+		return 0;
+	} 
+
+	ListFirst ( queue );
+	PCB *foundProcess = ( PCB *) ListSearch ( queue , &EqualsProcessID , &processID );
+	if ( !foundProcess ) {
+		return 0;
+	}
+
+	return 1;
+}
+
+PCB *FindLiveProcess ( OS_SIM *sim , int processID ) 
+{
+	if ( processID == INIT_PROCESS_ID ) 
+	{
+		return &sim -> initProcess;
+	}
+
+	CPU *runningCPU = CPURunningProcess ( sim , processID );
+	if ( runningCPU ) 
+	{
+		return runningCPU -> runningProcess;
+	}
+
+	return FindProcessFromAllQueues ( sim , processID );
+}
+
+/* a retired process with a live parent is kept as ZOMBIE until it is waited for, unless the parent is waiting already */
+void RetireProcess ( OS_SIM *sim , PCB *pcb , int exitStatus ) 
+{
+	LeaveProcessGroup ( sim , pcb );
+
+	// it is already out of its queue, so only a recipient still counts it as a waiter until the edges go
+	PCB *recipient = pcb -> sendRecipient;
+	int offeredPriorityLevel = OfferedPriorityLevel ( pcb );
+	ReleaseWaitForEdges ( pcb );
+	ReleaseLockSemaphores ( sim , pcb );
+	pcb -> inheritedPriorityLevel = NO_INHERITED_PRIORITY;
+	if ( recipient ) 
+	{
+		WaiterChanged ( sim , recipient , offeredPriorityLevel );
+	}
+	else if ( pcb -> processState == SEM_BLOCKED ) 
+	{
+		WaiterChangedAtHolders ( sim , pcb -> blockedSemaphoreID , offeredPriorityLevel );
+	}
+
+	if ( pcb -> schedulingClass == REAL_TIME_CLASS ) 
+	{
+		sim -> numRealTimeProcesses -= 1;
+	}
+
+	sim -> numLiveProcesses -= 1;
+	sim -> numZombieProcesses -= pcb -> numZombieChildren;
+	ReleaseChildren ( pcb );
+	pcb -> exitStatus = exitStatus;
+
+	PCB *parent = pcb -> parent;
+	if ( !parent ) 
+	{
+		FreePCB ( pcb );
+		return;
+	}
+
+	if ( parent -> processState == WAIT_BLOCKED && RemoveProcessFromQueue ( parent -> processID , sim -> waitBlockedQueue ) ) 
+	{
+		parent -> waitedChildID = pcb -> processID;
+		parent -> waitedExitStatus = exitStatus;
+		EmitEvent ( sim , OSSIM_EVENT_UNBLOCKED , parent -> cpuID , parent , NULL , WAIT_BLOCKED , pcb -> processID );
+
+		AddToReadyQueue ( sim , parent ); // dispatched by the caller's reschedule, its CPU may have no running process yet
+		FreePCB ( pcb );
+		return;
+	}
+
+	FreeMessage ( pcb -> readMessage );
+	pcb -> readMessage = NULL;
+	ReleaseAddressSpace ( pcb );
+	pcb -> processState = ZOMBIE;
+	parent -> numZombieChildren += 1;
+	sim -> numZombieProcesses += 1;
+}
+
+int EndProcess ( OS_SIM *sim , int processID , int exitStatus , PCB *endedProcess ) 
+{
+	if ( processID == INIT_PROCESS_ID ) {
+		int onlyInitProcessesInSystem = NumSystemProcessesTotal ( sim ) == 1;
+		if ( !onlyInitProcessesInSystem ) 
+		{
+			return OSSIM_INIT_PROCESS_BUSY;
+		}
+
+		EmitEvent ( sim , OSSIM_EVENT_PROCESS_ENDED , sim -> currentCPU -> cpuID , &sim -> initProcess , NULL , exitStatus , 0 );
+
+		if ( endedProcess ) 
+		{
+			*endedProcess = sim -> initProcess;
+		}
+
+		sim -> currentCPU -> runningProcess = NULL;
+		return OSSIM_SUCCESS;
+	}
+
+	CPU *runningCPU = CPURunningProcess ( sim , processID );
+	PCB *foundProcess = NULL;
+	if ( runningCPU ) 
+	{
+		foundProcess = runningCPU -> runningProcess;
+		runningCPU -> runningProcess = NULL;
+	}
+	else 
+	{
+		foundProcess = FindAndRemoveProcessFromAllQueues ( sim , processID );
+	}
+
+	if ( !foundProcess ) {
+		return OSSIM_NO_SUCH_PROCESS;
+	}
+
+	foundProcess -> exitStatus = exitStatus;
+	if ( endedProcess ) 
+	{
+		*endedProcess = *foundProcess;
+		endedProcess -> readMessage = NULL; // freed with the process
+	}
+
+	EmitEvent ( sim , OSSIM_EVENT_PROCESS_ENDED , foundProcess -> cpuID , foundProcess , NULL , exitStatus , 0 );
+	RetireProcess ( sim , foundProcess , exitStatus );
+
+	if ( runningCPU ) 
+	{
+		RunNextProcess ( sim , runningCPU );
+	}
+
+	KickIdleCPUs ( sim );
+	return OSSIM_SUCCESS;
+}
+
+int OSSimKill ( OS_SIM *sim , int processID , PCB *endedProcess ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	return EndProcess ( sim , processID , KILLED_EXIT_STATUS , endedProcess );
+}
+
+int OSSimExit ( OS_SIM *sim , PCB *endedProcess ) 
+{
+	return OSSimExitWithStatus ( sim , 0 , endedProcess );
+}
+
+int OSSimExitWithStatus ( OS_SIM *sim , int exitStatus , PCB *endedProcess ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	return EndProcess ( sim , sim -> currentCPU -> runningProcess -> processID , exitStatus , endedProcess );
+}
+
+/* DEADLOCK DETECTION - only a block adds wait-for edges, and they can only close a cycle through the process that
+ * blocked, so a search follows just the processes it waits for, directly or through others, and never the whole
+ * graph. Nearly every blocked process waits for exactly one other, its recipient or the one holder of its lock,
+ * so the search is a walk along one chain */
+PCB *FirstWaitedFor ( OS_SIM *sim , const PCB *pcb ) 
+{
+	if ( pcb -> processState == SEM_BLOCKED ) 
+	{
+		return sim -> semaphores [ pcb -> blockedSemaphoreID ].firstHolder; // NULL unless it is a lock
+	}
+
+	return pcb -> processState == SEND_BLOCKED ? pcb -> sendRecipient : NULL;
+}
+
+/* a lock V'd by a process that did not hold it can be held by several, each another edge to try */
+PCB *NextWaitedFor ( const PCB *pcb , const PCB *waitedFor ) 
+{
+	return pcb -> processState == SEM_BLOCKED ? waitedFor -> nextHolder [ pcb -> blockedSemaphoreID ] : NULL;
+}
+
+/* depth first from blockedProcess along the edges leaving it - each process is reached once, linked through
+ * waitSearchQueueNext to the one the walk came from and through waitSearchNext to the one it went on to. Returns
+ * 1 once an edge leads back to blockedProcess, with waitSearchNext then going round the cycle */
+int WalkWaitedFor ( OS_SIM *sim , PCB *blockedProcess , long *numSteps ) 
+{
+	sim -> lastWaitSearchID += 1;
+	blockedProcess -> waitSearchID = sim -> lastWaitSearchID;
+	blockedProcess -> waitSearchQueueNext = NULL;
+	*numSteps += 1;
+
+	PCB *pcb = blockedProcess;
+	PCB *waitedFor = FirstWaitedFor ( sim , pcb );
+	while ( pcb ) 
+	{
+		if ( !waitedFor ) 
+		{
+			// every edge leaving pcb is a dead end, so is the one that led to it
+			PCB *walkedFrom = pcb -> waitSearchQueueNext;
+			waitedFor = walkedFrom ? NextWaitedFor ( walkedFrom , pcb ) : NULL;
+			pcb = walkedFrom;
+		}
+		else if ( waitedFor == blockedProcess ) 
+		{
+			pcb -> waitSearchNext = waitedFor;
+			return 1;
+		}
+		else if ( waitedFor -> waitSearchID == sim -> lastWaitSearchID ) 
+		{
+			waitedFor = NextWaitedFor ( pcb , waitedFor ); // already walked from, without getting back
+		}
+		else 
+		{
+			waitedFor -> waitSearchID = sim -> lastWaitSearchID;
+			waitedFor -> waitSearchQueueNext = pcb;
+			pcb -> waitSearchNext = waitedFor;
+			pcb = waitedFor;
+			waitedFor = FirstWaitedFor ( sim , pcb );
+			*numSteps += 1;
+		}
+	}
+
+	return 0;
+}
+
+void ReportDeadlockedProcess ( OS_SIM *sim , PCB *pcb , PCB *waitedFor ) 
+{
+	int waitedOn = pcb -> processState == SEM_BLOCKED ? pcb -> blockedSemaphoreID : WAITING_FOR_REPLY;
+	EmitEvent ( sim , OSSIM_EVENT_DEADLOCK , pcb -> cpuID , pcb , NULL , waitedFor -> processID , waitedOn );
+	sim -> numDeadlockedProcesses += 1;
+}
+
+/* one event per process of the cycle, starting with the process whose block closed it */
+void ReportDeadlock ( OS_SIM *sim , PCB *blockedProcess ) 
+{
+	sim -> numDeadlocksDetected += 1;
+
+	PCB *pcb = blockedProcess;
+	do 
+	{
+		ReportDeadlockedProcess ( sim , pcb , pcb -> waitSearchNext );
+		pcb = pcb -> waitSearchNext;
+	}
+	while ( pcb != blockedProcess );
+}
+
+/* runs once blockedProcess is queued with its new edges in place */
+void DetectDeadlock ( OS_SIM *sim , PCB *blockedProcess ) 
+{
+	sim -> numDeadlockSearches += 1;
+	if ( WalkWaitedFor ( sim , blockedProcess , &sim -> numDeadlockSearchSteps ) ) 
+	{
+		ReportDeadlock ( sim , blockedProcess );
+	}
+}
+
+void SendBlockRunningProcess ( OS_SIM *sim , PCB *recipient ) 
+{
+	PCB *sender = sim -> currentCPU -> runningProcess;
+	if ( sender -> processID == INIT_PROCESS_ID ) 
+	{
+		return;
+	} 
+
+	sender -> processState = SEND_BLOCKED;
+	ListAppend ( sim -> sendBlockedQueue , ( void *) sender );
+	LinkWaitingSender ( sender , recipient );
+
+	EmitEvent ( sim , OSSIM_EVENT_BLOCKED , sim -> currentCPU -> cpuID , sender , NULL , SEND_BLOCKED , 0 );
+	DetectDeadlock ( sim , sender );
+	if ( sender -> sendRecipient ) 
+	{
+		WaiterChanged ( sim , sender -> sendRecipient , OfferedPriorityLevel ( sender ) );
+	}
+
+	sim -> currentCPU -> runningProcess = NULL;
+	RunNextProcess ( sim , sim -> currentCPU );
+}
+
+int UnblockSendBlockedProcess ( OS_SIM *sim , MESSAGE *replyMessage ) 
+{
+	if ( !replyMessage ) 
+	{
+		return 0;
+	}
+
+	if ( replyMessage -> recipientProcessID == INIT_PROCESS_ID ) 
+	{
+		return 0;
+	}
+
+	PCB *unblockedProcess = RemoveProcessFromQueue ( replyMessage -> recipientProcessID , sim -> sendBlockedQueue );
+	if ( !unblockedProcess ) 
+	{
+		return 0;
+	}
+
+	PCB *recipient = unblockedProcess -> sendRecipient;
+	UnlinkWaitingSender ( unblockedProcess );
+	FreeMessage ( unblockedProcess -> readMessage );
+	unblockedProcess -> readMessage = replyMessage;
+
+	EmitEvent ( sim , OSSIM_EVENT_UNBLOCKED , unblockedProcess -> cpuID , unblockedProcess , replyMessage , SEND_BLOCKED , 0 );
+
+	AddToReadyQueue ( sim , unblockedProcess );
+	if ( recipient ) 
+	{
+		WaiterChanged ( sim , recipient , OfferedPriorityLevel ( unblockedProcess ) );
+	}
+
+	return 1;
+}
+
+void AddToMessagesQueue ( OS_SIM *sim , MESSAGE *message ) 
+{
+	if ( !message ) 
+	{
+		return;
+	}
+
+	ListAppend ( sim -> messagesQueue , ( void *) message );
+	EmitEvent ( sim , OSSIM_EVENT_MESSAGE_QUEUED , sim -> currentCPU -> cpuID , NULL , message , 0 , 0 );
+}
+
+MESSAGE *CreateMessage ( int senderProcessID , int recipientProcessID , const char *messageStr ) 
+{
+	if ( !messageStr || strlen ( messageStr ) == 0 ) 
+	{
+		messageStr = "<Blank Message>\0";
+	}
+
+	MESSAGE *message = ( MESSAGE *) malloc ( sizeof ( MESSAGE ) );
+	if ( !message ) 
+	{
+		return NULL;
+	}
+
+	message -> senderProcessID = senderProcessID;
+	message -> recipientProcessID = recipientProcessID;
+	strncpy ( message -> messageStr , messageStr , MAX_MESSAGE_LENGTH - 1 );
+	message -> messageStr [ MAX_MESSAGE_LENGTH - 1 ] = '\0';
+
+	return message;
+}
+
+int EqualsMessageRecipientID (  void *message , void *processID ) 
+{
+	if ( !message || !processID ) 
+	{
+		return 0;
+	}
+
+	return ( ( MESSAGE *) message ) -> recipientProcessID == *( ( int *) processID );
+}
+
+MESSAGE *FindMessage ( OS_SIM *sim , int processID ) 
+{
+	ListFirst ( sim -> messagesQueue );
+	MESSAGE *foundMessage = ( MESSAGE *) ListSearch ( sim -> messagesQueue , &EqualsMessageRecipientID , &processID );
+	if ( !foundMessage ) {
+		return 0;
+	}
+
+	ListRemove ( sim -> messagesQueue );
+
+	return foundMessage;
+}
+
+void ReceiveBlockRunningProcess ( OS_SIM *sim ) 
+{
+	if ( sim -> currentCPU -> runningProcess -> processID == INIT_PROCESS_ID ) 
+	{
+		return;
+	}
+
+	sim -> currentCPU -> runningProcess -> processState = RECEIVE_BLOCKED;
+	ListAppend ( sim -> receiveBlockedQueue , ( void *) sim -> currentCPU -> runningProcess );
+
+	EmitEvent ( sim , OSSIM_EVENT_BLOCKED , sim -> currentCPU -> cpuID , sim -> currentCPU -> runningProcess , NULL , RECEIVE_BLOCKED , 0 );
+
+	sim -> currentCPU -> runningProcess = NULL;
+	RunNextProcess ( sim , sim -> currentCPU );
+}
+
+int UnblockReceiveBlockedProcess ( OS_SIM *sim , MESSAGE *sentMessage ) 
+{
+	if ( !sentMessage ) 
+	{
+		return 0;
+	}
+
+	if ( sentMessage -> recipientProcessID == INIT_PROCESS_ID ) 
+	{
+		return 0;
+	}
+
+	PCB *unblockedProcess = RemoveProcessFromQueue ( sentMessage -> recipientProcessID , sim -> receiveBlockedQueue );
+	if ( !unblockedProcess ) 
+	{
+		return 0;
+	}
+
+	FreeMessage ( unblockedProcess -> readMessage );
+	unblockedProcess -> readMessage = sentMessage;
+
+	EmitEvent ( sim , OSSIM_EVENT_UNBLOCKED , unblockedProcess -> cpuID , unblockedProcess , sentMessage , RECEIVE_BLOCKED , 0 );
+
+	AddToReadyQueue ( sim , unblockedProcess );
+	return 1;
+}
+
+int OSSimReceive ( OS_SIM *sim , MESSAGE *receivedMessage ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	PCB *runningProcess = sim -> currentCPU -> runningProcess;
+	MESSAGE *foundMessage = FindMessage ( sim , runningProcess -> processID );
+	if ( foundMessage ) 
+	{
+		FreeMessage ( runningProcess -> readMessage ); // an earlier message the process never got to read
+		runningProcess -> readMessage = foundMessage;
+		if ( receivedMessage ) 
+		{
+			*receivedMessage = *foundMessage;
+		}
+
+		return OSSIM_SUCCESS;
+	}
+
+	if ( runningProcess -> processID != INIT_PROCESS_ID ) 
+	{
+		ReceiveBlockRunningProcess ( sim );
+		KickIdleCPUs ( sim );
+	}
+
+	return OSSIM_NO_MESSAGE;
+}
+
+int OSSimSend ( OS_SIM *sim , int recipientProcessID , const char *messageStr , MESSAGE *sentMessage ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( recipientProcessID == sim -> currentCPU -> runningProcess -> processID ) 
+	{
+		return OSSIM_SEND_TO_SELF;
+	}
+
+	PCB *recipient = FindLiveProcess ( sim , recipientProcessID );
+	if ( !recipient ) 
+	{
+		return OSSIM_NO_SUCH_PROCESS;
+	}
+
+	MESSAGE *message = CreateMessage ( sim -> currentCPU -> runningProcess -> processID , recipientProcessID , messageStr );
+	if ( !message ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	if ( sentMessage ) 
+	{
+		*sentMessage = *message;
+	}
+
+	int unblockedAProcess = UnblockReceiveBlockedProcess ( sim , message );
+	if ( !unblockedAProcess ) 
+	{
+		AddToMessagesQueue ( sim , message );
+	}
+
+	if ( sim -> currentCPU -> runningProcess -> processID != INIT_PROCESS_ID ) 
+	{
+		SendBlockRunningProcess ( sim , recipient );
+	}
+	else 
+	{
+		DispatchIfIdle ( sim , sim -> currentCPU );
+	}
+
+	KickIdleCPUs ( sim );
+	return OSSIM_SUCCESS;
+}
+
+int OSSimReply ( OS_SIM *sim , int recipientProcessID , const char *messageStr , MESSAGE *sentMessage ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( recipientProcessID == sim -> currentCPU -> runningProcess -> processID ) 
+	{
+		return OSSIM_SEND_TO_SELF;
+	}
+
+	int sendBlockedRecipientProcessExists = ProcessExistsInQueue ( recipientProcessID , sim -> sendBlockedQueue );
+	if ( !sendBlockedRecipientProcessExists ) 
+	{
+		return OSSIM_NOT_SEND_BLOCKED;
+	}
+
+	MESSAGE *repliedMessage = CreateMessage ( sim -> currentCPU -> runningProcess -> processID , recipientProcessID , messageStr );
+	if ( !repliedMessage ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	if ( sentMessage ) 
+	{
+		*sentMessage = *repliedMessage;
+	}
+
+	int unblockedAProcess = UnblockSendBlockedProcess ( sim , repliedMessage );
+	if ( !unblockedAProcess ) 
+	{
+		AddToMessagesQueue ( sim , repliedMessage );
+	}
+
+	DispatchIfIdle ( sim , sim -> currentCPU );
+	KickIdleCPUs ( sim );
+	return OSSIM_SUCCESS;
+}
+
+int ValidSemID ( int semaphoreID ) 
+{
+	return semaphoreID >= 0 && semaphoreID < NUM_SEMAPHORES;
+}
+
+int CreatedSem ( OS_SIM *sim , int semaphoreID ) 
+{
+	if ( !ValidSemID ( semaphoreID ) ) 
+	{
+		return 0;
+	}
+
+	SEMAPHORE *semaphore = &sim -> semaphores [ semaphoreID ];
+	if ( semaphore -> semStatus == NOT_CREATED ) 
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+/* only a lock's holders are known to be the processes that will V it, so only a lock adds wait-for edges */
+int IsLockSemaphore ( SEMAPHORE *semaphore ) 
+{
+	return semaphore -> initSemValue == 1;
+}
+
+int HoldsLockSemaphore ( const PCB *pcb ) 
+{
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		if ( pcb -> semaphoresHeld [ i ] != 0 ) 
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int CheckSemaphoreCommand ( OS_SIM *sim , int semaphoreID ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( !ValidSemID ( semaphoreID ) ) 
+	{
+		return OSSIM_INVALID_SEMAPHORE;
+	}
+
+	if ( !CreatedSem ( sim , semaphoreID ) ) 
+	{
+		return OSSIM_SEMAPHORE_NOT_CREATED;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int OSSimSemaphoreV ( OS_SIM *sim , int semaphoreID , int *semValue ) 
+{
+	int status = CheckSemaphoreCommand ( sim , semaphoreID );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	SEMAPHORE *semaphore = &sim -> semaphores [ semaphoreID ];
+	semaphore -> semValue += 1;
+
+	PCB *runningProcess = sim -> currentCPU -> runningProcess;
+	int released = runningProcess -> semaphoresHeld [ semaphoreID ] > 0;
+	int waitersPriorityLevel = released ? OfferedPriorityLevel ( runningProcess ) : 0; // its waiters were all waiting on it
+	if ( released ) 
+	{
+		ReleaseLockSemaphore ( sim , runningProcess , semaphoreID );
+	}
+
+	if ( semValue ) 
+	{
+		*semValue = semaphore -> semValue;
+	}
+
+	int woken = semaphore -> semValue <= 0 && ListCount ( semaphore -> blockedPCBs ) > 0;
+	if ( woken ) 
+	{
+		PCB *blockedProcess = ListTrim ( semaphore -> blockedPCBs );
+		if ( IsLockSemaphore ( semaphore ) ) 
+		{
+			WaiterChangedAtHolders ( sim , semaphoreID , OfferedPriorityLevel ( blockedProcess ) );
+			AcquireLockSemaphore ( sim , blockedProcess , semaphoreID ); // the unit given back is handed straight to it
+		}
+
+		AddToReadyQueue ( sim , blockedProcess );
+
+		EmitEvent ( sim , OSSIM_EVENT_UNBLOCKED , blockedProcess -> cpuID , blockedProcess , NULL , SEM_BLOCKED , semaphoreID );
+
+		if ( IsLockSemaphore ( semaphore ) ) 
+		{
+			InheritFromLockWaiters ( sim , blockedProcess , semaphoreID , waitersPriorityLevel );
+		}
+	}
+
+	// a holder letting go of a lock can only lose the boost its waiters gave it
+	if ( released && runningProcess -> inheritedPriorityLevel != NO_INHERITED_PRIORITY ) 
+	{
+		UpdateInheritedPriorities ( sim , runningProcess );
+	}
+
+	DispatchIfIdle ( sim , sim -> currentCPU );
+	KickIdleCPUs ( sim );
+	return OSSIM_SUCCESS;
+}
+
+int OSSimSemaphoreP ( OS_SIM *sim , int semaphoreID , int *semValue ) 
+{
+	int status = CheckSemaphoreCommand ( sim , semaphoreID );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	SEMAPHORE *semaphore = &sim -> semaphores [ semaphoreID ];
+	semaphore -> semValue -= 1;
+
+	if ( semValue ) 
+	{
+		*semValue = semaphore -> semValue;
+	}
+
+	PCB *runningProcess = sim -> currentCPU -> runningProcess;
+	if ( runningProcess -> processID != INIT_PROCESS_ID && semaphore -> semValue < 0 ) 
+	{
+		EmitEvent ( sim , OSSIM_EVENT_BLOCKED , sim -> currentCPU -> cpuID , runningProcess , NULL , SEM_BLOCKED , semaphoreID );
+
+		ListPrepend ( semaphore -> blockedPCBs , runningProcess );
+		runningProcess -> processState = SEM_BLOCKED;
+		runningProcess -> blockedSemaphoreID = semaphoreID;
+		DetectDeadlock ( sim , runningProcess );
+		WaiterChangedAtHolders ( sim , semaphoreID , OfferedPriorityLevel ( runningProcess ) );
+		
+		sim -> currentCPU -> runningProcess = NULL;
+		RunNextProcess ( sim , sim -> currentCPU );
+	}
+	else if ( runningProcess -> processID != INIT_PROCESS_ID && IsLockSemaphore ( semaphore ) ) 
+	{
+		AcquireLockSemaphore ( sim , runningProcess , semaphoreID );
+	}
+
+	KickIdleCPUs ( sim );
+	return OSSIM_SUCCESS;
+}
+
+int OSSimNewSemaphore ( OS_SIM *sim , int semaphoreID , int initSemValue ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( !ValidSemID ( semaphoreID ) ) 
+	{
+		return OSSIM_INVALID_SEMAPHORE;
+	}
+
+	if ( initSemValue < 0 ) 
+	{
+		return OSSIM_INVALID_SEMAPHORE_VALUE;
+	}
+
+	if ( CreatedSem ( sim , semaphoreID ) ) 
+	{
+		return OSSIM_SEMAPHORE_EXISTS;
+	}
+
+	SEMAPHORE *semaphore = &sim -> semaphores [ semaphoreID ];
+	semaphore -> semStatus = CREATED;
+	semaphore -> semValue = initSemValue;
+	semaphore -> initSemValue = initSemValue;
+
+	return OSSIM_SUCCESS;
+}
+
+int OSSimFork ( OS_SIM *sim , int *newProcessID ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	PCB *parentProcess = sim -> currentCPU -> runningProcess;
+	if ( parentProcess -> processID == INIT_PROCESS_ID ) 
+	{
+		return OSSIM_INIT_PROCESS_NOT_ALLOWED;
+	}
+
+	PCB *newProcess = NULL;
+	int status = OSSIM_SUCCESS;
+	if ( parentProcess -> schedulingClass == REAL_TIME_CLASS ) 
+	{
+		status = NewRealTimeProcess ( sim , 
+			parentProcess -> period , 
+			parentProcess -> relativeDeadline , 
+			parentProcess -> budget ,
+			&newProcess
+		);
+	}
+	else 
+	{
+		status = NewProcess ( sim , parentProcess -> priorityLevel , &newProcess );
+	}
+
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	newProcess -> affinityMask = parentProcess -> affinityMask;
+	if ( parentProcess -> groupID != NO_PROCESS_GROUP ) 
+	{
+		JoinProcessGroup ( sim , newProcess , parentProcess -> groupID );
+	}
+
+	AddChild ( parentProcess , newProcess );
+	ShareAddressSpace ( sim , parentProcess , newProcess );
+	newProcess -> cpuID = LeastLoadedCPU ( sim , newProcess , sim -> currentCPU ) -> cpuID;
+	AddToReadyQueue ( sim , newProcess );
+	EmitEvent ( sim , OSSIM_EVENT_PROCESS_CREATED , newProcess -> cpuID , newProcess , NULL , parentProcess -> processID , 0 );
+
+	if ( newProcessID ) 
+	{
+		*newProcessID = newProcess -> processID;
+	}
+
+	KickIdleCPUs ( sim );
+	return OSSIM_SUCCESS;
+}
+
+PCB *RemoveFromReadyQueue ( OS_SIM *sim , PCB *pcb ) 
+{
+	CPU *queuedCPU = &sim -> cpus [ pcb -> cpuID ];
+	if ( pcb -> schedulingClass == REAL_TIME_CLASS ) 
+	{
+		return HeapRemove ( queuedCPU -> realTimeReadyHeap , &EqualsProcessID , &pcb -> processID );
+	}
+
+	return RemoveProcessFromQueue ( pcb -> processID , queuedCPU -> readyPriorityQueues [ EffectivePriorityLevel ( pcb ) ] );
+}
+
+int OSSimSetAffinity ( OS_SIM *sim , int processID , unsigned int affinityMask ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	unsigned int validCPUsMask = ( 1u << sim -> numCPUs ) - 1;
+	unsigned int newAffinityMask = affinityMask & validCPUsMask;
+	if ( !newAffinityMask ) 
+	{
+		return OSSIM_INVALID_AFFINITY;
+	}
+
+	if ( processID == INIT_PROCESS_ID ) 
+	{
+		return OSSIM_INIT_PROCESS_NOT_ALLOWED;
+	}
+
+	PCB *foundProcess = NULL;
+	CPU *runningCPU = CPURunningProcess ( sim , processID );
+	if ( runningCPU ) 
+	{
+		foundProcess = runningCPU -> runningProcess;
+	}
+	else 
+	{
+		foundProcess = FindProcessFromAllQueues ( sim , processID );
+	}
+
+	if ( !foundProcess ) 
+	{
+		return OSSIM_NO_SUCH_PROCESS;
+	}
+
+	foundProcess -> affinityMask = newAffinityMask;
+
+	// running and blocked processes move off a disallowed CPU the next time they are made ready
+	if ( foundProcess -> processState == READY && !AllowedOnCPU ( foundProcess , &sim -> cpus [ foundProcess -> cpuID ] ) ) 
+	{
+		RemoveFromReadyQueue ( sim , foundProcess );
+		AddToReadyQueue ( sim , foundProcess );
+	}
+
+	KickIdleCPUs ( sim );
+	return OSSIM_SUCCESS;
+}
+
+int OSSimUseCPU ( OS_SIM *sim , int cpuID ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( cpuID < 0 || cpuID >= sim -> numCPUs ) 
+	{
+		return OSSIM_INVALID_CPU;
+	}
+
+	sim -> currentCPU = &sim -> cpus [ cpuID ];
+	return OSSIM_SUCCESS;
+}
+
+int OSSimQuantum ( OS_SIM *sim ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	QuantumExpired ( sim );
+	KickIdleCPUs ( sim );
+	return OSSIM_SUCCESS;
+}
+
+/* PROCESS GROUPS - a member's state says which one queue holds it, so no group command searches every queue */
+PCB *RemoveQueuedProcess ( OS_SIM *sim , PCB *pcb ) 
+{
+	switch ( pcb -> processState ) 
+	{
+		case READY :
+			return RemoveFromReadyQueue ( sim , pcb );
+
+		case SEND_BLOCKED :
+			return RemoveProcessFromQueue ( pcb -> processID , sim -> sendBlockedQueue );
+
+		case RECEIVE_BLOCKED :
+			return RemoveProcessFromQueue ( pcb -> processID , sim -> receiveBlockedQueue );
+
+		case WAIT_BLOCKED :
+			return RemoveProcessFromQueue ( pcb -> processID , sim -> waitBlockedQueue );
+
+		case SEM_BLOCKED :
+			return RemoveProcessFromQueue ( pcb -> processID , sim -> semaphores [ pcb -> blockedSemaphoreID ].blockedPCBs );
+
+		case PERIOD_WAITING :
+			return HeapRemove ( sim -> realTimeReleaseHeap , &EqualsProcessID , &pcb -> processID );
+
+		default:
+			return NULL;
+	}
+}
+
+/* takes a live process off its CPU or out of its queue - a CPU left with no running process is added to vacatedCPUsMask */
+int DetachProcess ( OS_SIM *sim , PCB *pcb , unsigned int *vacatedCPUsMask ) 
+{
+	CPU *processCPU = &sim -> cpus [ pcb -> cpuID ];
+	if ( processCPU -> runningProcess == pcb ) 
+	{
+		processCPU -> runningProcess = NULL;
+		*vacatedCPUsMask |= 1u << processCPU -> cpuID;
+		return 1;
+	}
+
+	return RemoveQueuedProcess ( sim , pcb ) != NULL;
+}
+
+/* one reschedule per CPU in the mask, however many of its processes a command touched */
+void RescheduleCPUs ( OS_SIM *sim , unsigned int cpusMask ) 
+{
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		if ( cpusMask & ( 1u << i ) ) 
+		{
+			RunNextProcess ( sim , &sim -> cpus [ i ] );
+		}
+	}
+
+	KickIdleCPUs ( sim );
+}
+
+int CheckGroupCommand ( OS_SIM *sim , int groupID ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( !ValidGroupID ( groupID ) ) 
+	{
+		return OSSIM_INVALID_GROUP;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int OSSimKillGroup ( OS_SIM *sim , int groupID , int *numKilled ) 
+{
+	int status = CheckGroupCommand ( sim , groupID );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	// a CPU whose running process ended gets its next one after the whole group is gone, not after each member
+	unsigned int vacatedCPUsMask = 0;
+	int numEnded = 0;
+	PCB *member = sim -> processGroups [ groupID ].firstMember;
+	while ( member ) 
+	{
+		PCB *nextMember = member -> nextInGroup;
+		if ( DetachProcess ( sim , member , &vacatedCPUsMask ) ) 
+		{
+			EmitEvent ( sim , OSSIM_EVENT_PROCESS_ENDED , member -> cpuID , member , NULL , KILLED_EXIT_STATUS , 0 );
+			RetireProcess ( sim , member , KILLED_EXIT_STATUS );
+			numEnded += 1;
+		}
+
+		member = nextMember;
+	}
+
+	RescheduleCPUs ( sim , vacatedCPUsMask );
+
+	if ( numKilled ) 
+	{
+		*numKilled = numEnded;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* the new level applies from the member's next dispatch, as an aging step would, and to the processes a blocked
+ * member lends it to - REAL-TIME members are skipped */
+int OSSimSetGroupPriority ( OS_SIM *sim , int groupID , int priorityLevel , int *numChanged ) 
+{
+	int status = CheckGroupCommand ( sim , groupID );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	if ( !ValidPriorityLevel ( sim , priorityLevel ) ) 
+	{
+		return OSSIM_INVALID_PRIORITY;
+	}
+
+	int numSet = 0;
+	for ( PCB *member = sim -> processGroups [ groupID ].firstMember ; member ; member = member -> nextInGroup ) 
+	{
+		if ( member -> schedulingClass == REAL_TIME_CLASS ) 
+		{
+			continue;
+		}
+
+		int prevPriorityLevel = EffectivePriorityLevel ( member );
+		member -> priorityLevel = priorityLevel;
+		member -> numCPUBurstsInPriorityLevel = 0;
+		member -> priorityDirection = priorityLevel == sim -> numPriorityLevels - 1 ? PROMOTING : DEMOTING;
+		RequeueReadyProcess ( sim , member , prevPriorityLevel );
+		UpdateInheritedPriorities ( sim , member ); // what it inherits and what it lends are both measured against its own level
+
+		numSet += 1;
+	}
+
+	if ( numChanged ) 
+	{
+		*numChanged = numSet;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* expires the quantum of every running member only - virtual time does not advance */
+int OSSimGroupQuantum ( OS_SIM *sim , int groupID , int *numPreempted ) 
+{
+	int status = CheckGroupCommand ( sim , groupID );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	unsigned int preemptedCPUsMask = 0;
+	int numRunning = 0;
+	for ( PCB *member = sim -> processGroups [ groupID ].firstMember ; member ; member = member -> nextInGroup ) 
+	{
+		if ( member -> processState == RUNNING ) 
+		{
+			preemptedCPUsMask |= 1u << member -> cpuID;
+			numRunning += 1;
+		}
+	}
+
+	// collected first, so a member dispatched by one of these reschedules is not pre-empted as well
+	RescheduleCPUs ( sim , preemptedCPUsMask );
+
+	if ( numPreempted ) 
+	{
+		*numPreempted = numRunning;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* PROCESS TREE - WAIT and KILL TREE only follow the child links of the processes they touch */
+void WaitBlockRunningProcess ( OS_SIM *sim ) 
+{
+	PCB *runningProcess = sim -> currentCPU -> runningProcess;
+	runningProcess -> processState = WAIT_BLOCKED;
+	ListAppend ( sim -> waitBlockedQueue , ( void *) runningProcess );
+
+	EmitEvent ( sim , OSSIM_EVENT_BLOCKED , sim -> currentCPU -> cpuID , runningProcess , NULL , WAIT_BLOCKED , 0 );
+
+	sim -> currentCPU -> runningProcess = NULL;
+	RunNextProcess ( sim , sim -> currentCPU );
+}
+
+void ReapChild ( OS_SIM *sim , PCB *parent , PCB *child ) 
+{
+	parent -> waitedChildID = child -> processID;
+	parent -> waitedExitStatus = child -> exitStatus;
+
+	RemoveChild ( child );
+	sim -> numZombieProcesses -= 1;
+	FreePCB ( child );
+}
+
+/* reaps the lowest ZOMBIE child of the running process, or blocks it until a child ends and reaps that one instead */
+int OSSimWait ( OS_SIM *sim , int *childProcessID , int *exitStatus ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	PCB *runningProcess = sim -> currentCPU -> runningProcess;
+	if ( runningProcess -> processID == INIT_PROCESS_ID ) 
+	{
+		return OSSIM_INIT_PROCESS_NOT_ALLOWED;
+	}
+
+	if ( runningProcess -> numChildren == 0 ) 
+	{
+		return OSSIM_NO_CHILDREN;
+	}
+
+	if ( runningProcess -> numZombieChildren == 0 ) 
+	{
+		WaitBlockRunningProcess ( sim );
+		KickIdleCPUs ( sim );
+		return OSSIM_NO_EXITED_CHILD;
+	}
+
+	PCB *child = runningProcess -> firstChild;
+	while ( child -> processState != ZOMBIE ) 
+	{
+		child = child -> nextSibling;
+	}
+
+	ReapChild ( sim , runningProcess , child );
+	if ( childProcessID ) 
+	{
+		*childProcessID = runningProcess -> waitedChildID;
+	}
+
+	if ( exitStatus ) 
+	{
+		*exitStatus = runningProcess -> waitedExitStatus;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* descendants are unlinked from their parent before they end, so only the root can leave a ZOMBIE or wake a waiter */
+void EndTreeMember ( OS_SIM *sim , PCB *pcb , unsigned int *vacatedCPUsMask , int *numEnded ) 
+{
+	if ( pcb -> processState == ZOMBIE ) 
+	{
+		RemoveChild ( pcb );
+		sim -> numZombieProcesses -= 1;
+		FreePCB ( pcb );
+		return;
+	}
+
+	RemoveChild ( pcb );
+	if ( !DetachProcess ( sim , pcb , vacatedCPUsMask ) ) 
+	{
+		return;
+	}
+
+	EmitEvent ( sim , OSSIM_EVENT_PROCESS_ENDED , pcb -> cpuID , pcb , NULL , KILLED_EXIT_STATUS , 0 );
+	RetireProcess ( sim , pcb , KILLED_EXIT_STATUS );
+	*numEnded += 1;
+}
+
+int OSSimKillTree ( OS_SIM *sim , int processID , int *numKilled ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( processID == INIT_PROCESS_ID ) 
+	{
+		return OSSIM_INIT_PROCESS_NOT_ALLOWED;
+	}
+
+	CPU *runningCPU = CPURunningProcess ( sim , processID );
+	PCB *root = runningCPU ? runningCPU -> runningProcess : FindProcessFromAllQueues ( sim , processID );
+	if ( !root ) 
+	{
+		return OSSIM_NO_SUCH_PROCESS;
+	}
+
+	// post-order without a stack - a leaf is ended, then the walk goes back up to its parent and down its next child
+	unsigned int vacatedCPUsMask = 0;
+	int numEnded = 0;
+	PCB *node = root;
+	while ( 1 ) 
+	{
+		while ( node -> firstChild ) 
+		{
+			node = node -> firstChild;
+		}
+
+		if ( node == root ) 
+		{
+			break;
+		}
+
+		PCB *parent = node -> parent;
+		EndTreeMember ( sim , node , &vacatedCPUsMask , &numEnded );
+		node = parent;
+	}
+
+	if ( DetachProcess ( sim , root , &vacatedCPUsMask ) ) 
+	{
+		EmitEvent ( sim , OSSIM_EVENT_PROCESS_ENDED , root -> cpuID , root , NULL , KILLED_EXIT_STATUS , 0 );
+		RetireProcess ( sim , root , KILLED_EXIT_STATUS );
+		numEnded += 1;
+	}
+
+	RescheduleCPUs ( sim , vacatedCPUsMask );
+
+	if ( numKilled ) 
+	{
+		*numKilled = numEnded;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* MEMORY - a write copies at most the page table and the one page written, and only while another process holds them */
+ADDRESS_SPACE *PrivateAddressSpace ( OS_SIM *sim , PCB *pcb ) 
+{
+	ADDRESS_SPACE *addressSpace = pcb -> addressSpace;
+	if ( addressSpace && addressSpace -> refCount == 1 ) 
+	{
+		return addressSpace;
+	}
+
+	ADDRESS_SPACE *copy = ( ADDRESS_SPACE *) calloc ( 1 , sizeof ( ADDRESS_SPACE ) );
+	if ( !copy ) 
+	{
+		return NULL;
+	}
+
+	copy -> refCount = 1;
+	if ( addressSpace ) 
+	{
+		// the pages themselves stay shared, each one is now held by one more table
+		copy -> numPages = addressSpace -> numPages;
+		for ( int i = 0 ; i < NUM_MEMORY_PAGES ; i++ ) 
+		{
+			copy -> pages [ i ] = addressSpace -> pages [ i ];
+			if ( copy -> pages [ i ] ) 
+			{
+				copy -> pages [ i ] -> refCount += 1;
+			}
+		}
+
+		addressSpace -> refCount -= 1;
+		sim -> numPageTableCopies += 1;
+	}
+
+	pcb -> addressSpace = copy;
+	return copy;
+}
+
+int OSSimWriteMemory ( OS_SIM *sim , int page , const char *data , int *copiedOnWrite ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( page < 0 || page >= NUM_MEMORY_PAGES || !data ) 
+	{
+		return OSSIM_INVALID_PAGE;
+	}
+
+	PCB *runningProcess = sim -> currentCPU -> runningProcess;
+	if ( runningProcess -> processID == INIT_PROCESS_ID ) 
+	{
+		return OSSIM_INIT_PROCESS_NOT_ALLOWED;
+	}
+
+	ADDRESS_SPACE *addressSpace = PrivateAddressSpace ( sim , runningProcess );
+	if ( !addressSpace ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	// a write replaces the whole page, so a shared page is left to its other holders rather than copied byte by byte
+	MEMORY_PAGE *sharedPage = addressSpace -> pages [ page ];
+	MEMORY_PAGE *writtenPage = sharedPage;
+	if ( !sharedPage || sharedPage -> refCount > 1 ) 
+	{
+		writtenPage = ( MEMORY_PAGE *) malloc ( sizeof ( MEMORY_PAGE ) );
+		if ( !writtenPage ) 
+		{
+			return OSSIM_FAILURE;
+		}
+
+		writtenPage -> refCount = 1;
+		addressSpace -> pages [ page ] = writtenPage;
+	}
+
+	if ( !sharedPage ) 
+	{
+		addressSpace -> numPages += 1;
+	}
+	else if ( sharedPage != writtenPage ) 
+	{
+		sharedPage -> refCount -= 1;
+		sim -> numCOWFaults += 1;
+	}
+
+	strncpy ( writtenPage -> data , data , MEMORY_PAGE_SIZE - 1 );
+	writtenPage -> data [ MEMORY_PAGE_SIZE - 1 ] = '\0';
+
+	if ( copiedOnWrite ) 
+	{
+		*copiedOnWrite = sharedPage && sharedPage != writtenPage;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int OSSimReadMemory ( OS_SIM *sim , int page , char *data ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( page < 0 || page >= NUM_MEMORY_PAGES || !data ) 
+	{
+		return OSSIM_INVALID_PAGE;
+	}
+
+	PCB *runningProcess = sim -> currentCPU -> runningProcess;
+	if ( runningProcess -> processID == INIT_PROCESS_ID ) 
+	{
+		return OSSIM_INIT_PROCESS_NOT_ALLOWED;
+	}
+
+	ADDRESS_SPACE *addressSpace = runningProcess -> addressSpace;
+	if ( addressSpace && addressSpace -> pages [ page ] ) 
+	{
+		memcpy ( data , addressSpace -> pages [ page ] -> data , MEMORY_PAGE_SIZE );
+	}
+	else 
+	{
+		memset ( data , 0 , MEMORY_PAGE_SIZE );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int OSSimBeginBatch ( OS_SIM *sim ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	sim -> inBatch = 1;
+	return OSSIM_SUCCESS;
+}
+
+int OSSimEndBatch ( OS_SIM *sim ) 
+{
+	sim -> inBatch = 0;
+	if ( !SystemRunning ( sim ) ) 
+	{
+		sim -> deferredDispatchMask = 0;
+		sim -> idleCPUKickDeferred = 0;
+		return OSSIM_NOT_RUNNING;
+	}
+
+	RunDeferredDispatches ( sim );
+	return OSSIM_SUCCESS;
+}
+
+const PCB *OSSimFindProcess ( OS_SIM *sim , int processID ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return NULL;
+	}
+
+	return FindLiveProcess ( sim , processID );
+}
+
+const PCB *OSSimRunningProcess ( OS_SIM *sim , int cpuID ) 
+{
+	if ( !sim || cpuID < 0 || cpuID >= sim -> numCPUs ) 
+	{
+		return NULL;
+	}
+
+	return sim -> cpus [ cpuID ].runningProcess;
+}
+
+const char *OSSimStatusStr ( int status ) 
+{
+	switch ( status ) 
+	{
+		case OSSIM_SUCCESS :
+			return "SUCCESS";
+
+		case OSSIM_NO_MESSAGE :
+			return "NO MESSAGE";
+
+		case OSSIM_NO_EXITED_CHILD :
+			return "NO EXITED CHILD";
+
+		case OSSIM_FAILURE :
+			return "OUT OF MEMORY";
+
+		case OSSIM_NOT_RUNNING :
+			return "SIMULATOR NOT RUNNING";
+
+		case OSSIM_INVALID_PRIORITY :
+			return "INVALID PRIORITY LEVEL";
+
+		case OSSIM_INVALID_REAL_TIME_PARAMS :
+			return "INVALID REAL-TIME PARAMETERS";
+
+		case OSSIM_TOO_MANY_REAL_TIME_PROCESSES :
+			return "TOO MANY REAL-TIME PROCESSES";
+
+		case OSSIM_NO_SUCH_PROCESS :
+			return "NO SUCH PROCESS";
+
+		case OSSIM_INIT_PROCESS_BUSY :
+			return "INIT PROCESS STILL HAS OTHER PROCESSES";
+
+		case OSSIM_INIT_PROCESS_NOT_ALLOWED :
+			return "NOT ALLOWED ON INIT PROCESS";
+
+		case OSSIM_SEND_TO_SELF :
+			return "CANNOT SEND TO SELF";
+
+		case OSSIM_NOT_SEND_BLOCKED :
+			return "RECIPIENT NOT SEND-BLOCKED";
+
+		case OSSIM_INVALID_SEMAPHORE :
+			return "INVALID SEMAPHORE ID";
+
+		case OSSIM_SEMAPHORE_NOT_CREATED :
+			return "SEMAPHORE NOT CREATED";
+
+		case OSSIM_SEMAPHORE_EXISTS :
+			return "SEMAPHORE ALREADY CREATED";
+
+		case OSSIM_INVALID_SEMAPHORE_VALUE :
+			return "INVALID SEMAPHORE VALUE";
+
+		case OSSIM_INVALID_AFFINITY :
+			return "INVALID AFFINITY MASK";
+
+		case OSSIM_INVALID_CPU :
+			return "INVALID CPU ID";
+
+		case OSSIM_INVALID_CONFIG :
+			return "INVALID CONFIGURATION";
+
+		case OSSIM_TOO_MANY_SUBSCRIBERS :
+			return "TOO MANY EVENT SUBSCRIBERS";
+
+		case OSSIM_NO_SUCH_SUBSCRIBER :
+			return "NO SUCH EVENT SUBSCRIBER";
+
+		case OSSIM_INVARIANT_VIOLATED :
+			return "INVARIANT VIOLATED";
+
+		case OSSIM_SNAPSHOT_IO_ERROR :
+			return "COULD NOT READ OR WRITE SNAPSHOT FILE";
+
+		case OSSIM_INVALID_SNAPSHOT :
+			return "INVALID OR INCOMPATIBLE SNAPSHOT";
+
+		case OSSIM_INVALID_GROUP :
+			return "INVALID PROCESS GROUP";
+
+		case OSSIM_NO_CHILDREN :
+			return "NO CHILD PROCESSES";
+
+		case OSSIM_INVALID_PAGE :
+			return "INVALID MEMORY PAGE";
+
+		default: 
+			return "UNKNOWN STATUS";
+	}
+}
+
+const char *OSSimListOwnerStr ( int ownerID ) 
+{
+	switch ( ownerID ) 
+	{
+		case OSSIM_READY_QUEUES :
+			return "READY QUEUES";
+
+		case OSSIM_SEMAPHORE_QUEUES :
+			return "SEMAPHORE QUEUES";
+
+		case OSSIM_SEND_BLOCKED_QUEUE :
+			return "SEND-BLOCKED QUEUE";
+
+		case OSSIM_RECEIVE_BLOCKED_QUEUE :
+			return "RECEIVE-BLOCKED QUEUE";
+
+		case OSSIM_MESSAGES_QUEUE :
+			return "MESSAGES QUEUE";
+
+		case OSSIM_WAIT_BLOCKED_QUEUE :
+			return "WAIT-BLOCKED QUEUE";
+
+		default: 
+			return "UNTAGGED";
+	}
+}
+
+/* INVARIANTS - every PCB the queues hold is collected, then cross-checked against the counters kept as they change */
+#define ANY_QUEUE_VALUE -2 // the queue does not pin the process to one CPU or priority level
+
+typedef struct invariantCheck
+{
+	OS_SIM *sim;
+	PCB **processes;
+	int numProcesses;
+	int maxProcesses;
+	int numQueuedNodes; // list nodes the queues hold, the pool must have exactly this many in use
+	int numQueuedNodesByOwner [ MAX_LIST_OWNERS ];
+	char *violation;
+	int violationLength;
+} INVARIANT_CHECK;
+
+int InvariantViolated ( INVARIANT_CHECK *check , const char *format , ... ) 
+{
+	if ( check -> violation && check -> violationLength > 0 ) 
+	{
+		va_list args;
+		va_start ( args , format );
+		vsnprintf ( check -> violation , check -> violationLength , format , args );
+		va_end ( args );
+	}
+
+	return OSSIM_INVARIANT_VIOLATED;
+}
+
+int CheckQueuedProcess ( INVARIANT_CHECK *check , PCB *pcb , const char *queueName , enum STATE expectedState , int expectedCPUID , int expectedPriorityLevel ) 
+{
+	if ( !pcb ) 
+	{
+		return InvariantViolated ( check , "%s holds a NULL process" , queueName );
+	}
+
+	if ( check -> numProcesses >= check -> maxProcesses ) 
+	{
+		return InvariantViolated ( check , "queues hold more than the %d live processes" , check -> sim -> numLiveProcesses );
+	}
+
+	check -> processes [ check -> numProcesses ] = pcb;
+	check -> numProcesses += 1;
+
+	if ( pcb -> processID <= INIT_PROCESS_ID || pcb -> processID >= check -> sim -> nextAvailProcessID ) 
+	{
+		return InvariantViolated ( check , "%s holds process %d, which was never allocated" , queueName , pcb -> processID );
+	}
+
+	if ( pcb -> processState != expectedState ) 
+	{
+		return InvariantViolated ( check , "process %d is in %s but its state is %d" , pcb -> processID , queueName , pcb -> processState );
+	}
+
+	if ( pcb -> cpuID < 0 || pcb -> cpuID >= check -> sim -> numCPUs || ( expectedCPUID != ANY_QUEUE_VALUE && pcb -> cpuID != expectedCPUID ) ) 
+	{
+		return InvariantViolated ( check , "process %d is in %s but its CPU is %d" , pcb -> processID , queueName , pcb -> cpuID );
+	}
+
+	int validPriorityLevel = pcb -> schedulingClass == REAL_TIME_CLASS ? 
+		pcb -> priorityLevel == REAL_TIME_PRIORITY_LEVEL && pcb -> inheritedPriorityLevel == NO_INHERITED_PRIORITY : 
+		pcb -> priorityLevel >= 0 && pcb -> priorityLevel < check -> sim -> numPriorityLevels && 
+		pcb -> inheritedPriorityLevel >= 0 && ( pcb -> inheritedPriorityLevel < pcb -> priorityLevel || pcb -> inheritedPriorityLevel == NO_INHERITED_PRIORITY );
+	if ( !validPriorityLevel || ( expectedPriorityLevel != ANY_QUEUE_VALUE && EffectivePriorityLevel ( pcb ) != expectedPriorityLevel ) ) 
+	{
+		return InvariantViolated ( check , "process %d is in %s but its priority level is %d (inherited %d)" , pcb -> processID , queueName , pcb -> priorityLevel , pcb -> inheritedPriorityLevel );
+	}
+
+	if ( pcb -> groupID != NO_PROCESS_GROUP && !ValidGroupID ( pcb -> groupID ) ) 
+	{
+		return InvariantViolated ( check , "process %d is in %s but its process group is %d" , pcb -> processID , queueName , pcb -> groupID );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int CheckListLinks ( INVARIANT_CHECK *check , LIST *list , const char *queueName ) 
+{
+	if ( !list || list -> pool != &check -> sim -> listPool ) 
+	{
+		return InvariantViolated ( check , "%s was not allocated from the instance's list pool" , queueName );
+	}
+
+	// walks the links directly so the list cursor the core may rely on is never moved
+	int numNodes = 0;
+	NODE *prevNode = NULL;
+	for ( NODE *node = list -> headNodePtr ; node ; node = node -> nextNodePtr ) 
+	{
+		numNodes += 1;
+		if ( numNodes > ListCount ( list ) || node -> prevNodePtr != prevNode ) 
+		{
+			return InvariantViolated ( check , "%s links do not match its count of %d" , queueName , ListCount ( list ) );
+		}
+
+		prevNode = node;
+	}
+
+	if ( numNodes != ListCount ( list ) || list -> tailNodePtr != prevNode ) 
+	{
+		return InvariantViolated ( check , "%s links do not match its count of %d" , queueName , ListCount ( list ) );
+	}
+
+	check -> numQueuedNodes += numNodes;
+	check -> numQueuedNodesByOwner [ list -> ownerID ] += numNodes;
+	return OSSIM_SUCCESS;
+}
+
+int CheckProcessList ( INVARIANT_CHECK *check , LIST *list , const char *queueName , enum STATE expectedState , int expectedCPUID , int expectedPriorityLevel ) 
+{
+	int status = CheckListLinks ( check , list , queueName );
+	for ( NODE *node = list -> headNodePtr ; node && status == OSSIM_SUCCESS ; node = node -> nextNodePtr ) 
+	{
+		PCB *pcb = node -> valuePtr;
+		status = CheckQueuedProcess ( check , pcb , queueName , expectedState , expectedCPUID , expectedPriorityLevel );
+		if ( status == OSSIM_SUCCESS && expectedPriorityLevel != ANY_QUEUE_VALUE && pcb -> schedulingClass != NORMAL_CLASS ) 
+		{
+			status = InvariantViolated ( check , "real-time process %d is in %s" , pcb -> processID , queueName );
+		}
+	}
+
+	return status;
+}
+
+int CheckProcessHeap ( INVARIANT_CHECK *check , HEAP *heap , const char *queueName , enum STATE expectedState , int expectedCPUID ) 
+{
+	if ( !heap || heap -> count < 0 || heap -> count > heap -> capacity ) 
+	{
+		return InvariantViolated ( check , "%s count is out of range" , queueName );
+	}
+
+	for ( int i = 0 ; i < heap -> count ; i++ ) 
+	{
+		PCB *pcb = heap -> items [ i ];
+		int status = CheckQueuedProcess ( check , pcb , queueName , expectedState , expectedCPUID , REAL_TIME_PRIORITY_LEVEL );
+		if ( status != OSSIM_SUCCESS ) 
+		{
+			return status;
+		}
+
+		if ( pcb -> schedulingClass != REAL_TIME_CLASS ) 
+		{
+			return InvariantViolated ( check , "normal process %d is in %s" , pcb -> processID , queueName );
+		}
+
+		int parent = ( i - 1 ) / 2;
+		if ( i > 0 && heap -> comparator ( heap -> items [ parent ] , pcb ) > 0 ) 
+		{
+			return InvariantViolated ( check , "%s is out of heap order at process %d" , queueName , pcb -> processID );
+		}
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int CheckFreeStack ( INVARIANT_CHECK *check , int **freeIndexes , int topFreeIndex , int capacity , const char *poolName ) 
+{
+	char *isFree = ( char *) calloc ( capacity , sizeof ( char ) );
+	if ( !isFree ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	int status = OSSIM_SUCCESS;
+	for ( int i = 0 ; i <= topFreeIndex && status == OSSIM_SUCCESS ; i++ ) 
+	{
+		int freeIndex = *freeIndexes [ i ];
+		if ( freeIndex < 0 || freeIndex >= capacity || isFree [ freeIndex ] ) 
+		{
+			status = InvariantViolated ( check , "%s free stack holds index %d twice or out of range" , poolName , freeIndex );
+		}
+		else 
+		{
+			isFree [ freeIndex ] = 1;
+		}
+	}
+
+	free ( isFree );
+	return status;
+}
+
+int CheckListPool ( INVARIANT_CHECK *check ) 
+{
+	LIST_POOL *pool = &check -> sim -> listPool;
+	int numFreeNodes = pool -> topFreeNodeIndex + 1;
+	int numFreeLists = pool -> topFreeListIndex + 1;
+	if ( numFreeNodes < 0 || numFreeNodes > MAX_NUM_NODES_ALLOC || numFreeLists < 0 || numFreeLists > MAX_NUM_LISTS_ALLOC ) 
+	{
+		return InvariantViolated ( check , "list pool free counts %d / %d are out of range" , numFreeNodes , numFreeLists );
+	}
+
+	int numNodesInUse = MAX_NUM_NODES_ALLOC - numFreeNodes;
+	if ( numNodesInUse != check -> numQueuedNodes ) 
+	{
+		return InvariantViolated ( check , "list pool has %d nodes in use but the queues hold %d" , numNodesInUse , check -> numQueuedNodes );
+	}
+
+	int numListsInUse = MAX_NUM_LISTS_ALLOC - numFreeLists;
+	int numSimLists = check -> sim -> numCPUs * check -> sim -> numPriorityLevels + NUM_SEMAPHORES + 4; // + send-blocked, receive-blocked, wait-blocked and messages queues
+	if ( numListsInUse != numSimLists ) 
+	{
+		return InvariantViolated ( check , "list pool has %d lists in use but the instance owns %d" , numListsInUse , numSimLists );
+	}
+
+	for ( int i = 0 ; i < MAX_LIST_OWNERS ; i++ ) 
+	{
+		if ( pool -> stats.owners [ i ].nodesInUse != check -> numQueuedNodesByOwner [ i ] ) 
+		{
+			return InvariantViolated ( check , 
+				"list pool counts %d nodes in use by %s but they hold %d" , 
+				pool -> stats.owners [ i ].nodesInUse , 
+				OSSimListOwnerStr ( i ) , 
+				check -> numQueuedNodesByOwner [ i ] 
+			);
+		}
+	}
+
+	int status = CheckFreeStack ( check , pool -> freeNodeIndexesPtrArr , pool -> topFreeNodeIndex , MAX_NUM_NODES_ALLOC , "node" );
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckFreeStack ( check , pool -> freeListIndexesPtrArr , pool -> topFreeListIndex , MAX_NUM_LISTS_ALLOC , "list" );
+	}
+
+	return status;
+}
+
+int CompareProcessIDs ( const void *a , const void *b ) 
+{
+	const PCB *process1 = *( const PCB **) a;
+	const PCB *process2 = *( const PCB **) b;
+	return ( process1 -> processID > process2 -> processID ) - ( process1 -> processID < process2 -> processID );
+}
+
+/* orders items by address, to find every holder of a shared item next to each other */
+int ComparePointers ( const void *a , const void *b ) 
+{
+	uintptr_t pointer1 = ( uintptr_t ) *( void * const *) a;
+	uintptr_t pointer2 = ( uintptr_t ) *( void * const *) b;
+	return ( pointer1 > pointer2 ) - ( pointer1 < pointer2 );
+}
+
+int CheckAllQueues ( INVARIANT_CHECK *check ) 
+{
+	OS_SIM *sim = check -> sim;
+	int status = OSSIM_SUCCESS;
+	for ( int i = 0 ; i < sim -> numCPUs && status == OSSIM_SUCCESS ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		PCB *runningProcess = cpu -> runningProcess;
+		if ( !runningProcess ) 
+		{
+			return InvariantViolated ( check , "CPU %d has no running process" , i );
+		}
+
+		if ( runningProcess != &sim -> initProcess ) 
+		{
+			status = CheckQueuedProcess ( check , runningProcess , "a CPU" , RUNNING , i , ANY_QUEUE_VALUE );
+		}
+
+		for ( int j = 0 ; j < sim -> numPriorityLevels && status == OSSIM_SUCCESS ; j++ ) 
+		{
+			status = CheckProcessList ( check , cpu -> readyPriorityQueues [ j ] , "a ready queue" , READY , i , j );
+		}
+
+		if ( status == OSSIM_SUCCESS ) 
+		{
+			status = CheckProcessHeap ( check , cpu -> realTimeReadyHeap , "a real-time ready heap" , READY , i );
+		}
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES && status == OSSIM_SUCCESS ; i++ ) 
+	{
+		status = CheckProcessList ( check , sim -> semaphores [ i ].blockedPCBs , "a semaphore queue" , SEM_BLOCKED , ANY_QUEUE_VALUE , ANY_QUEUE_VALUE );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckProcessList ( check , sim -> sendBlockedQueue , "the send-blocked queue" , SEND_BLOCKED , ANY_QUEUE_VALUE , ANY_QUEUE_VALUE );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckProcessList ( check , sim -> receiveBlockedQueue , "the receive-blocked queue" , RECEIVE_BLOCKED , ANY_QUEUE_VALUE , ANY_QUEUE_VALUE );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckProcessList ( check , sim -> waitBlockedQueue , "the wait-blocked queue" , WAIT_BLOCKED , ANY_QUEUE_VALUE , ANY_QUEUE_VALUE );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckProcessHeap ( check , sim -> realTimeReleaseHeap , "the release heap" , PERIOD_WAITING , ANY_QUEUE_VALUE );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckListLinks ( check , sim -> messagesQueue , "the messages queue" );
+	}
+
+	return status;
+}
+
+int CheckProcessCounts ( INVARIANT_CHECK *check ) 
+{
+	OS_SIM *sim = check -> sim;
+	qsort ( check -> processes , check -> numProcesses , sizeof ( PCB *) , &CompareProcessIDs );
+
+	int numRealTimeProcesses = 0;
+	for ( int i = 0 ; i < check -> numProcesses ; i++ ) 
+	{
+		if ( i > 0 && check -> processes [ i ] -> processID == check -> processes [ i - 1 ] -> processID ) 
+		{
+			return InvariantViolated ( check , "process %d is held by more than one queue" , check -> processes [ i ] -> processID );
+		}
+
+		numRealTimeProcesses += check -> processes [ i ] -> schedulingClass == REAL_TIME_CLASS;
+	}
+
+	if ( check -> numProcesses != sim -> numLiveProcesses ) 
+	{
+		return InvariantViolated ( check , "queues hold %d processes but %d are live" , check -> numProcesses , sim -> numLiveProcesses );
+	}
+
+	int numSystemProcesses = NumSystemProcessesTotal ( sim );
+	if ( numSystemProcesses != check -> numProcesses + 1 ) 
+	{
+		return InvariantViolated ( check , "NumSystemProcessesTotal reports %d but %d processes and INIT are live" , numSystemProcesses , check -> numProcesses );
+	}
+
+	if ( numRealTimeProcesses != sim -> numRealTimeProcesses ) 
+	{
+		return InvariantViolated ( check , "%d real-time processes are queued but %d are counted" , numRealTimeProcesses , sim -> numRealTimeProcesses );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* only valid once CheckProcessCounts has sorted check -> processes */
+int IsCheckedProcess ( INVARIANT_CHECK *check , PCB *pcb ) 
+{
+	PCB **queuedProcess = bsearch ( &pcb , check -> processes , check -> numProcesses , sizeof ( PCB *) , &CompareProcessIDs );
+	return queuedProcess && *queuedProcess == pcb;
+}
+
+/* runs after CheckProcessCounts, which leaves check -> processes sorted by process ID */
+int CheckProcessGroups ( INVARIANT_CHECK *check ) 
+{
+	OS_SIM *sim = check -> sim;
+	int numGroupedProcesses = 0;
+	for ( int i = 0 ; i < check -> numProcesses ; i++ ) 
+	{
+		numGroupedProcesses += check -> processes [ i ] -> groupID != NO_PROCESS_GROUP;
+	}
+
+	int numLinkedTotal = 0;
+	for ( int i = 0 ; i < MAX_PROCESS_GROUPS ; i++ ) 
+	{
+		PROCESS_GROUP *group = &sim -> processGroups [ i ];
+		PCB *prevMember = NULL;
+		int numLinked = 0;
+		for ( PCB *member = group -> firstMember ; member ; member = member -> nextInGroup ) 
+		{
+			if ( numLinkedTotal + numLinked >= numGroupedProcesses ) 
+			{
+				return InvariantViolated ( check , "process groups link more than the %d processes that belong to one" , numGroupedProcesses );
+			}
+
+			if ( !IsCheckedProcess ( check , member ) ) 
+			{
+				return InvariantViolated ( check , "process group %d links process %d, which no queue holds" , i , member -> processID );
+			}
+
+			if ( member -> groupID != i || member -> prevInGroup != prevMember ) 
+			{
+				return InvariantViolated ( check , "process %d is linked into process group %d but its group is %d" , member -> processID , i , member -> groupID );
+			}
+
+			if ( prevMember && member -> processID <= prevMember -> processID ) 
+			{
+				return InvariantViolated ( check , "process group %d is out of process ID order at process %d" , i , member -> processID );
+			}
+
+			prevMember = member;
+			numLinked += 1;
+		}
+
+		if ( group -> lastMember != prevMember || group -> numMembers != numLinked ) 
+		{
+			return InvariantViolated ( check , "process group %d counts %d members but links %d" , i , group -> numMembers , numLinked );
+		}
+
+		numLinkedTotal += numLinked;
+	}
+
+	if ( numLinkedTotal != numGroupedProcesses ) 
+	{
+		return InvariantViolated ( check , "%d processes belong to a process group but the groups link %d" , numGroupedProcesses , numLinkedTotal );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* also runs after CheckProcessCounts - a child is linked by its live parent only, and always has the higher process ID, so the tree has no cycles */
+int CheckProcessTree ( INVARIANT_CHECK *check ) 
+{
+	OS_SIM *sim = check -> sim;
+	int numParentedProcesses = 0;
+	int numLinkedLiveTotal = 0;
+	int numLinkedZombiesTotal = 0;
+	int maxLinked = check -> numProcesses + sim -> numZombieProcesses;
+	for ( int i = 0 ; i < check -> numProcesses ; i++ ) 
+	{
+		PCB *pcb = check -> processes [ i ];
+		if ( pcb -> parent ) 
+		{
+			if ( !IsCheckedProcess ( check , pcb -> parent ) || pcb -> parentProcessID != pcb -> parent -> processID ) 
+			{
+				return InvariantViolated ( check , "process %d has parent %d, which no queue holds" , pcb -> processID , pcb -> parentProcessID );
+			}
+
+			numParentedProcesses += 1;
+		}
+		else if ( pcb -> parentProcessID != INIT_PROCESS_ID ) 
+		{
+			return InvariantViolated ( check , "process %d has no parent PCB but its parent is %d" , pcb -> processID , pcb -> parentProcessID );
+		}
+
+		PCB *prevChild = NULL;
+		int numLinked = 0;
+		int numZombies = 0;
+		for ( PCB *child = pcb -> firstChild ; child ; child = child -> nextSibling ) 
+		{
+			if ( numLinkedLiveTotal + numLinkedZombiesTotal + numLinked >= maxLinked ) 
+			{
+				return InvariantViolated ( check , "child lists link more than the %d live and ZOMBIE processes" , maxLinked );
+			}
+
+			if ( child -> parent != pcb || child -> prevSibling != prevChild || child -> processID <= pcb -> processID ) 
+			{
+				return InvariantViolated ( check , "process %d links child %d, whose parent links are wrong" , pcb -> processID , child -> processID );
+			}
+
+			if ( prevChild && child -> processID <= prevChild -> processID ) 
+			{
+				return InvariantViolated ( check , "children of process %d are out of process ID order at process %d" , pcb -> processID , child -> processID );
+			}
+
+			if ( child -> processState == ZOMBIE ) 
+			{
+				if ( child -> firstChild || child -> numChildren != 0 || child -> readMessage || child -> addressSpace || 
+					child -> sendRecipient || child -> firstWaitingSender || HoldsLockSemaphore ( child ) || 
+					child -> inheritedPriorityLevel != NO_INHERITED_PRIORITY ) 
+				{
+					return InvariantViolated ( check , "ZOMBIE process %d still holds children, a message, memory or a wait-for edge" , child -> processID );
+				}
+
+				numZombies += 1;
+			}
+			else if ( !IsCheckedProcess ( check , child ) ) 
+			{
+				return InvariantViolated ( check , "process %d links child %d, which no queue holds" , pcb -> processID , child -> processID );
+			}
+
+			prevChild = child;
+			numLinked += 1;
+		}
+
+		if ( pcb -> lastChild != prevChild || pcb -> numChildren != numLinked || pcb -> numZombieChildren != numZombies ) 
+		{
+			return InvariantViolated ( check , "process %d counts %d children (%d ZOMBIE) but links %d (%d ZOMBIE)" , pcb -> processID , pcb -> numChildren , pcb -> numZombieChildren , numLinked , numZombies );
+		}
+
+		if ( pcb -> processState == WAIT_BLOCKED && ( numLinked == numZombies || numZombies > 0 ) ) 
+		{
+			return InvariantViolated ( check , "process %d is WAIT-BLOCKED with no live child or with a ZOMBIE to reap" , pcb -> processID );
+		}
+
+		numLinkedLiveTotal += numLinked - numZombies;
+		numLinkedZombiesTotal += numZombies;
+	}
+
+	if ( numLinkedLiveTotal != numParentedProcesses ) 
+	{
+		return InvariantViolated ( check , "%d processes have a parent but the child lists link %d" , numParentedProcesses , numLinkedLiveTotal );
+	}
+
+	if ( numLinkedZombiesTotal != sim -> numZombieProcesses ) 
+	{
+		return InvariantViolated ( check , "child lists link %d ZOMBIE processes but %d are counted" , numLinkedZombiesTotal , sim -> numZombieProcesses );
+	}
+
+	if ( sim -> initProcess.firstChild || sim -> initProcess.numChildren != 0 ) 
+	{
+		return InvariantViolated ( check , "INIT links children of its own" );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* each page table is held by exactly refCount live processes, and each page by exactly refCount of those tables */
+int CheckProcessMemory ( INVARIANT_CHECK *check ) 
+{
+	if ( check -> sim -> initProcess.addressSpace ) 
+	{
+		return InvariantViolated ( check , "INIT holds memory of its own" );
+	}
+
+	ADDRESS_SPACE **addressSpaces = ( ADDRESS_SPACE **) malloc ( ( check -> numProcesses + 1 ) * sizeof ( ADDRESS_SPACE *) );
+	if ( !addressSpaces ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	int numHeld = 0;
+	for ( int i = 0 ; i < check -> numProcesses ; i++ ) 
+	{
+		if ( check -> processes [ i ] -> addressSpace ) 
+		{
+			addressSpaces [ numHeld ] = check -> processes [ i ] -> addressSpace;
+			numHeld += 1;
+		}
+	}
+
+	qsort ( addressSpaces , numHeld , sizeof ( ADDRESS_SPACE *) , &ComparePointers );
+
+	// each run of equal tables is one table, the distinct ones are packed to the front as they are checked
+	int numAddressSpaces = 0;
+	int status = OSSIM_SUCCESS;
+	for ( int i = 0 ; i < numHeld && status == OSSIM_SUCCESS ; ) 
+	{
+		ADDRESS_SPACE *addressSpace = addressSpaces [ i ];
+		int runLength = 1;
+		while ( i + runLength < numHeld && addressSpaces [ i + runLength ] == addressSpace ) 
+		{
+			runLength += 1;
+		}
+
+		if ( addressSpace -> refCount != runLength ) 
+		{
+			status = InvariantViolated ( check , "a page table held by %d processes counts %d" , runLength , addressSpace -> refCount );
+		}
+
+		addressSpaces [ numAddressSpaces ] = addressSpace;
+		numAddressSpaces += 1;
+		i += runLength;
+	}
+
+	MEMORY_PAGE **pages = NULL;
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		pages = ( MEMORY_PAGE **) malloc ( ( ( size_t ) numAddressSpaces * NUM_MEMORY_PAGES + 1 ) * sizeof ( MEMORY_PAGE *) );
+		status = pages ? OSSIM_SUCCESS : OSSIM_FAILURE;
+	}
+
+	int numPagesHeld = 0;
+	for ( int i = 0 ; i < numAddressSpaces && status == OSSIM_SUCCESS ; i++ ) 
+	{
+		int numPages = 0;
+		for ( int j = 0 ; j < NUM_MEMORY_PAGES ; j++ ) 
+		{
+			if ( addressSpaces [ i ] -> pages [ j ] ) 
+			{
+				pages [ numPagesHeld ] = addressSpaces [ i ] -> pages [ j ];
+				numPagesHeld += 1;
+				numPages += 1;
+			}
+		}
+
+		if ( addressSpaces [ i ] -> numPages != numPages ) 
+		{
+			status = InvariantViolated ( check , "a page table counts %d pages but holds %d" , addressSpaces [ i ] -> numPages , numPages );
+		}
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		qsort ( pages , numPagesHeld , sizeof ( MEMORY_PAGE *) , &ComparePointers );
+	}
+
+	for ( int i = 0 ; i < numPagesHeld && status == OSSIM_SUCCESS ; ) 
+	{
+		int runLength = 1;
+		while ( i + runLength < numPagesHeld && pages [ i + runLength ] == pages [ i ] ) 
+		{
+			runLength += 1;
+		}
+
+		if ( pages [ i ] -> refCount != runLength || pages [ i ] -> data [ MEMORY_PAGE_SIZE - 1 ] != '\0' ) 
+		{
+			status = InvariantViolated ( check , "a page held by %d page tables counts %d, or is not terminated" , runLength , pages [ i ] -> refCount );
+		}
+
+		i += runLength;
+	}
+
+	free ( addressSpaces );
+	free ( pages );
+	return status;
+}
+
+/* the holder list of a lock links exactly the processes holding it, latest to take it first */
+int CheckSemaphoreHolders ( INVARIANT_CHECK *check , int semaphoreID ) 
+{
+	int numHolders = 0;
+	for ( int i = 0 ; i < check -> numProcesses ; i++ ) 
+	{
+		if ( check -> processes [ i ] -> semaphoresHeld [ semaphoreID ] > 0 ) 
+		{
+			numHolders += 1;
+		}
+	}
+
+	int numLinked = 0;
+	PCB *prevHolder = NULL;
+	for ( PCB *holder = check -> sim -> semaphores [ semaphoreID ].firstHolder ; holder ; holder = holder -> nextHolder [ semaphoreID ] ) 
+	{
+		if ( numLinked >= numHolders || !IsCheckedProcess ( check , holder ) || holder -> semaphoresHeld [ semaphoreID ] == 0 ) 
+		{
+			return InvariantViolated ( check , "semaphore %d links holder %d, which holds none of it or no queue holds" , semaphoreID , holder -> processID );
+		}
+
+		long holdSequence = holder -> holdSequence [ semaphoreID ];
+		if ( holder -> prevHolder [ semaphoreID ] != prevHolder || holdSequence <= 0 || 
+			holdSequence > ( prevHolder ? prevHolder -> holdSequence [ semaphoreID ] - 1 : check -> sim -> semaphores [ semaphoreID ].numTakes ) ) 
+		{
+			return InvariantViolated ( check , "holders of semaphore %d are out of take order at process %d" , semaphoreID , holder -> processID );
+		}
+
+		prevHolder = holder;
+		numLinked += 1;
+	}
+
+	if ( numLinked != numHolders ) 
+	{
+		return InvariantViolated ( check , "%d processes hold semaphore %d but its holder list links %d" , numHolders , semaphoreID , numLinked );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* also runs after CheckProcessCounts - every wait-for edge joins two live processes, the waiting-sender and holder
+ * lists link exactly the processes at their ends, and every level inherited matches the waiters behind it */
+int CheckWaitForGraph ( INVARIANT_CHECK *check ) 
+{
+	OS_SIM *sim = check -> sim;
+	PCB *initProcess = &sim -> initProcess;
+	if ( initProcess -> sendRecipient || initProcess -> firstWaitingSender || HoldsLockSemaphore ( initProcess ) || 
+		initProcess -> inheritedPriorityLevel != NO_INHERITED_PRIORITY ) 
+	{
+		return InvariantViolated ( check , "INIT holds a wait-for edge" );
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		for ( NODE *node = sim -> semaphores [ i ].blockedPCBs -> headNodePtr ; node ; node = node -> nextNodePtr ) 
+		{
+			PCB *pcb = node -> valuePtr;
+			if ( pcb -> blockedSemaphoreID != i ) 
+			{
+				return InvariantViolated ( check , "process %d is in the queue of semaphore %d but is blocked on %d" , pcb -> processID , i , pcb -> blockedSemaphoreID );
+			}
+		}
+	}
+
+	int numWaitingSenders = 0;
+	int numLinkedTotal = 0;
+	for ( int i = 0 ; i < check -> numProcesses ; i++ ) 
+	{
+		PCB *pcb = check -> processes [ i ];
+		for ( int j = 0 ; j < NUM_SEMAPHORES ; j++ ) 
+		{
+			if ( pcb -> semaphoresHeld [ j ] < 0 || ( pcb -> semaphoresHeld [ j ] > 0 && !IsLockSemaphore ( &sim -> semaphores [ j ] ) ) ) 
+			{
+				return InvariantViolated ( check , "process %d holds %d units of semaphore %d, which is not a lock" , pcb -> processID , pcb -> semaphoresHeld [ j ] , j );
+			}
+
+			if ( pcb -> semaphoresHeld [ j ] == 0 && pcb -> holdSequence [ j ] != 0 ) 
+			{
+				return InvariantViolated ( check , "process %d holds none of semaphore %d but took it at %ld" , pcb -> processID , j , pcb -> holdSequence [ j ] );
+			}
+		}
+
+		if ( pcb -> processState != SEND_BLOCKED || !pcb -> sendRecipient ) 
+		{
+			int validNoRecipient = !pcb -> sendRecipient && pcb -> sendRecipientID == INIT_PROCESS_ID && !pcb -> nextWaitingSender && !pcb -> prevWaitingSender;
+			if ( !validNoRecipient ) 
+			{
+				return InvariantViolated ( check , "process %d is %d but waits for a reply from %d" , pcb -> processID , pcb -> processState , pcb -> sendRecipientID );
+			}
+		}
+		else if ( !IsCheckedProcess ( check , pcb -> sendRecipient ) || pcb -> sendRecipient == pcb || pcb -> sendRecipient -> processID != pcb -> sendRecipientID ) 
+		{
+			return InvariantViolated ( check , "process %d waits for a reply from %d, which no queue holds" , pcb -> processID , pcb -> sendRecipientID );
+		}
+		else 
+		{
+			numWaitingSenders += 1;
+		}
+
+		PCB *prevSender = NULL;
+		for ( PCB *sender = pcb -> firstWaitingSender ; sender ; sender = sender -> nextWaitingSender ) 
+		{
+			if ( numLinkedTotal >= check -> numProcesses ) 
+			{
+				return InvariantViolated ( check , "waiting-sender lists link more than the %d live processes" , check -> numProcesses );
+			}
+
+			if ( sender -> sendRecipient != pcb || sender -> prevWaitingSender != prevSender ) 
+			{
+				return InvariantViolated ( check , "process %d links waiting sender %d, whose links are wrong" , pcb -> processID , sender -> processID );
+			}
+
+			prevSender = sender;
+			numLinkedTotal += 1;
+		}
+	}
+
+	if ( numLinkedTotal != numWaitingSenders ) 
+	{
+		return InvariantViolated ( check , "%d processes wait for a live recipient but the waiting-sender lists link %d" , numWaitingSenders , numLinkedTotal );
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		int status = CheckSemaphoreHolders ( check , i );
+		if ( status != OSSIM_SUCCESS ) 
+		{
+			return status;
+		}
+	}
+
+	// the searches only move marks the logical state leaves out
+	for ( int i = 0 ; i < check -> numProcesses ; i++ ) 
+	{
+		PCB *pcb = check -> processes [ i ];
+		int inheritablePriorityLevel = InheritablePriorityLevel ( sim , pcb );
+		if ( pcb -> inheritedPriorityLevel != inheritablePriorityLevel ) 
+		{
+			return InvariantViolated ( check , "process %d inherited level %d but the processes waiting on it lend %d" , pcb -> processID , pcb -> inheritedPriorityLevel , inheritablePriorityLevel );
+		}
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int OSSimCheckInvariants ( OS_SIM *sim , char *violation , int violationLength ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	INVARIANT_CHECK check = 
+	{
+		.sim = sim ,
+		.maxProcesses = sim -> numLiveProcesses ,
+		.violation = violation ,
+		.violationLength = violationLength
+	};
+
+	check.processes = ( PCB **) malloc ( ( check.maxProcesses + 1 ) * sizeof ( PCB *) );
+	if ( !check.processes ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	int status = CheckAllQueues ( &check );
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckProcessCounts ( &check );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckProcessGroups ( &check );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckProcessTree ( &check );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckProcessMemory ( &check );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckWaitForGraph ( &check );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = CheckListPool ( &check );
+	}
+
+	free ( check.processes );
+	return status;
+}
+
+/* STATE HASH - FNV-1a over the logical state in queue order, never over addresses or pool slots, so two
+ * instances that reached the same state by the same commands (or through a snapshot) hash the same */
+#define STATE_HASH_OFFSET_BASIS 14695981039346656037UL
+#define STATE_HASH_PRIME 1099511628211UL
+#define STATE_HASH_NO_PROCESS -1
+
+unsigned long HashBytes ( unsigned long hash , const void *bytes , size_t length ) 
+{
+	const unsigned char *byte = ( const unsigned char *) bytes;
+	for ( size_t i = 0 ; i < length ; i++ ) 
+	{
+		hash ^= byte [ i ];
+		hash *= STATE_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+unsigned long HashInt ( unsigned long hash , long value ) 
+{
+	return HashBytes ( hash , &value , sizeof ( long ) );
+}
+
+unsigned long HashMessage ( unsigned long hash , const MESSAGE *message ) 
+{
+	if ( !message ) 
+	{
+		return HashInt ( hash , STATE_HASH_NO_PROCESS );
+	}
+
+	hash = HashInt ( hash , message -> senderProcessID );
+	hash = HashInt ( hash , message -> recipientProcessID );
+	return HashBytes ( hash , message -> messageStr , strnlen ( message -> messageStr , MAX_MESSAGE_LENGTH ) ); // bytes past the terminator are never read
+}
+
+/* the holder counts are hashed with the contents, sharing decides which later writes copy */
+unsigned long HashAddressSpace ( unsigned long hash , const ADDRESS_SPACE *addressSpace ) 
+{
+	if ( !addressSpace ) 
+	{
+		return HashInt ( hash , STATE_HASH_NO_PROCESS );
+	}
+
+	hash = HashInt ( hash , addressSpace -> refCount );
+	hash = HashInt ( hash , addressSpace -> numPages );
+	for ( int i = 0 ; i < NUM_MEMORY_PAGES ; i++ ) 
+	{
+		const MEMORY_PAGE *page = addressSpace -> pages [ i ];
+		if ( page ) 
+		{
+			hash = HashInt ( hash , i );
+			hash = HashInt ( hash , page -> refCount );
+			hash = HashBytes ( hash , page -> data , strnlen ( page -> data , MEMORY_PAGE_SIZE ) );
+		}
+	}
+
+	return hash;
+}
+
+unsigned long HashProcess ( unsigned long hash , const PCB *pcb ) 
+{
+	if ( !pcb ) 
+	{
+		return HashInt ( hash , STATE_HASH_NO_PROCESS );
+	}
+
+	const long fields [] = 
+	{
+		pcb -> processID , pcb -> priorityLevel , pcb -> inheritedPriorityLevel , pcb -> priorityDirection , pcb -> numCPUBurstsInPriorityLevel , 
+		pcb -> processState , pcb -> cpuID , pcb -> affinityMask , pcb -> numMigrations , pcb -> numCrossNodeMigrations , 
+		pcb -> warmUpBurstsLeft , pcb -> schedulingClass , pcb -> period , pcb -> relativeDeadline , pcb -> budget , 
+		pcb -> remainingBudget , pcb -> releaseTick , pcb -> absoluteDeadline , pcb -> numJobsCompleted , 
+		pcb -> numDeadlineMisses , pcb -> readyTick , pcb -> groupID , pcb -> parentProcessID , pcb -> numChildren , 
+		pcb -> numZombieChildren , pcb -> waitedChildID , pcb -> waitedExitStatus , pcb -> sendRecipientID
+	};
+
+	for ( size_t i = 0 ; i < sizeof ( fields ) / sizeof ( long ) ; i++ ) 
+	{
+		hash = HashInt ( hash , fields [ i ] );
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		hash = HashInt ( hash , pcb -> semaphoresHeld [ i ] );
+		hash = HashInt ( hash , pcb -> holdSequence [ i ] );
+	}
+
+	// a ZOMBIE is in no queue, so it is hashed with the parent that holds it
+	for ( const PCB *child = pcb -> firstChild ; child ; child = child -> nextSibling ) 
+	{
+		if ( child -> processState == ZOMBIE ) 
+		{
+			hash = HashInt ( hash , child -> processID );
+			hash = HashInt ( hash , child -> exitStatus );
+		}
+	}
+
+	hash = HashAddressSpace ( hash , pcb -> addressSpace );
+	return HashMessage ( hash , pcb -> readMessage );
+}
+
+unsigned long HashList ( unsigned long hash , LIST *list , int isMessageList ) 
+{
+	hash = HashInt ( hash , ListCount ( list ) );
+
+	// walks the links directly so the list cursor is never moved
+	for ( NODE *node = list -> headNodePtr ; node ; node = node -> nextNodePtr ) 
+	{
+		hash = isMessageList ? HashMessage ( hash , node -> valuePtr ) : HashProcess ( hash , node -> valuePtr );
+	}
+
+	return hash;
+}
+
+unsigned long HashHeap ( unsigned long hash , HEAP *heap ) 
+{
+	hash = HashInt ( hash , heap -> count );
+	for ( int i = 0 ; i < heap -> count ; i++ ) 
+	{
+		hash = HashProcess ( hash , heap -> items [ i ] );
+	}
+
+	return hash;
+}
+
+unsigned long OSSimStateHash ( OS_SIM *sim ) 
+{
+	unsigned long hash = STATE_HASH_OFFSET_BASIS;
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return hash;
+	}
+
+	const long fields [] = 
+	{
+		sim -> numCPUs , sim -> numNodes , sim -> numCPUsPerCache , sim -> currentCPU -> cpuID , 
+		sim -> numPriorityLevels , sim -> maxCPUBursts , sim -> agingPolicy , sim -> nextAvailProcessID , 
+		sim -> numLiveProcesses , sim -> numPromotions , sim -> numDemotions , sim -> numDispatches , 
+		sim -> totalReadyWaitTicks , sim -> maxReadyWaitTicks , sim -> totalDeadlineMisses , sim -> currentTick , 
+		sim -> numRealTimeProcesses , sim -> totalMigrationWarmUpBursts , sim -> numZombieProcesses , sim -> numForks , 
+		sim -> numForkPagesShared , sim -> numPageTableCopies , sim -> numCOWFaults , sim -> numDeadlockSearches , 
+		sim -> numDeadlockSearchSteps , sim -> numDeadlocksDetected , sim -> numDeadlockedProcesses , sim -> numPriorityBoosts , 
+		sim -> numBoostedRunTicks
+	};
+
+	for ( size_t i = 0 ; i < sizeof ( fields ) / sizeof ( long ) ; i++ ) 
+	{
+		hash = HashInt ( hash , fields [ i ] );
+	}
+
+	for ( int i = 0 ; i < NUM_CPU_DISTANCES ; i++ ) 
+	{
+		hash = HashInt ( hash , sim -> numMigrationsByDistance [ i ] );
+	}
+
+	hash = HashProcess ( hash , &sim -> initProcess );
+
+	for ( int i = 0 ; i < sim -> numCPUs ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		const long cpuFields [] = 
+		{
+			cpu -> numBusyTicks , cpu -> numIdleTicks , cpu -> numContextSwitches , cpu -> numMigrationsIn , 
+			cpu -> numMigrationsOut , cpu -> numSteals , cpu -> numWarmUpBursts , 
+			cpu -> runningProcess ? cpu -> runningProcess -> processID : STATE_HASH_NO_PROCESS
+		};
+
+		for ( size_t j = 0 ; j < sizeof ( cpuFields ) / sizeof ( long ) ; j++ ) 
+		{
+			hash = HashInt ( hash , cpuFields [ j ] );
+		}
+
+		for ( int level = 0 ; level < sim -> numPriorityLevels ; level++ ) 
+		{
+			hash = HashList ( hash , cpu -> readyPriorityQueues [ level ] , 0 );
+		}
+
+		hash = HashHeap ( hash , cpu -> realTimeReadyHeap );
+	}
+
+	hash = HashList ( hash , sim -> sendBlockedQueue , 0 );
+	hash = HashList ( hash , sim -> receiveBlockedQueue , 0 );
+	hash = HashList ( hash , sim -> waitBlockedQueue , 0 );
+	hash = HashList ( hash , sim -> messagesQueue , 1 );
+	hash = HashHeap ( hash , sim -> realTimeReleaseHeap );
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		SEMAPHORE *semaphore = &sim -> semaphores [ i ];
+		hash = HashInt ( hash , semaphore -> semStatus );
+		hash = HashInt ( hash , semaphore -> semValue );
+		hash = HashInt ( hash , semaphore -> initSemValue );
+		hash = HashInt ( hash , semaphore -> numTakes );
+		hash = HashList ( hash , semaphore -> blockedPCBs , 0 );
+	}
+
+	return hash;
+}
+
+/* SNAPSHOTS - pointers into the instance are stored as offsets from its start (+1, so 0 stays NULL) and PCB /
+ * MESSAGE pointers as indexes into the tables that follow the image, so the file does not depend on where
+ * either instance lives and can be restored straight from a read-only mapping */
+#define SNAPSHOT_MAGIC "OSSIMSNP"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_INIT_PROCESS -1 // a CPU running INIT
+
+typedef struct snapshotHeader
+{
+	char magic [ 8 ];
+	unsigned int version;
+	unsigned int headerSize; // sizes of the build that wrote it, a snapshot only restores into the same layout
+	unsigned int simSize;
+	unsigned int processSize;
+	unsigned int messageSize;
+	unsigned int addressSpaceSize;
+	unsigned int pageSize;
+	int numProcesses;
+	int numMessages;
+	int numAddressSpaces;
+	int numPages;
+	int runningProcesses [ MAX_NUM_CPUS ]; // process table index, or SNAPSHOT_INIT_PROCESS
+	int numRealTimeReady [ MAX_NUM_CPUS ]; // heap table entries of each CPU's ready heap, in heap order
+	int numRealTimeWaiting; // then the release heap
+	int initHasMessage;
+	MESSAGE initMessage;
+	unsigned long fileSize;
+} SNAPSHOT_HEADER;
+
+typedef struct snapshotProcess
+{
+	PCB pcb; // readMessage and addressSpace are not used
+	int hasReadMessage;
+	MESSAGE readMessage;
+	int addressSpaceIndex; // address space table index, -1 = none
+} SNAPSHOT_PROCESS;
+
+typedef struct snapshotAddressSpace
+{
+	int refCount;
+	int numPages;
+	int pageIndexes [ NUM_MEMORY_PAGES ]; // page table index, -1 = never written
+} SNAPSHOT_ADDRESS_SPACE;
+
+/* FILE LAYOUT - header, OS_SIM image, process table, message table, address space table, page table (MEMORY_PAGE),
+ * heap table (int process indexes) - a page table or page shared copy-on-write is stored once */
+typedef struct snapshot
+{
+	SNAPSHOT_HEADER header;
+	OS_SIM *image;
+	PCB **processes;
+	int numProcesses;
+	MESSAGE **messages;
+	int numMessages;
+	ADDRESS_SPACE **addressSpaces; // sorted by address, so each one's index is found by bsearch
+	int numAddressSpaces;
+	MEMORY_PAGE **pages; // sorted the same way
+	int numPages;
+	int *heapIndexes;
+	int numHeapIndexes;
+} SNAPSHOT;
+
+void *RelocatePointer ( void *ptr , uintptr_t fromBase , uintptr_t toBase ) 
+{
+	if ( !ptr ) 
+	{
+		return NULL;
+	}
+
+	return ( void *) ( ( uintptr_t ) ptr - fromBase + toBase );
+}
+
+/* moves every pointer that points inside the instance, PCB / MESSAGE pointers and heaps are left alone */
+void RelocateInternalPointers ( OS_SIM *sim , uintptr_t fromBase , uintptr_t toBase ) 
+{
+	PCB *fromInitProcess = ( PCB *) ( fromBase + offsetof ( OS_SIM , initProcess ) );
+	for ( int i = 0 ; i < MAX_NUM_CPUS ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		for ( int j = 0 ; j < MAX_NUM_PRIORITY_LEVELS ; j++ ) 
+		{
+			cpu -> readyPriorityQueues [ j ] = RelocatePointer ( cpu -> readyPriorityQueues [ j ] , fromBase , toBase );
+		}
+
+		if ( cpu -> runningProcess == fromInitProcess ) 
+		{
+			cpu -> runningProcess = RelocatePointer ( cpu -> runningProcess , fromBase , toBase );
+		}
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		sim -> semaphores [ i ].blockedPCBs = RelocatePointer ( sim -> semaphores [ i ].blockedPCBs , fromBase , toBase );
+	}
+
+	sim -> currentCPU = RelocatePointer ( sim -> currentCPU , fromBase , toBase );
+	sim -> sendBlockedQueue = RelocatePointer ( sim -> sendBlockedQueue , fromBase , toBase );
+	sim -> receiveBlockedQueue = RelocatePointer ( sim -> receiveBlockedQueue , fromBase , toBase );
+	sim -> waitBlockedQueue = RelocatePointer ( sim -> waitBlockedQueue , fromBase , toBase );
+	sim -> messagesQueue = RelocatePointer ( sim -> messagesQueue , fromBase , toBase );
+
+	LIST_POOL *pool = &sim -> listPool;
+	for ( int i = 0 ; i < MAX_NUM_NODES_ALLOC ; i++ ) 
+	{
+		NODE *node = &pool -> allocNodesArr [ i ];
+		node -> prevNodePtr = RelocatePointer ( node -> prevNodePtr , fromBase , toBase );
+		node -> nextNodePtr = RelocatePointer ( node -> nextNodePtr , fromBase , toBase );
+		pool -> freeNodeIndexesPtrArr [ i ] = RelocatePointer ( pool -> freeNodeIndexesPtrArr [ i ] , fromBase , toBase );
+	}
+
+	for ( int i = 0 ; i < MAX_NUM_LISTS_ALLOC ; i++ ) 
+	{
+		LIST *list = &pool -> allocListsArr [ i ];
+		list -> currentNodePtr = RelocatePointer ( list -> currentNodePtr , fromBase , toBase );
+		list -> headNodePtr = RelocatePointer ( list -> headNodePtr , fromBase , toBase );
+		list -> tailNodePtr = RelocatePointer ( list -> tailNodePtr , fromBase , toBase );
+		list -> pool = RelocatePointer ( list -> pool , fromBase , toBase );
+		pool -> freeListIndexesPtrArr [ i ] = RelocatePointer ( pool -> freeListIndexesPtrArr [ i ] , fromBase , toBase );
+	}
+}
+
+/* PROCESS / MESSAGE TABLES - each PCB and MESSAGE is held once, so it gets the next index the first time it is seen */
+int SnapshotProcess ( SNAPSHOT *snapshot , PCB *pcb ) 
+{
+	if ( snapshot -> numProcesses >= snapshot -> image -> numLiveProcesses + snapshot -> image -> numZombieProcesses ) 
+	{
+		return OSSIM_INVARIANT_VIOLATED;
+	}
+
+	snapshot -> processes [ snapshot -> numProcesses ] = pcb;
+	snapshot -> numProcesses += 1;
+	return snapshot -> numProcesses - 1;
+}
+
+int SnapshotList ( SNAPSHOT *snapshot , OS_SIM *sim , LIST *list , int isMessageList ) 
+{
+	for ( NODE *node = list -> headNodePtr ; node ; node = node -> nextNodePtr ) 
+	{
+		int index = 0;
+		if ( isMessageList ) 
+		{
+			if ( snapshot -> numMessages >= ListCount ( sim -> messagesQueue ) ) 
+			{
+				return OSSIM_INVARIANT_VIOLATED;
+			}
+
+			index = snapshot -> numMessages;
+			snapshot -> messages [ snapshot -> numMessages ] = node -> valuePtr;
+			snapshot -> numMessages += 1;
+		}
+		else 
+		{
+			index = SnapshotProcess ( snapshot , node -> valuePtr );
+		}
+
+		if ( index < 0 ) 
+		{
+			return OSSIM_INVARIANT_VIOLATED;
+		}
+
+		NODE *imageNode = &snapshot -> image -> listPool.allocNodesArr [ node -> allocID ];
+		imageNode -> valuePtr = ( void *) ( uintptr_t ) ( index + 1 );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int SnapshotHeap ( SNAPSHOT *snapshot , HEAP *heap ) 
+{
+	for ( int i = 0 ; i < heap -> count ; i++ ) 
+	{
+		int index = SnapshotProcess ( snapshot , heap -> items [ i ] );
+		if ( index < 0 ) 
+		{
+			return OSSIM_INVARIANT_VIOLATED;
+		}
+
+		snapshot -> heapIndexes [ snapshot -> numHeapIndexes ] = index;
+		snapshot -> numHeapIndexes += 1;
+	}
+
+	return heap -> count; // also the number of heap table entries written
+}
+
+/* MEMORY TABLES - sorted and packed to one entry per page table or page, however many processes share it */
+int PackPointers ( void **items , int numItems ) 
+{
+	qsort ( items , numItems , sizeof ( void *) , &ComparePointers );
+
+	int numPacked = 0;
+	for ( int i = 0 ; i < numItems ; i++ ) 
+	{
+		if ( numPacked == 0 || items [ numPacked - 1 ] != items [ i ] ) 
+		{
+			items [ numPacked ] = items [ i ];
+			numPacked += 1;
+		}
+	}
+
+	return numPacked;
+}
+
+int MemoryTableIndex ( const void *item , void *const *table , int numItems ) 
+{
+	if ( !item ) 
+	{
+		return -1;
+	}
+
+	void *const *found = bsearch ( &item , table , numItems , sizeof ( void *) , &ComparePointers );
+	return found ? ( int ) ( found - table ) : -1;
+}
+
+int SnapshotMemory ( SNAPSHOT *snapshot ) 
+{
+	snapshot -> addressSpaces = ( ADDRESS_SPACE **) malloc ( ( snapshot -> numProcesses + 1 ) * sizeof ( ADDRESS_SPACE *) );
+	if ( !snapshot -> addressSpaces ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	for ( int i = 0 ; i < snapshot -> numProcesses ; i++ ) 
+	{
+		if ( snapshot -> processes [ i ] -> addressSpace ) 
+		{
+			snapshot -> addressSpaces [ snapshot -> numAddressSpaces ] = snapshot -> processes [ i ] -> addressSpace;
+			snapshot -> numAddressSpaces += 1;
+		}
+	}
+
+	snapshot -> numAddressSpaces = PackPointers ( ( void **) snapshot -> addressSpaces , snapshot -> numAddressSpaces );
+
+	snapshot -> pages = ( MEMORY_PAGE **) malloc ( ( ( size_t ) snapshot -> numAddressSpaces * NUM_MEMORY_PAGES + 1 ) * sizeof ( MEMORY_PAGE *) );
+	if ( !snapshot -> pages ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	for ( int i = 0 ; i < snapshot -> numAddressSpaces ; i++ ) 
+	{
+		for ( int j = 0 ; j < NUM_MEMORY_PAGES ; j++ ) 
+		{
+			if ( snapshot -> addressSpaces [ i ] -> pages [ j ] ) 
+			{
+				snapshot -> pages [ snapshot -> numPages ] = snapshot -> addressSpaces [ i ] -> pages [ j ];
+				snapshot -> numPages += 1;
+			}
+		}
+	}
+
+	snapshot -> numPages = PackPointers ( ( void **) snapshot -> pages , snapshot -> numPages );
+	return OSSIM_SUCCESS;
+}
+
+int BuildSnapshot ( SNAPSHOT *snapshot , OS_SIM *sim ) 
+{
+	SNAPSHOT_HEADER *header = &snapshot -> header;
+	*snapshot -> image = *sim;
+	OS_SIM *image = snapshot -> image;
+
+	for ( int i = 0 ; i < MAX_NUM_NODES_ALLOC ; i++ ) 
+	{
+		image -> listPool.allocNodesArr [ i ].valuePtr = NULL;
+	}
+
+	int status = OSSIM_SUCCESS;
+	for ( int i = 0 ; i < sim -> numCPUs && status == OSSIM_SUCCESS ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		header -> runningProcesses [ i ] = SNAPSHOT_INIT_PROCESS;
+		if ( cpu -> runningProcess != &sim -> initProcess ) 
+		{
+			header -> runningProcesses [ i ] = SnapshotProcess ( snapshot , cpu -> runningProcess );
+			status = header -> runningProcesses [ i ] < 0 ? OSSIM_INVARIANT_VIOLATED : OSSIM_SUCCESS;
+		}
+
+		for ( int j = 0 ; j < sim -> numPriorityLevels && status == OSSIM_SUCCESS ; j++ ) 
+		{
+			status = SnapshotList ( snapshot , sim , cpu -> readyPriorityQueues [ j ] , 0 );
+		}
+
+		header -> numRealTimeReady [ i ] = SnapshotHeap ( snapshot , cpu -> realTimeReadyHeap );
+		if ( header -> numRealTimeReady [ i ] < 0 ) 
+		{
+			status = OSSIM_INVARIANT_VIOLATED;
+		}
+
+		image -> cpus [ i ].realTimeReadyHeap = NULL;
+		image -> cpus [ i ].runningProcess = NULL;
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES && status == OSSIM_SUCCESS ; i++ ) 
+	{
+		status = SnapshotList ( snapshot , sim , sim -> semaphores [ i ].blockedPCBs , 0 );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = SnapshotList ( snapshot , sim , sim -> sendBlockedQueue , 0 );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = SnapshotList ( snapshot , sim , sim -> receiveBlockedQueue , 0 );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = SnapshotList ( snapshot , sim , sim -> waitBlockedQueue , 0 );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = SnapshotList ( snapshot , sim , sim -> messagesQueue , 1 );
+	}
+
+	header -> numRealTimeWaiting = SnapshotHeap ( snapshot , sim -> realTimeReleaseHeap );
+
+	if ( status != OSSIM_SUCCESS || header -> numRealTimeWaiting < 0 || snapshot -> numProcesses != sim -> numLiveProcesses ) 
+	{
+		return OSSIM_INVARIANT_VIOLATED;
+	}
+
+	// ZOMBIE processes are in no queue, they follow the live ones in the table and are found through their parents
+	for ( int i = 0 ; i < sim -> numLiveProcesses ; i++ ) 
+	{
+		for ( PCB *child = snapshot -> processes [ i ] -> firstChild ; child ; child = child -> nextSibling ) 
+		{
+			if ( child -> processState == ZOMBIE && SnapshotProcess ( snapshot , child ) < 0 ) 
+			{
+				return OSSIM_INVARIANT_VIOLATED;
+			}
+		}
+	}
+
+	if ( snapshot -> numProcesses != sim -> numLiveProcesses + sim -> numZombieProcesses ) 
+	{
+		return OSSIM_INVARIANT_VIOLATED;
+	}
+
+	status = SnapshotMemory ( snapshot );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	header -> initHasMessage = sim -> initProcess.readMessage != NULL;
+	if ( header -> initHasMessage ) 
+	{
+		header -> initMessage = *sim -> initProcess.readMessage;
+	}
+
+	image -> realTimeReleaseHeap = NULL;
+	image -> initProcess.readMessage = NULL;
+	memset ( image -> processGroups , 0 , sizeof ( image -> processGroups ) ); // rebuilt from each PCB's groupID
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		image -> semaphores [ i ].firstHolder = NULL; // rebuilt from each PCB's semaphoresHeld
+	}
+
+	image -> lastWaitSearchID = 0;
+	image -> lastInheritanceUpdateID = 0;
+	image -> outputFile = NULL;
+	image -> subscribedEventsMask = 0;
+	memset ( image -> subscribers , 0 , sizeof ( image -> subscribers ) );
+	RelocateInternalPointers ( image , ( uintptr_t ) sim , 1 );
+
+	memcpy ( header -> magic , SNAPSHOT_MAGIC , sizeof ( header -> magic ) );
+	header -> version = SNAPSHOT_VERSION;
+	header -> headerSize = sizeof ( SNAPSHOT_HEADER );
+	header -> simSize = sizeof ( OS_SIM );
+	header -> processSize = sizeof ( SNAPSHOT_PROCESS );
+	header -> messageSize = sizeof ( MESSAGE );
+	header -> addressSpaceSize = sizeof ( SNAPSHOT_ADDRESS_SPACE );
+	header -> pageSize = sizeof ( MEMORY_PAGE );
+	header -> numProcesses = snapshot -> numProcesses;
+	header -> numMessages = snapshot -> numMessages;
+	header -> numAddressSpaces = snapshot -> numAddressSpaces;
+	header -> numPages = snapshot -> numPages;
+	header -> fileSize = sizeof ( SNAPSHOT_HEADER ) + 
+		sizeof ( OS_SIM ) + 
+		snapshot -> numProcesses * sizeof ( SNAPSHOT_PROCESS ) + 
+		snapshot -> numMessages * sizeof ( MESSAGE ) + 
+		snapshot -> numAddressSpaces * sizeof ( SNAPSHOT_ADDRESS_SPACE ) + 
+		snapshot -> numPages * sizeof ( MEMORY_PAGE ) + 
+		snapshot -> numHeapIndexes * sizeof ( int );
+
+	return OSSIM_SUCCESS;
+}
+
+int WriteSnapshot ( const SNAPSHOT *snapshot , FILE *file ) 
+{
+	int written = fwrite ( &snapshot -> header , sizeof ( SNAPSHOT_HEADER ) , 1 , file ) == 1 && 
+		fwrite ( snapshot -> image , sizeof ( OS_SIM ) , 1 , file ) == 1;
+
+	for ( int i = 0 ; i < snapshot -> numProcesses && written ; i++ ) 
+	{
+		SNAPSHOT_PROCESS process;
+		memset ( &process , 0 , sizeof ( SNAPSHOT_PROCESS ) );
+		process.pcb = *snapshot -> processes [ i ];
+		process.pcb.readMessage = NULL;
+		process.pcb.addressSpace = NULL;
+		process.addressSpaceIndex = MemoryTableIndex ( snapshot -> processes [ i ] -> addressSpace , ( void **) snapshot -> addressSpaces , snapshot -> numAddressSpaces );
+		process.hasReadMessage = snapshot -> processes [ i ] -> readMessage != NULL;
+		if ( process.hasReadMessage ) 
+		{
+			process.readMessage = *snapshot -> processes [ i ] -> readMessage;
+		}
+
+		written = fwrite ( &process , sizeof ( SNAPSHOT_PROCESS ) , 1 , file ) == 1;
+	}
+
+	for ( int i = 0 ; i < snapshot -> numMessages && written ; i++ ) 
+	{
+		written = fwrite ( snapshot -> messages [ i ] , sizeof ( MESSAGE ) , 1 , file ) == 1;
+	}
+
+	for ( int i = 0 ; i < snapshot -> numAddressSpaces && written ; i++ ) 
+	{
+		SNAPSHOT_ADDRESS_SPACE addressSpace;
+		addressSpace.refCount = snapshot -> addressSpaces [ i ] -> refCount;
+		addressSpace.numPages = snapshot -> addressSpaces [ i ] -> numPages;
+		for ( int j = 0 ; j < NUM_MEMORY_PAGES ; j++ ) 
+		{
+			addressSpace.pageIndexes [ j ] = MemoryTableIndex ( snapshot -> addressSpaces [ i ] -> pages [ j ] , ( void **) snapshot -> pages , snapshot -> numPages );
+		}
+
+		written = fwrite ( &addressSpace , sizeof ( SNAPSHOT_ADDRESS_SPACE ) , 1 , file ) == 1;
+	}
+
+	for ( int i = 0 ; i < snapshot -> numPages && written ; i++ ) 
+	{
+		written = fwrite ( snapshot -> pages [ i ] , sizeof ( MEMORY_PAGE ) , 1 , file ) == 1;
+	}
+
+	if ( written && snapshot -> numHeapIndexes > 0 ) 
+	{
+		written = fwrite ( snapshot -> heapIndexes , sizeof ( int ) , snapshot -> numHeapIndexes , file ) == ( size_t ) snapshot -> numHeapIndexes;
+	}
+
+	return written ? OSSIM_SUCCESS : OSSIM_SNAPSHOT_IO_ERROR;
+}
+
+int OSSimSaveSnapshot ( OS_SIM *sim , const char *path ) 
+{
+	if ( !SystemRunning ( sim ) ) 
+	{
+		return OSSIM_NOT_RUNNING;
+	}
+
+	if ( !path ) 
+	{
+		return OSSIM_SNAPSHOT_IO_ERROR;
+	}
+
+	int status = OSSimCheckInvariants ( sim , NULL , 0 ); // a consistent state is what makes the tables below big enough
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	SNAPSHOT snapshot;
+	memset ( &snapshot , 0 , sizeof ( SNAPSHOT ) );
+	snapshot.image = ( OS_SIM *) malloc ( sizeof ( OS_SIM ) );
+	snapshot.processes = ( PCB **) malloc ( ( sim -> numLiveProcesses + sim -> numZombieProcesses + 1 ) * sizeof ( PCB *) );
+	snapshot.messages = ( MESSAGE **) malloc ( ( ListCount ( sim -> messagesQueue ) + 1 ) * sizeof ( MESSAGE *) );
+	snapshot.heapIndexes = ( int *) malloc ( ( sim -> numLiveProcesses + 1 ) * sizeof ( int ) );
+
+	status = OSSIM_FAILURE;
+	if ( snapshot.image && snapshot.processes && snapshot.messages && snapshot.heapIndexes ) 
+	{
+		status = BuildSnapshot ( &snapshot , sim );
+	}
+
+	// written beside the destination and renamed over it, so a reader never maps a half-written snapshot
+	char tempPath [ PATH_MAX ];
+	if ( status == OSSIM_SUCCESS && snprintf ( tempPath , PATH_MAX , "%s.tmp" , path ) >= PATH_MAX ) 
+	{
+		status = OSSIM_SNAPSHOT_IO_ERROR;
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		FILE *file = fopen ( tempPath , "wb" );
+		status = file ? WriteSnapshot ( &snapshot , file ) : OSSIM_SNAPSHOT_IO_ERROR;
+		if ( file && fclose ( file ) != 0 ) 
+		{
+			status = OSSIM_SNAPSHOT_IO_ERROR;
+		}
+
+		if ( status == OSSIM_SUCCESS && rename ( tempPath , path ) != 0 ) 
+		{
+			status = OSSIM_SNAPSHOT_IO_ERROR;
+		}
+
+		if ( status != OSSIM_SUCCESS ) 
+		{
+			remove ( tempPath );
+		}
+	}
+
+	free ( snapshot.image );
+	free ( snapshot.processes );
+	free ( snapshot.messages );
+	free ( snapshot.addressSpaces );
+	free ( snapshot.pages );
+	free ( snapshot.heapIndexes );
+	return status;
+}
+
+/* RESTORE - the image is rebuilt in a scratch instance and has to pass OSSimCheckInvariants before it replaces anything */
+int IsArrayElement ( const void *ptr , const void *array , size_t elementSize , int count , size_t fieldOffset ) 
+{
+	uintptr_t start = ( uintptr_t ) array + fieldOffset;
+	if ( ( uintptr_t ) ptr < start ) 
+	{
+		return 0;
+	}
+
+	uintptr_t offset = ( uintptr_t ) ptr - start;
+	return offset % elementSize == 0 && offset / elementSize < ( uintptr_t ) count;
+}
+
+int IsPoolNode ( OS_SIM *sim , const NODE *node ) 
+{
+	return !node || IsArrayElement ( node , sim -> listPool.allocNodesArr , sizeof ( NODE ) , MAX_NUM_NODES_ALLOC , 0 );
+}
+
+int IsPoolList ( OS_SIM *sim , const LIST *list ) 
+{
+	return list && IsArrayElement ( list , sim -> listPool.allocListsArr , sizeof ( LIST ) , MAX_NUM_LISTS_ALLOC , 0 );
+}
+
+/* every pointer RelocateInternalPointers moved must land on the start of the element it claims to point at */
+int ValidInternalPointers ( OS_SIM *sim ) 
+{
+	if ( !ValidConfiguration ( sim ) || !IsArrayElement ( sim -> currentCPU , sim -> cpus , sizeof ( CPU ) , sim -> numCPUs , 0 ) ) 
+	{
+		return 0;
+	}
+
+	for ( int i = 0 ; i < MAX_NUM_CPUS ; i++ ) 
+	{
+		for ( int j = 0 ; j < MAX_NUM_PRIORITY_LEVELS ; j++ ) 
+		{
+			LIST *readyQueue = sim -> cpus [ i ].readyPriorityQueues [ j ];
+			int inUse = i < sim -> numCPUs && j < sim -> numPriorityLevels;
+			if ( inUse ? !IsPoolList ( sim , readyQueue ) : readyQueue != NULL ) 
+			{
+				return 0;
+			}
+		}
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		if ( !IsPoolList ( sim , sim -> semaphores [ i ].blockedPCBs ) ) 
+		{
+			return 0;
+		}
+	}
+
+	if ( !IsPoolList ( sim , sim -> sendBlockedQueue ) || !IsPoolList ( sim , sim -> receiveBlockedQueue ) || 
+		!IsPoolList ( sim , sim -> waitBlockedQueue ) || !IsPoolList ( sim , sim -> messagesQueue ) ) 
+	{
+		return 0;
+	}
+
+	LIST_POOL *pool = &sim -> listPool;
+	if ( pool -> topFreeNodeIndex < -1 || pool -> topFreeNodeIndex >= MAX_NUM_NODES_ALLOC || 
+		pool -> topFreeListIndex < -1 || pool -> topFreeListIndex >= MAX_NUM_LISTS_ALLOC ) 
+	{
+		return 0;
+	}
+
+	for ( int i = 0 ; i < MAX_NUM_NODES_ALLOC ; i++ ) 
+	{
+		NODE *node = &pool -> allocNodesArr [ i ];
+		int *freeIndex = pool -> freeNodeIndexesPtrArr [ i ];
+		int validFreeIndex = freeIndex ? 
+			IsArrayElement ( freeIndex , pool -> allocNodesArr , sizeof ( NODE ) , MAX_NUM_NODES_ALLOC , offsetof ( NODE , allocID ) ) : 
+			i > pool -> topFreeNodeIndex;
+		if ( node -> allocID != i || !IsPoolNode ( sim , node -> prevNodePtr ) || !IsPoolNode ( sim , node -> nextNodePtr ) || !validFreeIndex ) 
+		{
+			return 0;
+		}
+	}
+
+	for ( int i = 0 ; i < MAX_NUM_LISTS_ALLOC ; i++ ) 
+	{
+		LIST *list = &pool -> allocListsArr [ i ];
+		int *freeIndex = pool -> freeListIndexesPtrArr [ i ];
+		int validFreeIndex = freeIndex ? 
+			IsArrayElement ( freeIndex , pool -> allocListsArr , sizeof ( LIST ) , MAX_NUM_LISTS_ALLOC , offsetof ( LIST , allocID ) ) : 
+			i > pool -> topFreeListIndex;
+		int validFields = list -> allocID == i && 
+			list -> pool == pool && 
+			list -> ownerID >= 0 && list -> ownerID < MAX_LIST_OWNERS && 
+			list -> currentCapacity >= 0 && list -> currentCapacity <= MAX_NUM_NODES_ALLOC && 
+			list -> currentNodeState >= BEFORE_HEAD && list -> currentNodeState <= AFTER_TAIL;
+		if ( !validFields || !validFreeIndex || 
+			!IsPoolNode ( sim , list -> currentNodePtr ) || !IsPoolNode ( sim , list -> headNodePtr ) || !IsPoolNode ( sim , list -> tailNodePtr ) ) 
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+typedef struct snapshotRestore
+{
+	OS_SIM *sim; // scratch instance the state is rebuilt in
+	PCB **processes; // indexed like the process table, until RebuildProcessTree sorts it by process ID
+	int numProcesses;
+	MESSAGE **messages;
+	int numMessages;
+	ADDRESS_SPACE **addressSpaces;
+	int numAddressSpaces;
+	MEMORY_PAGE **pages;
+	int numPages;
+	int *numHolders; // links to each address space table entry, then to each page table entry
+	char *claimed; // a table entry may only be linked in once
+} SNAPSHOT_RESTORE;
+
+void *ClaimSnapshotItem ( SNAPSHOT_RESTORE *restore , uintptr_t encodedIndex , int isMessage ) 
+{
+	int index = ( int ) encodedIndex - 1;
+	int numItems = isMessage ? restore -> numMessages : restore -> numProcesses;
+	if ( encodedIndex == 0 || encodedIndex > ( uintptr_t ) numItems ) 
+	{
+		return NULL;
+	}
+
+	char *claimed = isMessage ? &restore -> claimed [ restore -> numProcesses + index ] : &restore -> claimed [ index ];
+	if ( *claimed ) 
+	{
+		return NULL;
+	}
+
+	*claimed = 1;
+	return isMessage ? ( void *) restore -> messages [ index ] : ( void *) restore -> processes [ index ];
+}
+
+int RestoreListItems ( SNAPSHOT_RESTORE *restore , LIST *list , int isMessageList ) 
+{
+	int numNodes = 0;
+	for ( NODE *node = list -> headNodePtr ; node ; node = node -> nextNodePtr ) 
+	{
+		numNodes += 1;
+		if ( numNodes > list -> currentCapacity ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+
+		node -> valuePtr = ClaimSnapshotItem ( restore , ( uintptr_t ) node -> valuePtr , isMessageList );
+		if ( !node -> valuePtr ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+	}
+
+	return numNodes == list -> currentCapacity ? OSSIM_SUCCESS : OSSIM_INVALID_SNAPSHOT;
+}
+
+int RestoreHeap ( SNAPSHOT_RESTORE *restore , HEAP **heap , int ( *comparator ) ( void* , void* ) , const int *indexes , int numIndexes ) 
+{
+	*heap = HeapCreate ( MAX_REAL_TIME_PROCESSES , comparator );
+	if ( !*heap ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	if ( numIndexes < 0 || numIndexes > MAX_REAL_TIME_PROCESSES ) 
+	{
+		return OSSIM_INVALID_SNAPSHOT;
+	}
+
+	for ( int i = 0 ; i < numIndexes ; i++ ) 
+	{
+		int index = 0;
+		memcpy ( &index , &indexes [ i ] , sizeof ( int ) );
+		( *heap ) -> items [ i ] = ClaimSnapshotItem ( restore , ( uintptr_t ) index + 1 , 0 );
+		if ( index < 0 || !( *heap ) -> items [ i ] ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+
+		( *heap ) -> count = i + 1;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* page tables and pages are shared by index, and each must be linked exactly as often as its stored holder count */
+int AllocateSnapshotMemory ( SNAPSHOT_RESTORE *restore , const SNAPSHOT_HEADER *header , const unsigned char *memoryTables ) 
+{
+	restore -> addressSpaces = ( ADDRESS_SPACE **) calloc ( header -> numAddressSpaces + 1 , sizeof ( ADDRESS_SPACE *) );
+	restore -> pages = ( MEMORY_PAGE **) calloc ( header -> numPages + 1 , sizeof ( MEMORY_PAGE *) );
+	restore -> numHolders = ( int *) calloc ( header -> numAddressSpaces + header -> numPages + 1 , sizeof ( int ) );
+	if ( !restore -> addressSpaces || !restore -> pages || !restore -> numHolders ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	const unsigned char *pageTable = memoryTables + header -> numAddressSpaces * sizeof ( SNAPSHOT_ADDRESS_SPACE );
+	for ( int i = 0 ; i < header -> numPages ; i++ ) 
+	{
+		MEMORY_PAGE *page = ( MEMORY_PAGE *) malloc ( sizeof ( MEMORY_PAGE ) );
+		if ( !page ) 
+		{
+			return OSSIM_FAILURE;
+		}
+
+		memcpy ( page , pageTable + i * sizeof ( MEMORY_PAGE ) , sizeof ( MEMORY_PAGE ) );
+		page -> data [ MEMORY_PAGE_SIZE - 1 ] = '\0';
+		restore -> pages [ i ] = page;
+		restore -> numPages = i + 1;
+	}
+
+	int *numPageHolders = restore -> numHolders + header -> numAddressSpaces;
+	for ( int i = 0 ; i < header -> numAddressSpaces ; i++ ) 
+	{
+		SNAPSHOT_ADDRESS_SPACE storedAddressSpace;
+		memcpy ( &storedAddressSpace , memoryTables + i * sizeof ( SNAPSHOT_ADDRESS_SPACE ) , sizeof ( SNAPSHOT_ADDRESS_SPACE ) );
+
+		ADDRESS_SPACE *addressSpace = ( ADDRESS_SPACE *) calloc ( 1 , sizeof ( ADDRESS_SPACE ) );
+		if ( !addressSpace ) 
+		{
+			return OSSIM_FAILURE;
+		}
+
+		addressSpace -> refCount = storedAddressSpace.refCount;
+		addressSpace -> numPages = storedAddressSpace.numPages;
+		restore -> addressSpaces [ i ] = addressSpace;
+		restore -> numAddressSpaces = i + 1;
+
+		for ( int j = 0 ; j < NUM_MEMORY_PAGES ; j++ ) 
+		{
+			int pageIndex = storedAddressSpace.pageIndexes [ j ];
+			if ( pageIndex < -1 || pageIndex >= header -> numPages ) 
+			{
+				return OSSIM_INVALID_SNAPSHOT;
+			}
+
+			if ( pageIndex >= 0 ) 
+			{
+				addressSpace -> pages [ j ] = restore -> pages [ pageIndex ];
+				numPageHolders [ pageIndex ] += 1;
+			}
+		}
+	}
+
+	for ( int i = 0 ; i < header -> numPages ; i++ ) 
+	{
+		if ( numPageHolders [ i ] == 0 || numPageHolders [ i ] != restore -> pages [ i ] -> refCount ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+int AllocateSnapshotItems ( SNAPSHOT_RESTORE *restore , const SNAPSHOT_HEADER *header , const unsigned char *tables ) 
+{
+	restore -> processes = ( PCB **) calloc ( header -> numProcesses + 1 , sizeof ( PCB *) );
+	restore -> messages = ( MESSAGE **) calloc ( header -> numMessages + 1 , sizeof ( MESSAGE *) );
+	restore -> claimed = ( char *) calloc ( header -> numProcesses + header -> numMessages + 1 , sizeof ( char ) );
+	if ( !restore -> processes || !restore -> messages || !restore -> claimed ) 
+	{
+		return OSSIM_FAILURE;
+	}
+
+	const unsigned char *messageTable = tables + header -> numProcesses * sizeof ( SNAPSHOT_PROCESS );
+	const unsigned char *memoryTables = messageTable + header -> numMessages * sizeof ( MESSAGE );
+	int status = AllocateSnapshotMemory ( restore , header , memoryTables );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	for ( int i = 0 ; i < header -> numProcesses ; i++ ) 
+	{
+		SNAPSHOT_PROCESS process;
+		memcpy ( &process , tables + i * sizeof ( SNAPSHOT_PROCESS ) , sizeof ( SNAPSHOT_PROCESS ) );
+
+		PCB *pcb = ( PCB *) malloc ( sizeof ( PCB ) );
+		if ( !pcb ) 
+		{
+			return OSSIM_FAILURE;
+		}
+
+		*pcb = process.pcb;
+		pcb -> readMessage = NULL;
+		pcb -> addressSpace = NULL;
+		pcb -> nextInGroup = NULL;
+		pcb -> prevInGroup = NULL;
+		pcb -> parent = NULL;
+		pcb -> firstChild = NULL;
+		pcb -> lastChild = NULL;
+		pcb -> nextSibling = NULL;
+		pcb -> prevSibling = NULL;
+		pcb -> sendRecipient = NULL;
+		pcb -> firstWaitingSender = NULL;
+		pcb -> nextWaitingSender = NULL;
+		pcb -> prevWaitingSender = NULL;
+		memset ( pcb -> nextHolder , 0 , sizeof ( pcb -> nextHolder ) );
+		memset ( pcb -> prevHolder , 0 , sizeof ( pcb -> prevHolder ) );
+		pcb -> waitSearchID = 0; // searches restart from ID 0 in the restored instance
+		pcb -> waitSearchNext = NULL;
+		pcb -> waitSearchQueueNext = NULL;
+		pcb -> inheritanceUpdateID = 0;
+		pcb -> inheritanceUpdateQueueNext = NULL;
+		restore -> processes [ i ] = pcb;
+		restore -> numProcesses = i + 1;
+
+		if ( process.addressSpaceIndex < -1 || process.addressSpaceIndex >= header -> numAddressSpaces ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+
+		if ( process.addressSpaceIndex >= 0 ) 
+		{
+			pcb -> addressSpace = restore -> addressSpaces [ process.addressSpaceIndex ];
+			restore -> numHolders [ process.addressSpaceIndex ] += 1;
+		}
+
+		if ( process.hasReadMessage ) 
+		{
+			pcb -> readMessage = ( MESSAGE *) malloc ( sizeof ( MESSAGE ) );
+			if ( !pcb -> readMessage ) 
+			{
+				return OSSIM_FAILURE;
+			}
+
+			*pcb -> readMessage = process.readMessage;
+			pcb -> readMessage -> messageStr [ MAX_MESSAGE_LENGTH - 1 ] = '\0';
+		}
+	}
+
+	for ( int i = 0 ; i < header -> numAddressSpaces ; i++ ) 
+	{
+		if ( restore -> numHolders [ i ] == 0 || restore -> numHolders [ i ] != restore -> addressSpaces [ i ] -> refCount ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+	}
+
+	for ( int i = 0 ; i < header -> numMessages ; i++ ) 
+	{
+		MESSAGE *message = ( MESSAGE *) malloc ( sizeof ( MESSAGE ) );
+		if ( !message ) 
+		{
+			return OSSIM_FAILURE;
+		}
+
+		memcpy ( message , messageTable + i * sizeof ( MESSAGE ) , sizeof ( MESSAGE ) );
+		message -> messageStr [ MAX_MESSAGE_LENGTH - 1 ] = '\0';
+		restore -> messages [ i ] = message;
+		restore -> numMessages = i + 1;
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* membership lists are not stored - every member is linked again in process ID order, the order groups are kept in */
+int RebuildProcessGroups ( SNAPSHOT_RESTORE *restore ) 
+{
+	OS_SIM *sim = restore -> sim;
+	memset ( sim -> processGroups , 0 , sizeof ( sim -> processGroups ) );
+
+	for ( int i = 0 ; i < restore -> numProcesses ; i++ ) 
+	{
+		PCB *pcb = restore -> processes [ i ];
+		if ( pcb -> groupID == NO_PROCESS_GROUP ) 
+		{
+			continue;
+		}
+
+		if ( !ValidGroupID ( pcb -> groupID ) ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+
+		JoinProcessGroup ( sim , pcb , pcb -> groupID );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* child lists are not stored either - each child is linked to the parent its process ID names, again in process
+ * ID order, and exactly the table entries no queue claimed must be ZOMBIE */
+int RebuildProcessTree ( SNAPSHOT_RESTORE *restore ) 
+{
+	for ( int i = 0 ; i < restore -> numProcesses ; i++ ) 
+	{
+		PCB *pcb = restore -> processes [ i ];
+		if ( restore -> claimed [ i ] == ( pcb -> processState == ZOMBIE ) ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+
+		pcb -> numChildren = 0;
+		pcb -> numZombieChildren = 0;
+	}
+
+	qsort ( restore -> processes , restore -> numProcesses , sizeof ( PCB *) , &CompareProcessIDs );
+
+	for ( int i = 0 ; i < restore -> numProcesses ; i++ ) 
+	{
+		PCB *pcb = restore -> processes [ i ];
+		if ( pcb -> parentProcessID == INIT_PROCESS_ID ) 
+		{
+			if ( pcb -> processState == ZOMBIE ) 
+			{
+				return OSSIM_INVALID_SNAPSHOT;
+			}
+
+			continue;
+		}
+
+		PCB key = { .processID = pcb -> parentProcessID };
+		PCB *keyPtr = &key;
+		PCB **parent = bsearch ( &keyPtr , restore -> processes , restore -> numProcesses , sizeof ( PCB *) , &CompareProcessIDs );
+		if ( !parent || ( *parent ) -> processState == ZOMBIE || pcb -> parentProcessID >= pcb -> processID ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+
+		AddChild ( *parent , pcb );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* waiting-sender lists are not stored - the send-blocked queue is in the order its processes blocked, and so is
+ * each list, so walking the queue and linking every sender to the recipient its process ID names rebuilds them */
+int RebuildWaitingSenders ( SNAPSHOT_RESTORE *restore ) 
+{
+	for ( NODE *node = restore -> sim -> sendBlockedQueue -> headNodePtr ; node ; node = node -> nextNodePtr ) 
+	{
+		PCB *sender = node -> valuePtr;
+		if ( sender -> sendRecipientID == INIT_PROCESS_ID ) 
+		{
+			continue;
+		}
+
+		PCB key = { .processID = sender -> sendRecipientID };
+		PCB *keyPtr = &key;
+		PCB **recipient = bsearch ( &keyPtr , restore -> processes , restore -> numProcesses , sizeof ( PCB *) , &CompareProcessIDs );
+		if ( !recipient || ( *recipient ) -> processState == ZOMBIE || *recipient == sender ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+
+		LinkWaitingSender ( sender , *recipient );
+	}
+
+	return OSSIM_SUCCESS;
+}
+
+/* holder lists are not stored - every holder is linked again behind the holders that took the lock after it */
+void RebuildSemaphoreHolders ( SNAPSHOT_RESTORE *restore ) 
+{
+	for ( int i = 0 ; i < restore -> numProcesses ; i++ ) 
+	{
+		PCB *pcb = restore -> processes [ i ];
+		for ( int j = 0 ; j < NUM_SEMAPHORES ; j++ ) 
+		{
+			if ( pcb -> semaphoresHeld [ j ] <= 0 ) 
+			{
+				continue;
+			}
+
+			PCB *prevHolder = NULL;
+			PCB *nextHolder = restore -> sim -> semaphores [ j ].firstHolder;
+			while ( nextHolder && nextHolder -> holdSequence [ j ] > pcb -> holdSequence [ j ] ) 
+			{
+				prevHolder = nextHolder;
+				nextHolder = nextHolder -> nextHolder [ j ];
+			}
+
+			LinkHolder ( restore -> sim , pcb , j , prevHolder );
+		}
+	}
+}
+
+int RebuildFromSnapshot ( SNAPSHOT_RESTORE *restore , const SNAPSHOT_HEADER *header , const unsigned char *mapping ) 
+{
+	OS_SIM *sim = restore -> sim;
+	memcpy ( sim , mapping + sizeof ( SNAPSHOT_HEADER ) , sizeof ( OS_SIM ) );
+	RelocateInternalPointers ( sim , 1 , ( uintptr_t ) sim );
+	sim -> initProcess.readMessage = NULL;
+	sim -> realTimeReleaseHeap = NULL;
+	sim -> lastWaitSearchID = 0;
+	sim -> lastInheritanceUpdateID = 0;
+	for ( int i = 0 ; i < MAX_NUM_CPUS ; i++ ) 
+	{
+		sim -> cpus [ i ].realTimeReadyHeap = NULL;
+		sim -> cpus [ i ].runningProcess = NULL;
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES ; i++ ) 
+	{
+		sim -> semaphores [ i ].firstHolder = NULL;
+	}
+
+	const unsigned char *tables = mapping + sizeof ( SNAPSHOT_HEADER ) + sizeof ( OS_SIM );
+	int status = AllocateSnapshotItems ( restore , header , tables );
+	if ( status != OSSIM_SUCCESS ) 
+	{
+		return status;
+	}
+
+	if ( !ValidInternalPointers ( sim ) || 
+		sim -> numZombieProcesses < 0 || 
+		sim -> numLiveProcesses + sim -> numZombieProcesses != header -> numProcesses || 
+		sim -> messagesQueue -> currentCapacity != header -> numMessages ) 
+	{
+		return OSSIM_INVALID_SNAPSHOT;
+	}
+
+	for ( int i = sim -> numCPUs ; i < MAX_NUM_CPUS ; i++ ) 
+	{
+		if ( header -> numRealTimeReady [ i ] != 0 ) 
+		{
+			return OSSIM_INVALID_SNAPSHOT;
+		}
+	}
+
+	if ( header -> initHasMessage ) 
+	{
+		sim -> initProcess.readMessage = ( MESSAGE *) malloc ( sizeof ( MESSAGE ) );
+		if ( !sim -> initProcess.readMessage ) 
+		{
+			return OSSIM_FAILURE;
+		}
+
+		*sim -> initProcess.readMessage = header -> initMessage;
+		sim -> initProcess.readMessage -> messageStr [ MAX_MESSAGE_LENGTH - 1 ] = '\0';
+	}
+
+	const int *heapIndexes = ( const int *) ( tables + 
+		header -> numProcesses * sizeof ( SNAPSHOT_PROCESS ) + 
+		header -> numMessages * sizeof ( MESSAGE ) + 
+		header -> numAddressSpaces * sizeof ( SNAPSHOT_ADDRESS_SPACE ) + 
+		header -> numPages * sizeof ( MEMORY_PAGE ) 
+	);
+	for ( int i = 0 ; i < sim -> numCPUs && status == OSSIM_SUCCESS ; i++ ) 
+	{
+		CPU *cpu = &sim -> cpus [ i ];
+		cpu -> runningProcess = &sim -> initProcess;
+		if ( header -> runningProcesses [ i ] != SNAPSHOT_INIT_PROCESS ) 
+		{
+			cpu -> runningProcess = ClaimSnapshotItem ( restore , ( uintptr_t ) header -> runningProcesses [ i ] + 1 , 0 );
+		}
+
+		for ( int j = 0 ; j < sim -> numPriorityLevels && status == OSSIM_SUCCESS ; j++ ) 
+		{
+			status = RestoreListItems ( restore , cpu -> readyPriorityQueues [ j ] , 0 );
+		}
+
+		if ( status == OSSIM_SUCCESS ) 
+		{
+			status = RestoreHeap ( restore , &cpu -> realTimeReadyHeap , &EarlierDeadline , heapIndexes , header -> numRealTimeReady [ i ] );
+			heapIndexes += header -> numRealTimeReady [ i ];
+		}
+
+		if ( !cpu -> runningProcess ) 
+		{
+			status = OSSIM_INVALID_SNAPSHOT;
+		}
+	}
+
+	for ( int i = 0 ; i < NUM_SEMAPHORES && status == OSSIM_SUCCESS ; i++ ) 
+	{
+		status = RestoreListItems ( restore , sim -> semaphores [ i ].blockedPCBs , 0 );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = RestoreListItems ( restore , sim -> sendBlockedQueue , 0 );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = RestoreListItems ( restore , sim -> receiveBlockedQueue , 0 );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = RestoreListItems ( restore , sim -> waitBlockedQueue , 0 );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = RestoreListItems ( restore , sim -> messagesQueue , 1 );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = RestoreHeap ( restore , &sim -> realTimeReleaseHeap , &EarlierRelease , heapIndexes , header -> numRealTimeWaiting );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = RebuildProcessTree ( restore );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = RebuildProcessGroups ( restore );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		status = RebuildWaitingSenders ( restore );
+	}
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		RebuildSemaphoreHolders ( restore );
+	}
+
+	if ( status == OSSIM_SUCCESS && OSSimCheckInvariants ( sim , NULL , 0 ) != OSSIM_SUCCESS ) 
+	{
+		status = OSSIM_INVALID_SNAPSHOT;
+	}
+
+	return status;
+}
+
+void FreeRestoredItems ( SNAPSHOT_RESTORE *restore ) 
+{
+	OS_SIM *sim = restore -> sim;
+	for ( int i = 0 ; i < restore -> numProcesses ; i++ ) 
+	{
+		restore -> processes [ i ] -> parent = NULL; // every entry is freed here, so FreePCB must not follow the tree
+		restore -> processes [ i ] -> firstChild = NULL;
+		restore -> processes [ i ] -> sendRecipient = NULL;
+		restore -> processes [ i ] -> firstWaitingSender = NULL;
+		restore -> processes [ i ] -> addressSpace = NULL; // the memory tables below hold every page table and page once
+		FreePCB ( restore -> processes [ i ] );
+	}
+
+	for ( int i = 0 ; i < restore -> numAddressSpaces ; i++ ) 
+	{
+		free ( restore -> addressSpaces [ i ] );
+	}
+
+	for ( int i = 0 ; i < restore -> numPages ; i++ ) 
+	{
+		free ( restore -> pages [ i ] );
+	}
+
+	for ( int i = 0 ; i < restore -> numMessages ; i++ ) 
+	{
+		FreeMessage ( restore -> messages [ i ] );
+	}
+
+	for ( int i = 0 ; i < MAX_NUM_CPUS ; i++ ) 
+	{
+		HeapFree ( sim -> cpus [ i ].realTimeReadyHeap , NULL );
+	}
+
+	HeapFree ( sim -> realTimeReleaseHeap , NULL );
+	FreeMessage ( sim -> initProcess.readMessage );
+}
+
+int OSSimRestoreSnapshot ( OS_SIM *sim , const char *path ) 
+{
+	if ( !sim || !path ) 
+	{
+		return OSSIM_SNAPSHOT_IO_ERROR;
+	}
+
+	int fd = open ( path , O_RDONLY );
+	struct stat fileStat;
+	if ( fd < 0 || fstat ( fd , &fileStat ) != 0 || fileStat.st_size < ( off_t ) sizeof ( SNAPSHOT_HEADER ) ) 
+	{
+		if ( fd >= 0 ) 
+		{
+			close ( fd );
+		}
+
+		return fd < 0 ? OSSIM_SNAPSHOT_IO_ERROR : OSSIM_INVALID_SNAPSHOT;
+	}
+
+	unsigned char *mapping = mmap ( NULL , fileStat.st_size , PROT_READ , MAP_PRIVATE , fd , 0 );
+	close ( fd );
+	if ( mapping == MAP_FAILED ) 
+	{
+		return OSSIM_SNAPSHOT_IO_ERROR;
+	}
+
+	SNAPSHOT_HEADER header;
+	memcpy ( &header , mapping , sizeof ( SNAPSHOT_HEADER ) );
+	int validHeader = memcmp ( header.magic , SNAPSHOT_MAGIC , sizeof ( header.magic ) ) == 0 && 
+		header.version == SNAPSHOT_VERSION && 
+		header.headerSize == sizeof ( SNAPSHOT_HEADER ) && 
+		header.simSize == sizeof ( OS_SIM ) && 
+		header.processSize == sizeof ( SNAPSHOT_PROCESS ) && 
+		header.messageSize == sizeof ( MESSAGE ) && 
+		header.addressSpaceSize == sizeof ( SNAPSHOT_ADDRESS_SPACE ) && 
+		header.pageSize == sizeof ( MEMORY_PAGE ) && 
+		header.numProcesses >= 0 && 
+		header.numMessages >= 0 && 
+		header.numAddressSpaces >= 0 && 
+		header.numPages >= 0 && 
+		header.numRealTimeWaiting >= 0 && 
+		header.fileSize == ( unsigned long ) fileStat.st_size;
+
+	unsigned long numHeapIndexes = header.numRealTimeWaiting;
+	for ( int i = 0 ; i < MAX_NUM_CPUS ; i++ ) 
+	{
+		validHeader = validHeader && header.numRealTimeReady [ i ] >= 0;
+		numHeapIndexes += header.numRealTimeReady [ i ];
+	}
+
+	// the file size bounds every count, so nothing below allocates more than the file could describe
+	unsigned long expectedSize = sizeof ( SNAPSHOT_HEADER ) + sizeof ( OS_SIM ) + 
+		( unsigned long ) header.numProcesses * sizeof ( SNAPSHOT_PROCESS ) + 
+		( unsigned long ) header.numMessages * sizeof ( MESSAGE ) + 
+		( unsigned long ) header.numAddressSpaces * sizeof ( SNAPSHOT_ADDRESS_SPACE ) + 
+		( unsigned long ) header.numPages * sizeof ( MEMORY_PAGE ) + 
+		numHeapIndexes * sizeof ( int );
+	if ( !validHeader || expectedSize != header.fileSize ) 
+	{
+		munmap ( mapping , fileStat.st_size );
+		return OSSIM_INVALID_SNAPSHOT;
+	}
+
+	SNAPSHOT_RESTORE restore;
+	memset ( &restore , 0 , sizeof ( SNAPSHOT_RESTORE ) );
+	restore.sim = ( OS_SIM *) calloc ( 1 , sizeof ( OS_SIM ) );
+	int status = restore.sim ? RebuildFromSnapshot ( &restore , &header , mapping ) : OSSIM_FAILURE;
+	munmap ( mapping , fileStat.st_size );
+
+	if ( status == OSSIM_SUCCESS ) 
+	{
+		// the subscribers and output stream belong to the caller, not to the saved state
+		OS_SIM *restored = restore.sim;
+		memcpy ( restored -> subscribers , sim -> subscribers , sizeof ( sim -> subscribers ) );
+		restored -> subscribedEventsMask = sim -> subscribedEventsMask;
+		restored -> outputFile = sim -> outputFile;
+
+		// so is the batch being applied, a reschedule the saved state was still owed is merged into it
+		restored -> inBatch = sim -> inBatch;
+		restored -> deferredDispatchMask = ( restored -> deferredDispatchMask | sim -> deferredDispatchMask ) & ( ( 1u << restored -> numCPUs ) - 1 );
+		restored -> idleCPUKickDeferred = restored -> idleCPUKickDeferred || sim -> idleCPUKickDeferred;
+
+		FreeSimState ( sim );
+		memcpy ( sim , restored , sizeof ( OS_SIM ) );
+		RelocateInternalPointers ( sim , ( uintptr_t ) restored , ( uintptr_t ) sim );
+
+		if ( !sim -> inBatch ) 
+		{
+			RunDeferredDispatches ( sim );
+		}
+	}
+	else if ( restore.sim ) 
+	{
+		FreeRestoredItems ( &restore );
+	}
+
+	free ( restore.sim );
+	free ( restore.processes );
+	free ( restore.messages );
+	free ( restore.addressSpaces );
+	free ( restore.pages );
+	free ( restore.numHolders );
+	free ( restore.claimed );
+	return status;
+}
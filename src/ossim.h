@@ -0,0 +1,450 @@
+/* Nic Pucci
+ * OS-SIM CORE LIBRARY HEADER
+*/
+
+#ifndef OSSIM_H
+#define OSSIM_H
+
+#include <stdio.h>
+#include "List.h"
+#include "Heap.h"
+
+#define NUM_PRIORITY_LEVELS 3
+#define MAX_NUM_PRIORITY_LEVELS 8
+#define MAX_MESSAGE_LENGTH 40
+#define INIT_PROCESS_ID 0
+#define NUM_SEMAPHORES 5
+#define MAX_CPU_BURSTS 5
+#define REAL_TIME_PRIORITY_LEVEL -1
+#define MAX_REAL_TIME_PROCESSES 100
+#define MAX_NUM_CPUS 16
+#define LOAD_BALANCE_INTERVAL 4
+#define ALL_CPUS_AFFINITY_MASK 0xFFFFFFFF
+#define MAX_EVENT_SUBSCRIBERS 8
+#define MAX_PROCESS_GROUPS 16
+#define NO_PROCESS_GROUP -1
+#define KILLED_EXIT_STATUS -1 // exit status of a process ended by a kill
+#define WAITING_FOR_REPLY -1 // in place of a semaphore ID, for a process waiting on a SEND
+#define NO_INHERITED_PRIORITY MAX_NUM_PRIORITY_LEVELS // below every level, so the process runs at its own
+#define NUM_MEMORY_PAGES 64 // pages in the address space of every process
+#define MEMORY_PAGE_SIZE 64 // bytes, a page holds one string
+#define OSSIM_EVENT_BIT(type) ( 1u << ( type ) )
+#define OSSIM_ALL_EVENTS 0xFFFFFFFF
+
+/* STATUS CODES RETURNED BY THE OSSim* COMMANDS */
+enum OSSIM_STATUS
+{
+	OSSIM_SUCCESS = 0 ,
+	OSSIM_NO_MESSAGE = 1 , // RECEIVE found nothing, the caller is RECEIVE-BLOCKED unless it is INIT
+	OSSIM_NO_EXITED_CHILD = 2 , // WAIT found no exited child, the caller is WAIT-BLOCKED until one exits
+	OSSIM_FAILURE = -1 , // out of memory
+	OSSIM_NOT_RUNNING = -2 , // OSSimStart has not been called, or INIT has exited
+	OSSIM_INVALID_PRIORITY = -3 ,
+	OSSIM_INVALID_REAL_TIME_PARAMS = -4 ,
+	OSSIM_TOO_MANY_REAL_TIME_PROCESSES = -5 ,
+	OSSIM_NO_SUCH_PROCESS = -6 ,
+	OSSIM_INIT_PROCESS_BUSY = -7 , // INIT can only end once it is the last process
+	OSSIM_INIT_PROCESS_NOT_ALLOWED = -8 ,
+	OSSIM_SEND_TO_SELF = -9 ,
+	OSSIM_NOT_SEND_BLOCKED = -10 ,
+	OSSIM_INVALID_SEMAPHORE = -11 ,
+	OSSIM_SEMAPHORE_NOT_CREATED = -12 ,
+	OSSIM_SEMAPHORE_EXISTS = -13 ,
+	OSSIM_INVALID_SEMAPHORE_VALUE = -14 ,
+	OSSIM_INVALID_AFFINITY = -15 ,
+	OSSIM_INVALID_CPU = -16 ,
+	OSSIM_INVALID_CONFIG = -17 ,
+	OSSIM_TOO_MANY_SUBSCRIBERS = -18 ,
+	OSSIM_NO_SUCH_SUBSCRIBER = -19 ,
+	OSSIM_INVARIANT_VIOLATED = -20 , // OSSimCheckInvariants found inconsistent state
+	OSSIM_SNAPSHOT_IO_ERROR = -21 ,
+	OSSIM_INVALID_SNAPSHOT = -22 , // bad file, or written by a build with a different state layout
+	OSSIM_INVALID_GROUP = -23 ,
+	OSSIM_NO_CHILDREN = -24 ,
+	OSSIM_INVALID_PAGE = -25
+};
+
+/* LIST POOL OWNERS - every list of an instance is tagged so its node usage is counted separately */
+enum OSSIM_LIST_OWNER
+{
+	OSSIM_UNTAGGED_LISTS = 0 ,
+	OSSIM_READY_QUEUES = 1 ,
+	OSSIM_SEMAPHORE_QUEUES = 2 ,
+	OSSIM_SEND_BLOCKED_QUEUE = 3 ,
+	OSSIM_RECEIVE_BLOCKED_QUEUE = 4 ,
+	OSSIM_MESSAGES_QUEUE = 5 ,
+	OSSIM_WAIT_BLOCKED_QUEUE = 6 ,
+	NUM_OSSIM_LIST_OWNERS = 7
+};
+
+typedef struct message
+{
+	int senderProcessID;
+	int recipientProcessID;
+	char messageStr [ MAX_MESSAGE_LENGTH ];
+} MESSAGE;
+
+enum STATE
+{
+	SEND_BLOCKED = 0 ,
+	RECEIVE_BLOCKED = 1 ,
+	SEM_BLOCKED = 2 ,
+	READY = 3,
+	RUNNING = 4,
+	PERIOD_WAITING = 5 ,
+	WAIT_BLOCKED = 6 ,
+	ZOMBIE = 7 // ended, held by its parent's child list until the parent waits for it
+};
+
+enum PRIORITY_DIRECTION
+{
+	PROMOTING = 0 ,
+	DEMOTING = 1
+};
+
+enum AGING_POLICY
+{
+	BOUNCE_AGING = 0 , // demote down to the lowest level, then promote back up
+	DEMOTE_ONLY_AGING = 1 , // demote down to the lowest level and stay there
+	NO_AGING = 2 // processes keep their priority level
+};
+
+enum SCHEDULING_CLASS
+{
+	NORMAL_CLASS = 0 ,
+	REAL_TIME_CLASS = 1
+};
+
+/* SIMULATED MEMORY - a forked child shares its parent's page table and pages, the table is copied the first time
+ * either of them writes, and a page the first time it is written while another table still holds it */
+typedef struct memoryPage
+{
+	int refCount; // page tables holding the page
+	char data [ MEMORY_PAGE_SIZE ];
+} MEMORY_PAGE;
+
+typedef struct addressSpace
+{
+	int refCount; // processes sharing the page table
+	int numPages;
+	MEMORY_PAGE *pages [ NUM_MEMORY_PAGES ]; // NULL = never written, reads as an empty string
+} ADDRESS_SPACE;
+
+typedef struct pcb
+{
+	int processID;
+	int priorityLevel;
+	enum PRIORITY_DIRECTION priorityDirection;
+	int numCPUBurstsInPriorityLevel;
+	enum STATE processState;
+	MESSAGE *readMessage;
+	int cpuID; // CPU whose run queues hold the process
+	unsigned int affinityMask; // bit N set = process may run on CPU N
+	int numMigrations;
+	int numCrossNodeMigrations;
+	int warmUpBurstsLeft; // bursts still spent refilling caches after a migration
+	enum SCHEDULING_CLASS schedulingClass;
+	int period; // REAL-TIME only: ticks between job releases
+	int relativeDeadline; // REAL-TIME only: ticks after release the job must finish by
+	int budget; // REAL-TIME only: CPU bursts each job needs
+	int remainingBudget;
+	int releaseTick;
+	int absoluteDeadline;
+	int numJobsCompleted;
+	int numDeadlineMisses;
+	int readyTick; // tick the process last entered a ready queue
+	int groupID; // NO_PROCESS_GROUP, or the process group it was created or forked into
+	struct pcb *nextInGroup; // membership list of groupID, in process ID order
+	struct pcb *prevInGroup;
+	int parentProcessID; // INIT_PROCESS_ID for created and orphaned processes, INIT reaps them as they end
+	struct pcb *parent; // NULL when the parent is INIT
+	struct pcb *firstChild; // children in process ID order, ended ones stay as ZOMBIE until waited for
+	struct pcb *lastChild;
+	struct pcb *nextSibling;
+	struct pcb *prevSibling;
+	int numChildren; // ZOMBIE children included
+	int numZombieChildren;
+	int exitStatus; // ZOMBIE only
+	int waitedChildID; // last child reaped by WAIT, INIT_PROCESS_ID = none yet
+	int waitedExitStatus;
+	ADDRESS_SPACE *addressSpace; // NULL until the process first writes its memory, never held by INIT or a ZOMBIE
+	int semaphoresHeld [ NUM_SEMAPHORES ]; // lock semaphores only: P operations not yet matched by a V of the process
+	int blockedSemaphoreID; // SEM_BLOCKED only: semaphore whose queue holds the process
+	int sendRecipientID; // SEND_BLOCKED only: process expected to reply, INIT_PROCESS_ID for INIT or once it has ended
+	struct pcb *sendRecipient; // NULL when sendRecipientID is INIT_PROCESS_ID
+	struct pcb *firstWaitingSender; // processes whose sendRecipient is this process, latest to block first
+	struct pcb *nextWaitingSender;
+	struct pcb *prevWaitingSender;
+	struct pcb *nextHolder [ NUM_SEMAPHORES ]; // holders of each lock semaphore, latest to take it first
+	struct pcb *prevHolder [ NUM_SEMAPHORES ];
+	long holdSequence [ NUM_SEMAPHORES ]; // numTakes of each lock semaphore when the process took it, 0 = not held
+	int inheritedPriorityLevel; // most urgent level among the processes waiting on it, NO_INHERITED_PRIORITY = none
+	int waitSearchID; // last search of the wait-for graph that reached the process
+	struct pcb *waitSearchNext; // process a deadlock search went on to from it
+	struct pcb *waitSearchQueueNext; // waiters a search still has to expand, or the process a deadlock search came from
+	int inheritanceUpdateID; // last update of inherited levels that reached the process
+	struct pcb *inheritanceUpdateQueueNext;
+} PCB;
+
+/* PROCESS GROUP - members are linked through their PCBs, a new member always has the highest process ID so
+ * appending it keeps the list in process ID order */
+typedef struct processGroup
+{
+	PCB *firstMember;
+	PCB *lastMember;
+	int numMembers;
+} PROCESS_GROUP;
+
+enum SEMAPHORE_STATUS
+{
+	CREATED = 0 ,
+	NOT_CREATED = 1
+};
+
+typedef struct semaphore
+{
+	int semID;
+	enum SEMAPHORE_STATUS semStatus;
+	int semValue;
+	int initSemValue; // created with 1 = a lock, its waiters wait for the processes holding it
+	LIST *blockedPCBs;
+	PCB *firstHolder; // lock semaphores only, linked through the holders' PCBs
+	long numTakes; // lock semaphores only: times a process became a holder
+} SEMAPHORE;
+
+enum CPU_DISTANCE
+{
+	SAME_CPU = 0 ,
+	SHARED_CACHE = 1 ,
+	SAME_NODE = 2 ,
+	CROSS_NODE = 3 ,
+	NUM_CPU_DISTANCES = 4
+};
+
+typedef struct cpu
+{
+	int cpuID;
+	int nodeID; // NUMA node (socket)
+	int cacheID; // CPUs with the same cacheID share a last-level cache
+	PCB *runningProcess;
+	LIST *readyPriorityQueues [ MAX_NUM_PRIORITY_LEVELS ];
+	HEAP *realTimeReadyHeap; // EDF - ordered by absolute deadline
+	int numBusyTicks;
+	int numIdleTicks;
+	int numContextSwitches;
+	int numMigrationsIn;
+	int numMigrationsOut;
+	int numSteals;
+	int numWarmUpBursts;
+} CPU;
+
+/* SCHEDULER EVENTS - fromValue / toValue meaning per type */
+enum OSSIM_EVENT_TYPE
+{
+	OSSIM_EVENT_PROCESS_CREATED = 0 , // fromValue = parent process ID when forked
+	OSSIM_EVENT_PROCESS_ENDED = 1 , // fromValue = exit status
+	OSSIM_EVENT_DISPATCHED = 2 , // process now running on cpuID
+	OSSIM_EVENT_BLOCKED = 3 , // fromValue = blocked STATE, toValue = semaphore ID when SEM_BLOCKED
+	OSSIM_EVENT_UNBLOCKED = 4 , // fromValue = STATE it was blocked in, toValue = semaphore ID when SEM_BLOCKED, child reaped when WAIT_BLOCKED
+	OSSIM_EVENT_PROMOTED = 5 , // fromValue -> toValue priority level
+	OSSIM_EVENT_DEMOTED = 6 , // fromValue -> toValue priority level
+	OSSIM_EVENT_MESSAGE_QUEUED = 7 , // no process is waiting for it yet
+	OSSIM_EVENT_MESSAGE_DELIVERED = 8 , // process dispatched with a message it has not read yet
+	OSSIM_EVENT_STOLEN = 9 , // fromValue -> toValue CPU
+	OSSIM_EVENT_LOAD_BALANCED = 10 , // fromValue -> toValue CPU
+	OSSIM_EVENT_DEADLINE_MISSED = 11 , // fromValue = absolute deadline missed
+	OSSIM_EVENT_DEADLOCK = 12 , // one per process of a wait-for cycle, fromValue = process it waits for, toValue = semaphore ID or WAITING_FOR_REPLY
+	OSSIM_EVENT_PRIORITY_INHERITED = 13 , // fromValue -> toValue level the process is queued at, its own level when the boost ends
+	NUM_OSSIM_EVENT_TYPES = 14
+};
+
+typedef struct ossimEvent
+{
+	enum OSSIM_EVENT_TYPE type;
+	int tick;
+	int cpuID;
+	const PCB *process; // only valid for the duration of the callback
+	const MESSAGE *message;
+	int fromValue;
+	int toValue;
+} OSSIM_EVENT;
+
+typedef void ( *OSSIM_EVENT_CALLBACK ) ( const OSSIM_EVENT *event , void *context );
+
+typedef struct eventSubscriber
+{
+	unsigned int eventMask; // OSSIM_EVENT_BIT of every event type the callback wants
+	OSSIM_EVENT_CALLBACK callback; // NULL = free slot
+	void *context;
+} EVENT_SUBSCRIBER;
+
+/* ONE SIMULATED SYSTEM - every function works on the instance it is given, so instances never share state */
+typedef struct osSim
+{
+	/* TOPOLOGY */
+	CPU cpus [ MAX_NUM_CPUS ];
+	int numCPUs;
+	int numNodes;
+	int numCPUsPerCache;
+	CPU *currentCPU; // CPU that user commands are issued on
+
+	/* SCHEDULING POLICY PARAMETERS */
+	int numPriorityLevels;
+	int maxCPUBursts;
+	enum AGING_POLICY agingPolicy;
+
+	PCB initProcess;
+	int nextAvailProcessID;
+	int numLiveProcesses; // every process but INIT, counted as PCBs are allocated and freed
+	int numZombieProcesses; // ended but not yet waited for, not live
+
+	/* BATCHES - between OSSimBeginBatch and OSSimEndBatch, INIT keeps its CPU until the batch ends */
+	int inBatch;
+	unsigned int deferredDispatchMask; // bit N = a command made work for CPU N while it ran INIT
+	int idleCPUKickDeferred;
+
+	LIST *sendBlockedQueue;
+	LIST *receiveBlockedQueue;
+	LIST *waitBlockedQueue;
+	LIST *messagesQueue;
+	HEAP *realTimeReleaseHeap; // ordered by next job release tick
+	SEMAPHORE semaphores [ NUM_SEMAPHORES ];
+	PROCESS_GROUP processGroups [ MAX_PROCESS_GROUPS ];
+
+	/* SCHEDULER STATISTICS */
+	int numPromotions;
+	int numDemotions;
+	int numDispatches;
+	long totalReadyWaitTicks;
+	int maxReadyWaitTicks;
+	int totalDeadlineMisses;
+	int currentTick; // virtual time, advances by one every quantum
+	int numRealTimeProcesses;
+	int numMigrationsByDistance [ NUM_CPU_DISTANCES ];
+	int totalMigrationWarmUpBursts;
+
+	/* MEMORY STATISTICS */
+	int numForks;
+	long numForkPagesShared; // pages forks shared instead of copying
+	int numPageTableCopies; // first write to a shared page table, only the table is copied
+	int numCOWFaults; // first write to a shared page, only that page is copied
+
+	/* DEADLOCK DETECTION STATISTICS */
+	int numDeadlockSearches; // one per block that added a wait-for edge
+	long numDeadlockSearchSteps; // processes those searches expanded
+	int numDeadlocksDetected;
+	int numDeadlockedProcesses; // processes on the cycles detected
+
+	/* PRIORITY INHERITANCE STATISTICS */
+	int numPriorityBoosts; // times a process was raised above its own level by a process waiting on it
+	long numBoostedRunTicks; // ticks processes ran above their own level, time the waiters behind them would have lost to priority inversion
+
+	/* WAIT-FOR GRAPH SEARCHES - IDs of the latest ones, the marks they leave in PCBs are not part of the logical state */
+	int lastWaitSearchID;
+	int lastInheritanceUpdateID;
+
+	EVENT_SUBSCRIBER subscribers [ MAX_EVENT_SUBSCRIBERS ];
+	unsigned int subscribedEventsMask; // union of every subscriber mask, events outside it are never built
+
+	FILE *outputFile; // for front ends, the core itself never prints
+	LIST_POOL listPool; // every list of this instance is allocated from here
+} OS_SIM;
+
+
+/* LIFETIME - configure the topology and policy fields between OSSimCreate and OSSimStart */
+OS_SIM *OSSimCreate ();
+
+int OSSimStart ( OS_SIM *sim );
+
+void OSSimFree ( OS_SIM *sim );
+
+/* COMMANDS - issued on sim -> currentCPU, each returns an OSSIM_STATUS */
+int OSSimCreateProcess ( OS_SIM *sim , int priorityLevel , int *newProcessID );
+
+int OSSimCreateProcessInGroup ( OS_SIM *sim , int priorityLevel , int groupID , int *newProcessID );
+
+int OSSimCreateRealTimeProcess ( OS_SIM *sim , int period , int relativeDeadline , int budget , int *newProcessID );
+
+int OSSimFork ( OS_SIM *sim , int *newProcessID );
+
+int OSSimKill ( OS_SIM *sim , int processID , PCB *endedProcess );
+
+int OSSimExit ( OS_SIM *sim , PCB *endedProcess );
+
+int OSSimExitWithStatus ( OS_SIM *sim , int exitStatus , PCB *endedProcess );
+
+/* PROCESS TREE - WAIT reaps an ended child of the running process or blocks until one ends, KILL TREE ends a
+ * process and every descendant in one walk down its child lists */
+int OSSimWait ( OS_SIM *sim , int *childProcessID , int *exitStatus );
+
+int OSSimKillTree ( OS_SIM *sim , int processID , int *numKilled );
+
+/* MEMORY - on the running process, page is 0 to NUM_MEMORY_PAGES - 1, data holds MEMORY_PAGE_SIZE bytes */
+int OSSimWriteMemory ( OS_SIM *sim , int page , const char *data , int *copiedOnWrite );
+
+int OSSimReadMemory ( OS_SIM *sim , int page , char *data );
+
+int OSSimQuantum ( OS_SIM *sim );
+
+int OSSimSend ( OS_SIM *sim , int recipientProcessID , const char *messageStr , MESSAGE *sentMessage );
+
+int OSSimReceive ( OS_SIM *sim , MESSAGE *receivedMessage );
+
+int OSSimReply ( OS_SIM *sim , int recipientProcessID , const char *messageStr , MESSAGE *sentMessage );
+
+int OSSimNewSemaphore ( OS_SIM *sim , int semaphoreID , int initSemValue );
+
+int OSSimSemaphoreP ( OS_SIM *sim , int semaphoreID , int *semValue );
+
+int OSSimSemaphoreV ( OS_SIM *sim , int semaphoreID , int *semValue );
+
+int OSSimSetAffinity ( OS_SIM *sim , int processID , unsigned int affinityMask );
+
+int OSSimUseCPU ( OS_SIM *sim , int cpuID );
+
+/* PROCESS GROUPS - each handles every member in one pass over the group's membership list and reschedules
+ * once afterwards, the count is the number of members it acted on */
+int OSSimKillGroup ( OS_SIM *sim , int groupID , int *numKilled );
+
+int OSSimSetGroupPriority ( OS_SIM *sim , int groupID , int priorityLevel , int *numChanged );
+
+int OSSimGroupQuantum ( OS_SIM *sim , int groupID , int *numPreempted );
+
+/* BATCHES - the commands in between see one consistent running process per CPU, idle CPUs are only handed
+ * new work at OSSimEndBatch, once - a running process that blocks or ends is still replaced at once */
+int OSSimBeginBatch ( OS_SIM *sim );
+
+int OSSimEndBatch ( OS_SIM *sim );
+
+/* SNAPSHOTS - the whole state in one position-independent file, subscribers and outputFile are not part of it */
+int OSSimSaveSnapshot ( OS_SIM *sim , const char *path );
+
+int OSSimRestoreSnapshot ( OS_SIM *sim , const char *path );
+
+/* EVENTS - callbacks run synchronously inside the command that caused the event */
+int OSSimSubscribe ( OS_SIM *sim , unsigned int eventMask , OSSIM_EVENT_CALLBACK callback , void *context , int *subscriberID );
+
+int OSSimUnsubscribe ( OS_SIM *sim , int subscriberID );
+
+/* QUERIES */
+const PCB *OSSimFindProcess ( OS_SIM *sim , int processID );
+
+const PCB *OSSimRunningProcess ( OS_SIM *sim , int cpuID );
+
+int NumSystemProcessesTotal ( OS_SIM *sim );
+
+int CPUReadyCount ( OS_SIM *sim , CPU *cpu );
+
+double MeanReadyWaitTicks ( OS_SIM *sim );
+
+const char *OSSimStatusStr ( int status );
+
+const char *OSSimListOwnerStr ( int ownerID );
+
+/* CONSISTENCY - walks every queue read-only, describes the first violation found in violation */
+int OSSimCheckInvariants ( OS_SIM *sim , char *violation , int violationLength );
+
+/* FINGERPRINT - equal for equal logical states, whatever pool slots or addresses they occupy */
+unsigned long OSSimStateHash ( OS_SIM *sim );
+
+#endif
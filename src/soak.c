@@ -0,0 +1,265 @@
+/* Nic Pucci
+ * SOAK HARNESS - drives the random workload through one instance at full speed, checking invariants as it goes
+ *
+ * The run is reproducible from its seed and configuration alone, so a violation found after millions of
+ * operations can be replayed with a smaller check interval to find the exact operation that caused it.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "ossim.h"
+#include "Workload.h"
+
+#define DEFAULT_SOAK_OPS 10000000
+#define DEFAULT_CHECK_INTERVAL 10000 // ops between invariant checks
+#define DEFAULT_REPORT_INTERVAL_MS 1000
+#define DEFAULT_SOAK_NODES 2 // NUMA nodes, so migrations cross node distances
+#define MAX_VIOLATION_LENGTH 256
+
+typedef struct soakConfig
+{
+	unsigned int seed;
+	long numOps;
+	double maxSeconds; // 0 = stop only after numOps
+	int numCPUs;
+	int numNodes; // 0 = DEFAULT_SOAK_NODES when the CPUs split evenly into them, else 1
+	int numPriorityLevels;
+	long checkInterval;
+	int reportIntervalMs;
+} SOAK_CONFIG;
+
+typedef struct soakStats
+{
+	long numOps;
+	long numChecks;
+	double workloadNs; // time spent issuing commands, excluding invariant checks
+	double checkNs;
+	int peakLiveProcesses;
+} SOAK_STATS;
+
+double NsSince ( const struct timespec *startTime )
+{
+	struct timespec endTime;
+	clock_gettime ( CLOCK_MONOTONIC , &endTime );
+
+	return ( endTime.tv_sec - startTime -> tv_sec ) * 1e9 + ( endTime.tv_nsec - startTime -> tv_nsec );
+}
+
+long PeakResidentKB ()
+{
+	struct rusage usage;
+	if ( getrusage ( RUSAGE_SELF , &usage ) != 0 )
+	{
+		return -1;
+	}
+
+	return usage.ru_maxrss; // kilobytes on Linux
+}
+
+void PrintReport ( OS_SIM *sim , const SOAK_STATS *stats , double elapsedNs , long intervalOps , double intervalNs )
+{
+	LIST_POOL_STATS poolStats;
+	ListPoolGetStats ( &sim -> listPool , &poolStats );
+
+	printf ( "%.1f\t%ld\t%.0f\t%.0f\t%d\t%d\t%d\t%ld\t%ld\n" ,
+		elapsedNs / 1e9 ,
+		stats -> numOps ,
+		stats -> numOps / ( stats -> workloadNs / 1e9 ) ,
+		intervalOps / ( intervalNs / 1e9 ) ,
+		sim -> numLiveProcesses ,
+		stats -> peakLiveProcesses ,
+		poolStats.peakNodesInUse ,
+		PeakResidentKB () ,
+		stats -> numChecks
+	);
+	fflush ( stdout );
+}
+
+int RunSoak ( const SOAK_CONFIG *config , SOAK_STATS *stats )
+{
+	OS_SIM *sim = OSSimCreate ();
+	if ( !sim )
+	{
+		fprintf ( stderr , "ERROR: Could not allocate the simulator\n" );
+		return 1;
+	}
+
+	sim -> numCPUs = config -> numCPUs;
+	sim -> numNodes = config -> numNodes;
+	if ( !sim -> numNodes )
+	{
+		sim -> numNodes = config -> numCPUs % DEFAULT_SOAK_NODES == 0 ? DEFAULT_SOAK_NODES : 1;
+	}
+
+	sim -> numPriorityLevels = config -> numPriorityLevels;
+	int status = OSSimStart ( sim );
+	if ( status != OSSIM_SUCCESS )
+	{
+		fprintf ( stderr , "ERROR: %s\n" , OSSimStatusStr ( status ) );
+		OSSimFree ( sim );
+		return 1;
+	}
+
+	unsigned int randomState = config -> seed ? config -> seed : 1;
+	WorkloadCreateSemaphores ( sim , &randomState );
+
+	printf ( "elapsed_s\tops\tops_per_sec\tinterval_ops_per_sec\tlive_processes\tpeak_live_processes\tpeak_list_nodes\tpeak_rss_kb\tchecks\n" );
+
+	struct timespec startTime;
+	struct timespec reportTime;
+	clock_gettime ( CLOCK_MONOTONIC , &startTime );
+	reportTime = startTime;
+	long reportOps = 0;
+
+	char violation [ MAX_VIOLATION_LENGTH ];
+	int exitCode = 0;
+	while ( stats -> numOps < config -> numOps )
+	{
+		long chunkOps = config -> numOps - stats -> numOps;
+		if ( chunkOps > config -> checkInterval )
+		{
+			chunkOps = config -> checkInterval;
+		}
+
+		struct timespec chunkTime;
+		clock_gettime ( CLOCK_MONOTONIC , &chunkTime );
+		WorkloadRunOps ( sim , &randomState , chunkOps );
+		stats -> workloadNs += NsSince ( &chunkTime );
+		stats -> numOps += chunkOps;
+
+		clock_gettime ( CLOCK_MONOTONIC , &chunkTime );
+		status = OSSimCheckInvariants ( sim , violation , MAX_VIOLATION_LENGTH );
+		stats -> checkNs += NsSince ( &chunkTime );
+		stats -> numChecks += 1;
+
+		if ( status != OSSIM_SUCCESS )
+		{
+			fprintf ( stderr , "INVARIANT VIOLATED within ops %ld-%ld (seed %u): %s\n" ,
+				stats -> numOps - chunkOps + 1 ,
+				stats -> numOps ,
+				config -> seed ,
+				status == OSSIM_INVARIANT_VIOLATED ? violation : OSSimStatusStr ( status )
+			);
+			exitCode = 2;
+			break;
+		}
+
+		if ( sim -> numLiveProcesses > stats -> peakLiveProcesses )
+		{
+			stats -> peakLiveProcesses = sim -> numLiveProcesses;
+		}
+
+		double sinceReportNs = NsSince ( &reportTime );
+		if ( sinceReportNs >= config -> reportIntervalMs * 1e6 )
+		{
+			PrintReport ( sim , stats , NsSince ( &startTime ) , stats -> numOps - reportOps , sinceReportNs );
+			clock_gettime ( CLOCK_MONOTONIC , &reportTime );
+			reportOps = stats -> numOps;
+		}
+
+		if ( config -> maxSeconds > 0 && NsSince ( &startTime ) >= config -> maxSeconds * 1e9 )
+		{
+			break;
+		}
+	}
+
+	double elapsedNs = NsSince ( &startTime );
+	if ( stats -> numOps > reportOps )
+	{
+		PrintReport ( sim , stats , elapsedNs , stats -> numOps - reportOps , NsSince ( &reportTime ) );
+	}
+
+	fprintf ( stderr ,
+		"%s: %ld ops in %.2f s - %.0f ops/sec sustained, %.0f ns per invariant check, %d peak live processes, %ld KB peak RSS\n" ,
+		exitCode ? "FAILED" : "PASSED" ,
+		stats -> numOps ,
+		elapsedNs / 1e9 ,
+		stats -> numOps / ( stats -> workloadNs / 1e9 ) ,
+		stats -> checkNs / stats -> numChecks ,
+		stats -> peakLiveProcesses ,
+		PeakResidentKB ()
+	);
+
+	OSSimFree ( sim );
+	return exitCode;
+}
+
+void PrintUsage ( const char *programName )
+{
+	printf ( "Usage: %s [-s seed] [-n ops] [-d maxSeconds] [-c numCPUs (1-%d)] [-N numNodes] [-l numPriorityLevels (1-%d)] [-i checkIntervalOps] [-r reportIntervalMs]\n" ,
+		programName ,
+		MAX_NUM_CPUS ,
+		MAX_NUM_PRIORITY_LEVELS
+	);
+}
+
+int main ( int argc , char *argv [] )
+{
+	SOAK_CONFIG config =
+	{
+		.seed = 1 ,
+		.numOps = DEFAULT_SOAK_OPS ,
+		.maxSeconds = 0 ,
+		.numCPUs = 4 ,
+		.numNodes = 0 ,
+		.numPriorityLevels = NUM_PRIORITY_LEVELS ,
+		.checkInterval = DEFAULT_CHECK_INTERVAL ,
+		.reportIntervalMs = DEFAULT_REPORT_INTERVAL_MS
+	};
+
+	int option = 0;
+	while ( ( option = getopt ( argc , argv , "s:n:d:c:N:l:i:r:" ) ) != -1 )
+	{
+		if ( option == 's' )
+		{
+			config.seed = strtoul ( optarg , NULL , 10 );
+		}
+		else if ( option == 'n' )
+		{
+			config.numOps = atol ( optarg );
+		}
+		else if ( option == 'd' )
+		{
+			config.maxSeconds = atof ( optarg );
+		}
+		else if ( option == 'c' )
+		{
+			config.numCPUs = atoi ( optarg );
+		}
+		else if ( option == 'N' )
+		{
+			config.numNodes = atoi ( optarg );
+		}
+		else if ( option == 'l' )
+		{
+			config.numPriorityLevels = atoi ( optarg );
+		}
+		else if ( option == 'i' )
+		{
+			config.checkInterval = atol ( optarg );
+		}
+		else if ( option == 'r' )
+		{
+			config.reportIntervalMs = atoi ( optarg );
+		}
+		else
+		{
+			PrintUsage ( argv [ 0 ] );
+			exit ( 1 );
+		}
+	}
+
+	if ( config.numOps < 1 || config.checkInterval < 1 || config.reportIntervalMs < 1 || config.maxSeconds < 0 || config.numNodes < 0 )
+	{
+		PrintUsage ( argv [ 0 ] );
+		exit ( 1 );
+	}
+
+	SOAK_STATS stats;
+	memset ( &stats , 0 , sizeof ( SOAK_STATS ) );
+	return RunSoak ( &config , &stats );
+}